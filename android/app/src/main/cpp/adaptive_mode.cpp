@@ -0,0 +1,266 @@
+// Adaptive-sampling benchmark: keep timing runSession until the confidence interval of the median is
+// narrow enough relative to the median, or the time/sample budget runs out. Around that:
+//   - warm-up transient: MSER-5 truncation (batch means of 5, cut minimizing the marginal standard
+//     error) decides how many leading samples to drop before the interval is computed;
+//   - bimodality: Sarle's bimodality coefficient plus a two-class (Otsu) split of the steady samples,
+//     flagged only when the minor mode carries weight and Ashman's D says the modes separate;
+//   - quality: converged or not, why sampling stopped, and notes on anything that makes the median
+//     a poor summary.
+#include "modes.hpp"
+#include "runner_common.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace runner {
+
+#if HAVE_MNN
+namespace {
+
+// Leading samples to drop (MSER-5); at most half the series is ever cut.
+size_t mser5Truncation(const std::vector<double>& x) {
+    const size_t batch = 5;
+    const size_t m = x.size() / batch;
+    if (m < 4) return 0;
+    std::vector<double> b(m);
+    for (size_t j = 0; j < m; ++j) {
+        double s = 0.0;
+        for (size_t i = 0; i < batch; ++i) s += x[j * batch + i];
+        b[j] = s / batch;
+    }
+    std::vector<double> sum(m + 1, 0.0), sum2(m + 1, 0.0); // suffix sums
+    for (size_t j = m; j-- > 0;) {
+        sum[j] = sum[j + 1] + b[j];
+        sum2[j] = sum2[j + 1] + b[j] * b[j];
+    }
+    size_t best = 0;
+    double bestStat = INFINITY;
+    for (size_t d = 0; d <= m / 2; ++d) {
+        const double k = (double)(m - d);
+        const double ss = sum2[d] - sum[d] * sum[d] / k;
+        const double stat = ss / (k * k);
+        if (stat < bestStat) {
+            bestStat = stat;
+            best = d;
+        }
+    }
+    return best * batch;
+}
+
+struct MedianCI {
+    double median = 0.0;
+    double low = 0.0;
+    double high = 0.0;
+    double relWidth = INFINITY;
+};
+
+// Distribution-free interval from order statistics (normal approximation to the binomial).
+MedianCI medianCI(std::vector<double> x, double z) {
+    MedianCI ci;
+    const size_t n = x.size();
+    if (n == 0) return ci;
+    std::sort(x.begin(), x.end());
+    ci.median = medianOf(x);
+    const double half = z * std::sqrt((double)n) / 2.0;
+    const long lo = (long)std::floor(n / 2.0 - half) - 1;   // 1-based rank -> index
+    const long hi = (long)std::ceil(1.0 + n / 2.0 + half) - 1;
+    if (lo < 0 || hi >= (long)n) return ci; // too few samples for this confidence
+    ci.low = x[lo];
+    ci.high = x[hi];
+    if (ci.median > 0.0) ci.relWidth = (ci.high - ci.low) / ci.median;
+    return ci;
+}
+
+struct Modality {
+    double coefficient = 0.0; // Sarle's b; > 5/9 hints at more than one mode
+    double ashmanD = 0.0;
+    double lowMean = 0.0, lowWeight = 0.0;
+    double highMean = 0.0, highWeight = 0.0;
+    bool bimodal = false;
+};
+
+Modality modality(std::vector<double> x) {
+    Modality m;
+    const size_t n = x.size();
+    if (n < 8) return m;
+    double mean = 0.0;
+    for (double v : x) mean += v;
+    mean /= n;
+    double m2 = 0.0, m3 = 0.0, m4 = 0.0;
+    for (double v : x) {
+        const double d = v - mean;
+        m2 += d * d;
+        m3 += d * d * d;
+        m4 += d * d * d * d;
+    }
+    const double sd = std::sqrt(m2 / (n - 1));
+    if (sd <= 0.0) return m;
+    const double nn = (double)n;
+    const double g = nn / ((nn - 1) * (nn - 2)) * m3 / (sd * sd * sd);
+    const double tail = 3.0 * (nn - 1) * (nn - 1) / ((nn - 2) * (nn - 3));
+    const double k = nn * (nn + 1) / ((nn - 1) * (nn - 2) * (nn - 3)) * m4 / (sd * sd * sd * sd) - tail;
+    m.coefficient = (g * g + 1.0) / (k + tail);
+
+    // Two-class split maximizing between-class variance.
+    std::sort(x.begin(), x.end());
+    std::vector<double> prefix(n + 1, 0.0);
+    for (size_t i = 0; i < n; ++i) prefix[i + 1] = prefix[i] + x[i];
+    size_t split = 1;
+    double bestBetween = -1.0;
+    for (size_t i = 1; i < n; ++i) {
+        const double w1 = (double)i / n, w2 = 1.0 - w1;
+        const double mu1 = prefix[i] / i, mu2 = (prefix[n] - prefix[i]) / (n - i);
+        const double between = w1 * w2 * (mu1 - mu2) * (mu1 - mu2);
+        if (between > bestBetween) {
+            bestBetween = between;
+            split = i;
+        }
+    }
+    auto variance = [&x](size_t a, size_t b, double mu) {
+        double s = 0.0;
+        for (size_t i = a; i < b; ++i) s += (x[i] - mu) * (x[i] - mu);
+        return b - a > 1 ? s / (b - a - 1) : 0.0;
+    };
+    m.lowMean = prefix[split] / split;
+    m.highMean = (prefix[n] - prefix[split]) / (n - split);
+    m.lowWeight = (double)split / n;
+    m.highWeight = 1.0 - m.lowWeight;
+    const double v1 = variance(0, split, m.lowMean), v2 = variance(split, n, m.highMean);
+    m.ashmanD = v1 + v2 > 0.0 ? std::sqrt(2.0) * (m.highMean - m.lowMean) / std::sqrt(v1 + v2) : INFINITY;
+    m.bimodal = m.coefficient > 5.0 / 9.0 && std::min(m.lowWeight, m.highWeight) >= 0.05 && m.ashmanD > 2.0;
+    return m;
+}
+
+double zFor(double confidence) {
+    if (confidence >= 0.985) return 2.576;
+    if (confidence >= 0.925) return 1.960;
+    return 1.645;
+}
+
+} // namespace
+#endif
+
+std::string runAdaptive(const std::string& configJson) {
+#if HAVE_MNN
+    try {
+        json::Value root = json::parse(configJson);
+        RunOptions opt;
+        applyRunOptions(root, opt);
+        if (opt.modelPath.empty()) throw std::runtime_error("Missing modelPath");
+        const int warmup = std::max(0, root.getInt("warmup", 3));
+        const int minSamples = std::max(10, root.getInt("minSamples", 20));
+        const int maxSamples = std::max(minSamples, root.getInt("maxSamples", 10000));
+        const double maxMs = std::max(100.0, root.getNumber("maxMs", 30000.0));
+        const double target = std::max(1e-4, root.getNumber("targetRelWidth", 0.02));
+        const double confidence = root.getNumber("confidence", 0.95);
+        const double z = zFor(confidence);
+
+        std::string stopReason = "ci_reached";
+        clock::time_point start, end;
+        size_t nextCheck = 0;
+        BenchHooks hooks;
+        hooks.beforeTimed = [&start] { start = clock::now(); };
+        hooks.afterTimed = [&end] { end = clock::now(); };
+        hooks.keepSampling = [&](const std::vector<double>& s) {
+            if ((int)s.size() >= maxSamples) {
+                stopReason = "max_samples";
+                return false;
+            }
+            if (msBetween(start, clock::now()) >= maxMs) {
+                stopReason = "time_budget";
+                return false;
+            }
+            // Re-evaluating costs a sort; do it about 20 times per doubling of the series.
+            if (s.size() < nextCheck) return true;
+            nextCheck = s.size() + std::max<size_t>(1, s.size() / 20);
+            const size_t cut = mser5Truncation(s);
+            std::vector<double> steady(s.begin() + cut, s.end());
+            if ((int)steady.size() < minSamples) return true;
+            return medianCI(steady, z).relWidth > target;
+        };
+        BenchRun run = benchmarkConfig(opt, warmup, minSamples, hooks);
+        const double sampledMs = msBetween(start, end);
+
+        const auto& all = run.samplesMs;
+        const size_t cut = mser5Truncation(all);
+        std::vector<double> steady(all.begin() + cut, all.end());
+        const MedianCI ci = medianCI(steady, z);
+        const bool converged = ci.relWidth <= target;
+        const Modality mod = modality(steady);
+        double mean = 0.0;
+        for (double v : steady) mean += v;
+        mean /= std::max<size_t>(1, steady.size());
+        double var = 0.0;
+        for (double v : steady) var += (v - mean) * (v - mean);
+        const double cv = steady.size() > 1 && mean > 0.0 ? std::sqrt(var / (steady.size() - 1)) / mean : 0.0;
+        const double transientMedian = cut ? medianOf(std::vector<double>(all.begin(), all.begin() + cut)) : 0.0;
+
+        std::vector<std::string> notes;
+        std::ostringstream note;
+        note.setf(std::ios::fixed); note.precision(2);
+        if (!converged) {
+            note << "Not converged: median CI is " << (std::isfinite(ci.relWidth) ? ci.relWidth * 100.0 : 0.0)
+                 << "% wide, target " << target * 100.0 << "% (" << stopReason << ")";
+            notes.push_back(note.str());
+            note.str("");
+        }
+        if (cut) {
+            note << "Warm-up transient: first " << cut << " samples dropped (median " << transientMedian
+                 << " ms vs " << ci.median << " ms steady)";
+            notes.push_back(note.str());
+            note.str("");
+        }
+        if (mod.bimodal) {
+            note << "Bimodal: modes at " << mod.lowMean << " ms (" << mod.lowWeight * 100.0 << "%) and "
+                 << mod.highMean << " ms (" << mod.highWeight * 100.0 << "%); the median hides one of them";
+            notes.push_back(note.str());
+            note.str("");
+        }
+        if (cv > 0.10) {
+            note << "High dispersion: CV " << cv * 100.0 << "%";
+            notes.push_back(note.str());
+            note.str("");
+        }
+        const char* quality = !converged ? "poor" : (mod.bimodal || cv > 0.10) ? "fair" : "good";
+
+        std::ostringstream json;
+        json.setf(std::ios::fixed); json.precision(4);
+        json << "{\"adaptive\":true,\"config\":\"" << describeOptions(opt) << "\""
+             << ",\"quality\":\"" << quality << "\""
+             << ",\"converged\":" << (converged ? "true" : "false")
+             << ",\"stop_reason\":\"" << stopReason << "\""
+             << ",\"samples_needed\":" << all.size()
+             << ",\"transient_samples\":" << cut
+             << ",\"steady_samples\":" << steady.size()
+             << ",\"sampling_ms\":" << sampledMs
+             << ",\"median_ms\":" << ci.median
+             << ",\"ci\":{\"confidence\":" << confidence
+             << ",\"low_ms\":" << ci.low << ",\"high_ms\":" << ci.high
+             << ",\"rel_width\":" << (std::isfinite(ci.relWidth) ? ci.relWidth : -1.0)
+             << ",\"target_rel_width\":" << target << "}"
+             << ",\"cv\":" << cv
+             << ",\"transient_median_ms\":" << transientMedian
+             << ",\"modality\":{\"bimodal\":" << (mod.bimodal ? "true" : "false")
+             << ",\"coefficient\":" << mod.coefficient
+             << ",\"ashman_d\":" << (std::isfinite(mod.ashmanD) ? mod.ashmanD : -1.0)
+             << ",\"modes\":[{\"mean_ms\":" << mod.lowMean << ",\"weight\":" << mod.lowWeight << "}"
+             << ",{\"mean_ms\":" << mod.highMean << ",\"weight\":" << mod.highWeight << "}]}"
+             << ",\"notes\":[";
+        for (size_t i = 0; i < notes.size(); ++i) json << (i ? "," : "") << "\"" << jsonEscape(notes[i]) << "\"";
+        json << "],\"latency\":";
+        writeLatency(json, steady);
+        json << ",\"raw_samples_ms\":[";
+        for (size_t i = 0; i < all.size(); ++i) json << (i ? "," : "") << all[i];
+        json << "],\"memory_mb\":" << run.memoryMb << "}";
+        return json.str();
+    } catch (const std::exception& ex) {
+        return std::string("{\"error\":\"") + jsonEscape(ex.what()) + "\"}";
+    }
+#else
+    (void)configJson;
+    return "{\"error\":\"MNN not bundled. Cannot run the adaptive benchmark. Place headers and libMNN.so as documented.\"}";
+#endif
+}
+
+} // namespace runner
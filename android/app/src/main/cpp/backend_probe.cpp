@@ -0,0 +1,224 @@
+#include "backend_probe.hpp"
+#include "runner_common.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <mutex>
+#include <sstream>
+
+#include <dlfcn.h>
+#if defined(__linux__)
+#include <sys/auxv.h>
+#endif
+
+#if HAVE_MNN && HAVE_MNN_EXPRESS
+#include "MNN/expr/Executor.hpp"
+#endif
+
+namespace runner {
+
+namespace {
+
+struct ProbeResult {
+    std::vector<BackendCaps> backends;
+    CpuFeatures cpu;
+    double probeMs = 0.0;
+    std::string json;
+};
+
+CpuFeatures readCpuFeatures() {
+    CpuFeatures f;
+#if defined(__aarch64__) && defined(__linux__)
+    // Bit positions from the arm64 uapi hwcap.h; spelled out so older NDK headers still build.
+    const unsigned long hw = getauxval(AT_HWCAP);
+    const unsigned long hw2 = getauxval(AT_HWCAP2);
+    f.known = true;
+    f.fp16 = hw & (1UL << 10);       // HWCAP_ASIMDHP
+    f.dotProduct = hw & (1UL << 20); // HWCAP_ASIMDDP
+    f.sve = hw & (1UL << 22);        // HWCAP_SVE
+    f.sve2 = hw2 & (1UL << 1);       // HWCAP2_SVE2
+    f.i8mm = hw2 & (1UL << 13);      // HWCAP2_I8MM
+    f.bf16 = hw2 & (1UL << 14);      // HWCAP2_BF16
+#elif (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    f.known = true;
+    f.fp16 = __builtin_cpu_supports("avx512fp16");
+    f.dotProduct = __builtin_cpu_supports("avx512vnni");
+    f.bf16 = __builtin_cpu_supports("avx512bf16");
+    if (__builtin_cpu_supports("avx2")) f.names.push_back("avx2");
+    if (__builtin_cpu_supports("fma")) f.names.push_back("fma");
+    if (__builtin_cpu_supports("avx512f")) f.names.push_back("avx512f");
+#endif
+    if (f.fp16) f.names.push_back("fp16");
+    if (f.dotProduct) f.names.push_back("dotprod");
+    if (f.i8mm) f.names.push_back("i8mm");
+    if (f.bf16) f.names.push_back("bf16");
+    if (f.sve) f.names.push_back("sve");
+    if (f.sve2) f.names.push_back("sve2");
+    return f;
+}
+
+// dlopen with RTLD_GLOBAL so the plugin's backend registration is visible to libMNN; the handle is
+// kept for the life of the process.
+void loadPlugin(BackendCaps& b) {
+    if (b.plugin.empty()) {
+        b.pluginLoaded = true;
+        return;
+    }
+    if (void* h = dlopen(b.plugin.c_str(), RTLD_NOW | RTLD_NOLOAD)) {
+        b.alreadyLoaded = true;
+        b.pluginLoaded = true;
+        dlclose(h); // drops only the reference NOLOAD took
+        return;
+    }
+    auto t0 = clock::now();
+    void* h = dlopen(b.plugin.c_str(), RTLD_NOW | RTLD_GLOBAL);
+    b.loadMs = msBetween(t0, clock::now());
+    b.pluginLoaded = h != nullptr;
+    if (!h) {
+        const char* err = dlerror();
+        b.loadError = err ? err : "dlopen failed";
+    }
+}
+
+#if HAVE_MNN
+MNNForwardType forwardOf(const std::string& name) {
+    std::string upper = name;
+    std::transform(upper.begin(), upper.end(), upper.begin(), [](unsigned char c) { return (char)std::toupper(c); });
+    return (MNNForwardType)mapForward(upper);
+}
+
+void probeRuntime(BackendCaps& b, const CpuFeatures& cpu) {
+    const MNNForwardType type = forwardOf(b.name);
+    MNN::ScheduleConfig cfg;
+    cfg.type = type;
+    cfg.backupType = type; // no silent CPU fallback: a missing backend yields no runtime of its type
+    cfg.numThread = 1;
+    MNN::BackendConfig bcfg;
+    cfg.backendConfig = &bcfg;
+    auto t0 = clock::now();
+    MNN::RuntimeInfo rt = MNN::Interpreter::createRuntime({cfg});
+    b.runtimeMs = msBetween(t0, clock::now());
+    b.runtime = rt.first.count(type) && rt.first.at(type);
+    if (!b.runtime) {
+        b.statusSource = "none";
+        return;
+    }
+#if HAVE_MNN_EXPRESS
+    auto exe = MNN::Express::Executor::newExecutor(type, bcfg, 1);
+    if (exe) {
+        b.fp16 = exe->getCurrentRuntimeStatus(MNN::STATUS_SUPPORT_FP16) ? 1 : 0;
+        b.dotProduct = exe->getCurrentRuntimeStatus(MNN::STATUS_SUPPORT_DOT_PRODUCT) ? 1 : 0;
+        b.powerLow = exe->getCurrentRuntimeStatus(MNN::STATUS_SUPPORT_POWER_LOW) ? 1 : 0;
+        b.statusSource = "runtime";
+        return;
+    }
+#endif
+    // RuntimeStatus is only reachable through the Express Executor; for the CPU the hwcaps answer
+    // the same question.
+    if (b.name == "cpu" && cpu.known) {
+        b.fp16 = cpu.fp16 ? 1 : 0;
+        b.dotProduct = cpu.dotProduct ? 1 : 0;
+        b.statusSource = "hwcap";
+    } else {
+        b.statusSource = "none";
+    }
+}
+#endif
+
+void writeTri(std::ostream& json, const char* key, int v) {
+    json << ",\"" << key << "\":" << (v < 0 ? "null" : v ? "true" : "false");
+}
+
+std::string toJson(const ProbeResult& r) {
+    std::ostringstream json;
+    json.setf(std::ios::fixed); json.precision(3);
+    json << "{";
+    for (auto& b : r.backends) {
+        const bool available = b.pluginLoaded && b.driverLoaded && b.runtime;
+        json << "\"" << b.name << "\":{\"available\":" << (available ? "true" : "false")
+             << ",\"lib\":" << (b.driverLoaded ? "true" : "false")
+             << ",\"plugin\":" << (b.pluginLoaded ? "true" : "false")
+             << ",\"source\":" << (b.plugin.empty() ? "\"core\"" : b.pluginLoaded ? "\"apk\"" : "null")
+             << ",\"already_loaded\":" << (b.alreadyLoaded ? "true" : "false")
+             << ",\"load_ms\":" << b.loadMs
+             << ",\"runtime\":" << (b.runtime ? "true" : "false")
+             << ",\"runtime_ms\":" << b.runtimeMs;
+        writeTri(json, "fp16", b.fp16);
+        writeTri(json, "dot_product", b.dotProduct);
+        writeTri(json, "power_low", b.powerLow);
+        json << ",\"status_source\":\"" << b.statusSource << "\"";
+        if (!b.loadError.empty()) json << ",\"error\":\"" << jsonEscape(b.loadError) << "\"";
+        json << "},";
+    }
+    json << "\"cpu_features\":{\"known\":" << (r.cpu.known ? "true" : "false") << ",\"features\":[";
+    for (size_t i = 0; i < r.cpu.names.size(); ++i) json << (i ? "," : "") << "\"" << r.cpu.names[i] << "\"";
+    json << "]},\"mnn\":" << (HAVE_MNN ? "true" : "false")
+         << ",\"probe_ms\":" << r.probeMs << "}";
+    return json.str();
+}
+
+const ProbeResult& probe() {
+    static ProbeResult result;
+    static std::once_flag once;
+    std::call_once(once, [] {
+        auto t0 = clock::now();
+        result.cpu = readCpuFeatures();
+        const std::pair<const char*, const char*> plugins[] = {
+            {"cpu", ""}, {"vulkan", "libMNN_Vulkan.so"}, {"opencl", "libMNN_CL.so"}, {"opengl", "libMNN_GL.so"}};
+        for (auto& p : plugins) {
+            BackendCaps b;
+            b.name = p.first;
+            b.plugin = p.second;
+            if (b.name == "vulkan") {
+                // The plugin is useless without the system loader; check it first so a missing one
+                // is reported as such rather than as a plugin load error.
+                void* vk = dlopen("libvulkan.so", RTLD_NOW | RTLD_GLOBAL);
+                b.driverLoaded = vk != nullptr;
+                if (!vk) {
+                    b.loadError = "libvulkan.so not loadable";
+                    b.statusSource = "none";
+                    result.backends.push_back(b);
+                    continue;
+                }
+            }
+            loadPlugin(b);
+#if HAVE_MNN
+            if (b.pluginLoaded) probeRuntime(b, result.cpu);
+#else
+            b.statusSource = "none";
+#endif
+            result.backends.push_back(b);
+        }
+        result.probeMs = msBetween(t0, clock::now());
+        result.json = toJson(result);
+    });
+    return result;
+}
+
+} // namespace
+
+const std::vector<BackendCaps>& backendCaps() {
+    return probe().backends;
+}
+
+const CpuFeatures& cpuFeatures() {
+    return probe().cpu;
+}
+
+std::string probeBackendsJson() {
+    return probe().json;
+}
+
+std::string resolvePrecision(const std::string& precision, const std::string& backend) {
+    if (precision != "AUTO") return precision;
+    std::string name = backend;
+    std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    if (name == "opengl_es" || name == "opengl_es3") name = "opengl";
+    for (auto& b : backendCaps()) {
+        if (b.name == name) return b.fp16 == 1 ? "LOW" : "NORMAL";
+    }
+    return "NORMAL";
+}
+
+} // namespace runner
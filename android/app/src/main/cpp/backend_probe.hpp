@@ -0,0 +1,47 @@
+// Backend plugin loader and capability probe, run once per process: each libMNN_* plugin is dlopen'd
+// with timing, a minimal runtime is created for its forward type, and RuntimeStatus (FP16, dot
+// product, low-power) is read back. CPU ISA features come from the kernel's hwcaps.
+#pragma once
+#include <string>
+#include <vector>
+
+namespace runner {
+
+struct BackendCaps {
+    std::string name;         // "cpu", "vulkan", "opencl", "opengl"
+    std::string plugin;       // plugin library, empty for CPU
+    bool pluginLoaded = false;
+    bool alreadyLoaded = false; // loaded before the probe (e.g. by System.loadLibrary)
+    double loadMs = 0.0;
+    std::string loadError;
+    bool driverLoaded = true;  // vendor loader the plugin needs (libvulkan.so for Vulkan)
+    bool runtime = false;      // createRuntime produced a runtime of this forward type
+    double runtimeMs = 0.0;
+    // RuntimeStatus values: 1 / 0, or -1 when the runtime could not be asked.
+    int fp16 = -1;
+    int dotProduct = -1;
+    int powerLow = -1;
+    std::string statusSource;  // "runtime", "hwcap" or "none"
+};
+
+struct CpuFeatures {
+    bool known = false;
+    bool fp16 = false;     // FP16 vector arithmetic (asimdhp)
+    bool dotProduct = false;
+    bool i8mm = false;
+    bool bf16 = false;
+    bool sve = false;
+    bool sve2 = false;
+    std::vector<std::string> names;
+};
+
+// Probed on first call; later calls return the cached result.
+const std::vector<BackendCaps>& backendCaps();
+const CpuFeatures& cpuFeatures();
+// The cached probe as JSON, keeping the keys of the Kotlin probe ("available", "lib", "plugin").
+std::string probeBackendsJson();
+
+// "AUTO" precision: LOW where the backend does FP16 math, NORMAL elsewhere; other values unchanged.
+std::string resolvePrecision(const std::string& precision, const std::string& backend);
+
+} // namespace runner
@@ -0,0 +1,171 @@
+// Accuracy-vs-speed comparison across backends and precision modes.
+#include "modes.hpp"
+#include "runner_common.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace runner {
+
+#if HAVE_MNN
+namespace {
+
+struct OpTrace {
+    std::string name;
+    std::string type;
+    std::vector<float> data;
+};
+
+struct ConfigRun {
+    RunOptions opt;
+    BenchRun bench;
+    std::vector<OpTrace> ops;
+    bool traceTruncated = false;
+};
+
+ConfigRun runConfig(const RunOptions& opt, int warmup, int iterations, bool traceOps, size_t traceBudgetBytes) {
+    ConfigRun run;
+    run.opt = opt;
+    BenchHooks hooks;
+    // Intermediate capture runs after the timed loop so callback overhead never lands in the latency samples.
+    if (traceOps) {
+        hooks.afterRun = [&](MNN::Interpreter* net, MNN::Session* session) {
+            size_t used = 0;
+            auto before = [](const std::vector<MNN::Tensor*>&, const MNN::OperatorInfo*) { return true; };
+            auto after = [&](const std::vector<MNN::Tensor*>& tensors, const MNN::OperatorInfo* info) {
+                if (!info || tensors.empty() || !tensors[0]) return true;
+                if (used >= traceBudgetBytes) {
+                    run.traceTruncated = true;
+                    return true;
+                }
+                OpTrace rec;
+                rec.name = info->name();
+                rec.type = info->type();
+                rec.data = tensorToFloat(tensors[0]);
+                used += rec.data.size() * sizeof(float);
+                run.ops.emplace_back(std::move(rec));
+                return true;
+            };
+            net->runSessionWithCallBackInfo(session, before, after, true);
+        };
+    }
+    run.bench = benchmarkConfig(opt, warmup, iterations, hooks);
+    return run;
+}
+
+void writeConfig(std::ostream& json, const ConfigRun& run) {
+    json << "\"label\":\"" << jsonEscape(describeOptions(run.opt)) << "\""
+         << ",\"backend\":\"" << run.opt.backend << "\""
+         << ",\"precisionMode\":\"" << run.opt.precisionMode << "\""
+         << ",\"threads\":" << run.opt.threads
+         << ",\"createSession_ms\":" << run.bench.createSessionMs
+         << ",\"memory_mb\":" << run.bench.memoryMb
+         << ",\"latency\":";
+    writeLatency(json, run.bench.samplesMs);
+}
+
+} // namespace
+
+std::string runCompare(const std::string& configJson) {
+    try {
+        json::Value root = json::parse(configJson);
+        RunOptions base;
+        applyRunOptions(root, base);
+        if (base.modelPath.empty()) throw std::runtime_error("Missing modelPath");
+
+        const int warmup = std::max(0, root.getInt("warmup", 1));
+        const int iterations = std::max(1, root.getInt("iterations", 5));
+        const bool traceOps = root.getBool("traceOps", false);
+        const size_t traceBudget = (size_t)std::max(1.0, root.getNumber("traceBudgetMB", 256.0)) << 20;
+        const double relTol = root.getNumber("opRelTolerance", 1e-2);
+        const double cosTol = root.getNumber("opCosineTolerance", 0.999);
+
+        // Reference defaults to CPU/Precision_High; any key in "reference" overrides that.
+        RunOptions refOpt = base;
+        refOpt.backend = "CPU";
+        refOpt.backupType = "CPU";
+        refOpt.precisionMode = "HIGH";
+        refOpt.cacheFile.clear();
+        if (auto* r = root.get("reference")) applyRunOptions(*r, refOpt);
+
+        std::vector<RunOptions> candOpts;
+        if (auto* c = root.get("candidates")) {
+            for (auto& item : c->items) {
+                RunOptions o = base;
+                applyRunOptions(item, o);
+                candOpts.push_back(o);
+            }
+        }
+        // Without an explicit list, compare the currently selected config against the reference.
+        if (candOpts.empty()) candOpts.push_back(base);
+
+        ConfigRun ref = runConfig(refOpt, warmup, iterations, traceOps, traceBudget);
+        const double refMedian = medianOf(ref.bench.samplesMs);
+
+        std::ostringstream json;
+        json.setf(std::ios::fixed); json.precision(6);
+        json << "{\"compare\":true,\"reference\":{";
+        writeConfig(json, ref);
+        json << "},\"candidates\":[";
+        for (size_t ci = 0; ci < candOpts.size(); ++ci) {
+            if (ci) json << ",";
+            json << "{";
+            ConfigRun cand;
+            try {
+                cand = runConfig(candOpts[ci], warmup, iterations, traceOps, traceBudget);
+            } catch (const std::exception& e) {
+                json << "\"label\":\"" << jsonEscape(describeOptions(candOpts[ci])) << "\""
+                     << ",\"error\":\"" << jsonEscape(e.what()) << "\"}";
+                continue;
+            }
+            writeConfig(json, cand);
+            const double candMedian = medianOf(cand.bench.samplesMs);
+            json << ",\"speedup_vs_reference\":" << (candMedian > 0.0 ? refMedian / candMedian : 0.0);
+
+            json << ",\"outputs\":";
+            writeOutputErrors(json, ref.bench.outputs, cand.bench.outputs);
+
+            if (traceOps) {
+                // Backends may fuse or rename ops; only ops present in both traces are compared, in candidate order.
+                std::map<std::string, const OpTrace*> refByName;
+                for (auto& op : ref.ops) refByName.emplace(op.name, &op);
+                size_t compared = 0;
+                bool found = false;
+                json << ",\"op_trace\":{";
+                for (size_t oi = 0; oi < cand.ops.size() && !found; ++oi) {
+                    auto& op = cand.ops[oi];
+                    auto it = refByName.find(op.name);
+                    if (it == refByName.end()) continue;
+                    ErrStats st = computeErr(it->second->data, op.data);
+                    if (st.sizeMismatch) continue;
+                    ++compared;
+                    if (st.relL2 > relTol || st.cosine < cosTol) {
+                        found = true;
+                        json << "\"first_divergent_op\":{\"index\":" << (oi + 1)
+                             << ",\"name\":\"" << jsonEscape(op.name) << "\""
+                             << ",\"type\":\"" << jsonEscape(op.type) << "\"";
+                        writeErrFields(json, st);
+                        json << "},";
+                    }
+                }
+                if (!found) json << "\"first_divergent_op\":null,";
+                json << "\"ops_compared\":" << compared
+                     << ",\"truncated\":" << ((ref.traceTruncated || cand.traceTruncated) ? "true" : "false") << "}";
+            }
+            json << "}";
+        }
+        json << "]}";
+        return json.str();
+    } catch (const std::exception& e) {
+        return std::string("{\"error\":\"") + jsonEscape(e.what()) + "\"}";
+    }
+}
+#else
+std::string runCompare(const std::string& configJson) {
+    (void)configJson;
+    return "{\"error\":\"MNN not bundled. Cannot compare. Place headers and libMNN.so as documented.\"}";
+}
+#endif
+
+} // namespace runner
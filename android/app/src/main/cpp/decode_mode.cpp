@@ -0,0 +1,391 @@
+// Autoregressive decode benchmark: one prefill step, then one step per new token with a
+// growing context. Drives the model through the Express Module API when it is
+// available (what MNN's own LLM runtime uses) or through repeated session runs.
+//
+// No KV cache state is handed to the model: MNN's attention takes it from a KVMeta attached with
+// RuntimeManager::setHintPtr(KVCACHE_INFO), and that struct is not part of the public headers, so
+// its layout cannot be relied on from here. Each step therefore feeds the whole context so far
+// (prompt plus generated tokens), which is what uncached decoding costs: step time and footprint
+// grow with the context. KVCACHE_SIZE_LIMIT and the KV-cache directory are still set on the Module
+// runtime, where attention ops that keep their own cache pick them up.
+#include "modes.hpp"
+#include "runner_common.hpp"
+#include "telemetry.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <sstream>
+
+namespace runner {
+
+#if HAVE_MNN
+namespace {
+
+enum class Role { Tokens, Positions, Mask, Other };
+
+// One dimension of a decode input template: a fixed size, or the current
+// step length ("seq"), total context ("ctx") or cached length ("past").
+struct Dim {
+    enum Kind { Fixed, Seq, Ctx, Past } kind = Fixed;
+    int value = 1;
+};
+
+struct InputTemplate {
+    std::string name;
+    Role role = Role::Other;
+    std::vector<Dim> dims;
+    bool hasTemplate = false; // false: keep the model's own dims
+};
+
+Role roleFromName(const std::string& name) {
+    std::string n = name;
+    std::transform(n.begin(), n.end(), n.begin(), ::tolower);
+    if (n.find("mask") != std::string::npos) return Role::Mask;
+    if (n.find("pos") != std::string::npos) return Role::Positions;
+    if (n.find("ids") != std::string::npos || n.find("token") != std::string::npos ||
+        n.find("embed") != std::string::npos) return Role::Tokens;
+    return Role::Other;
+}
+
+Role roleFromString(const std::string& s, Role def) {
+    if (s == "tokens") return Role::Tokens;
+    if (s == "positions") return Role::Positions;
+    if (s == "mask") return Role::Mask;
+    if (s == "other") return Role::Other;
+    return def;
+}
+
+// Layout of MNN's exported LLMs: input_ids [seq], position_ids [1,seq], attention_mask [1,1,seq,ctx].
+std::vector<Dim> defaultDims(Role role) {
+    Dim one; one.value = 1;
+    Dim seq; seq.kind = Dim::Seq;
+    Dim ctx; ctx.kind = Dim::Ctx;
+    switch (role) {
+        case Role::Tokens: return {seq};
+        case Role::Positions: return {one, seq};
+        case Role::Mask: return {one, one, seq, ctx};
+        default: return {};
+    }
+}
+
+std::vector<InputTemplate> buildTemplates(const json::Value& root, const std::vector<std::string>& modelInputs) {
+    const json::Value* explicitDims = root.get("decodeInputs");
+    const json::Value* roles = root.get("decodeRoles");
+    std::vector<InputTemplate> out;
+    for (auto& name : modelInputs) {
+        InputTemplate t;
+        t.name = name;
+        t.role = roleFromName(name);
+        if (roles) t.role = roleFromString(roles->getString(name), t.role);
+        const json::Value* dims = explicitDims ? explicitDims->get(name) : nullptr;
+        if (dims && dims->isArray()) {
+            t.hasTemplate = true;
+            for (auto& d : dims->items) {
+                Dim dim;
+                if (d.isNumber()) dim.value = (int)d.number;
+                else if (d.str == "seq") dim.kind = Dim::Seq;
+                else if (d.str == "ctx") dim.kind = Dim::Ctx;
+                else if (d.str == "past") dim.kind = Dim::Past;
+                t.dims.push_back(dim);
+            }
+        } else if (t.role != Role::Other) {
+            t.hasTemplate = true;
+            t.dims = defaultDims(t.role);
+        }
+        out.push_back(t);
+    }
+    return out;
+}
+
+std::vector<int> resolveDims(const InputTemplate& t, int seq, int past) {
+    std::vector<int> dims;
+    for (auto& d : t.dims) {
+        switch (d.kind) {
+            case Dim::Seq: dims.push_back(seq); break;
+            case Dim::Ctx: dims.push_back(past + seq); break;
+            case Dim::Past: dims.push_back(std::max(past, 1)); break;
+            default: dims.push_back(d.value); break;
+        }
+    }
+    return dims;
+}
+
+// Fill one step's input buffer. Tokens get pseudo-random ids (or normal floats for embeddings),
+// positions count up from the cached length, masks are causal over [seq, ctx].
+void fillStep(void* data, halide_type_t type, const std::vector<int>& dims, Role role,
+              int seq, int past, int vocab, std::mt19937& rng) {
+    size_t n = 1;
+    for (int d : dims) n *= (size_t)std::max(d, 0);
+    const bool isFloat = type.code == halide_type_float;
+    const int ctx = past + seq;
+    for (size_t k = 0; k < n; ++k) {
+        double v = 0.0;
+        switch (role) {
+            case Role::Tokens:
+                v = isFloat ? std::normal_distribution<float>(0.0f, 1.0f)(rng) : (double)(rng() % (unsigned)vocab);
+                break;
+            case Role::Positions:
+                v = past + (int)(k % (size_t)seq);
+                break;
+            case Role::Mask: {
+                const int i = (int)((k / (size_t)ctx) % (size_t)seq);
+                const int j = (int)(k % (size_t)ctx);
+                const bool visible = j <= past + i;
+                // fp16-safe "minus infinity" for additive float masks, 1/0 for integer masks
+                v = isFloat ? (visible ? 0.0 : -65504.0) : (visible ? 1.0 : 0.0);
+                break;
+            }
+            default:
+                v = 0.0;
+        }
+        if (isFloat) static_cast<float*>(data)[k] = (float)v;
+        else if (type.bits == 64) static_cast<int64_t*>(data)[k] = (int64_t)v;
+        else if (type.bits == 8) static_cast<int8_t*>(data)[k] = (int8_t)v;
+        else static_cast<int32_t*>(data)[k] = (int32_t)v;
+    }
+}
+
+struct StepRecord {
+    int ctx = 0;
+    double ms = 0.0;
+    double resizeMs = 0.0;
+    long long rssBytes = -1;
+    float memoryMb = 0.0f;
+};
+
+struct DecodeParams {
+    int promptTokens = 32;
+    int newTokens = 64;
+    int vocab = 32000;
+    int kvCacheLimit = -1;
+    std::string kvCacheDir;
+};
+
+// Session engine: every step resizes inputs and the session, then runs it.
+std::vector<StepRecord> decodeWithSession(const RunOptions& opt, const json::Value& root, const DecodeParams& p,
+                                          std::vector<InputTemplate>& templates, std::string& note) {
+    std::unique_ptr<MNN::Interpreter> net(MNN::Interpreter::createFromFile(opt.modelPath.c_str()));
+    if (!net) throw std::runtime_error("Failed to create interpreter");
+    if (!opt.cacheFile.empty()) net->setCacheFile(opt.cacheFile.c_str());
+    for (auto& kv : opt.sessionHints) net->setSessionHint((MNN::Interpreter::HintMode)kv.first, kv.second);
+    if (p.kvCacheLimit >= 0) net->setSessionHint(MNN::Interpreter::KVCACHE_SIZE_LIMIT, p.kvCacheLimit);
+    if (!p.kvCacheDir.empty()) {
+        note = "EXTERNAL_PATH_KVCACHE_DIR needs the Module engine (RuntimeManager::setExternalPath); ignored";
+    }
+    MNN::BackendConfig bcfg = makeBackendConfig(opt);
+    MNN::ScheduleConfig cfg = makeScheduleConfig(opt, &bcfg);
+    auto session = net->createSession(cfg);
+    if (!session) throw std::runtime_error("Failed to create session");
+
+    std::vector<std::string> names;
+    for (auto& kv : net->getSessionInputAll(session)) names.push_back(kv.first);
+    templates = buildTemplates(root, names);
+
+    std::mt19937 rng(42);
+    std::vector<StepRecord> steps;
+    const int past = 0; // nothing cached: every step feeds the whole context
+    TelemetryLease telemetry;
+    telemetry.runBegin((uint32_t)p.newTokens + 1);
+    for (int step = 0; step <= p.newTokens; ++step) {
+        const int seq = p.promptTokens + step;
+        StepRecord rec;
+        auto t0 = clock::now();
+        for (auto& t : templates) {
+            if (!t.hasTemplate) continue;
+            auto* in = net->getSessionInput(session, t.name.c_str());
+            if (in) net->resizeTensor(in, resolveDims(t, seq, past));
+        }
+        net->resizeSession(session);
+        auto t1 = clock::now();
+        for (auto& t : templates) {
+            auto* in = net->getSessionInput(session, t.name.c_str());
+            if (!in) continue;
+            MNN::Tensor host(in, in->getDimensionType());
+            std::vector<int> dims;
+            for (int i = 0; i < host.dimensions(); ++i) dims.push_back(host.length(i));
+            fillStep(host.host<void>(), host.getType(), dims, t.role, seq, past, p.vocab, rng);
+            in->copyFromHostTensor(&host);
+        }
+        net->runSession(session);
+        // Copy the first output back so asynchronous backends are measured to completion.
+        auto& outs = net->getSessionOutputAll(session);
+        if (!outs.empty() && outs.begin()->second) {
+            MNN::Tensor hostOut(outs.begin()->second, outs.begin()->second->getDimensionType());
+            outs.begin()->second->copyToHostTensor(&hostOut);
+        }
+        auto t2 = clock::now();
+        rec.ctx = past + seq;
+        rec.resizeMs = msBetween(t0, t1);
+        rec.ms = msBetween(t0, t2);
+        telemetry.publish(kTelemetryToken, (uint32_t)step, rec.ms, t2);
+        rec.rssBytes = readRssBytes();
+        (void)net->getSessionInfo(session, MNN::Interpreter::MEMORY, &rec.memoryMb);
+        steps.push_back(rec);
+    }
+    net->releaseSession(session);
+    return steps;
+}
+
+#if HAVE_MNN_EXPRESS
+// Module engine: a shapeMutable Module on its own RuntimeManager, which is also what
+// carries the KV-cache size limit and directory.
+std::vector<StepRecord> decodeWithModule(const RunOptions& opt, const json::Value& root, const DecodeParams& p,
+                                         std::vector<InputTemplate>& templates) {
+    using namespace MNN::Express;
+    RuntimeManagerPtr rtmgr = makeRuntimeManager(opt);
+    if (p.kvCacheLimit >= 0) rtmgr->setHint(MNN::Interpreter::KVCACHE_SIZE_LIMIT, p.kvCacheLimit);
+    if (!p.kvCacheDir.empty()) rtmgr->setExternalPath(p.kvCacheDir, MNN::Interpreter::EXTERNAL_PATH_KVCACHE_DIR);
+
+    Module::Config mcfg;
+    mcfg.shapeMutable = true;
+    mcfg.rearrange = true;
+    std::shared_ptr<Module> module(Module::load({}, {}, opt.modelPath.c_str(), rtmgr, &mcfg), Module::destroy);
+    if (!module) throw std::runtime_error("Failed to load module");
+    const Module::Info* info = module->getInfo();
+    templates = buildTemplates(root, info->inputNames);
+
+    std::mt19937 rng(42);
+    std::vector<StepRecord> steps;
+    const int past = 0; // nothing cached: every step feeds the whole context
+    TelemetryLease telemetry;
+    telemetry.runBegin((uint32_t)p.newTokens + 1);
+    for (int step = 0; step <= p.newTokens; ++step) {
+        const int seq = p.promptTokens + step;
+        StepRecord rec;
+        auto t0 = clock::now();
+        std::vector<VARP> inputs;
+        for (size_t i = 0; i < templates.size(); ++i) {
+            auto& t = templates[i];
+            const auto& vinfo = info->inputs[i];
+            std::vector<int> dims = t.hasTemplate ? resolveDims(t, seq, past) : vinfo.dim;
+            VARP v = _Input(dims, vinfo.order, vinfo.type);
+            fillStep(v->writeMap<void>(), vinfo.type, dims, t.role, seq, past, p.vocab, rng);
+            inputs.push_back(v);
+        }
+        auto t1 = clock::now();
+        auto outputs = module->onForward(inputs);
+        if (outputs.empty()) throw std::runtime_error("Module forward returned no outputs");
+        (void)outputs[0]->readMap<void>();
+        auto t2 = clock::now();
+        rec.ctx = past + seq;
+        rec.resizeMs = msBetween(t0, t1); // input creation; shape changes are absorbed inside onForward
+        rec.ms = msBetween(t0, t2);
+        telemetry.publish(kTelemetryToken, (uint32_t)step, rec.ms, t2);
+        rec.rssBytes = readRssBytes();
+        (void)rtmgr->getInfo(MNN::Interpreter::MEMORY, &rec.memoryMb);
+        steps.push_back(rec);
+    }
+    return steps;
+}
+#endif
+
+const char* roleName(Role r) {
+    switch (r) {
+        case Role::Tokens: return "tokens";
+        case Role::Positions: return "positions";
+        case Role::Mask: return "mask";
+        default: return "other";
+    }
+}
+
+} // namespace
+
+std::string runDecode(const std::string& configJson) {
+    try {
+        json::Value root = json::parse(configJson);
+        RunOptions opt;
+        applyRunOptions(root, opt);
+        if (opt.modelPath.empty()) throw std::runtime_error("Missing modelPath");
+        DecodeParams p;
+        p.promptTokens = std::max(1, root.getInt("promptTokens", p.promptTokens));
+        p.newTokens = std::max(1, root.getInt("newTokens", p.newTokens));
+        p.vocab = std::max(2, root.getInt("vocabSize", p.vocab));
+        p.kvCacheLimit = root.getInt("kvCacheSizeLimit", -1);
+        p.kvCacheDir = root.getString("kvCacheDir");
+
+#if HAVE_MNN_EXPRESS
+        std::string engine = root.getString("decodeEngine", "module");
+#else
+        std::string engine = root.getString("decodeEngine", "session");
+#endif
+        std::string note;
+        std::vector<InputTemplate> templates;
+        std::vector<StepRecord> steps;
+        if (engine == "module") {
+#if HAVE_MNN_EXPRESS
+            steps = decodeWithModule(opt, root, p, templates);
+#else
+            throw std::runtime_error("Module engine needs libMNN_Express.so; use decodeEngine=session");
+#endif
+        } else {
+            engine = "session";
+            steps = decodeWithSession(opt, root, p, templates, note);
+        }
+
+        std::vector<double> decodeMs;
+        double decodeTotal = 0.0;
+        for (size_t i = 1; i < steps.size(); ++i) {
+            decodeMs.push_back(steps[i].ms);
+            decodeTotal += steps[i].ms;
+        }
+        std::vector<double> sorted = decodeMs;
+        std::sort(sorted.begin(), sorted.end());
+        const double p90 = sorted.empty() ? 0.0 : sorted[std::min(sorted.size() - 1, (size_t)(0.9 * sorted.size()))];
+
+        std::ostringstream json;
+        json.setf(std::ios::fixed); json.precision(3);
+        json << "{\"decode\":true"
+             << ",\"engine\":\"" << engine << "\""
+             << ",\"backend\":\"" << opt.backend << "\""
+             << ",\"threads\":" << opt.threads
+             << ",\"prompt_tokens\":" << p.promptTokens
+             << ",\"new_tokens\":" << p.newTokens
+             << ",\"kv_cache\":false"
+             << ",\"step_input\":\"full_context\""
+             << ",\"kv_cache_size_limit\":" << p.kvCacheLimit
+             << ",\"kv_cache_dir\":\"" << jsonEscape(p.kvCacheDir) << "\"";
+        if (!note.empty()) json << ",\"note\":\"" << jsonEscape(note) << "\"";
+        json << ",\"inputs\":[";
+        for (size_t i = 0; i < templates.size(); ++i) {
+            if (i) json << ",";
+            json << "{\"name\":\"" << jsonEscape(templates[i].name) << "\",\"role\":\"" << roleName(templates[i].role) << "\"}";
+        }
+        json << "]";
+        json << ",\"ttft_ms\":" << steps.front().ms
+             << ",\"prefill_tokens_per_s\":" << (steps.front().ms > 0 ? 1000.0 * p.promptTokens / steps.front().ms : 0.0)
+             << ",\"per_step\":{\"median_ms\":" << medianOf(decodeMs)
+             << ",\"p90_ms\":" << p90
+             << ",\"mean_ms\":" << (decodeMs.empty() ? 0.0 : decodeTotal / decodeMs.size())
+             << ",\"steps_per_s\":" << (decodeTotal > 0 ? 1000.0 * decodeMs.size() / decodeTotal : 0.0) << "}";
+        const auto& firstDecode = steps.size() > 1 ? steps[1] : steps.front();
+        const auto& last = steps.back();
+        if (firstDecode.rssBytes >= 0 && last.rssBytes >= 0 && last.ctx > firstDecode.ctx) {
+            const double growthMb = (double)(last.rssBytes - firstDecode.rssBytes) / (1024.0 * 1024.0);
+            json << ",\"rss_growth_mb\":" << growthMb
+                 << ",\"rss_growth_mb_per_1k_ctx\":" << growthMb * 1000.0 / (last.ctx - firstDecode.ctx);
+        }
+        json << ",\"steps\":[";
+        for (size_t i = 0; i < steps.size(); ++i) {
+            if (i) json << ",";
+            json << "{\"step\":" << i
+                 << ",\"ctx\":" << steps[i].ctx
+                 << ",\"ms\":" << steps[i].ms
+                 << ",\"prepare_ms\":" << steps[i].resizeMs
+                 << ",\"memory_mb\":" << steps[i].memoryMb
+                 << ",\"rss_mb\":" << (steps[i].rssBytes >= 0 ? steps[i].rssBytes / (1024.0 * 1024.0) : -1.0) << "}";
+        }
+        json << "]}";
+        return json.str();
+    } catch (const std::exception& e) {
+        return std::string("{\"error\":\"") + jsonEscape(e.what()) + "\"}";
+    }
+}
+#else
+std::string runDecode(const std::string& configJson) {
+    (void)configJson;
+    return "{\"error\":\"MNN not bundled. Cannot run decode benchmark. Place headers and libMNN.so as documented.\"}";
+}
+#endif
+
+} // namespace runner
@@ -0,0 +1,201 @@
+#include "device_info.hpp"
+#include "runner_common.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __ANDROID__
+#include <sys/system_properties.h>
+#endif
+
+namespace runner {
+
+namespace {
+
+std::string trim(const std::string& s) {
+    size_t b = s.find_first_not_of(" \t\r\n");
+    if (b == std::string::npos) return std::string();
+    size_t e = s.find_last_not_of(" \t\r\n");
+    return s.substr(b, e - b + 1);
+}
+
+std::string readCpuModel() {
+    std::ifstream in("/proc/cpuinfo");
+    std::string line, hardware, modelName;
+    std::set<std::string> parts;
+    while (std::getline(in, line)) {
+        auto colon = line.find(':');
+        if (colon == std::string::npos) continue;
+        std::string key = trim(line.substr(0, colon));
+        std::string val = trim(line.substr(colon + 1));
+        if (key == "Hardware") hardware = val;
+        else if (key == "model name" && modelName.empty()) modelName = val;
+        else if (key == "CPU part") parts.insert(val);
+    }
+    std::string model = !hardware.empty() ? hardware : modelName;
+#ifdef __ANDROID__
+    char soc[PROP_VALUE_MAX] = {0};
+    if (__system_property_get("ro.soc.model", soc) > 0) {
+        model = model.empty() ? std::string(soc) : model + " " + soc;
+    }
+#endif
+    if (!parts.empty()) {
+        // Distinct core micro-architectures tell big.LITTLE variants of one SoC name apart.
+        std::string joined;
+        for (auto& p : parts) joined += (joined.empty() ? "" : ",") + p;
+        model += " parts=" + joined;
+    }
+    return model.empty() ? std::string("unknown") : model;
+}
+
+// CPU ids grouped by cpuinfo_max_freq (kHz, 0 when unreadable).
+std::map<long, std::vector<int>> readClusters(int cores) {
+    std::map<long, std::vector<int>> byFreq;
+    for (int i = 0; i < cores; ++i) {
+        char path[96];
+        std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/cpuinfo_max_freq", i);
+        long khz = 0;
+        if (FILE* f = std::fopen(path, "r")) {
+            if (std::fscanf(f, "%ld", &khz) != 1) khz = 0;
+            std::fclose(f);
+        }
+        byFreq[khz].push_back(i);
+    }
+    return byFreq;
+}
+
+std::string readCoreLayout(const std::map<long, std::vector<int>>& byFreq) {
+    std::ostringstream s;
+    bool first = true;
+    for (auto& kv : byFreq) {
+        if (!first) s << "+";
+        first = false;
+        s << kv.second.size() << "x";
+        if (kv.first > 0) s << kv.first / 1000 << "MHz";
+        else s << "?";
+    }
+    return s.str();
+}
+
+const char* compiledAbi() {
+#if defined(__aarch64__)
+    return "arm64-v8a";
+#elif defined(__arm__)
+    return "armeabi-v7a";
+#elif defined(__x86_64__)
+    return "x86_64";
+#elif defined(__i386__)
+    return "x86";
+#else
+    return "unknown";
+#endif
+}
+
+} // namespace
+
+std::string DeviceInfo::fingerprint() const {
+    return cpuModel + "|" + coreLayout + "|" + abi + "|MNN " + mnnVersion;
+}
+
+const DeviceInfo& deviceInfo() {
+    static const DeviceInfo info = [] {
+        DeviceInfo d;
+        d.cores = (int)sysconf(_SC_NPROCESSORS_CONF);
+        if (d.cores <= 0) d.cores = 1;
+        d.cpuModel = readCpuModel();
+        auto byFreq = readClusters(d.cores);
+        d.coreLayout = readCoreLayout(byFreq);
+        for (auto it = byFreq.rbegin(); it != byFreq.rend(); ++it) d.clusters.push_back(it->second);
+        d.abi = compiledAbi();
+#if HAVE_MNN
+        d.mnnVersion = MNN::getVersion();
+#else
+        d.mnnVersion = "none";
+#endif
+        return d;
+    }();
+    return info;
+}
+
+void writeDeviceJson(std::ostream& json, const DeviceInfo& info) {
+    json << "{\"cpu\":\"" << jsonEscape(info.cpuModel) << "\""
+         << ",\"core_layout\":\"" << jsonEscape(info.coreLayout) << "\""
+         << ",\"cores\":" << info.cores
+         << ",\"abi\":\"" << info.abi << "\""
+         << ",\"mnn_version\":\"" << jsonEscape(info.mnnVersion) << "\""
+         << ",\"fingerprint\":\"" << hex64(fnv1a(info.fingerprint().data(), info.fingerprint().size())) << "\"}";
+}
+
+uint64_t fnv1a(const void* data, size_t size, uint64_t seed) {
+    const auto* p = static_cast<const unsigned char*>(data);
+    uint64_t h = seed;
+    for (size_t i = 0; i < size; ++i) {
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+std::string hex64(uint64_t v) {
+    char buf[17];
+    std::snprintf(buf, sizeof(buf), "%016llx", (unsigned long long)v);
+    return buf;
+}
+
+namespace {
+
+struct FileHash {
+    long long size = 0;
+    long long mtimeNs = 0;
+    std::string hash;
+};
+
+std::mutex gHashMutex;
+std::map<std::string, FileHash> gHashCache; // by path
+
+} // namespace
+
+std::string hashModelFile(const std::string& path) {
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0) return std::string();
+    const long long size = (long long)st.st_size;
+    const long long mtimeNs = (long long)st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+    {
+        std::lock_guard<std::mutex> lock(gHashMutex);
+        auto it = gHashCache.find(path);
+        if (it != gHashCache.end() && it->second.size == size && it->second.mtimeNs == mtimeNs) return it->second.hash;
+    }
+    // Hashed outside the lock: a model of a few hundred MB takes a while, and two callers racing
+    // on the same file just compute the same value.
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return std::string();
+    std::vector<unsigned char> buf(1 << 20);
+    uint64_t h = fnv1a(&size, sizeof(size));
+    long long total = 0;
+    size_t n;
+    while ((n = std::fread(buf.data(), 1, buf.size(), f)) > 0) {
+        h = fnv1a(buf.data(), n, h);
+        total += (long long)n;
+    }
+    const bool ok = !std::ferror(f) && total == size;
+    std::fclose(f);
+    if (!ok) return std::string();
+    FileHash entry;
+    entry.size = size;
+    entry.mtimeNs = mtimeNs;
+    entry.hash = hex64(h);
+    std::lock_guard<std::mutex> lock(gHashMutex);
+    gHashCache[path] = entry;
+    return entry.hash;
+}
+
+} // namespace runner
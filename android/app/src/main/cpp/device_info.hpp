@@ -0,0 +1,35 @@
+// Device/environment fingerprint used to key stored profiles and benchmark records.
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace runner {
+
+struct DeviceInfo {
+    std::string cpuModel;   // SoC / CPU name from /proc/cpuinfo (and ro.soc.model on Android)
+    std::string coreLayout; // cores grouped by max frequency, e.g. "4x1800MHz+3x2400MHz+1x3000MHz"
+    int cores = 0;
+    // CPU ids per cluster (same max frequency), fastest cluster first.
+    std::vector<std::vector<int>> clusters;
+    std::string abi;
+    std::string mnnVersion;
+
+    // Stable key string built from the fields above.
+    std::string fingerprint() const;
+};
+
+// Probed once per process; the fields do not change while the app runs.
+const DeviceInfo& deviceInfo();
+
+void writeDeviceJson(std::ostream& json, const DeviceInfo& info);
+
+uint64_t fnv1a(const void* data, size_t size, uint64_t seed = 1469598103934665603ULL);
+std::string hex64(uint64_t v);
+
+// Hash of the whole file and its size. Cached by path, size and mtime, so only the first call per
+// model version pays for reading the file. Empty on I/O error.
+std::string hashModelFile(const std::string& path);
+
+} // namespace runner
@@ -0,0 +1,361 @@
+// Energy per inference: energy counters bracket the timed iterations of each BackendConfig::power
+// setting. Sources, in order of preference:
+//   - /sys/class/powercap RAPL zones (Linux hosts): cumulative energy_uj, read at both ends;
+//   - /sys/class/power_supply battery current_now x voltage_now (Android): sampled on a thread
+//     and integrated over time.
+// When neither is readable, or the battery is charging, the report says why instead of a number.
+#include "modes.hpp"
+#include "runner_common.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <thread>
+
+#include <dirent.h>
+
+namespace runner {
+
+#if HAVE_MNN
+namespace {
+
+bool readText(const std::string& path, std::string& out, int* err = nullptr) {
+    FILE* f = std::fopen(path.c_str(), "r");
+    if (!f) {
+        if (err) *err = errno;
+        return false;
+    }
+    char buf[256];
+    size_t n = std::fread(buf, 1, sizeof(buf) - 1, f);
+    std::fclose(f);
+    buf[n] = '\0';
+    out = buf;
+    while (!out.empty() && (out.back() == '\n' || out.back() == ' ')) out.pop_back();
+    return true;
+}
+
+bool readInt(const std::string& path, long long& v, int* err = nullptr) {
+    std::string s;
+    if (!readText(path, s, err) || s.empty()) return false;
+    char* end = nullptr;
+    v = std::strtoll(s.c_str(), &end, 10);
+    return end != s.c_str();
+}
+
+std::vector<std::string> listDir(const std::string& dir) {
+    std::vector<std::string> out;
+    DIR* d = opendir(dir.c_str());
+    if (!d) return out;
+    while (auto* e = readdir(d)) {
+        std::string name = e->d_name;
+        if (name != "." && name != "..") out.push_back(name);
+    }
+    closedir(d);
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+struct RaplZone {
+    std::string path;
+    std::string name;
+    long long maxRangeUj = 0;
+    long long startUj = 0;
+};
+
+struct EnergyReading {
+    bool available = false;
+    std::string reason;
+    double joules = 0.0;
+    double windowMs = 0.0;
+    int samples = 0;
+    int distinctSamples = 0;
+    std::vector<std::string> warnings;
+};
+
+class EnergyMeter {
+public:
+    explicit EnergyMeter(int sampleIntervalMs) : intervalMs_(std::max(5, sampleIntervalMs)) {
+        std::string raplReason, batteryReason;
+        if (probeRapl(raplReason)) {
+            source_ = "powercap";
+        } else if (probeBattery(batteryReason)) {
+            source_ = "battery";
+        } else {
+            reason_ = raplReason + "; " + batteryReason;
+        }
+    }
+
+    const std::string& source() const { return source_; }
+    const std::string& unavailableReason() const { return reason_; }
+    const std::vector<RaplZone>& zones() const { return zones_; }
+    const std::string& batteryPath() const { return battery_; }
+
+    void start() {
+        reading_ = EnergyReading();
+        begin_ = clock::now();
+        if (source_ == "powercap") {
+            for (auto& z : zones_) readInt(z.path + "/energy_uj", z.startUj);
+        } else if (source_ == "battery") {
+            std::string status;
+            readText(battery_ + "/status", status);
+            startStatus_ = status;
+            running_ = true;
+            sampler_ = std::thread([this]() { sampleBattery(); });
+        }
+    }
+
+    EnergyReading stop() {
+        const auto end = clock::now();
+        reading_.windowMs = msBetween(begin_, end);
+        if (source_ == "powercap") {
+            double uj = 0.0;
+            bool ok = true;
+            for (auto& z : zones_) {
+                long long now = 0;
+                if (!readInt(z.path + "/energy_uj", now)) { ok = false; break; }
+                long long delta = now - z.startUj;
+                if (delta < 0 && z.maxRangeUj > 0) delta += z.maxRangeUj; // counter wrapped
+                uj += (double)delta;
+            }
+            reading_.available = ok;
+            if (!ok) reading_.reason = "energy_uj became unreadable during the run";
+            reading_.joules = uj * 1e-6;
+            reading_.samples = 2;
+            reading_.distinctSamples = 2;
+        } else if (source_ == "battery") {
+            running_ = false;
+            if (sampler_.joinable()) sampler_.join();
+            std::string status;
+            readText(battery_ + "/status", status);
+            auto onCharger = [](const std::string& st) { return st == "Charging" || st == "Full" || st == "Not charging"; };
+            if (onCharger(startStatus_) || onCharger(status)) {
+                reading_.available = false;
+                reading_.reason = "battery status is " + (status.empty() ? startStatus_ : status) +
+                                  "; current_now is net of the charger, unplug the device to measure";
+            } else if (reading_.samples < 2) {
+                reading_.available = false;
+                reading_.reason = "fewer than two current/voltage samples; run more iterations";
+            } else {
+                reading_.available = true;
+                reading_.joules = batteryJoules_;
+                if (reading_.distinctSamples < 3) {
+                    reading_.warnings.push_back("fuel gauge updated fewer than 3 times in the window; "
+                                                "energy is dominated by gauge resolution");
+                }
+                if (maxCurrentUa_ < 1000.0) {
+                    reading_.warnings.push_back("current_now below 1 mA; this gauge may not report microamps");
+                }
+            }
+        } else {
+            reading_.available = false;
+            reading_.reason = reason_;
+        }
+        return reading_;
+    }
+
+private:
+    bool probeRapl(std::string& reason) {
+        const std::string root = "/sys/class/powercap";
+        std::vector<RaplZone> pkg, psys;
+        int deniedErr = 0;
+        for (auto& entry : listDir(root)) {
+            // Top-level zones only ("intel-rapl:0"); subzones ("intel-rapl:0:0") are already included
+            // in their parent, and the MMIO interface duplicates the package zone.
+            if (entry.rfind("intel-rapl:", 0) != 0 || std::count(entry.begin(), entry.end(), ':') != 1) continue;
+            RaplZone z;
+            z.path = root + "/" + entry;
+            readText(z.path + "/name", z.name);
+            readInt(z.path + "/max_energy_range_uj", z.maxRangeUj);
+            long long probe = 0;
+            int err = 0;
+            if (!readInt(z.path + "/energy_uj", probe, &err)) {
+                if (err == EACCES || err == EPERM) deniedErr = err;
+                continue;
+            }
+            (z.name == "psys" ? psys : pkg).push_back(z);
+        }
+        // psys covers the whole platform and already contains the packages.
+        zones_ = psys.empty() ? pkg : psys;
+        if (!zones_.empty()) return true;
+        reason = deniedErr ? "powercap energy_uj exists but is not readable (root only since Linux 5.10)"
+                           : "no readable powercap RAPL zone";
+        return false;
+    }
+
+    bool probeBattery(std::string& reason) {
+        const std::string root = "/sys/class/power_supply";
+        for (auto& entry : listDir(root)) {
+            std::string type;
+            if (!readText(root + "/" + entry + "/type", type) || type != "Battery") continue;
+            long long i = 0, v = 0;
+            const bool hasI = readInt(root + "/" + entry + "/current_now", i);
+            const bool hasV = readInt(root + "/" + entry + "/voltage_now", v);
+            if (hasI && hasV && v > 0) {
+                battery_ = root + "/" + entry;
+                return true;
+            }
+            if (reason.empty()) {
+                reason = "battery " + entry + " has no readable " + std::string(hasI ? "voltage_now" : "current_now");
+            }
+        }
+        if (reason.empty()) reason = "no power_supply battery with current_now/voltage_now";
+        return false;
+    }
+
+    // Trapezoid integration of |I| x V; current_now/voltage_now are in uA/uV per the power_supply ABI.
+    void sampleBattery() {
+        batteryJoules_ = 0.0;
+        maxCurrentUa_ = 0.0;
+        double lastW = -1.0;
+        clock::time_point lastT;
+        long long lastI = 0, lastV = 0;
+        auto sample = [&]() {
+            long long i = 0, v = 0;
+            if (!readInt(battery_ + "/current_now", i) || !readInt(battery_ + "/voltage_now", v)) return;
+            const auto t = clock::now();
+            const double w = std::fabs((double)i) * 1e-6 * (double)v * 1e-6;
+            if (lastW >= 0.0) batteryJoules_ += 0.5 * (w + lastW) * msBetween(lastT, t) / 1000.0;
+            if (reading_.samples == 0 || i != lastI || v != lastV) ++reading_.distinctSamples;
+            maxCurrentUa_ = std::max(maxCurrentUa_, std::fabs((double)i));
+            lastW = w;
+            lastT = t;
+            lastI = i;
+            lastV = v;
+            ++reading_.samples;
+        };
+        sample();
+        while (running_.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs_));
+            sample();
+        }
+    }
+
+    int intervalMs_;
+    std::string source_;
+    std::string reason_;
+    std::vector<RaplZone> zones_;
+    std::string battery_;
+    std::string startStatus_;
+    clock::time_point begin_;
+    EnergyReading reading_;
+    std::atomic<bool> running_{false};
+    std::thread sampler_;
+    double batteryJoules_ = 0.0;
+    double maxCurrentUa_ = 0.0;
+};
+
+void writeEnergy(std::ostream& json, const EnergyReading& r, const std::string& source, int inferences, double idleW) {
+    json << "{\"available\":" << (r.available ? "true" : "false")
+         << ",\"source\":\"" << source << "\"";
+    if (!r.available) {
+        json << ",\"reason\":\"" << jsonEscape(r.reason) << "\"}";
+        return;
+    }
+    const double seconds = r.windowMs / 1000.0;
+    const double avgW = seconds > 0.0 ? r.joules / seconds : 0.0;
+    json << ",\"window_ms\":" << r.windowMs
+         << ",\"joules\":" << r.joules
+         << ",\"joules_per_inference\":" << (inferences > 0 ? r.joules / inferences : 0.0)
+         << ",\"avg_power_w\":" << avgW
+         << ",\"samples\":" << r.samples
+         << ",\"distinct_samples\":" << r.distinctSamples;
+    if (idleW >= 0.0) {
+        // Energy above the idle floor: what the inference itself costs on top of the device being awake.
+        const double net = std::max(0.0, r.joules - idleW * seconds);
+        json << ",\"idle_power_w\":" << idleW
+             << ",\"net_joules_per_inference\":" << (inferences > 0 ? net / inferences : 0.0);
+    }
+    json << ",\"warnings\":[";
+    for (size_t i = 0; i < r.warnings.size(); ++i) json << (i ? "," : "") << "\"" << jsonEscape(r.warnings[i]) << "\"";
+    json << "]}";
+}
+
+} // namespace
+
+std::string runEnergy(const std::string& configJson) {
+    try {
+        json::Value root = json::parse(configJson);
+        RunOptions base;
+        applyRunOptions(root, base);
+        if (base.modelPath.empty()) throw std::runtime_error("Missing modelPath");
+        const int warmup = std::max(0, root.getInt("warmup", 3));
+        const int iterations = std::max(1, root.getInt("iterations", 50));
+        const int idleMs = std::max(0, root.getInt("idleMs", 1000));
+        std::vector<std::string> powerModes;
+        if (auto* p = root.get("powerModes")) {
+            for (auto& v : p->items) if (v.isString()) powerModes.push_back(v.str);
+        }
+        if (powerModes.empty()) powerModes = {"LOW", "NORMAL", "HIGH"};
+
+        EnergyMeter meter(root.getInt("sampleIntervalMs", 50));
+        double idleW = -1.0;
+        EnergyReading idle;
+        if (!meter.source().empty() && idleMs > 0) {
+            meter.start();
+            std::this_thread::sleep_for(std::chrono::milliseconds(idleMs));
+            idle = meter.stop();
+            if (idle.available && idle.windowMs > 0.0) idleW = idle.joules / (idle.windowMs / 1000.0);
+        }
+
+        std::ostringstream json;
+        json.setf(std::ios::fixed); json.precision(6);
+        json << "{\"energy\":true"
+             << ",\"source\":\"" << (meter.source().empty() ? "none" : meter.source()) << "\"";
+        if (meter.source().empty()) json << ",\"unavailable_reason\":\"" << jsonEscape(meter.unavailableReason()) << "\"";
+        if (meter.source() == "powercap") {
+            json << ",\"zones\":[";
+            for (size_t i = 0; i < meter.zones().size(); ++i) {
+                json << (i ? "," : "") << "\"" << jsonEscape(meter.zones()[i].name) << "\"";
+            }
+            json << "]";
+        } else if (meter.source() == "battery") {
+            json << ",\"battery\":\"" << jsonEscape(meter.batteryPath()) << "\"";
+        }
+        json << ",\"idle\":";
+        if (idleW >= 0.0) {
+            json << "{\"window_ms\":" << idle.windowMs << ",\"power_w\":" << idleW << "}";
+        } else {
+            json << "null";
+        }
+        json << ",\"backend\":\"" << base.backend << "\""
+             << ",\"threads\":" << base.threads
+             << ",\"runs\":[";
+        for (size_t i = 0; i < powerModes.size(); ++i) {
+            RunOptions opt = base;
+            opt.powerMode = powerModes[i];
+            if (i) json << ",";
+            json << "{\"powerMode\":\"" << jsonEscape(opt.powerMode) << "\"";
+            try {
+                EnergyReading reading;
+                BenchHooks hooks;
+                hooks.beforeTimed = [&]() { meter.start(); };
+                hooks.afterTimed = [&]() { reading = meter.stop(); };
+                hooks.preemptible = false; // preempting work would land in the integrated energy
+                BenchRun b = benchmarkConfig(opt, warmup, iterations, hooks);
+                json << ",\"memory_mb\":" << b.memoryMb << ",\"latency\":";
+                writeLatency(json, b.samplesMs);
+                json << ",\"energy\":";
+                writeEnergy(json, reading, meter.source().empty() ? "none" : meter.source(), iterations, idleW);
+            } catch (const std::exception& e) {
+                json << ",\"error\":\"" << jsonEscape(e.what()) << "\"";
+            }
+            json << "}";
+        }
+        json << "]}";
+        return json.str();
+    } catch (const std::exception& e) {
+        return std::string("{\"error\":\"") + jsonEscape(e.what()) + "\"}";
+    }
+}
+#else
+std::string runEnergy(const std::string& configJson) {
+    (void)configJson;
+    return "{\"error\":\"MNN not bundled. Cannot run energy mode. Place headers and libMNN.so as documented.\"}";
+}
+#endif
+
+} // namespace runner
@@ -0,0 +1,296 @@
+#include "executor.hpp"
+#include "runner_common.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace runner {
+
+namespace {
+
+constexpr int kDefaultWorkers = 2;
+constexpr int kMaxWorkers = 16;
+
+struct Job {
+    uint64_t id = 0;
+    Priority priority = Priority::Interactive;
+    std::string key;
+    std::function<void()> task;
+    clock::time_point enqueued;
+};
+
+// The job a thread is running; inline jobs stack on top of the background job they preempted.
+struct JobContext {
+    const Job* job = nullptr;
+    int worker = -1;
+    clock::time_point start;
+    double queueWaitMs = 0.0;
+    double preemptedMs = 0.0;
+    int preemptions = 0;
+    bool inlined = false;
+    JobContext* parent = nullptr;
+};
+thread_local JobContext* tCurrent = nullptr;
+
+struct ClassTotals {
+    long long completed = 0;
+    double queueWaitMs = 0.0;
+    double maxQueueWaitMs = 0.0;
+    double runMs = 0.0;
+    double preemptedMs = 0.0;
+    long long preemptions = 0;
+    long long inlined = 0; // interactive jobs run inside a background job
+};
+
+struct Executor {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<Job> queues[2]; // by Priority
+    // Model key -> worker running it and nesting depth (an inline job may reuse its worker's key).
+    std::map<std::string, std::pair<int, int>> busy;
+    int targetWorkers = kDefaultWorkers;
+    int startedWorkers = 0;
+    // Indices of live worker threads. An index is freed only when its thread exits, so a worker
+    // still finishing a job after a shrink never shares its index (and its model keys) with a
+    // worker started by a later grow.
+    bool liveIndex[kMaxWorkers] = {};
+    int runningJobs = 0;
+    int runningBackground = 0;
+    uint64_t nextId = 1;
+    ClassTotals totals[2];
+    std::function<void()> onStart, onExit;
+    std::atomic<int> pendingInteractive{0};
+};
+
+Executor& executor() {
+    static Executor* e = new Executor(); // leaked on purpose: workers outlive static destruction
+    return *e;
+}
+
+bool keyFreeLocked(Executor& e, const std::string& key, int worker) {
+    if (key.empty()) return true;
+    auto it = e.busy.find(key);
+    return it == e.busy.end() || it->second.first == worker;
+}
+
+// First runnable job, interactive before background; FIFO within a class, but a job whose model is
+// busy does not hold up the ones behind it.
+bool takeLocked(Executor& e, int worker, bool interactiveOnly, Job& out) {
+    for (int p = 0; p < (interactiveOnly ? 1 : 2); ++p) {
+        // One worker stays free of background work, for modes that never reach a yield point.
+        if (p == 1 && e.targetWorkers > 1 && e.runningBackground >= e.targetWorkers - 1) break;
+        auto& q = e.queues[p];
+        for (auto it = q.begin(); it != q.end(); ++it) {
+            if (!keyFreeLocked(e, it->key, worker)) continue;
+            out = std::move(*it);
+            q.erase(it);
+            if (p == 0) e.pendingInteractive.fetch_sub(1, std::memory_order_relaxed);
+            else e.runningBackground++;
+            if (!out.key.empty()) {
+                auto& b = e.busy[out.key];
+                b.first = worker;
+                b.second++;
+            }
+            e.runningJobs++;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Runs `job` on the calling worker; the lock is held on entry and exit, released while it runs.
+void runLocked(Executor& e, std::unique_lock<std::mutex>& lock, Job& job, int worker) {
+    JobContext ctx;
+    ctx.job = &job;
+    ctx.worker = worker;
+    ctx.start = clock::now();
+    ctx.queueWaitMs = msBetween(job.enqueued, ctx.start);
+    ctx.parent = tCurrent;
+    ctx.inlined = tCurrent != nullptr;
+    lock.unlock();
+    tCurrent = &ctx;
+    try {
+        job.task();
+    } catch (...) {
+        // Tasks report their own errors; a throw must not take the worker down.
+    }
+    tCurrent = ctx.parent;
+    const double wallMs = msBetween(ctx.start, clock::now());
+    lock.lock();
+    if (!job.key.empty()) {
+        auto it = e.busy.find(job.key);
+        if (it != e.busy.end() && --it->second.second <= 0) e.busy.erase(it);
+    }
+    e.runningJobs--;
+    if (job.priority == Priority::Background) e.runningBackground--;
+    ClassTotals& t = e.totals[(int)job.priority];
+    t.completed++;
+    t.queueWaitMs += ctx.queueWaitMs;
+    t.maxQueueWaitMs = std::max(t.maxQueueWaitMs, ctx.queueWaitMs);
+    t.runMs += wallMs - ctx.preemptedMs;
+    t.preemptedMs += ctx.preemptedMs;
+    t.preemptions += ctx.preemptions;
+    if (ctx.inlined) t.inlined++;
+    e.cv.notify_all(); // a model key may have been freed
+}
+
+void workerLoop(int index) {
+    Executor& e = executor();
+    if (e.onStart) e.onStart();
+    std::unique_lock<std::mutex> lock(e.mutex);
+    for (;;) {
+        if (index >= e.targetWorkers) break;
+        Job job;
+        if (takeLocked(e, index, false, job)) {
+            runLocked(e, lock, job, index);
+            continue;
+        }
+        e.cv.wait(lock);
+    }
+    e.startedWorkers--;
+    e.liveIndex[index] = false;
+    lock.unlock();
+    if (e.onExit) e.onExit();
+}
+
+// Fewer live workers than the target leaves an index below the target free: the lowest one is
+// taken, so worker indices stay dense and below the target.
+void startWorkersLocked(Executor& e) {
+    while (e.startedWorkers < e.targetWorkers) {
+        int index = 0;
+        while (index < kMaxWorkers && e.liveIndex[index]) ++index;
+        if (index >= e.targetWorkers) break;
+        e.liveIndex[index] = true;
+        e.startedWorkers++;
+        std::thread(workerLoop, index).detach();
+    }
+}
+
+const char* priorityName(Priority p) {
+    return p == Priority::Interactive ? "interactive" : "background";
+}
+
+void writeContext(std::ostream& json, const JobContext& c) {
+    const double wallMs = msBetween(c.start, clock::now());
+    json << "{\"job\":" << c.job->id
+         << ",\"priority\":\"" << priorityName(c.job->priority) << "\""
+         << ",\"worker\":" << c.worker
+         << ",\"queue_wait_ms\":" << c.queueWaitMs
+         << ",\"run_ms\":" << (wallMs - c.preemptedMs)
+         << ",\"preempted_ms\":" << c.preemptedMs
+         << ",\"preemptions\":" << c.preemptions
+         << ",\"inline\":" << (c.inlined ? "true" : "false") << "}";
+}
+
+} // namespace
+
+void setExecutorThreadHooks(std::function<void()> onStart, std::function<void()> onExit) {
+    Executor& e = executor();
+    std::lock_guard<std::mutex> lock(e.mutex);
+    e.onStart = std::move(onStart);
+    e.onExit = std::move(onExit);
+}
+
+uint64_t submitJob(Priority priority, const std::string& modelKey, std::function<void()> task) {
+    Executor& e = executor();
+    std::lock_guard<std::mutex> lock(e.mutex);
+    Job job;
+    job.id = e.nextId++;
+    job.priority = priority;
+    job.key = modelKey;
+    job.task = std::move(task);
+    job.enqueued = clock::now();
+    const uint64_t id = job.id;
+    e.queues[(int)priority].push_back(std::move(job));
+    if (priority == Priority::Interactive) e.pendingInteractive.fetch_add(1, std::memory_order_relaxed);
+    startWorkersLocked(e);
+    e.cv.notify_all();
+    return id;
+}
+
+void yieldPoint() {
+    JobContext* c = tCurrent;
+    if (!c || c->job->priority != Priority::Background) return;
+    Executor& e = executor();
+    if (e.pendingInteractive.load(std::memory_order_relaxed) == 0) return;
+    std::unique_lock<std::mutex> lock(e.mutex);
+    Job job;
+    bool preempted = false;
+    auto t0 = clock::now();
+    while (takeLocked(e, c->worker, true, job)) {
+        preempted = true;
+        runLocked(e, lock, job, c->worker);
+    }
+    if (preempted) {
+        c->preemptions++;
+        c->preemptedMs += msBetween(t0, clock::now());
+    }
+}
+
+std::string currentJobJson() {
+    if (!tCurrent) return "";
+    std::ostringstream json;
+    json.setf(std::ios::fixed); json.precision(3);
+    writeContext(json, *tCurrent);
+    return json.str();
+}
+
+std::string annotateWithJob(const std::string& report) {
+    if (!tCurrent) return report;
+    const size_t first = report.find_first_not_of(" \t\r\n");
+    const size_t last = report.find_last_not_of(" \t\r\n");
+    if (first != std::string::npos && report[first] == '{' && report[last] == '}') {
+        const bool empty = report.find_first_not_of(" \t\r\n", first + 1) == last;
+        return report.substr(0, last) + (empty ? "" : ",") + "\"executor\":" + currentJobJson() + "}";
+    }
+    const JobContext& c = *tCurrent;
+    std::ostringstream s;
+    s.setf(std::ios::fixed); s.precision(1);
+    s << report << " (queue " << c.queueWaitMs << " ms, run " << (msBetween(c.start, clock::now()) - c.preemptedMs)
+      << " ms)";
+    return s.str();
+}
+
+std::string executorStats(const std::string& configJson) {
+    Executor& e = executor();
+    json::Value root;
+    try {
+        root = json::parse(configJson.empty() ? "{}" : configJson);
+    } catch (const std::exception& ex) {
+        return std::string("{\"error\":\"") + jsonEscape(ex.what()) + "\"}";
+    }
+    std::lock_guard<std::mutex> lock(e.mutex);
+    if (root.get("workers")) {
+        e.targetWorkers = std::min(kMaxWorkers, std::max(1, root.getInt("workers", kDefaultWorkers)));
+        startWorkersLocked(e);
+        e.cv.notify_all(); // workers above the new target exit
+    }
+    std::ostringstream json;
+    json.setf(std::ios::fixed); json.precision(3);
+    json << "{\"workers\":" << e.targetWorkers
+         << ",\"started_workers\":" << e.startedWorkers
+         << ",\"running\":" << e.runningJobs
+         << ",\"queued\":{\"interactive\":" << e.queues[0].size() << ",\"background\":" << e.queues[1].size() << "}"
+         << ",\"busy_models\":" << e.busy.size();
+    for (int p = 0; p < 2; ++p) {
+        const ClassTotals& t = e.totals[p];
+        const double n = t.completed > 0 ? (double)t.completed : 1.0;
+        json << ",\"" << priorityName((Priority)p) << "\":{\"completed\":" << t.completed
+             << ",\"mean_queue_wait_ms\":" << t.queueWaitMs / n
+             << ",\"max_queue_wait_ms\":" << t.maxQueueWaitMs
+             << ",\"mean_run_ms\":" << t.runMs / n
+             << ",\"preempted_ms\":" << t.preemptedMs
+             << ",\"preemptions\":" << t.preemptions
+             << ",\"inline\":" << t.inlined << "}";
+    }
+    json << "}";
+    return json.str();
+}
+
+} // namespace runner
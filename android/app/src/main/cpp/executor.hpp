@@ -0,0 +1,35 @@
+// Native inference executor: a fixed set of worker threads serving two priority classes, with runs
+// on the same model serialized. Interactive work goes first; a background job (benchmarks, sweeps)
+// that reaches a yield point between iterations runs queued interactive jobs on its own worker
+// before continuing, so a latency-critical run waits at most one iteration. Each job records its
+// queue wait apart from its run time and the time it spent preempted. With more than one worker,
+// one is always left to interactive work.
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace runner {
+
+enum class Priority { Interactive = 0, Background = 1 };
+
+// Called on each worker thread when it starts and before it exits (JNI attach / detach).
+void setExecutorThreadHooks(std::function<void()> onStart, std::function<void()> onExit);
+
+// Queue `task`; jobs with the same non-empty `modelKey` never run at the same time. Returns the job id.
+uint64_t submitJob(Priority priority, const std::string& modelKey, std::function<void()> task);
+
+// Between iterations of a long loop, outside any timed window: when the calling thread runs
+// background work, run the interactive jobs it can take first. No-op elsewhere.
+void yieldPoint();
+
+// {"job","priority","worker","queue_wait_ms","run_ms","preempted_ms","preemptions","inline"} of the
+// job running on this thread, or "" outside a job.
+std::string currentJobJson();
+// `report` with the current job attached: an "executor" member for a JSON object, a suffix for text.
+std::string annotateWithJob(const std::string& report);
+
+// Workers, queue depths and per-priority totals; applies "workers" (1..16) when present.
+std::string executorStats(const std::string& configJson);
+
+} // namespace runner
@@ -0,0 +1,200 @@
+// Host scheduling checks for the native executor, run by ctest in the host build:
+//   cmake -S . -B build-host -DMNN_RUNNER_HOST_CLI=ON && cmake --build build-host && ctest --test-dir build-host
+// Exits non-zero on the first broken guarantee: per-model serialization (including across a worker
+// shrink and grow), interactive work running at a background job's yield points, and the reserved
+// interactive worker.
+#include "executor.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+using namespace runner;
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(cond, ...)                                          \
+    do {                                                          \
+        if (!(cond)) {                                            \
+            std::fprintf(stderr, "FAIL %s:%d: ", __FILE__, __LINE__); \
+            std::fprintf(stderr, __VA_ARGS__);                    \
+            std::fprintf(stderr, "\n");                           \
+            failures++;                                           \
+        }                                                         \
+    } while (0)
+
+void sleepMs(int ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+// Waits until `pred` holds or `ms` pass; returns whether it held.
+template <typename Pred>
+bool waitFor(Pred pred, int ms = 5000) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+    while (!pred()) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        sleepMs(1);
+    }
+    return true;
+}
+
+int currentWorker() {
+    const std::string job = currentJobJson();
+    const size_t at = job.find("\"worker\":");
+    return at == std::string::npos ? -1 : std::atoi(job.c_str() + at + 9);
+}
+
+// Counts jobs inside a model key and records the highest overlap seen.
+struct KeyGuard {
+    std::mutex mutex;
+    std::map<std::string, int> active;
+    int maxOverlap = 0;
+
+    void enter(const std::string& key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        maxOverlap = std::max(maxOverlap, ++active[key]);
+    }
+    void leave(const std::string& key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        --active[key];
+    }
+};
+
+// A job that holds its key until released, reporting the worker it landed on.
+struct Gate {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool open = false;
+    std::atomic<int> worker{-1};
+    std::atomic<bool> done{false};
+
+    void release() {
+        std::lock_guard<std::mutex> lock(mutex);
+        open = true;
+        cv.notify_all();
+    }
+    void hold() {
+        worker = currentWorker();
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&] { return open; });
+        }
+        done = true; // last touch: the owner may destroy the gate once it sees this
+    }
+};
+
+// Background jobs on two models, interactive jobs on one of them: the interactive ones run at the
+// background job's yield points, and no model ever runs twice at once.
+void checkPreemptionAndSerialization() {
+    KeyGuard guard;
+    std::atomic<int> done{0};
+    auto background = [&](const std::string& key) {
+        return [&, key] {
+            guard.enter(key);
+            for (int i = 0; i < 30; ++i) {
+                sleepMs(2);
+                guard.leave(key); // a yield point may run an inline job on the same key
+                yieldPoint();
+                guard.enter(key);
+            }
+            guard.leave(key);
+            done++;
+        };
+    };
+    submitJob(Priority::Background, "A", background("A"));
+    submitJob(Priority::Background, "B", background("B"));
+    sleepMs(10);
+    for (int k = 0; k < 3; ++k) {
+        submitJob(Priority::Interactive, "A", [&] {
+            guard.enter("A");
+            sleepMs(1);
+            guard.leave("A");
+            done++;
+        });
+    }
+    CHECK(waitFor([&] { return done == 5; }), "jobs did not finish (%d of 5)", done.load());
+    CHECK(guard.maxOverlap <= 1, "a model ran %d jobs at once", guard.maxOverlap);
+    // Model A stays busy on a background worker, so its interactive jobs can only run inline.
+    const std::string stats = executorStats("");
+    const size_t interactive = stats.find("\"interactive\":{");
+    const size_t inlined = stats.find("\"inline\":", interactive);
+    CHECK(interactive != std::string::npos && inlined != std::string::npos && std::atoi(stats.c_str() + inlined + 9) >= 1,
+          "no interactive job ran at a yield point: %s", stats.c_str());
+}
+
+// With two workers, a background job that never yields must not hold up interactive work.
+void checkReservedWorker() {
+    executorStats("{\"workers\":2}");
+    Gate hog;
+    submitJob(Priority::Background, "hog", [&] { hog.hold(); });
+    Gate second;
+    submitJob(Priority::Background, "second", [&] { second.hold(); });
+    std::atomic<bool> ran{false};
+    submitJob(Priority::Interactive, "", [&] { ran = true; });
+    CHECK(waitFor([&] { return ran.load(); }, 2000), "interactive job starved behind background work");
+    hog.release();
+    second.release();
+    CHECK(waitFor([&] { return hog.done && second.done; }), "background jobs did not finish");
+}
+
+// Shrink from 3 workers to 1 while worker 2 is busy, then grow back to 3: the new worker must not
+// take index 2 and run a second job on the model worker 2 still holds.
+void checkShrinkThenGrow() {
+    executorStats("{\"workers\":3}");
+    Gate gates[3];
+    const char* keys[3] = {"m0", "m1", "m2"};
+    for (int i = 0; i < 3; ++i) {
+        Gate* g = &gates[i];
+        submitJob(Priority::Interactive, keys[i], [g] { g->hold(); });
+    }
+    CHECK(waitFor([&] { return gates[0].worker >= 0 && gates[1].worker >= 0 && gates[2].worker >= 0; }),
+          "three jobs did not start on three workers");
+    int onTwo = -1, onOne = -1;
+    for (int i = 0; i < 3; ++i) {
+        if (gates[i].worker == 2) onTwo = i;
+        if (gates[i].worker == 1) onOne = i;
+    }
+    CHECK(onTwo >= 0 && onOne >= 0, "workers 1 and 2 not both busy");
+    if (onTwo < 0 || onOne < 0) {
+        for (auto& g : gates) g.release();
+        waitFor([&] { return gates[0].done && gates[1].done && gates[2].done; });
+        return;
+    }
+
+    executorStats("{\"workers\":1}");
+    gates[onOne].release(); // worker 1 finishes and exits; worker 2 stays busy
+    CHECK(waitFor([&] { return executorStats("").find("\"started_workers\":2") != std::string::npos; }),
+          "worker 1 did not exit after the shrink");
+    executorStats("{\"workers\":3}");
+
+    std::atomic<bool> ran{false};
+    submitJob(Priority::Interactive, keys[onTwo], [&] { ran = true; });
+    sleepMs(50);
+    CHECK(!ran, "a second job ran on model %s while worker 2 still held it", keys[onTwo]);
+    for (auto& g : gates) g.release();
+    CHECK(waitFor([&] { return ran.load() && gates[0].done && gates[1].done && gates[2].done; }),
+          "queued job never ran after the key was freed");
+}
+
+} // namespace
+
+int main() {
+    checkPreemptionAndSerialization();
+    checkReservedWorker();
+    checkShrinkThenGrow();
+    executorStats("{\"workers\":1}");
+    if (failures) {
+        std::fprintf(stderr, "%d executor check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("executor checks passed\n");
+    return 0;
+}
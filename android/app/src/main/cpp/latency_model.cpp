@@ -0,0 +1,654 @@
+// Latency prediction from measured per-op costs.
+//
+// buildCostTable() times every op of the given models through runSessionWithCallBackInfo and
+// merges the results into a per-device, per-config table keyed by op type and input-shape
+// signature, together with how the per-op sum relates to a plain runSession on each model.
+// predictLatency() walks a model's ops without executing them (the before-callback declines each
+// op), looks each one up in the table, and sums the estimates with an error bar; when the table
+// is for this device it also runs the model and reports how far off the prediction was.
+#include "modes.hpp"
+#include "runner_common.hpp"
+#include "device_info.hpp"
+#include "executor.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <sstream>
+#include <sys/stat.h>
+
+namespace runner {
+
+#if HAVE_MNN
+namespace {
+
+constexpr int kTableVersion = 1;
+// Relative uncertainty of ops the table has no measurement of their type for.
+constexpr double kFallbackRelError = 1.0;
+// Run-to-run spread assumed for the op-sum -> runSession scale until two models calibrate it.
+constexpr double kDefaultScaleRelError = 0.1;
+
+// One (op type, input shapes) cell: running mean/M2 over every timed sample of every instance.
+struct CostEntry {
+    std::string type;
+    std::string shape;
+    double mflops = 0.0;
+    long long n = 0;
+    double meanMs = 0.0;
+    double m2 = 0.0;
+    long long instances = 0;
+
+    double varMs() const { return n > 1 ? m2 / (double)(n - 1) : 0.0; }
+    // Chan et al. parallel update, so tables merge exactly across builds.
+    void merge(long long nb, double meanB, double m2B) {
+        if (nb <= 0) return;
+        const long long total = n + nb;
+        const double delta = meanB - meanMs;
+        meanMs += delta * (double)nb / (double)total;
+        m2 += m2B + delta * delta * (double)n * (double)nb / (double)total;
+        n = total;
+    }
+};
+
+// A model the table was built from: its per-op sum against the plain run.
+struct ModelRecord {
+    std::string model;
+    std::string shape;
+    int ops = 0;
+    double runMedianMs = 0.0;
+    double opSumMedianMs = 0.0;
+    double scale() const { return opSumMedianMs > 0.0 ? runMedianMs / opSumMedianMs : 1.0; }
+};
+
+struct CostTable {
+    std::string deviceKey;
+    json::Value device;
+    json::Value config;
+    std::map<std::string, CostEntry> entries; // type + "|" + shape
+    std::vector<ModelRecord> models;
+};
+
+// One op as seen from the callbacks.
+struct OpSite {
+    std::string type;
+    std::string shape;
+    double mflops = 0.0;
+};
+
+std::string currentDeviceKey() {
+    const auto fp = deviceInfo().fingerprint();
+    return hex64(fnv1a(fp.data(), fp.size()));
+}
+
+long long nowSeconds() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Costs depend on backend, precision and threads, so each combination gets its own table.
+std::string tablePathFor(const json::Value& root, const RunOptions& opt, const std::string& deviceKey) {
+    const std::string explicitPath = root.getString("tablePath");
+    if (!explicitPath.empty()) return explicitPath;
+    const std::string dir = root.getString("tableDir");
+    if (dir.empty()) throw std::runtime_error("Missing tablePath or tableDir");
+    ::mkdir(dir.c_str(), 0755);
+    return dir + "/" + deviceKey + "_" + opt.backend + "_" + opt.precisionMode + "_" + std::to_string(opt.threads) +
+           "t.json";
+}
+
+json::Value configJsonOf(const RunOptions& opt) {
+    json::Value cfg = json::Value::makeObject();
+    cfg.set("backend", json::Value::makeString(opt.backend));
+    cfg.set("precisionMode", json::Value::makeString(opt.precisionMode));
+    cfg.set("threads", json::Value::makeNumber(opt.threads));
+    return cfg;
+}
+
+bool loadTable(const std::string& path, CostTable& table) {
+    std::string text;
+    if (!readFile(path, text)) return false;
+    json::Value root;
+    try {
+        root = json::parse(text);
+    } catch (const std::exception&) {
+        return false;
+    }
+    if (!root.isObject() || root.getInt("version", 0) != kTableVersion) return false;
+    table.deviceKey = root.getString("device_key");
+    if (auto* d = root.get("device")) table.device = *d;
+    if (auto* c = root.get("config")) table.config = *c;
+    if (auto* list = root.get("entries")) {
+        for (auto& e : list->items) {
+            CostEntry c;
+            c.type = e.getString("type");
+            c.shape = e.getString("shape");
+            c.mflops = e.getNumber("mflops");
+            c.n = (long long)e.getNumber("n");
+            c.meanMs = e.getNumber("mean_ms");
+            c.m2 = e.getNumber("m2");
+            c.instances = (long long)e.getNumber("instances");
+            if (c.type.empty() || c.n <= 0) continue;
+            table.entries[c.type + "|" + c.shape] = c;
+        }
+    }
+    if (auto* list = root.get("models")) {
+        for (auto& m : list->items) {
+            ModelRecord r;
+            r.model = m.getString("model");
+            r.shape = m.getString("shape");
+            r.ops = m.getInt("ops");
+            r.runMedianMs = m.getNumber("run_median_ms");
+            r.opSumMedianMs = m.getNumber("op_sum_median_ms");
+            table.models.push_back(r);
+        }
+    }
+    return true;
+}
+
+bool saveTable(const std::string& path, const CostTable& table) {
+    json::Value root = json::Value::makeObject();
+    root.set("version", json::Value::makeNumber(kTableVersion));
+    root.set("device_key", json::Value::makeString(table.deviceKey));
+    root.set("device", table.device);
+    root.set("config", table.config);
+    root.set("updated_at", json::Value::makeNumber((double)nowSeconds()));
+    json::Value entries = json::Value::makeArray();
+    for (auto& kv : table.entries) {
+        const CostEntry& c = kv.second;
+        json::Value e = json::Value::makeObject();
+        e.set("type", json::Value::makeString(c.type));
+        e.set("shape", json::Value::makeString(c.shape));
+        e.set("mflops", json::Value::makeNumber(c.mflops));
+        e.set("n", json::Value::makeNumber((double)c.n));
+        e.set("mean_ms", json::Value::makeNumber(c.meanMs));
+        e.set("m2", json::Value::makeNumber(c.m2));
+        e.set("instances", json::Value::makeNumber((double)c.instances));
+        entries.items.push_back(e);
+    }
+    root.set("entries", entries);
+    json::Value models = json::Value::makeArray();
+    for (auto& r : table.models) {
+        json::Value m = json::Value::makeObject();
+        m.set("model", json::Value::makeString(r.model));
+        m.set("shape", json::Value::makeString(r.shape));
+        m.set("ops", json::Value::makeNumber(r.ops));
+        m.set("run_median_ms", json::Value::makeNumber(r.runMedianMs));
+        m.set("op_sum_median_ms", json::Value::makeNumber(r.opSumMedianMs));
+        models.items.push_back(m);
+    }
+    root.set("models", models);
+    return writeFileAtomic(path, json::dump(root));
+}
+
+// "1x3x224x224,1x64" over the op's inputs; "-" for a missing input, "s" for a scalar.
+std::string shapeKey(const std::vector<MNN::Tensor*>& inputs) {
+    std::ostringstream s;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        if (i) s << ",";
+        const MNN::Tensor* t = inputs[i];
+        if (!t) {
+            s << "-";
+            continue;
+        }
+        if (t->dimensions() == 0) s << "s";
+        for (int d = 0; d < t->dimensions(); ++d) s << (d ? "x" : "") << t->length(d);
+    }
+    return s.str();
+}
+
+OpSite siteOf(const std::vector<MNN::Tensor*>& inputs, const MNN::OperatorInfo* info) {
+    OpSite site;
+    site.type = info ? info->type() : std::string("unknown");
+    site.shape = shapeKey(inputs);
+    site.mflops = info ? (double)info->flops() : 0.0;
+    return site;
+}
+
+json::Value parsedDeviceJson() {
+    std::ostringstream s;
+    writeDeviceJson(s, deviceInfo());
+    return json::parse(s.str());
+}
+
+double meanOf(const std::vector<double>& v) {
+    double sum = 0.0;
+    for (double x : v) sum += x;
+    return v.empty() ? 0.0 : sum / (double)v.size();
+}
+
+double varianceOf(const std::vector<double>& v) {
+    if (v.size() < 2) return 0.0;
+    const double m = meanOf(v);
+    double acc = 0.0;
+    for (double x : v) acc += (x - m) * (x - m);
+    return acc / (double)(v.size() - 1);
+}
+
+struct ModelMeasurement {
+    ModelRecord record;
+    std::vector<OpSite> sites;
+    std::vector<std::vector<double>> opSamples; // by op index
+};
+
+// Plain runs for the reference latency, then synced callback runs for per-op times. Callbacks fire
+// in execution order, so one cursor pairs each after() with its before().
+ModelMeasurement measureModel(const RunOptions& opt, int warmup, int iterations) {
+    ModelMeasurement m;
+    std::unique_ptr<MNN::Interpreter> net = loadInterpreter(opt);
+    MNN::BackendConfig bcfg = makeBackendConfig(opt);
+    MNN::ScheduleConfig cfg = makeScheduleConfig(opt, &bcfg);
+    MNN::Session* session = net->createSession(cfg);
+    if (!session) throw std::runtime_error("Failed to create session");
+    resizeInputs(net.get(), session, opt);
+    fillInputs(net.get(), session, opt.inputFill);
+
+    for (int i = 0; i < warmup; ++i) {
+        net->runSession(session);
+        yieldPoint();
+    }
+    std::vector<double> runMs;
+    for (int i = 0; i < iterations; ++i) {
+        auto a = clock::now();
+        net->runSession(session);
+        runMs.push_back(msBetween(a, clock::now()));
+        yieldPoint();
+    }
+
+    std::vector<double> sumMs;
+    size_t cursor = 0, current = 0;
+    double runSum = 0.0;
+    bool firstRun = true;
+    clock::time_point opStart;
+    MNN::TensorCallBackWithInfo before = [&](const std::vector<MNN::Tensor*>& inputs, const MNN::OperatorInfo* info) {
+        current = cursor++;
+        if (firstRun) {
+            m.sites.push_back(siteOf(inputs, info));
+            m.opSamples.emplace_back();
+        }
+        opStart = clock::now();
+        return true;
+    };
+    MNN::TensorCallBackWithInfo after = [&](const std::vector<MNN::Tensor*>&, const MNN::OperatorInfo*) {
+        const double ms = msBetween(opStart, clock::now());
+        if (current < m.opSamples.size()) m.opSamples[current].push_back(ms);
+        runSum += ms;
+        return true;
+    };
+    for (int i = 0; i < iterations; ++i) {
+        cursor = 0;
+        runSum = 0.0;
+        net->runSessionWithCallBackInfo(session, before, after, true);
+        firstRun = false;
+        sumMs.push_back(runSum);
+        yieldPoint();
+    }
+    net->releaseSession(session);
+
+    m.record.model = opt.modelPath;
+    m.record.shape = shapeSignature(opt);
+    m.record.ops = (int)m.sites.size();
+    m.record.runMedianMs = medianOf(runMs);
+    m.record.opSumMedianMs = medianOf(sumMs);
+    return m;
+}
+
+// Fold a model's per-op samples into the table; returns how many cells were new.
+int mergeMeasurement(CostTable& table, const ModelMeasurement& m) {
+    int added = 0;
+    for (size_t i = 0; i < m.sites.size() && i < m.opSamples.size(); ++i) {
+        const OpSite& site = m.sites[i];
+        const auto& samples = m.opSamples[i];
+        if (samples.empty()) continue;
+        const std::string key = site.type + "|" + site.shape;
+        auto it = table.entries.find(key);
+        if (it == table.entries.end()) {
+            CostEntry c;
+            c.type = site.type;
+            c.shape = site.shape;
+            c.mflops = site.mflops;
+            it = table.entries.emplace(key, c).first;
+            added++;
+        }
+        const double mean = meanOf(samples);
+        it->second.merge((long long)samples.size(), mean, varianceOf(samples) * (double)(samples.size() - 1));
+        it->second.instances++;
+    }
+    // A re-measured model replaces its calibration record rather than adding a second one.
+    auto& models = table.models;
+    models.erase(std::remove_if(models.begin(), models.end(), [&](const ModelRecord& r) {
+        return r.model == m.record.model && r.shape == m.record.shape;
+    }), models.end());
+    models.push_back(m.record);
+    return added;
+}
+
+// Per-op estimate and its variance, from the closest information the table has.
+struct OpEstimate {
+    double ms = 0.0;
+    double var = 0.0;
+    const char* source = "fallback";
+};
+
+struct Predictor {
+    const CostTable& table;
+    // Per type: ms per MFLOP of each cell with flops, and the mean latency of each cell.
+    std::map<std::string, std::vector<double>> ratesByType, meansByType;
+    std::vector<double> allRates, zeroFlopMeans;
+
+    explicit Predictor(const CostTable& t) : table(t) {
+        for (auto& kv : t.entries) {
+            const CostEntry& c = kv.second;
+            meansByType[c.type].push_back(c.meanMs);
+            if (c.mflops > 0.0) {
+                ratesByType[c.type].push_back(c.meanMs / c.mflops);
+                allRates.push_back(c.meanMs / c.mflops);
+            } else {
+                zeroFlopMeans.push_back(c.meanMs);
+            }
+        }
+    }
+
+    // exact: the same type and input shapes were measured.
+    // type_scaled: the type was measured at other shapes; scaled by FLOPs at the median ms/MFLOP,
+    //   with the spread of those rates as the error.
+    // type_mean: the type was measured but neither side has FLOPs; mean and spread of its cells.
+    // fallback: an unmeasured type; the table-wide rate (or per-op mean), 100% error.
+    OpEstimate estimate(const OpSite& site) const {
+        OpEstimate e;
+        auto exact = table.entries.find(site.type + "|" + site.shape);
+        if (exact != table.entries.end()) {
+            e.ms = exact->second.meanMs;
+            e.var = exact->second.varMs();
+            e.source = "exact";
+            return e;
+        }
+        auto rates = ratesByType.find(site.type);
+        if (site.mflops > 0.0 && rates != ratesByType.end()) {
+            const double rate = medianOf(rates->second);
+            e.ms = rate * site.mflops;
+            const double sd = rates->second.size() > 1 ? std::sqrt(varianceOf(rates->second)) * site.mflops
+                                                       : 0.5 * e.ms;
+            e.var = sd * sd;
+            e.source = "type_scaled";
+            return e;
+        }
+        auto means = meansByType.find(site.type);
+        if (means != meansByType.end()) {
+            e.ms = meanOf(means->second);
+            const double sd = means->second.size() > 1 ? std::sqrt(varianceOf(means->second)) : 0.5 * e.ms;
+            e.var = sd * sd;
+            e.source = "type_mean";
+            return e;
+        }
+        if (site.mflops > 0.0 && !allRates.empty()) {
+            e.ms = medianOf(allRates) * site.mflops;
+        } else if (!zeroFlopMeans.empty()) {
+            e.ms = medianOf(zeroFlopMeans);
+        }
+        const double sd = kFallbackRelError * e.ms;
+        e.var = sd * sd;
+        return e;
+    }
+
+    // Mean and variance of runSession / per-op sum over the calibrating models.
+    void scale(double& mean, double& var) const {
+        std::vector<double> s;
+        for (auto& r : table.models) {
+            if (r.opSumMedianMs > 0.0 && r.runMedianMs > 0.0) s.push_back(r.scale());
+        }
+        mean = s.empty() ? 1.0 : meanOf(s);
+        var = s.size() > 1 ? varianceOf(s) : (kDefaultScaleRelError * mean) * (kDefaultScaleRelError * mean);
+    }
+};
+
+// Ops of the session at its current shapes, in execution order, without running any of them.
+std::vector<OpSite> walkOps(MNN::Interpreter* net, MNN::Session* session) {
+    std::vector<OpSite> sites;
+    MNN::TensorCallBackWithInfo before = [&](const std::vector<MNN::Tensor*>& inputs, const MNN::OperatorInfo* info) {
+        sites.push_back(siteOf(inputs, info));
+        return false; // skip execution
+    };
+    MNN::TensorCallBackWithInfo after = [](const std::vector<MNN::Tensor*>&, const MNN::OperatorInfo*) {
+        return true;
+    };
+    net->runSessionWithCallBackInfo(session, before, after);
+    return sites;
+}
+
+void writeConfigSummary(std::ostream& json, const RunOptions& opt) {
+    json << "\"config\":\"" << jsonEscape(describeOptions(opt)) << "\"";
+}
+
+} // namespace
+
+std::string buildCostTable(const std::string& configJson) {
+    try {
+        json::Value root = json::parse(configJson);
+        RunOptions base;
+        applyRunOptions(root, base);
+        const int warmup = std::max(0, root.getInt("warmup", 2));
+        const int iterations = std::max(2, root.getInt("iterations", 10));
+
+        // "models": paths or objects overlaying run options (e.g. their own inputShape); else modelPath.
+        std::vector<RunOptions> models;
+        if (auto* list = root.get("models")) {
+            for (auto& m : list->items) {
+                RunOptions opt = base;
+                if (m.isString()) opt.modelPath = m.str;
+                else if (m.isObject()) applyRunOptions(m, opt);
+                if (!opt.modelPath.empty()) models.push_back(opt);
+            }
+        } else if (!base.modelPath.empty()) {
+            models.push_back(base);
+        }
+        if (models.empty()) throw std::runtime_error("Missing modelPath or models");
+
+        const std::string deviceKey = currentDeviceKey();
+        const std::string path = tablePathFor(root, base, deviceKey);
+        CostTable table;
+        const bool existed = !root.getBool("reset", false) && loadTable(path, table);
+        if (existed && table.deviceKey != deviceKey) {
+            throw std::runtime_error("Cost table at " + path + " belongs to another device; pass reset or another tablePath");
+        }
+        table.deviceKey = deviceKey;
+        table.device = parsedDeviceJson();
+        table.config = configJsonOf(base);
+
+        std::ostringstream json;
+        json.setf(std::ios::fixed); json.precision(6);
+        json << "{\"costTable\":true,";
+        writeConfigSummary(json, base);
+        json << ",\"table\":\"" << jsonEscape(path) << "\",\"extended\":" << (existed ? "true" : "false")
+             << ",\"models\":[";
+        int added = 0;
+        for (size_t i = 0; i < models.size(); ++i) {
+            if (i) json << ",";
+            json << "{\"model\":\"" << jsonEscape(models[i].modelPath) << "\"";
+            try {
+                ModelMeasurement m = measureModel(models[i], warmup, iterations);
+                const int fresh = mergeMeasurement(table, m);
+                added += fresh;
+                json << ",\"shape\":\"" << jsonEscape(m.record.shape) << "\""
+                     << ",\"ops\":" << m.record.ops
+                     << ",\"new_entries\":" << fresh
+                     << ",\"run_median_ms\":" << m.record.runMedianMs
+                     << ",\"op_sum_median_ms\":" << m.record.opSumMedianMs
+                     << ",\"scale\":" << m.record.scale();
+            } catch (const std::exception& e) {
+                json << ",\"error\":\"" << jsonEscape(e.what()) << "\"";
+            }
+            json << "}";
+        }
+        if (!saveTable(path, table)) throw std::runtime_error("Failed to write cost table " + path);
+        std::map<std::string, int> perType;
+        for (auto& kv : table.entries) perType[kv.second.type]++;
+        json << "],\"entries\":" << table.entries.size()
+             << ",\"new_entries\":" << added
+             << ",\"calibration_models\":" << table.models.size()
+             << ",\"types\":{";
+        bool first = true;
+        for (auto& kv : perType) {
+            json << (first ? "" : ",") << "\"" << jsonEscape(kv.first) << "\":" << kv.second;
+            first = false;
+        }
+        json << "},\"device\":";
+        writeDeviceJson(json, deviceInfo());
+        json << "}";
+        return json.str();
+    } catch (const std::exception& e) {
+        return std::string("{\"error\":\"") + jsonEscape(e.what()) + "\"}";
+    }
+}
+
+std::string predictLatency(const std::string& configJson) {
+    try {
+        json::Value root = json::parse(configJson);
+        RunOptions opt;
+        applyRunOptions(root, opt);
+        if (opt.modelPath.empty()) throw std::runtime_error("Missing modelPath");
+
+        const std::string deviceKey = currentDeviceKey();
+        const std::string path = tablePathFor(root, opt, deviceKey);
+        CostTable table;
+        if (!loadTable(path, table) || table.entries.empty()) {
+            throw std::runtime_error("No cost table at " + path + "; run buildCostTable on the target device first");
+        }
+        const bool sameDevice = table.deviceKey == deviceKey;
+
+        // Walk the ops at the requested shapes. With resizeCheck the session is created with the
+        // resize trace open, resized under it, then resized again with the trace applied, so ops whose
+        // shapes are only settled while resizing are walked with their resolved shapes.
+        auto t0 = clock::now();
+        const bool resizeCheck = root.getBool("resizeCheck", true);
+        std::unique_ptr<MNN::Interpreter> net = loadInterpreter(opt);
+        if (resizeCheck) net->setSessionMode(MNN::Interpreter::Session_Resize_Check);
+        MNN::BackendConfig bcfg = makeBackendConfig(opt);
+        MNN::ScheduleConfig cfg = makeScheduleConfig(opt, &bcfg);
+        MNN::Session* session = net->createSession(cfg);
+        if (!session) throw std::runtime_error("Failed to create session");
+        resizeInputs(net.get(), session, opt);
+        if (resizeCheck) {
+            net->setSessionMode(MNN::Interpreter::Session_Resize_Fix);
+            net->resizeSession(session);
+        }
+        const std::vector<OpSite> sites = walkOps(net.get(), session);
+        net->releaseSession(session);
+        net.reset();
+        const double walkMs = msBetween(t0, clock::now());
+        if (sites.empty()) throw std::runtime_error("The session reported no ops");
+
+        Predictor predictor(table);
+        double sumMs = 0.0, sumVar = 0.0;
+        std::map<std::string, std::pair<int, double>> bySource; // count, ms
+        std::map<std::string, int> unmatchedTypes;
+        std::vector<OpEstimate> estimates;
+        estimates.reserve(sites.size());
+        for (auto& site : sites) {
+            OpEstimate e = predictor.estimate(site);
+            sumMs += e.ms;
+            sumVar += e.var;
+            auto& b = bySource[e.source];
+            b.first++;
+            b.second += e.ms;
+            if (std::string(e.source) == "fallback") unmatchedTypes[site.type]++;
+            estimates.push_back(e);
+        }
+        double scaleMean = 1.0, scaleVar = 0.0;
+        predictor.scale(scaleMean, scaleVar);
+        // Independent per-op errors plus the op-sum -> runSession scale: var(aX) ~ a^2 var(X) + X^2 var(a).
+        const double predicted = scaleMean * sumMs;
+        const double sd = std::sqrt(scaleMean * scaleMean * sumVar + sumMs * sumMs * scaleVar);
+        const double errorBar = 1.96 * sd;
+
+        std::ostringstream json;
+        json.setf(std::ios::fixed); json.precision(6);
+        json << "{\"predictLatency\":true,";
+        writeConfigSummary(json, opt);
+        json << ",\"table\":\"" << jsonEscape(path) << "\""
+             << ",\"table_entries\":" << table.entries.size()
+             << ",\"table_device\":" << json::dump(table.device)
+             << ",\"table_config\":" << json::dump(table.config)
+             << ",\"same_device\":" << (sameDevice ? "true" : "false")
+             << ",\"ops\":" << sites.size()
+             << ",\"walk_ms\":" << walkMs
+             << ",\"resize_checked\":" << (resizeCheck ? "true" : "false")
+             << ",\"prediction\":{\"median_ms\":" << predicted
+             << ",\"sd_ms\":" << sd
+             << ",\"error_bar_ms\":" << errorBar
+             << ",\"interval_ms\":[" << std::max(0.0, predicted - errorBar) << "," << predicted + errorBar << "]"
+             << ",\"op_sum_ms\":" << sumMs
+             << ",\"scale\":" << scaleMean << "}";
+        json << ",\"coverage\":{";
+        bool first = true;
+        for (auto& kv : bySource) {
+            json << (first ? "" : ",") << "\"" << kv.first << "\":{\"ops\":" << kv.second.first
+                 << ",\"ms\":" << kv.second.second
+                 << ",\"share\":" << (sumMs > 0.0 ? kv.second.second / sumMs : 0.0) << "}";
+            first = false;
+        }
+        json << "},\"unmatched_types\":{";
+        first = true;
+        for (auto& kv : unmatchedTypes) {
+            json << (first ? "" : ",") << "\"" << jsonEscape(kv.first) << "\":" << kv.second;
+            first = false;
+        }
+        json << "}";
+
+        // The ops that dominate the estimate, so a wide error bar can be traced to its cause.
+        std::vector<size_t> order(sites.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+        const size_t topN = std::min<size_t>(order.size(), (size_t)std::max(0, root.getInt("topOps", 10)));
+        std::partial_sort(order.begin(), order.begin() + (long)topN, order.end(),
+                          [&](size_t a, size_t b) { return estimates[a].ms > estimates[b].ms; });
+        json << ",\"top_ops\":[";
+        for (size_t k = 0; k < topN; ++k) {
+            const size_t i = order[k];
+            json << (k ? "," : "") << "{\"index\":" << i
+                 << ",\"type\":\"" << jsonEscape(sites[i].type) << "\""
+                 << ",\"shape\":\"" << jsonEscape(sites[i].shape) << "\""
+                 << ",\"mflops\":" << sites[i].mflops
+                 << ",\"predicted_ms\":" << estimates[i].ms
+                 << ",\"sd_ms\":" << std::sqrt(estimates[i].var)
+                 << ",\"source\":\"" << estimates[i].source << "\"}";
+        }
+        json << "]";
+
+        // Validate against a real run, which only means something on the device the table describes.
+        const bool validate = root.getBool("validate", sameDevice);
+        if (validate) {
+            const int warmup = std::max(0, root.getInt("warmup", 2));
+            const int iterations = std::max(1, root.getInt("iterations", 10));
+            BenchRun run = benchmarkConfig(opt, warmup, iterations);
+            const double measured = medianOf(run.samplesMs);
+            const double err = predicted - measured;
+            json << ",\"validation\":{\"measured_median_ms\":" << measured
+                 << ",\"error_ms\":" << err
+                 << ",\"error_pct\":" << (measured > 0.0 ? 100.0 * err / measured : 0.0)
+                 << ",\"within_error_bar\":" << (std::fabs(err) <= errorBar ? "true" : "false");
+            if (!sameDevice) json << ",\"note\":\"table from another device\"";
+            json << ",\"latency\":";
+            writeLatency(json, run.samplesMs);
+            json << "}";
+        }
+        json << ",\"device\":";
+        writeDeviceJson(json, deviceInfo());
+        json << "}";
+        return json.str();
+    } catch (const std::exception& e) {
+        return std::string("{\"error\":\"") + jsonEscape(e.what()) + "\"}";
+    }
+}
+#else
+std::string buildCostTable(const std::string& configJson) {
+    (void)configJson;
+    return "{\"error\":\"MNN not bundled. Cannot build a cost table. Place headers and libMNN.so as documented.\"}";
+}
+
+std::string predictLatency(const std::string& configJson) {
+    (void)configJson;
+    return "{\"error\":\"MNN not bundled. Cannot predict latency. Place headers and libMNN.so as documented.\"}";
+}
+#endif
+
+} // namespace runner
@@ -0,0 +1,122 @@
+#include "layout_pack.hpp"
+
+#include <cstring>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define RUNNER_PACK_NEON 1
+#elif defined(__SSE2__)
+#include <xmmintrin.h>
+#define RUNNER_PACK_SSE 1
+#endif
+
+namespace runner {
+
+namespace {
+
+// Four full channel planes -> one NC4HW4 plane.
+void packBlock4(float* dst, const float* r0, const float* r1, const float* r2, const float* r3, int area) {
+    int i = 0;
+#if RUNNER_PACK_NEON
+    for (; i + 4 <= area; i += 4) {
+        float32x4x4_t v;
+        v.val[0] = vld1q_f32(r0 + i);
+        v.val[1] = vld1q_f32(r1 + i);
+        v.val[2] = vld1q_f32(r2 + i);
+        v.val[3] = vld1q_f32(r3 + i);
+        vst4q_f32(dst + i * 4, v); // interleaving store is the 4x4 transpose
+    }
+#elif RUNNER_PACK_SSE
+    for (; i + 4 <= area; i += 4) {
+        __m128 a = _mm_loadu_ps(r0 + i), b = _mm_loadu_ps(r1 + i);
+        __m128 c = _mm_loadu_ps(r2 + i), d = _mm_loadu_ps(r3 + i);
+        _MM_TRANSPOSE4_PS(a, b, c, d);
+        _mm_storeu_ps(dst + i * 4, a);
+        _mm_storeu_ps(dst + i * 4 + 4, b);
+        _mm_storeu_ps(dst + i * 4 + 8, c);
+        _mm_storeu_ps(dst + i * 4 + 12, d);
+    }
+#endif
+    for (; i < area; ++i) {
+        dst[i * 4 + 0] = r0[i];
+        dst[i * 4 + 1] = r1[i];
+        dst[i * 4 + 2] = r2[i];
+        dst[i * 4 + 3] = r3[i];
+    }
+}
+
+void unpackBlock4(float* w0, float* w1, float* w2, float* w3, const float* src, int area) {
+    int i = 0;
+#if RUNNER_PACK_NEON
+    for (; i + 4 <= area; i += 4) {
+        float32x4x4_t v = vld4q_f32(src + i * 4);
+        vst1q_f32(w0 + i, v.val[0]);
+        vst1q_f32(w1 + i, v.val[1]);
+        vst1q_f32(w2 + i, v.val[2]);
+        vst1q_f32(w3 + i, v.val[3]);
+    }
+#elif RUNNER_PACK_SSE
+    for (; i + 4 <= area; i += 4) {
+        __m128 a = _mm_loadu_ps(src + i * 4), b = _mm_loadu_ps(src + i * 4 + 4);
+        __m128 c = _mm_loadu_ps(src + i * 4 + 8), d = _mm_loadu_ps(src + i * 4 + 12);
+        _MM_TRANSPOSE4_PS(a, b, c, d);
+        _mm_storeu_ps(w0 + i, a);
+        _mm_storeu_ps(w1 + i, b);
+        _mm_storeu_ps(w2 + i, c);
+        _mm_storeu_ps(w3 + i, d);
+    }
+#endif
+    for (; i < area; ++i) {
+        w0[i] = src[i * 4 + 0];
+        w1[i] = src[i * 4 + 1];
+        w2[i] = src[i * 4 + 2];
+        w3[i] = src[i * 4 + 3];
+    }
+}
+
+} // namespace
+
+void packNC4HW4(float* dst, const float* src, int batch, int channels, int area) {
+    const int blocks = (channels + 3) / 4;
+    for (int n = 0; n < batch; ++n) {
+        const float* s = src + (size_t)n * channels * area;
+        float* d = dst + (size_t)n * blocks * area * 4;
+        const int full = channels / 4;
+        for (int b = 0; b < full; ++b) {
+            const float* r = s + (size_t)b * 4 * area;
+            packBlock4(d + (size_t)b * area * 4, r, r + area, r + 2 * area, r + 3 * area, area);
+        }
+        if (full < blocks) {
+            float* tail = d + (size_t)full * area * 4;
+            std::memset(tail, 0, sizeof(float) * (size_t)area * 4);
+            for (int c = full * 4; c < channels; ++c) {
+                const float* r = s + (size_t)c * area;
+                const int lane = c - full * 4;
+                for (int i = 0; i < area; ++i) tail[i * 4 + lane] = r[i];
+            }
+        }
+    }
+}
+
+void unpackNC4HW4(float* dst, const float* src, int batch, int channels, int area) {
+    const int blocks = (channels + 3) / 4;
+    for (int n = 0; n < batch; ++n) {
+        const float* s = src + (size_t)n * blocks * area * 4;
+        float* d = dst + (size_t)n * channels * area;
+        const int full = channels / 4;
+        for (int b = 0; b < full; ++b) {
+            float* w = d + (size_t)b * 4 * area;
+            unpackBlock4(w, w + area, w + 2 * area, w + 3 * area, s + (size_t)b * area * 4, area);
+        }
+        if (full < blocks) {
+            const float* tail = s + (size_t)full * area * 4;
+            for (int c = full * 4; c < channels; ++c) {
+                float* w = d + (size_t)c * area;
+                const int lane = c - full * 4;
+                for (int i = 0; i < area; ++i) w[i] = tail[i * 4 + lane];
+            }
+        }
+    }
+}
+
+} // namespace runner
@@ -0,0 +1,14 @@
+// NCHW <-> NC4HW4 conversion for float32 host buffers, the layout MNN's CPU and GPU backends keep
+// 4-D tensors in. NC4HW4 groups channels by four and interleaves them per pixel:
+// [N][ceil(C/4)][H*W][4], with the channel tail zero-padded.
+#pragma once
+#include <cstddef>
+
+namespace runner {
+
+// `dst` holds batch * ceil(channels/4) * area * 4 floats.
+void packNC4HW4(float* dst, const float* src, int batch, int channels, int area);
+// `dst` holds batch * channels * area floats; padding lanes of `src` are dropped.
+void unpackNC4HW4(float* dst, const float* src, int batch, int channels, int area);
+
+} // namespace runner
@@ -0,0 +1,351 @@
+// Open-loop load generation: inferences arrive at a target rate (Poisson or fixed spacing) and are
+// served by a pool of sessions. Latency is taken from the intended send time, so time spent
+// queued behind a slow request counts (no coordinated omission), and lands in an HDR histogram.
+// Sweeping the rate traces the throughput/latency curve and its knee per config.
+#include "modes.hpp"
+#include "runner_common.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <thread>
+
+namespace runner {
+
+#if HAVE_MNN
+namespace {
+
+// HdrHistogram-style log-linear buckets over microseconds: 3 significant digits, 1 us to 1 hour.
+class HdrHistogram {
+public:
+    static constexpr int kSubBucketHalfMagnitude = 10;                  // 1024
+    static constexpr int64_t kSubBucketCount = 1 << (kSubBucketHalfMagnitude + 1);
+    static constexpr int64_t kSubBucketHalf = kSubBucketCount / 2;
+    static constexpr int64_t kHighest = 3600LL * 1000 * 1000;
+
+    HdrHistogram() {
+        int buckets = 1;
+        for (int64_t smallest = kSubBucketCount; smallest <= kHighest; smallest <<= 1) ++buckets;
+        counts_.assign((size_t)(buckets + 1) * kSubBucketHalf, 0);
+    }
+
+    void record(int64_t us) {
+        us = std::min(std::max<int64_t>(us, 0), kHighest);
+        ++counts_[indexOf(us)];
+        ++total_;
+        sum_ += (double)us;
+        max_ = std::max(max_, us);
+    }
+
+    void add(const HdrHistogram& o) {
+        for (size_t i = 0; i < counts_.size(); ++i) counts_[i] += o.counts_[i];
+        total_ += o.total_;
+        sum_ += o.sum_;
+        max_ = std::max(max_, o.max_);
+    }
+
+    uint64_t count() const { return total_; }
+    double meanUs() const { return total_ ? sum_ / (double)total_ : 0.0; }
+    int64_t maxUs() const { return max_; }
+
+    // Highest value equivalent to the bucket holding the requested percentile, like HdrHistogram.
+    int64_t valueAtPercentile(double pct) const {
+        if (!total_) return 0;
+        const uint64_t target = std::max<uint64_t>(1, (uint64_t)((pct / 100.0) * (double)total_ + 0.5));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < counts_.size(); ++i) {
+            seen += counts_[i];
+            if (seen >= target) return std::min(highestEquivalent(i), max_);
+        }
+        return max_;
+    }
+
+private:
+    static int bucketOf(int64_t v) {
+        return 63 - kSubBucketHalfMagnitude - __builtin_clzll((uint64_t)(v | (kSubBucketCount - 1)));
+    }
+    static size_t indexOf(int64_t v) {
+        const int bucket = bucketOf(v);
+        const int64_t sub = v >> bucket;
+        return (size_t)(((int64_t)(bucket + 1) << kSubBucketHalfMagnitude) + (sub - kSubBucketHalf));
+    }
+    static int64_t highestEquivalent(size_t index) {
+        int bucket = (int)(index >> kSubBucketHalfMagnitude) - 1;
+        int64_t sub = (int64_t)(index & (kSubBucketHalf - 1)) + kSubBucketHalf;
+        if (bucket < 0) { sub -= kSubBucketHalf; bucket = 0; }
+        return ((sub + 1) << bucket) - 1;
+    }
+
+    std::vector<uint64_t> counts_;
+    uint64_t total_ = 0;
+    double sum_ = 0.0;
+    int64_t max_ = 0;
+};
+
+// One Interpreter per slot: sessions of a single Interpreter serialize on its lock.
+struct PoolSlot {
+    std::unique_ptr<MNN::Interpreter> net;
+    MNN::Session* session = nullptr;
+    MNN::Tensor* output = nullptr;
+    std::unique_ptr<MNN::Tensor> hostOutput;
+
+    // Copy the first output back so asynchronous backends are measured to completion.
+    void run() {
+        net->runSession(session);
+        if (output) output->copyToHostTensor(hostOutput.get());
+    }
+};
+
+std::unique_ptr<PoolSlot> makeSlot(const RunOptions& opt) {
+    auto slot = std::unique_ptr<PoolSlot>(new PoolSlot());
+    slot->net.reset(MNN::Interpreter::createFromFile(opt.modelPath.c_str()));
+    if (!slot->net) throw std::runtime_error("Failed to create interpreter");
+    if (!opt.cacheFile.empty()) slot->net->setCacheFile(opt.cacheFile.c_str());
+    for (auto& kv : opt.sessionHints) slot->net->setSessionHint((MNN::Interpreter::HintMode)kv.first, kv.second);
+    MNN::BackendConfig bcfg = makeBackendConfig(opt);
+    MNN::ScheduleConfig cfg = makeScheduleConfig(opt, &bcfg);
+    slot->session = slot->net->createSession(cfg);
+    if (!slot->session) throw std::runtime_error("Failed to create session");
+    resizeInputs(slot->net.get(), slot->session, opt);
+    fillInputs(slot->net.get(), slot->session, opt.inputFill);
+    auto& outs = slot->net->getSessionOutputAll(slot->session);
+    if (!outs.empty() && outs.begin()->second) {
+        slot->output = outs.begin()->second;
+        slot->hostOutput.reset(new MNN::Tensor(slot->output, slot->output->getDimensionType()));
+    }
+    return slot;
+}
+
+struct LoadParams {
+    bool poisson = true;
+    double durationMs = 2000.0;
+    int minRequests = 20;
+    size_t maxBacklog = 256;
+    unsigned seed = 42;
+};
+
+struct RateResult {
+    double targetQps = 0.0;
+    double achievedQps = 0.0;
+    uint64_t sent = 0;
+    size_t maxBacklog = 0;
+    bool saturated = false; // backlog limit hit; the rate was cut short
+    HdrHistogram latency;   // completion - intended send time
+    HdrHistogram service;   // completion - dequeue, i.e. what a closed loop would report
+};
+
+// Issue requests at `qps` for the configured duration and wait for the pool to drain them.
+RateResult runRate(std::vector<std::unique_ptr<PoolSlot>>& pool, double qps, const LoadParams& p) {
+    RateResult res;
+    res.targetQps = qps;
+    std::mutex mu;
+    std::condition_variable cv;
+    std::deque<clock::time_point> queue;
+    bool stop = false;
+    std::vector<HdrHistogram> latency(pool.size()), service(pool.size());
+
+    std::vector<std::thread> workers;
+    for (size_t w = 0; w < pool.size(); ++w) {
+        workers.emplace_back([&, w]() {
+            for (;;) {
+                clock::time_point intended;
+                {
+                    std::unique_lock<std::mutex> lock(mu);
+                    cv.wait(lock, [&] { return stop || !queue.empty(); });
+                    if (queue.empty()) return;
+                    intended = queue.front();
+                    queue.pop_front();
+                }
+                const auto start = clock::now();
+                pool[w]->run();
+                const auto done = clock::now();
+                latency[w].record(std::chrono::duration_cast<std::chrono::microseconds>(done - intended).count());
+                service[w].record(std::chrono::duration_cast<std::chrono::microseconds>(done - start).count());
+            }
+        });
+    }
+
+    const double windowMs = std::max(p.durationMs, 1000.0 * p.minRequests / qps);
+    std::mt19937_64 rng(p.seed);
+    std::exponential_distribution<double> gap(qps / 1000.0); // mean gap in ms
+    const auto begin = clock::now();
+    double offsetMs = 0.0;
+    while (offsetMs < windowMs) {
+        const auto intended = begin + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double, std::milli>(offsetMs));
+        std::this_thread::sleep_until(intended);
+        {
+            std::lock_guard<std::mutex> lock(mu);
+            queue.push_back(intended);
+            res.maxBacklog = std::max(res.maxBacklog, queue.size());
+            if (queue.size() > p.maxBacklog) res.saturated = true;
+        }
+        cv.notify_one();
+        ++res.sent;
+        if (res.saturated) break;
+        offsetMs += p.poisson ? gap(rng) : 1000.0 / qps;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mu);
+        stop = true;
+    }
+    cv.notify_all();
+    for (auto& t : workers) t.join();
+    const double elapsedMs = msBetween(begin, clock::now());
+
+    for (size_t w = 0; w < pool.size(); ++w) {
+        res.latency.add(latency[w]);
+        res.service.add(service[w]);
+    }
+    res.achievedQps = elapsedMs > 0.0 ? 1000.0 * (double)res.latency.count() / elapsedMs : 0.0;
+    return res;
+}
+
+void writePercentiles(std::ostream& json, const HdrHistogram& h, bool full) {
+    auto ms = [](int64_t us) { return (double)us / 1000.0; };
+    json << "{\"count\":" << h.count()
+         << ",\"p50_ms\":" << ms(h.valueAtPercentile(50.0))
+         << ",\"p90_ms\":" << ms(h.valueAtPercentile(90.0))
+         << ",\"p99_ms\":" << ms(h.valueAtPercentile(99.0));
+    if (full) {
+        json << ",\"p99_9_ms\":" << ms(h.valueAtPercentile(99.9))
+             << ",\"p99_99_ms\":" << ms(h.valueAtPercentile(99.99));
+    }
+    json << ",\"mean_ms\":" << h.meanUs() / 1000.0
+         << ",\"max_ms\":" << ms(h.maxUs()) << "}";
+}
+
+} // namespace
+
+std::string runOpenLoop(const std::string& configJson) {
+    try {
+        json::Value root = json::parse(configJson);
+        RunOptions base;
+        applyRunOptions(root, base);
+        if (base.modelPath.empty()) throw std::runtime_error("Missing modelPath");
+
+        LoadParams params;
+        params.poisson = root.getString("arrival", "poisson") != "fixed";
+        params.durationMs = std::max(100.0, root.getNumber("durationMs", 2000.0));
+        params.minRequests = std::max(1, root.getInt("minRequests", 20));
+        params.maxBacklog = (size_t)std::max(1, root.getInt("maxBacklog", 256));
+        const int poolSize = std::max(1, root.getInt("poolSize", 2));
+        const int calibration = std::max(1, root.getInt("calibrationIterations", 10));
+        // The knee is the first rate whose p99 exceeds kneeFactor x the lightest rate's p99,
+        // that falls behind its target, or that overflows the backlog.
+        const double kneeFactor = std::max(1.0, root.getNumber("kneeFactor", 3.0));
+        std::vector<double> explicitRates;
+        if (auto* r = root.get("rates")) {
+            for (auto& v : r->items) if (v.isNumber() && v.number > 0.0) explicitRates.push_back(v.number);
+        }
+        std::vector<double> fractions = {0.2, 0.4, 0.6, 0.7, 0.8, 0.9, 1.0, 1.1, 1.25};
+        if (auto* f = root.get("rateFractions")) {
+            fractions.clear();
+            for (auto& v : f->items) if (v.isNumber() && v.number > 0.0) fractions.push_back(v.number);
+        }
+
+        std::vector<RunOptions> configs;
+        if (auto* c = root.get("configs")) {
+            for (auto& item : c->items) {
+                RunOptions o = base;
+                applyRunOptions(item, o);
+                configs.push_back(o);
+            }
+        }
+        if (configs.empty()) configs.push_back(base);
+
+        std::ostringstream json;
+        json.setf(std::ios::fixed); json.precision(3);
+        json << "{\"openLoop\":true"
+             << ",\"arrival\":\"" << (params.poisson ? "poisson" : "fixed") << "\""
+             << ",\"pool_size\":" << poolSize
+             << ",\"duration_ms\":" << params.durationMs
+             << ",\"knee_factor\":" << kneeFactor
+             << ",\"configs\":[";
+        for (size_t ci = 0; ci < configs.size(); ++ci) {
+            const RunOptions& opt = configs[ci];
+            if (ci) json << ",";
+            json << "{\"label\":\"" << jsonEscape(describeOptions(opt)) << "\""
+                 << ",\"backend\":\"" << opt.backend << "\""
+                 << ",\"precisionMode\":\"" << opt.precisionMode << "\""
+                 << ",\"threads\":" << opt.threads;
+            try {
+                std::vector<std::unique_ptr<PoolSlot>> pool;
+                for (int i = 0; i < poolSize; ++i) pool.push_back(makeSlot(opt));
+                for (auto& slot : pool) slot->run(); // warmup
+
+                // Closed-loop service time sets the default rate ladder around the pool's capacity.
+                std::vector<double> serviceMs;
+                for (int i = 0; i < calibration; ++i) {
+                    auto a = clock::now();
+                    pool[0]->run();
+                    serviceMs.push_back(msBetween(a, clock::now()));
+                }
+                const double service = medianOf(serviceMs);
+                const double capacity = service > 0.0 ? 1000.0 * poolSize / service : 0.0;
+                std::vector<double> rates = explicitRates;
+                if (rates.empty()) {
+                    for (double f : fractions) rates.push_back(f * capacity);
+                }
+                std::sort(rates.begin(), rates.end());
+                json << ",\"service_median_ms\":" << service
+                     << ",\"capacity_estimate_qps\":" << capacity
+                     << ",\"rates\":[";
+
+                double baseP99 = -1.0, sustainable = 0.0;
+                int kneeIndex = -1;
+                std::ostringstream knee;
+                knee.setf(std::ios::fixed); knee.precision(3);
+                for (size_t ri = 0; ri < rates.size(); ++ri) {
+                    params.seed = 42 + (unsigned)ri;
+                    RateResult r = runRate(pool, rates[ri], params);
+                    const double p99 = (double)r.latency.valueAtPercentile(99.0) / 1000.0;
+                    if (baseP99 < 0.0) baseP99 = p99;
+                    const bool behind = r.achievedQps < 0.9 * r.targetQps;
+                    const bool past = r.saturated || behind || (baseP99 > 0.0 && p99 > kneeFactor * baseP99);
+                    if (ri) json << ",";
+                    json << "{\"target_qps\":" << r.targetQps
+                         << ",\"achieved_qps\":" << r.achievedQps
+                         << ",\"sent\":" << r.sent
+                         << ",\"max_backlog\":" << r.maxBacklog
+                         << ",\"saturated\":" << (r.saturated ? "true" : "false")
+                         << ",\"latency\":";
+                    writePercentiles(json, r.latency, true);
+                    json << ",\"service\":";
+                    writePercentiles(json, r.service, false);
+                    json << "}";
+                    if (past && kneeIndex < 0) {
+                        kneeIndex = (int)ri;
+                        knee << "{\"index\":" << ri << ",\"target_qps\":" << r.targetQps
+                             << ",\"achieved_qps\":" << r.achievedQps << ",\"p99_ms\":" << p99
+                             << ",\"reason\":\"" << (r.saturated ? "backlog" : behind ? "throughput" : "p99") << "\"}";
+                    }
+                    if (kneeIndex < 0) sustainable = r.achievedQps;
+                    // Past saturation every later rate only measures queue growth.
+                    if (r.saturated) break;
+                }
+                json << "],\"knee\":" << (kneeIndex < 0 ? std::string("null") : knee.str())
+                     << ",\"max_sustainable_qps\":" << sustainable;
+            } catch (const std::exception& e) {
+                json << ",\"error\":\"" << jsonEscape(e.what()) << "\"";
+            }
+            json << "}";
+        }
+        json << "]}";
+        return json.str();
+    } catch (const std::exception& e) {
+        return std::string("{\"error\":\"") + jsonEscape(e.what()) + "\"}";
+    }
+}
+#else
+std::string runOpenLoop(const std::string& configJson) {
+    (void)configJson;
+    return "{\"error\":\"MNN not bundled. Cannot run open-loop load. Place headers and libMNN.so as documented.\"}";
+}
+#endif
+
+} // namespace runner
@@ -0,0 +1,236 @@
+// Low-memory residency: drop the model buffer after session creation, collect static
+// memory on resize and spill feature maps to disk, against the default footprint. Spill runs as a
+// Module in Memory_Low, so it is judged against a Module run in the same mode without the spill dir.
+#include "modes.hpp"
+#include "runner_common.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <sstream>
+
+#include <dirent.h>
+#include <malloc.h>
+#include <sys/stat.h>
+
+namespace runner {
+
+#if HAVE_MNN
+namespace {
+
+long long dirBytes(const std::string& dir) {
+    long long total = 0;
+    DIR* d = opendir(dir.c_str());
+    if (!d) return 0;
+    while (auto* e = readdir(d)) {
+        std::string name = e->d_name;
+        if (name == "." || name == "..") continue;
+        struct stat st;
+        if (stat((dir + "/" + name).c_str(), &st) == 0 && S_ISREG(st.st_mode)) total += st.st_size;
+    }
+    closedir(d);
+    return total;
+}
+
+// Return freed heap pages to the kernel so one run's leftovers do not shrink the next run's RSS delta.
+void trimHeap() {
+#if defined(M_PURGE)
+    mallopt(M_PURGE, 0);
+#elif defined(__GLIBC__)
+    malloc_trim(0);
+#endif
+}
+
+struct ResidencyRun {
+    std::string variant;
+    std::string engine = "interpreter";
+    std::string memoryMode;
+    BenchRun bench;
+    long long rssAfterReleaseBytes = -1; // right after releaseModel
+    long long spillBytes = -1;           // bytes written under the feature-map dir
+    std::string error;
+};
+
+// Default session next to one with Session_Memory_Collect and releaseModel() after resize.
+ResidencyRun runInterpreter(const RunOptions& opt, bool lowMemory, int warmup, int iterations) {
+    ResidencyRun run;
+    run.variant = lowMemory ? "release_model" : "default";
+    run.memoryMode = opt.memoryMode;
+    trimHeap();
+    BenchHooks hooks;
+    if (lowMemory) {
+        hooks.beforeSession = [](MNN::Interpreter* net) {
+            net->setSessionMode(MNN::Interpreter::Session_Memory_Collect);
+        };
+        hooks.afterResize = [&run](MNN::Interpreter* net, MNN::Session*) {
+            net->releaseModel();
+            run.rssAfterReleaseBytes = readRssBytes();
+        };
+    }
+    run.bench = benchmarkConfig(opt, warmup, iterations, hooks);
+    return run;
+}
+
+#if HAVE_MNN_EXPRESS
+// Feature-map spill is configured on a RuntimeManager, so this variant runs as a Module. An empty
+// featureMapDir gives the same Module setup without spill: the control the spill run is judged by.
+ResidencyRun runModule(const RunOptions& opt, const std::string& featureMapDir, int warmup, int iterations) {
+    using namespace MNN::Express;
+    ResidencyRun run;
+    run.variant = featureMapDir.empty() ? "module_control" : "featuremap_spill";
+    run.engine = "module";
+    run.memoryMode = opt.memoryMode;
+    BenchRun& bench = run.bench;
+    const long long spillBefore = featureMapDir.empty() ? 0 : dirBytes(featureMapDir);
+    trimHeap();
+    bench.rssBeforeBytes = readRssBytes();
+
+    auto t0 = clock::now();
+    RuntimeManagerPtr rtmgr = makeRuntimeManager(opt);
+    rtmgr->setMode(MNN::Interpreter::Session_Memory_Collect);
+    if (!featureMapDir.empty()) rtmgr->setExternalPath(featureMapDir, MNN::Interpreter::EXTERNAL_FEATUREMAP_DIR);
+    Module::Config mcfg;
+    std::shared_ptr<Module> module(Module::load({}, {}, opt.modelPath.c_str(), rtmgr, &mcfg), Module::destroy);
+    if (!module) throw std::runtime_error(featureMapDir.empty() ? "Failed to load module" : "Failed to load module with feature-map dir");
+    bench.createSessionMs = msBetween(t0, clock::now());
+    auto inputs = makeModuleInputs(module->getInfo(), opt);
+
+    auto forward = [&]() {
+        auto outs = module->onForward(inputs);
+        if (outs.empty()) throw std::runtime_error("Module forward returned no outputs");
+        (void)outs[0]->readMap<void>();
+    };
+    for (int i = 0; i < warmup; ++i) forward();
+    for (int i = 0; i < iterations; ++i) {
+        auto a = clock::now();
+        forward();
+        bench.samplesMs.push_back(msBetween(a, clock::now()));
+    }
+    bench.rssAfterBytes = readRssBytes();
+    (void)rtmgr->getInfo(MNN::Interpreter::MEMORY, &bench.memoryMb);
+    bench.outputs = readModuleOutputs(module->onForward(inputs), module->getInfo()->outputNames);
+    if (!featureMapDir.empty()) run.spillBytes = dirBytes(featureMapDir) - spillBefore;
+    return run;
+}
+#endif
+
+double rssDeltaMb(const BenchRun& b) {
+    if (b.rssBeforeBytes < 0 || b.rssAfterBytes < 0) return -1.0;
+    return (double)(b.rssAfterBytes - b.rssBeforeBytes) / (1024.0 * 1024.0);
+}
+
+void writeRun(std::ostream& json, const ResidencyRun& run, const ResidencyRun* base) {
+    json << "{\"variant\":\"" << run.variant << "\",\"engine\":\"" << run.engine << "\"";
+    if (!run.error.empty()) {
+        json << ",\"error\":\"" << jsonEscape(run.error) << "\"}";
+        return;
+    }
+    const BenchRun& b = run.bench;
+    const double median = medianOf(b.samplesMs);
+    json << ",\"memoryMode\":\"" << run.memoryMode << "\""
+         << ",\"createSession_ms\":" << b.createSessionMs
+         << ",\"memory_mb\":" << b.memoryMb
+         << ",\"rss_delta_mb\":" << rssDeltaMb(b);
+    if (run.rssAfterReleaseBytes >= 0 && b.rssBeforeBytes >= 0) {
+        json << ",\"rss_after_release_mb\":" << (double)(run.rssAfterReleaseBytes - b.rssBeforeBytes) / (1024.0 * 1024.0);
+    }
+    if (run.spillBytes >= 0) json << ",\"spilled_mb\":" << run.spillBytes / (1024.0 * 1024.0);
+    json << ",\"latency\":";
+    writeLatency(json, b.samplesMs);
+    if (base) {
+        const double baseMedian = medianOf(base->bench.samplesMs);
+        json << ",\"compared_to\":\"" << base->variant << "\""
+             << ",\"rss_saved_mb\":" << rssDeltaMb(base->bench) - rssDeltaMb(b)
+             << ",\"memory_saved_mb\":" << base->bench.memoryMb - b.memoryMb
+             << ",\"latency_cost_ms\":" << median - baseMedian
+             << ",\"latency_cost_pct\":" << (baseMedian > 0.0 ? 100.0 * (median - baseMedian) / baseMedian : 0.0)
+             << ",\"outputs\":";
+        writeOutputErrors(json, base->bench.outputs, b.outputs);
+    }
+    json << "}";
+}
+
+} // namespace
+
+std::string runLowMemory(const std::string& configJson) {
+    try {
+        json::Value root = json::parse(configJson);
+        RunOptions opt;
+        applyRunOptions(root, opt);
+        if (opt.modelPath.empty()) throw std::runtime_error("Missing modelPath");
+        const int warmup = std::max(0, root.getInt("warmup", 1));
+        const int iterations = std::max(1, root.getInt("iterations", 10));
+        const std::string featureMapDir = root.getString("featureMapDir");
+
+        ResidencyRun base = runInterpreter(opt, false, warmup, iterations);
+        // Each variant with the index of the run it is compared against (-1: the default run).
+        std::vector<ResidencyRun> variants;
+        std::vector<int> comparedTo;
+        try {
+            variants.push_back(runInterpreter(opt, true, warmup, iterations));
+        } catch (const std::exception& e) {
+            ResidencyRun failed;
+            failed.variant = "release_model";
+            failed.error = e.what();
+            variants.push_back(failed);
+        }
+        comparedTo.push_back(-1);
+#if HAVE_MNN_EXPRESS
+        if (!featureMapDir.empty()) {
+            RunOptions spillOpt = opt;
+            spillOpt.memoryMode = "LOW";
+            int control = -1;
+            try {
+                variants.push_back(runModule(spillOpt, std::string(), warmup, iterations));
+                control = (int)variants.size() - 1;
+            } catch (const std::exception& e) {
+                ResidencyRun failed;
+                failed.variant = "module_control";
+                failed.engine = "module";
+                failed.error = e.what();
+                variants.push_back(failed);
+            }
+            comparedTo.push_back(-1);
+            try {
+                variants.push_back(runModule(spillOpt, featureMapDir, warmup, iterations));
+            } catch (const std::exception& e) {
+                ResidencyRun failed;
+                failed.variant = "featuremap_spill";
+                failed.engine = "module";
+                failed.error = e.what();
+                variants.push_back(failed);
+            }
+            comparedTo.push_back(control);
+        }
+#endif
+
+        std::ostringstream json;
+        json.setf(std::ios::fixed); json.precision(3);
+        json << "{\"lowMemory\":true"
+             << ",\"backend\":\"" << opt.backend << "\""
+             << ",\"threads\":" << opt.threads
+             << ",\"feature_map_dir\":\"" << jsonEscape(featureMapDir) << "\""
+             << ",\"default\":";
+        writeRun(json, base, nullptr);
+        json << ",\"variants\":[";
+        for (size_t i = 0; i < variants.size(); ++i) {
+            if (i) json << ",";
+            writeRun(json, variants[i], comparedTo[i] >= 0 ? &variants[comparedTo[i]] : &base);
+        }
+        json << "]";
+#if !HAVE_MNN_EXPRESS
+        json << ",\"note\":\"EXTERNAL_FEATUREMAP_DIR is set through the Express RuntimeManager; ship libMNN_Express.so to measure feature-map spill\"";
+#endif
+        json << "}";
+        return json.str();
+    } catch (const std::exception& e) {
+        return std::string("{\"error\":\"") + jsonEscape(e.what()) + "\"}";
+    }
+}
+#else
+std::string runLowMemory(const std::string& configJson) {
+    (void)configJson;
+    return "{\"error\":\"MNN not bundled. Cannot run low-memory mode. Place headers and libMNN.so as documented.\"}";
+}
+#endif
+
+} // namespace runner
@@ -0,0 +1,286 @@
+// Minimal JSON reader for run configs passed from Kotlin/Dart.
+// Only what the runner needs: objects, arrays, strings, numbers, bools, null,
+// plus dump() to write modified configs and stored records back out.
+#pragma once
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+
+namespace json {
+
+struct Value {
+    enum Type { Null, Bool, Number, String, Array, Object };
+    Type type = Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string str;
+    // Array elements, or object values (paired with keys by index).
+    std::vector<Value> items;
+    std::vector<std::string> keys;
+
+    bool isNull() const { return type == Null; }
+    bool isObject() const { return type == Object; }
+    bool isArray() const { return type == Array; }
+    bool isNumber() const { return type == Number; }
+    bool isString() const { return type == String; }
+    size_t size() const { return items.size(); }
+    const Value& operator[](size_t i) const { return items[i]; }
+
+    const Value* get(const std::string& key) const {
+        if (type != Object) return nullptr;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            if (keys[i] == key) return &items[i];
+        }
+        return nullptr;
+    }
+    bool has(const std::string& key) const { return get(key) != nullptr; }
+    std::string getString(const std::string& key, const std::string& def = std::string()) const {
+        auto* v = get(key);
+        return (v && v->type == String) ? v->str : def;
+    }
+    double getNumber(const std::string& key, double def = 0.0) const {
+        auto* v = get(key);
+        return (v && v->type == Number) ? v->number : def;
+    }
+    int getInt(const std::string& key, int def = 0) const {
+        return (int)getNumber(key, (double)def);
+    }
+    bool getBool(const std::string& key, bool def = false) const {
+        auto* v = get(key);
+        return (v && v->type == Bool) ? v->boolean : def;
+    }
+    // Insert or replace an object member (turns a null value into an object).
+    void set(const std::string& key, Value v) {
+        if (type == Null) type = Object;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            if (keys[i] == key) { items[i] = std::move(v); return; }
+        }
+        keys.push_back(key);
+        items.push_back(std::move(v));
+    }
+    void erase(const std::string& key) {
+        for (size_t i = 0; i < keys.size(); ++i) {
+            if (keys[i] == key) {
+                keys.erase(keys.begin() + (long)i);
+                items.erase(items.begin() + (long)i);
+                return;
+            }
+        }
+    }
+
+    static Value makeNumber(double d) { Value v; v.type = Number; v.number = d; return v; }
+    static Value makeString(const std::string& s) { Value v; v.type = String; v.str = s; return v; }
+    static Value makeBool(bool b) { Value v; v.type = Bool; v.boolean = b; return v; }
+    static Value makeArray() { Value v; v.type = Array; return v; }
+    static Value makeObject() { Value v; v.type = Object; return v; }
+    static Value makeIntArray(const std::vector<int>& xs) {
+        Value v = makeArray();
+        for (int x : xs) v.items.push_back(makeNumber(x));
+        return v;
+    }
+
+    std::vector<int> getIntArray(const std::string& key) const {
+        std::vector<int> out;
+        auto* v = get(key);
+        if (!v || v->type != Array) return out;
+        for (auto& e : v->items) {
+            if (e.type == Number) out.push_back((int)e.number);
+        }
+        return out;
+    }
+};
+
+class Parser {
+public:
+    explicit Parser(const std::string& text) : s_(text) {}
+
+    Value parseDocument() {
+        Value v = parseValue();
+        skipWs();
+        if (pos_ != s_.size()) fail("trailing characters");
+        return v;
+    }
+
+private:
+    const std::string& s_;
+    size_t pos_ = 0;
+
+    [[noreturn]] void fail(const char* what) const {
+        throw std::runtime_error(std::string("JSON parse error at ") + std::to_string(pos_) + ": " + what);
+    }
+    void skipWs() {
+        while (pos_ < s_.size() && (s_[pos_] == ' ' || s_[pos_] == '\n' || s_[pos_] == '\r' || s_[pos_] == '\t')) ++pos_;
+    }
+    bool consume(char c) {
+        skipWs();
+        if (pos_ < s_.size() && s_[pos_] == c) { ++pos_; return true; }
+        return false;
+    }
+    void expect(char c) {
+        if (!consume(c)) fail("unexpected character");
+    }
+    bool matchWord(const char* w) {
+        size_t n = std::strlen(w);
+        if (s_.compare(pos_, n, w) == 0) { pos_ += n; return true; }
+        return false;
+    }
+
+    Value parseValue() {
+        skipWs();
+        if (pos_ >= s_.size()) fail("unexpected end");
+        char c = s_[pos_];
+        Value v;
+        if (c == '{') {
+            ++pos_;
+            v.type = Value::Object;
+            if (consume('}')) return v;
+            do {
+                skipWs();
+                if (pos_ >= s_.size() || s_[pos_] != '"') fail("expected key");
+                v.keys.push_back(parseString());
+                expect(':');
+                v.items.push_back(parseValue());
+            } while (consume(','));
+            expect('}');
+        } else if (c == '[') {
+            ++pos_;
+            v.type = Value::Array;
+            if (consume(']')) return v;
+            do {
+                v.items.push_back(parseValue());
+            } while (consume(','));
+            expect(']');
+        } else if (c == '"') {
+            v.type = Value::String;
+            v.str = parseString();
+        } else if (matchWord("true")) {
+            v.type = Value::Bool; v.boolean = true;
+        } else if (matchWord("false")) {
+            v.type = Value::Bool; v.boolean = false;
+        } else if (matchWord("null")) {
+            v.type = Value::Null;
+        } else {
+            const char* begin = s_.c_str() + pos_;
+            char* end = nullptr;
+            double d = std::strtod(begin, &end);
+            if (end == begin) fail("invalid value");
+            pos_ += (size_t)(end - begin);
+            v.type = Value::Number; v.number = d;
+        }
+        return v;
+    }
+
+    std::string parseString() {
+        std::string out;
+        ++pos_; // opening quote
+        while (pos_ < s_.size()) {
+            char c = s_[pos_++];
+            if (c == '"') return out;
+            if (c != '\\') { out.push_back(c); continue; }
+            if (pos_ >= s_.size()) break;
+            char e = s_[pos_++];
+            switch (e) {
+                case 'n': out.push_back('\n'); break;
+                case 't': out.push_back('\t'); break;
+                case 'r': out.push_back('\r'); break;
+                case 'b': out.push_back('\b'); break;
+                case 'f': out.push_back('\f'); break;
+                case 'u': {
+                    if (pos_ + 4 > s_.size()) fail("bad escape");
+                    unsigned cp = (unsigned)std::strtoul(s_.substr(pos_, 4).c_str(), nullptr, 16);
+                    pos_ += 4;
+                    // Encode BMP code point as UTF-8 (surrogate pairs are not expected in paths/names).
+                    if (cp < 0x80) {
+                        out.push_back((char)cp);
+                    } else if (cp < 0x800) {
+                        out.push_back((char)(0xC0 | (cp >> 6)));
+                        out.push_back((char)(0x80 | (cp & 0x3F)));
+                    } else {
+                        out.push_back((char)(0xE0 | (cp >> 12)));
+                        out.push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+                        out.push_back((char)(0x80 | (cp & 0x3F)));
+                    }
+                    break;
+                }
+                default: out.push_back(e); break;
+            }
+        }
+        fail("unterminated string");
+    }
+};
+
+inline Value parse(const std::string& text) {
+    return Parser(text).parseDocument();
+}
+
+inline void dumpString(std::string& out, const std::string& s) {
+    out.push_back('"');
+    for (char c : s) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if ((unsigned char)c < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", (unsigned)c);
+                    out += buf;
+                } else {
+                    out.push_back(c);
+                }
+        }
+    }
+    out.push_back('"');
+}
+
+inline void dumpTo(std::string& out, const Value& v) {
+    switch (v.type) {
+        case Value::Null: out += "null"; break;
+        case Value::Bool: out += v.boolean ? "true" : "false"; break;
+        case Value::Number: {
+            char buf[32];
+            if (std::isfinite(v.number) && v.number == std::floor(v.number) && std::fabs(v.number) < 1e15) {
+                std::snprintf(buf, sizeof(buf), "%lld", (long long)v.number);
+            } else if (std::isfinite(v.number)) {
+                std::snprintf(buf, sizeof(buf), "%.9g", v.number);
+            } else {
+                std::snprintf(buf, sizeof(buf), "null");
+            }
+            out += buf;
+            break;
+        }
+        case Value::String: dumpString(out, v.str); break;
+        case Value::Array:
+            out.push_back('[');
+            for (size_t i = 0; i < v.items.size(); ++i) {
+                if (i) out.push_back(',');
+                dumpTo(out, v.items[i]);
+            }
+            out.push_back(']');
+            break;
+        case Value::Object:
+            out.push_back('{');
+            for (size_t i = 0; i < v.items.size(); ++i) {
+                if (i) out.push_back(',');
+                dumpString(out, v.keys[i]);
+                out.push_back(':');
+                dumpTo(out, v.items[i]);
+            }
+            out.push_back('}');
+            break;
+    }
+}
+
+inline std::string dump(const Value& v) {
+    std::string out;
+    dumpTo(out, v);
+    return out;
+}
+
+} // namespace json
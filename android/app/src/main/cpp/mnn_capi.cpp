@@ -0,0 +1,275 @@
+#include "mnn_capi.h"
+#include "runner_common.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+using runner::RunOptions;
+using runner::msBetween;
+
+namespace {
+
+thread_local std::string lastError;
+
+int32_t fail(int32_t status, const std::string& message) {
+    lastError = message;
+    return status;
+}
+
+} // namespace
+
+#if HAVE_MNN
+struct mnnr_session {
+    RunOptions opt;
+    std::unique_ptr<MNN::Interpreter> net;
+    MNN::Session* session = nullptr;
+    // Session tensors and their NCHW host staging tensors, in getSession*All order.
+    std::vector<std::pair<std::string, MNN::Tensor*>> inputs, outputs;
+    std::vector<std::shared_ptr<MNN::Tensor>> inputHost, outputHost;
+
+    ~mnnr_session() {
+        if (net && session) net->releaseSession(session);
+    }
+};
+
+namespace {
+
+int32_t typeOf(const MNN::Tensor* t) {
+    const halide_type_t ty = t->getType();
+    if (ty.code == halide_type_float && ty.bits == 32) return MNNR_FLOAT32;
+    if (ty.code == halide_type_int && ty.bits == 32) return MNNR_INT32;
+    if (ty.code == halide_type_uint && ty.bits == 8) return MNNR_UINT8;
+    if (ty.code == halide_type_int && ty.bits == 8) return MNNR_INT8;
+    return MNNR_OTHER;
+}
+
+// Re-read the session tensors and allocate host staging for each; called after every resize.
+void bindTensors(mnnr_session* s) {
+    s->inputs.clear();
+    s->outputs.clear();
+    for (auto& kv : s->net->getSessionInputAll(s->session)) {
+        if (kv.second) s->inputs.emplace_back(kv.first, kv.second);
+    }
+    for (auto& kv : s->net->getSessionOutputAll(s->session)) {
+        if (kv.second) s->outputs.emplace_back(kv.first, kv.second);
+    }
+    // Keep input data across a resize of another input when the staging size did not change.
+    std::vector<std::shared_ptr<MNN::Tensor>> oldInputs;
+    oldInputs.swap(s->inputHost);
+    for (size_t i = 0; i < s->inputs.size(); ++i) {
+        std::shared_ptr<MNN::Tensor> host(new MNN::Tensor(s->inputs[i].second, MNN::Tensor::CAFFE));
+        if (i < oldInputs.size() && oldInputs[i]->size() == host->size()) {
+            std::memcpy(host->host<void>(), oldInputs[i]->host<void>(), host->size());
+        } else {
+            std::memset(host->host<void>(), 0, host->size());
+        }
+        s->inputHost.push_back(host);
+    }
+    s->outputHost.clear();
+    for (auto& o : s->outputs) {
+        s->outputHost.emplace_back(new MNN::Tensor(o.second, MNN::Tensor::CAFFE));
+    }
+}
+
+void runOnce(mnnr_session* s, mnnr_timing* timing) {
+    auto t0 = runner::clock::now();
+    for (size_t i = 0; i < s->inputs.size(); ++i) s->inputs[i].second->copyFromHostTensor(s->inputHost[i].get());
+    auto t1 = runner::clock::now();
+    const MNN::ErrorCode code = s->net->runSession(s->session);
+    auto t2 = runner::clock::now();
+    if (code != MNN::NO_ERROR) throw std::runtime_error("runSession failed with code " + std::to_string((int)code));
+    for (size_t i = 0; i < s->outputs.size(); ++i) s->outputs[i].second->copyToHostTensor(s->outputHost[i].get());
+    auto t3 = runner::clock::now();
+    if (timing) {
+        timing->upload_ms = msBetween(t0, t1);
+        timing->run_ms = msBetween(t1, t2);
+        timing->download_ms = msBetween(t2, t3);
+        timing->total_ms = msBetween(t0, t3);
+    }
+}
+
+} // namespace
+#else
+struct mnnr_session {};
+#endif
+
+extern "C" {
+
+int32_t mnnr_abi_version(void) {
+    return MNNR_ABI_VERSION;
+}
+
+const char* mnnr_last_error(void) {
+    return lastError.c_str();
+}
+
+mnnr_session* mnnr_open(const mnnr_config* config, mnnr_open_info* info) {
+#if HAVE_MNN
+    if (!config || !config->model_path || !*config->model_path) {
+        fail(MNNR_ERR_ARG, "Missing model_path");
+        return nullptr;
+    }
+    try {
+        std::unique_ptr<mnnr_session> s(new mnnr_session());
+        RunOptions& opt = s->opt;
+        opt.modelPath = config->model_path;
+        if (config->backend) opt.backend = config->backend;
+        if (config->backup_type) opt.backupType = config->backup_type;
+        if (config->precision) opt.precisionMode = config->precision;
+        if (config->memory) opt.memoryMode = config->memory;
+        if (config->power) opt.powerMode = config->power;
+        if (config->cache_file) opt.cacheFile = config->cache_file;
+        if (config->threads > 0) opt.threads = config->threads;
+        if (config->input_shape && config->input_rank > 0) {
+            opt.inputShape.assign(config->input_shape, config->input_shape + config->input_rank);
+        }
+
+        auto t0 = runner::clock::now();
+        s->net = runner::loadInterpreter(opt);
+        const double createInterpreterMs = msBetween(t0, runner::clock::now());
+        MNN::BackendConfig bcfg = runner::makeBackendConfig(opt);
+        MNN::ScheduleConfig cfg = runner::makeScheduleConfig(opt, &bcfg);
+        auto t1 = runner::clock::now();
+        s->session = s->net->createSession(cfg);
+        if (!s->session) throw std::runtime_error("Failed to create session");
+        const double createSessionMs = msBetween(t1, runner::clock::now());
+        auto t2 = runner::clock::now();
+        runner::resizeInputs(s->net.get(), s->session, opt);
+        const double resizeSessionMs = msBetween(t2, runner::clock::now());
+        bindTensors(s.get());
+        if (info) {
+            info->create_interpreter_ms = createInterpreterMs;
+            info->create_session_ms = createSessionMs;
+            info->resize_session_ms = resizeSessionMs;
+            info->inputs = (int32_t)s->inputs.size();
+            info->outputs = (int32_t)s->outputs.size();
+        }
+        lastError.clear();
+        return s.release();
+    } catch (const std::exception& ex) {
+        fail(MNNR_ERR_RUNTIME, ex.what());
+        return nullptr;
+    }
+#else
+    (void)config;
+    (void)info;
+    fail(MNNR_ERR_UNAVAILABLE, "MNN not bundled. Place headers and libMNN.so as documented.");
+    return nullptr;
+#endif
+}
+
+void mnnr_close(mnnr_session* session) {
+    delete session;
+}
+
+int32_t mnnr_input_count(const mnnr_session* session) {
+#if HAVE_MNN
+    return session ? (int32_t)session->inputs.size() : 0;
+#else
+    (void)session;
+    return 0;
+#endif
+}
+
+int32_t mnnr_output_count(const mnnr_session* session) {
+#if HAVE_MNN
+    return session ? (int32_t)session->outputs.size() : 0;
+#else
+    (void)session;
+    return 0;
+#endif
+}
+
+int32_t mnnr_describe(const mnnr_session* session, int32_t is_output, int32_t index, mnnr_tensor_desc* desc) {
+#if HAVE_MNN
+    if (!session || !desc) return fail(MNNR_ERR_ARG, "Null session or desc");
+    auto& list = is_output ? session->outputs : session->inputs;
+    auto& host = is_output ? session->outputHost : session->inputHost;
+    if (index < 0 || index >= (int32_t)list.size()) return fail(MNNR_ERR_ARG, "Tensor index out of range");
+    const MNN::Tensor* t = host[index].get();
+    std::memset(desc, 0, sizeof(*desc));
+    std::strncpy(desc->name, list[index].first.c_str(), MNNR_MAX_NAME - 1);
+    desc->type = typeOf(t);
+    desc->rank = std::min(t->dimensions(), MNNR_MAX_DIMS);
+    for (int i = 0; i < desc->rank; ++i) desc->dims[i] = t->length(i);
+    desc->elements = t->elementSize();
+    desc->bytes = t->size();
+    return MNNR_OK;
+#else
+    (void)session; (void)is_output; (void)index; (void)desc;
+    return fail(MNNR_ERR_UNAVAILABLE, "MNN not bundled");
+#endif
+}
+
+void* mnnr_buffer(mnnr_session* session, int32_t is_output, int32_t index) {
+#if HAVE_MNN
+    if (!session) return nullptr;
+    auto& host = is_output ? session->outputHost : session->inputHost;
+    if (index < 0 || index >= (int32_t)host.size()) {
+        fail(MNNR_ERR_ARG, "Tensor index out of range");
+        return nullptr;
+    }
+    return host[index]->host<void>();
+#else
+    (void)session; (void)is_output; (void)index;
+    return nullptr;
+#endif
+}
+
+int32_t mnnr_resize_input(mnnr_session* session, int32_t index, const int32_t* dims, int32_t rank) {
+#if HAVE_MNN
+    if (!session || !dims || rank <= 0) return fail(MNNR_ERR_ARG, "Null session or empty shape");
+    if (index < 0 || index >= (int32_t)session->inputs.size()) return fail(MNNR_ERR_ARG, "Input index out of range");
+    try {
+        session->net->resizeTensor(session->inputs[index].second, std::vector<int>(dims, dims + rank));
+        session->net->resizeSession(session->session);
+        bindTensors(session);
+        return MNNR_OK;
+    } catch (const std::exception& ex) {
+        return fail(MNNR_ERR_RUNTIME, ex.what());
+    }
+#else
+    (void)session; (void)index; (void)dims; (void)rank;
+    return fail(MNNR_ERR_UNAVAILABLE, "MNN not bundled");
+#endif
+}
+
+int32_t mnnr_run(mnnr_session* session, mnnr_timing* timing) {
+#if HAVE_MNN
+    if (!session) return fail(MNNR_ERR_ARG, "Null session");
+    try {
+        runOnce(session, timing);
+        return MNNR_OK;
+    } catch (const std::exception& ex) {
+        return fail(MNNR_ERR_RUNTIME, ex.what());
+    }
+#else
+    (void)session; (void)timing;
+    return fail(MNNR_ERR_UNAVAILABLE, "MNN not bundled");
+#endif
+}
+
+int32_t mnnr_bench(mnnr_session* session, int32_t warmup, int32_t iterations, double* samples_ms) {
+#if HAVE_MNN
+    if (!session || (iterations > 0 && !samples_ms)) return fail(MNNR_ERR_ARG, "Null session or samples");
+    try {
+        mnnr_timing timing{};
+        for (int32_t i = 0; i < warmup; ++i) runOnce(session, nullptr);
+        for (int32_t i = 0; i < iterations; ++i) {
+            runOnce(session, &timing);
+            samples_ms[i] = timing.total_ms;
+        }
+        return MNNR_OK;
+    } catch (const std::exception& ex) {
+        return fail(MNNR_ERR_RUNTIME, ex.what());
+    }
+#else
+    (void)session; (void)warmup; (void)iterations; (void)samples_ms;
+    return fail(MNNR_ERR_UNAVAILABLE, "MNN not bundled");
+#endif
+}
+
+} // extern "C"
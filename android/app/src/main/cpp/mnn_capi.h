@@ -0,0 +1,115 @@
+// C ABI over the native runner for dart:ffi (and any other C caller): a session handle owns a
+// prepared Interpreter + Session and host staging buffers for every input and output, so a run is
+// write input buffer -> mnnr_run -> read output buffer, with no JSON, JNI or thread hop in between.
+// Functions return MNNR_OK or a negative status; mnnr_last_error() gives the message of the last
+// failure on the calling thread. A handle may be used from one thread at a time.
+#ifndef MNN_RUNNER_CAPI_H
+#define MNN_RUNNER_CAPI_H
+
+#include <stdint.h>
+
+#if defined(_WIN32)
+#define MNNR_API __declspec(dllexport)
+#else
+#define MNNR_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MNNR_ABI_VERSION 1
+#define MNNR_MAX_DIMS 8
+#define MNNR_MAX_NAME 64
+
+enum {
+    MNNR_OK = 0,
+    MNNR_ERR_ARG = -1,         // bad handle, index or buffer size
+    MNNR_ERR_RUNTIME = -2,     // MNN refused (interpreter, session, resize or run)
+    MNNR_ERR_UNAVAILABLE = -3, // built without MNN
+};
+
+// Element type of a staging buffer.
+enum {
+    MNNR_FLOAT32 = 0,
+    MNNR_INT32 = 1,
+    MNNR_UINT8 = 2,
+    MNNR_INT8 = 3,
+    MNNR_OTHER = 4,
+};
+
+// Same meaning as the runModel JSON keys; NULL strings take the JSON defaults.
+typedef struct mnnr_config {
+    const char* model_path;
+    const char* backend;     // "CPU", "VULKAN", "OPENCL", ...
+    const char* backup_type;
+    const char* precision;   // "LOW", "NORMAL", "HIGH" or "AUTO"
+    const char* memory;      // "LOW", "BALANCED", "HIGH"
+    const char* power;       // "LOW", "NORMAL", "HIGH"
+    const char* cache_file;  // GPU kernel cache, optional
+    int32_t threads;         // <= 0 means 4
+    const int32_t* input_shape; // optional, applied to every input
+    int32_t input_rank;
+} mnnr_config;
+
+// Build times of mnnr_open.
+typedef struct mnnr_open_info {
+    double create_interpreter_ms;
+    double create_session_ms;
+    double resize_session_ms;
+    int32_t inputs;
+    int32_t outputs;
+} mnnr_open_info;
+
+typedef struct mnnr_tensor_desc {
+    char name[MNNR_MAX_NAME];
+    int32_t type;
+    int32_t rank;
+    int32_t dims[MNNR_MAX_DIMS];
+    int64_t elements;
+    int64_t bytes;
+} mnnr_tensor_desc;
+
+// Times of one mnnr_run: host -> session copy of every input, runSession, session -> host copy of
+// every output, and their sum.
+typedef struct mnnr_timing {
+    double upload_ms;
+    double run_ms;
+    double download_ms;
+    double total_ms;
+} mnnr_timing;
+
+typedef struct mnnr_session mnnr_session;
+
+MNNR_API int32_t mnnr_abi_version(void);
+// Message of the last failed call on this thread ("" when none).
+MNNR_API const char* mnnr_last_error(void);
+
+// NULL on failure. `info` may be NULL.
+MNNR_API mnnr_session* mnnr_open(const mnnr_config* config, mnnr_open_info* info);
+MNNR_API void mnnr_close(mnnr_session* session);
+
+MNNR_API int32_t mnnr_input_count(const mnnr_session* session);
+MNNR_API int32_t mnnr_output_count(const mnnr_session* session);
+MNNR_API int32_t mnnr_describe(const mnnr_session* session, int32_t is_output, int32_t index, mnnr_tensor_desc* desc);
+
+// Host staging buffer (NCHW, the tensor's own element type) of an input or output. Write inputs
+// here before mnnr_run and read outputs after it; the pointer stays valid until mnnr_resize_input
+// or mnnr_close.
+MNNR_API void* mnnr_buffer(mnnr_session* session, int32_t is_output, int32_t index);
+
+// Resize one input and the session; all staging buffers are reallocated.
+MNNR_API int32_t mnnr_resize_input(mnnr_session* session, int32_t index, const int32_t* dims, int32_t rank);
+
+// Upload the input buffers, run the session and download the outputs. `timing` may be NULL.
+MNNR_API int32_t mnnr_run(mnnr_session* session, mnnr_timing* timing);
+
+// `warmup` untimed then `iterations` timed mnnr_run calls inside native code; samples_ms receives the
+// total_ms of each timed run (capacity >= iterations).
+MNNR_API int32_t mnnr_bench(mnnr_session* session, int32_t warmup, int32_t iterations, double* samples_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MNN_RUNNER_CAPI_H
@@ -2,6 +2,7 @@
 #include <jni.h>
 #include <string>
 #include <vector>
+#include <algorithm>
 #include <sstream>
 #include <memory>
 #include <cstring>
@@ -9,42 +10,105 @@
 #include <chrono>
 #include <map>
 #include <iomanip>
+#include <mutex>
 
 #if HAVE_MNN
 #include "MNN/Interpreter.hpp"
 #include "MNN/Tensor.hpp"
 #endif
 
-static int mapForward(const std::string& s) {
+#include "runner_common.hpp"
+#include "modes.hpp"
+#include "telemetry.hpp"
+#include "backend_probe.hpp"
+#include "executor.hpp"
+
+using runner::mapForward;
+using runner::resolvePrecision;
 #if HAVE_MNN
-    if (s == "AUTO") return (int)MNN_FORWARD_AUTO;
-    if (s == "CPU") return (int)MNN_FORWARD_CPU;
-    if (s == "VULKAN") return (int)MNN_FORWARD_VULKAN;
-    if (s == "OPENCL") return (int)MNN_FORWARD_OPENCL;
-    if (s == "OPENGL" || s == "OPENGL_ES" || s == "OPENGL_ES3") return (int)MNN_FORWARD_OPENGL;
-    if (s == "METAL") return (int)MNN_FORWARD_METAL;
-    if (s == "CUDA") return (int)MNN_FORWARD_CUDA;
-    if (s == "NN" || s == "NNAPI") return (int)MNN_FORWARD_NN;
-    return (int)MNN_FORWARD_CPU;
-#else
-    (void)s; // unused
-    return 0;
+using runner::forwardName;
+#endif
+
+#if HAVE_MNN
+// Memory and power modes of the legacy run paths, same mapping as runner::makeBackendConfig.
+static void applyMemoryPower(JNIEnv* env, jstring memoryMode, jstring powerMode, MNN::BackendConfig& bcfg) {
+    runner::RunOptions opt;
+    const char* cMem = memoryMode ? env->GetStringUTFChars(memoryMode, nullptr) : nullptr;
+    if (cMem) { opt.memoryMode = cMem; env->ReleaseStringUTFChars(memoryMode, cMem); }
+    const char* cPow = powerMode ? env->GetStringUTFChars(powerMode, nullptr) : nullptr;
+    if (cPow) { opt.powerMode = cPow; env->ReleaseStringUTFChars(powerMode, cPow); }
+    const MNN::BackendConfig mapped = runner::makeBackendConfig(opt);
+    bcfg.memory = mapped.memory;
+    bcfg.power = mapped.power;
+}
 #endif
+
+// JSON-config entry points share one shape: decode the config string, run the mode, return its report.
+// Benchmark modes pass `recordAs` so the report is appended to the result store.
+static jstring runJsonMode(JNIEnv* env, jstring configJson, std::string (*mode)(const std::string&),
+                           const char* recordAs = nullptr) {
+    const char* cCfg = configJson ? env->GetStringUTFChars(configJson, nullptr) : nullptr;
+    std::string cfg = cCfg ? std::string(cCfg) : std::string();
+    if (cCfg) env->ReleaseStringUTFChars(configJson, cCfg);
+    std::string res = mode(cfg);
+    if (recordAs) runner::recordResult(recordAs, cfg, res);
+    return env->NewStringUTF(res.c_str());
 }
 
 #if HAVE_MNN
-static const char* forwardName(MNNForwardType t) {
-    switch (t) {
-        case MNN_FORWARD_CPU: return "CPU";
-        case MNN_FORWARD_AUTO: return "AUTO";
-        case MNN_FORWARD_METAL: return "METAL";
-        case MNN_FORWARD_CUDA: return "CUDA";
-        case MNN_FORWARD_OPENCL: return "OPENCL";
-        case MNN_FORWARD_OPENGL: return "OPENGL";
-        case MNN_FORWARD_VULKAN: return "VULKAN";
-        case MNN_FORWARD_NN: return "NN";
-        case MNN_FORWARD_ALL: return "ALL";
-        default: return "UNKNOWN";
+static std::string jniString(JNIEnv* env, jstring s) {
+    const char* c = s ? env->GetStringUTFChars(s, nullptr) : nullptr;
+    std::string out = c ? std::string(c) : std::string();
+    if (c) env->ReleaseStringUTFChars(s, c);
+    return out;
+}
+
+// The positional entry points predate JSON configs: rebuild one from their arguments, in the
+// JSON modes' key names, so their runs land in the result store next to the other modes.
+static json::Value positionalConfig(JNIEnv* env, jstring modelPath, jstring backend, jstring backupType,
+                                    jstring memoryMode, jstring precisionMode, jstring powerMode,
+                                    jstring inputFill, jint threads, jstring cacheFile) {
+    json::Value cfg = json::Value::makeObject();
+    cfg.set("modelPath", json::Value::makeString(jniString(env, modelPath)));
+    cfg.set("backend", json::Value::makeString(jniString(env, backend)));
+    cfg.set("backupType", json::Value::makeString(jniString(env, backupType)));
+    cfg.set("memoryMode", json::Value::makeString(jniString(env, memoryMode)));
+    cfg.set("precisionMode", json::Value::makeString(jniString(env, precisionMode)));
+    cfg.set("powerMode", json::Value::makeString(jniString(env, powerMode)));
+    cfg.set("inputFill", json::Value::makeString(jniString(env, inputFill)));
+    cfg.set("threads", json::Value::makeNumber(threads > 0 ? threads : 1));
+    cfg.set("cacheFile", json::Value::makeString(jniString(env, cacheFile)));
+    return cfg;
+}
+
+static json::Value namedShapes(JNIEnv* env, jobjectArray inputNames, jobjectArray inputShapes) {
+    json::Value shapes = json::Value::makeObject();
+    const jsize n = std::min(env->GetArrayLength(inputNames), env->GetArrayLength(inputShapes));
+    for (jsize i = 0; i < n; ++i) {
+        auto jname = (jstring)env->GetObjectArrayElement(inputNames, i);
+        auto jshape = (jintArray)env->GetObjectArrayElement(inputShapes, i);
+        std::vector<int> shape(jshape ? env->GetArrayLength(jshape) : 0);
+        if (!shape.empty()) env->GetIntArrayRegion(jshape, 0, (jsize)shape.size(), shape.data());
+        shapes.set(jniString(env, jname), json::Value::makeIntArray(shape));
+        env->DeleteLocalRef(jname);
+        env->DeleteLocalRef(jshape);
+    }
+    return shapes;
+}
+
+// These paths time a single runSession; it goes in as a one-sample "latency" series so
+// compareResults can pair it with other records of the same mode. Recording never fails the run.
+static void recordPositionalRun(const char* mode, const json::Value& config, const std::string& reportJson,
+                                double runMs) {
+    try {
+        json::Value report = json::parse(reportJson);
+        json::Value samples = json::Value::makeArray();
+        samples.items.push_back(json::Value::makeNumber(runMs));
+        json::Value latency = json::Value::makeObject();
+        latency.set("samples_ms", samples);
+        report.set("latency", latency);
+        runner::recordResult(mode, json::dump(config), json::dump(report));
+    } catch (const std::exception&) {
     }
 }
 #endif
@@ -74,8 +138,12 @@ Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_runModel(
 #if HAVE_MNN
     std::ostringstream out;
     try {
+        json::Value recordCfg = positionalConfig(env, modelPath, backend, backupType, memoryMode, precisionMode,
+                                                 powerMode, inputFill, threads, cacheFile);
+        recordCfg.set("inputShape", json::Value::makeIntArray(shape));
         std::unique_ptr<MNN::Interpreter> net(MNN::Interpreter::createFromFile(cModel));
         if (!net) throw std::runtime_error("Failed to create interpreter");
+        runner::applyActiveHints(net.get(), cModel);
 
         // Optional: set cache file for GPU backends (OpenCL/Vulkan)
         const char* cCache = cacheFile ? env->GetStringUTFChars(cacheFile, nullptr) : nullptr;
@@ -90,11 +158,12 @@ Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_runModel(
 
         MNN::BackendConfig bcfg;
         const char* cPrec = env->GetStringUTFChars(precisionMode, nullptr);
-        std::string prec = cPrec ? std::string(cPrec) : std::string("NORMAL");
+        std::string prec = resolvePrecision(cPrec ? std::string(cPrec) : std::string("NORMAL"), cBackend);
         if (prec == "LOW") bcfg.precision = MNN::BackendConfig::Precision_Low;
         else if (prec == "HIGH") bcfg.precision = MNN::BackendConfig::Precision_High;
         else bcfg.precision = MNN::BackendConfig::Precision_Normal;
         env->ReleaseStringUTFChars(precisionMode, cPrec);
+        applyMemoryPower(env, memoryMode, powerMode, bcfg);
 
         cfg.backendConfig = &bcfg;
 
@@ -142,7 +211,9 @@ Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_runModel(
             in->copyFromHostTensor(host.get());
         }
 
+        const auto runStart = std::chrono::steady_clock::now();
         net->runSession(session);
+        const double runMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - runStart).count();
 
         auto outputs = net->getSessionOutputAll(session);
         bool first = true;
@@ -160,6 +231,12 @@ Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_runModel(
 
         net->releaseSession(session);
 
+        json::Value recordReport = json::Value::makeObject();
+        recordReport.set("backend", json::Value::makeString(forwardName((MNNForwardType)mapForward(cBackend))));
+        recordReport.set("outputs", json::Value::makeString(out.str()));
+        recordReport.set("runSession_ms", json::Value::makeNumber(runMs));
+        recordPositionalRun("runModel", recordCfg, json::dump(recordReport), runMs);
+
         std::ostringstream msg;
         msg << "MNN 3.1.0 OK backend=" << cBackend << " outputs=" << out.str();
 
@@ -220,7 +297,9 @@ Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_runModelProfile(
         jstring powerMode,
         jstring inputFill,
         jint threads,
-        jstring cacheFile) {
+        jstring cacheFile,
+        jstring stagingLayout,
+        jstring postprocess) {
     const char* cModel = env->GetStringUTFChars(modelPath, nullptr);
     const char* cBackend = env->GetStringUTFChars(backend, nullptr);
     const char* cBackup = env->GetStringUTFChars(backupType, nullptr);
@@ -234,8 +313,14 @@ Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_runModelProfile(
     auto t0 = clock::now();
     std::ostringstream report;
     try {
+        json::Value recordCfg = positionalConfig(env, modelPath, backend, backupType, memoryMode, precisionMode,
+                                                 powerMode, inputFill, threads, cacheFile);
+        recordCfg.set("inputShape", json::Value::makeIntArray(shape));
+        recordCfg.set("stagingLayout", json::Value::makeString(jniString(env, stagingLayout)));
+        recordCfg.set("postprocess", json::Value::makeString(jniString(env, postprocess)));
         std::unique_ptr<MNN::Interpreter> net(MNN::Interpreter::createFromFile(cModel));
         if (!net) throw std::runtime_error("Failed to create interpreter");
+        runner::applyActiveHints(net.get(), cModel);
         auto t1 = clock::now();
 
         // Optional cache file
@@ -251,11 +336,12 @@ Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_runModelProfile(
 
         MNN::BackendConfig bcfg;
         const char* cPrec = env->GetStringUTFChars(precisionMode, nullptr);
-        std::string prec = cPrec ? std::string(cPrec) : std::string("NORMAL");
+        std::string prec = resolvePrecision(cPrec ? std::string(cPrec) : std::string("NORMAL"), cBackend);
         if (prec == "LOW") bcfg.precision = MNN::BackendConfig::Precision_Low;
         else if (prec == "HIGH") bcfg.precision = MNN::BackendConfig::Precision_High;
         else bcfg.precision = MNN::BackendConfig::Precision_Normal;
         env->ReleaseStringUTFChars(precisionMode, cPrec);
+        applyMemoryPower(env, memoryMode, powerMode, bcfg);
         cfg.backendConfig = &bcfg;
 
         auto t2_before = clock::now();
@@ -280,30 +366,12 @@ Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_runModelProfile(
         if (cFill) fill = std::string(cFill);
         env->ReleaseStringUTFChars(inputFill, cFill);
 
-        std::mt19937 rng(42);
-        std::uniform_real_distribution<float> uni(0.0f, 1.0f);
-        std::normal_distribution<float> norm(0.0f, 1.0f);
+        std::string layout = "NCHW";
+        const char* cLayout = stagingLayout ? env->GetStringUTFChars(stagingLayout, nullptr) : nullptr;
+        if (cLayout && std::strlen(cLayout) > 0) layout = std::string(cLayout);
+        if (cLayout) env->ReleaseStringUTFChars(stagingLayout, cLayout);
 
-        for (auto& kv : inputs) {
-            auto* in = kv.second;
-            if (!in) continue;
-            auto host = std::make_shared<MNN::Tensor>(in, in->getDimensionType());
-            auto bytes = host->size();
-            auto code = host->getType().code;
-            if (fill == "ONE" && code == halide_type_float) {
-                float* ptr = host->host<float>();
-                for (int i = 0; i < host->elementSize(); ++i) ptr[i] = 1.0f;
-            } else if (fill == "UNIFORM" && code == halide_type_float) {
-                float* ptr = host->host<float>();
-                for (int i = 0; i < host->elementSize(); ++i) ptr[i] = uni(rng);
-            } else if (fill == "NORMAL" && code == halide_type_float) {
-                float* ptr = host->host<float>();
-                for (int i = 0; i < host->elementSize(); ++i) ptr[i] = norm(rng);
-            } else {
-                std::memset(host->host<void>(), 0, bytes);
-            }
-            in->copyFromHostTensor(host.get());
-        }
+        auto uploads = runner::stageInputs(net.get(), session, fill, layout);
 
         // Collect session info helpers
         auto dur_ms = [](clock::time_point a, clock::time_point b) {
@@ -373,6 +441,17 @@ Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_runModelProfile(
         // High-level run only (no per-op callbacks)
         net->runSession(session);
         auto t4 = clock::now();
+        auto downloads = runner::downloadOutputs(net.get(), session, layout);
+        std::vector<runner::PostprocessStage> post;
+        const char* cPost = postprocess ? env->GetStringUTFChars(postprocess, nullptr) : nullptr;
+        const std::string postJson = cPost ? std::string(cPost) : std::string();
+        if (cPost) env->ReleaseStringUTFChars(postprocess, cPost);
+        if (!postJson.empty()) {
+            json::Value postList = json::parse(postJson);
+            post = runner::parsePostprocess(&postList);
+            auto hosts = runner::postprocessInputs(net.get(), session, post);
+            runner::runPostprocess(post, hosts);
+        }
 
         auto outputs = net->getSessionOutputAll(session);
         std::ostringstream outShapes;
@@ -402,7 +481,21 @@ Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_runModelProfile(
              << "\"createInterpreter_ms\":" << dur_ms(t0, t1) << ","
              << "\"createSession_ms\":" << dur_ms(t2_before, t2) << ","
              << "\"resizeSession_ms\":" << dur_ms(t3_before, t3) << ","
-             << "\"runSession_ms\":" << dur_ms(runStartAnchor, t4) << "},";
+             << "\"runSession_ms\":" << dur_ms(runStartAnchor, t4) << ","
+             << "\"upload_ms\":" << runner::totalTransferMs(uploads) << ","
+             << "\"download_ms\":" << runner::totalTransferMs(downloads) << ","
+             << "\"postprocess_ms\":" << runner::totalPostprocessMs(post) << ","
+             << "\"end_to_end_ms\":" << runner::totalTransferMs(uploads) + dur_ms(runStartAnchor, t4) +
+                    runner::totalTransferMs(downloads) + runner::totalPostprocessMs(post) << "},";
+        json << "\"stagingLayout\":\"" << layout << "\",";
+        json << "\"transfers\":";
+        runner::writeTransfers(json, uploads, downloads);
+        json << ",";
+        if (!post.empty()) {
+            json << "\"postprocess\":";
+            runner::writePostprocess(json, post);
+            json << ",";
+        }
         // outputs shapes
         json << "\"outputs\":[";
         {
@@ -434,6 +527,7 @@ Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_runModelProfile(
                  << "}";
         }
         json << "]}";
+        recordPositionalRun("runModelProfile", recordCfg, json.str(), dur_ms(runStartAnchor, t4));
 
         net->releaseSession(session);
 
@@ -482,6 +576,12 @@ Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_getModelInfo(
         jobject /* this */,
         jstring modelPath) {
     const char* cModel = env->GetStringUTFChars(modelPath, nullptr);
+    // Read inputs straight from the flatbuffer; only fall back to a CPU session when that fails.
+    const std::string inspected = runner::inspectModel(cModel);
+    if (inspected.compare(0, 9, "{\"error\":") != 0) {
+        env->ReleaseStringUTFChars(modelPath, cModel);
+        return env->NewStringUTF(inspected.c_str());
+    }
 #if HAVE_MNN
     try {
         std::unique_ptr<MNN::Interpreter> net(MNN::Interpreter::createFromFile(cModel));
@@ -553,8 +653,12 @@ Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_runModelMulti(
 
 #if HAVE_MNN
     try {
+        json::Value recordCfg = positionalConfig(env, modelPath, backend, backupType, memoryMode, precisionMode,
+                                                 powerMode, inputFill, threads, cacheFile);
+        recordCfg.set("inputShapes", namedShapes(env, inputNames, inputShapes));
         std::unique_ptr<MNN::Interpreter> net(MNN::Interpreter::createFromFile(cModel));
         if (!net) throw std::runtime_error("Failed to create interpreter");
+        runner::applyActiveHints(net.get(), cModel);
 
         // Optional cache file
         const char* cCache = cacheFile ? env->GetStringUTFChars(cacheFile, nullptr) : nullptr;
@@ -569,11 +673,12 @@ Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_runModelMulti(
 
         MNN::BackendConfig bcfg;
         const char* cPrec = env->GetStringUTFChars(precisionMode, nullptr);
-        std::string prec = cPrec ? std::string(cPrec) : std::string("NORMAL");
+        std::string prec = resolvePrecision(cPrec ? std::string(cPrec) : std::string("NORMAL"), cBackend);
         if (prec == "LOW") bcfg.precision = MNN::BackendConfig::Precision_Low;
         else if (prec == "HIGH") bcfg.precision = MNN::BackendConfig::Precision_High;
         else bcfg.precision = MNN::BackendConfig::Precision_Normal;
         env->ReleaseStringUTFChars(precisionMode, cPrec);
+        applyMemoryPower(env, memoryMode, powerMode, bcfg);
         cfg.backendConfig = &bcfg;
 
         auto session = net->createSession(cfg);
@@ -635,7 +740,9 @@ Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_runModelMulti(
             in->copyFromHostTensor(host.get());
         }
 
+        const auto runStart = std::chrono::steady_clock::now();
         net->runSession(session);
+        const double runMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - runStart).count();
 
         auto outputs = net->getSessionOutputAll(session);
         std::ostringstream out;
@@ -655,6 +762,12 @@ Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_runModelMulti(
 
         net->releaseSession(session);
 
+        json::Value recordReport = json::Value::makeObject();
+        recordReport.set("backend", json::Value::makeString(forwardName((MNNForwardType)mapForward(cBackend))));
+        recordReport.set("outputs", json::Value::makeString(out.str()));
+        recordReport.set("runSession_ms", json::Value::makeNumber(runMs));
+        recordPositionalRun("runModelMulti", recordCfg, json::dump(recordReport), runMs);
+
         std::ostringstream msg;
         msg << "MNN 3.1.0 OK backend=" << cBackend << " outputs=" << out.str();
 
@@ -714,7 +827,9 @@ Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_runModelMultiProfile(
         jstring powerMode,
         jstring inputFill,
         jint threads,
-        jstring cacheFile) {
+        jstring cacheFile,
+        jstring stagingLayout,
+        jstring postprocess) {
     const char* cModel = env->GetStringUTFChars(modelPath, nullptr);
     const char* cBackend = env->GetStringUTFChars(backend, nullptr);
     const char* cBackup = env->GetStringUTFChars(backupType, nullptr);
@@ -724,8 +839,14 @@ Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_runModelMultiProfile(
     auto t0 = clock::now();
     std::ostringstream report;
     try {
+        json::Value recordCfg = positionalConfig(env, modelPath, backend, backupType, memoryMode, precisionMode,
+                                                 powerMode, inputFill, threads, cacheFile);
+        recordCfg.set("inputShapes", namedShapes(env, inputNames, inputShapes));
+        recordCfg.set("stagingLayout", json::Value::makeString(jniString(env, stagingLayout)));
+        recordCfg.set("postprocess", json::Value::makeString(jniString(env, postprocess)));
         std::unique_ptr<MNN::Interpreter> net(MNN::Interpreter::createFromFile(cModel));
         if (!net) throw std::runtime_error("Failed to create interpreter");
+        runner::applyActiveHints(net.get(), cModel);
         auto t1 = clock::now();
 
         // Optional cache file
@@ -741,11 +862,12 @@ Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_runModelMultiProfile(
 
         MNN::BackendConfig bcfg;
         const char* cPrec = env->GetStringUTFChars(precisionMode, nullptr);
-        std::string prec = cPrec ? std::string(cPrec) : std::string("NORMAL");
+        std::string prec = resolvePrecision(cPrec ? std::string(cPrec) : std::string("NORMAL"), cBackend);
         if (prec == "LOW") bcfg.precision = MNN::BackendConfig::Precision_Low;
         else if (prec == "HIGH") bcfg.precision = MNN::BackendConfig::Precision_High;
         else bcfg.precision = MNN::BackendConfig::Precision_Normal;
         env->ReleaseStringUTFChars(precisionMode, cPrec);
+        applyMemoryPower(env, memoryMode, powerMode, bcfg);
         cfg.backendConfig = &bcfg;
 
         auto t2_before = clock::now();
@@ -781,31 +903,12 @@ Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_runModelMultiProfile(
         const char* cFill = env->GetStringUTFChars(inputFill, nullptr);
         if (cFill) fill = std::string(cFill);
         env->ReleaseStringUTFChars(inputFill, cFill);
-        std::mt19937 rng(42);
-        std::uniform_real_distribution<float> uni(0.0f, 1.0f);
-        std::normal_distribution<float> norm(0.0f, 1.0f);
+        std::string layout = "NCHW";
+        const char* cLayout = stagingLayout ? env->GetStringUTFChars(stagingLayout, nullptr) : nullptr;
+        if (cLayout && std::strlen(cLayout) > 0) layout = std::string(cLayout);
+        if (cLayout) env->ReleaseStringUTFChars(stagingLayout, cLayout);
 
-        auto inputsAll = net->getSessionInputAll(session);
-        for (auto& kv : inputsAll) {
-            auto* in = kv.second;
-            if (!in) continue;
-            auto host = std::make_shared<MNN::Tensor>(in, in->getDimensionType());
-            auto bytes = host->size();
-            auto code = host->getType().code;
-            if (fill == "ONE" && code == halide_type_float) {
-                float* ptr = host->host<float>();
-                for (int i = 0; i < host->elementSize(); ++i) ptr[i] = 1.0f;
-            } else if (fill == "UNIFORM" && code == halide_type_float) {
-                float* ptr = host->host<float>();
-                for (int i = 0; i < host->elementSize(); ++i) ptr[i] = uni(rng);
-            } else if (fill == "NORMAL" && code == halide_type_float) {
-                float* ptr = host->host<float>();
-                for (int i = 0; i < host->elementSize(); ++i) ptr[i] = norm(rng);
-            } else {
-                std::memset(host->host<void>(), 0, bytes);
-            }
-            in->copyFromHostTensor(host.get());
-        }
+        auto uploads = runner::stageInputs(net.get(), session, fill, layout);
 
         using clock = std::chrono::steady_clock;
         auto dur_ms = [](clock::time_point a, clock::time_point b) {
@@ -871,6 +974,17 @@ Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_runModelMultiProfile(
         // High-level run only (no per-op callbacks)
         net->runSession(session);
         auto t4 = clock::now();
+        auto downloads = runner::downloadOutputs(net.get(), session, layout);
+        std::vector<runner::PostprocessStage> post;
+        const char* cPost = postprocess ? env->GetStringUTFChars(postprocess, nullptr) : nullptr;
+        const std::string postJson = cPost ? std::string(cPost) : std::string();
+        if (cPost) env->ReleaseStringUTFChars(postprocess, cPost);
+        if (!postJson.empty()) {
+            json::Value postList = json::parse(postJson);
+            post = runner::parsePostprocess(&postList);
+            auto hosts = runner::postprocessInputs(net.get(), session, post);
+            runner::runPostprocess(post, hosts);
+        }
 
         auto outputs = net->getSessionOutputAll(session);
         std::ostringstream outShapes;
@@ -900,7 +1014,21 @@ Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_runModelMultiProfile(
              << "\"createInterpreter_ms\":" << dur_ms(t0, t1) << ","
              << "\"createSession_ms\":" << dur_ms(t2_before, t2) << ","
              << "\"resizeSession_ms\":" << dur_ms(t3_before, t3) << ","
-             << "\"runSession_ms\":" << dur_ms(runStartAnchor, t4) << "},";
+             << "\"runSession_ms\":" << dur_ms(runStartAnchor, t4) << ","
+             << "\"upload_ms\":" << runner::totalTransferMs(uploads) << ","
+             << "\"download_ms\":" << runner::totalTransferMs(downloads) << ","
+             << "\"postprocess_ms\":" << runner::totalPostprocessMs(post) << ","
+             << "\"end_to_end_ms\":" << runner::totalTransferMs(uploads) + dur_ms(runStartAnchor, t4) +
+                    runner::totalTransferMs(downloads) + runner::totalPostprocessMs(post) << "},";
+        json << "\"stagingLayout\":\"" << layout << "\",";
+        json << "\"transfers\":";
+        runner::writeTransfers(json, uploads, downloads);
+        json << ",";
+        if (!post.empty()) {
+            json << "\"postprocess\":";
+            runner::writePostprocess(json, post);
+            json << ",";
+        }
         json << "\"outputs\":[";
         {
             bool f = true;
@@ -930,6 +1058,7 @@ Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_runModelMultiProfile(
                  << "}";
         }
         json << "]}";
+        recordPositionalRun("runModelMultiProfile", recordCfg, json.str(), dur_ms(runStartAnchor, t4));
 
         net->releaseSession(session);
 
@@ -970,3 +1099,317 @@ Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_runModelMultiProfile(
     return env->NewStringUTF(msg.str().c_str());
 #endif
 }
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_runCompare(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring configJson) {
+    return runJsonMode(env, configJson, runner::runCompare, "runCompare");
+}
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_runDynamicQuant(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring configJson) {
+    return runJsonMode(env, configJson, runner::runDynamicQuant, "runDynamicQuant");
+}
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_runTuneProfile(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring configJson) {
+    return runJsonMode(env, configJson, runner::runTuneProfile, "tuneProfile");
+}
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_applyTuningProfile(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring configJson) {
+    return runJsonMode(env, configJson, runner::applyTuningProfile);
+}
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_runDecode(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring configJson) {
+    return runJsonMode(env, configJson, runner::runDecode, "runDecode");
+}
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_runModuleEngine(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring configJson) {
+    return runJsonMode(env, configJson, runner::runModuleEngine, "runModuleEngine");
+}
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_runExternalWeights(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring configJson) {
+    return runJsonMode(env, configJson, runner::runExternalWeights, "runExternalWeights");
+}
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_runLowMemory(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring configJson) {
+    return runJsonMode(env, configJson, runner::runLowMemory, "runLowMemory");
+}
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_runSuite(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring configJson) {
+    return runJsonMode(env, configJson, runner::runSuite, "runSuite");
+}
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_runOpenLoop(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring configJson) {
+    return runJsonMode(env, configJson, runner::runOpenLoop, "runOpenLoop");
+}
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_runEnergy(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring configJson) {
+    return runJsonMode(env, configJson, runner::runEnergy, "runEnergy");
+}
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_runMultiPath(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring configJson) {
+    return runJsonMode(env, configJson, runner::runMultiPath, "runMultiPath");
+}
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_runPipeline(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring configJson) {
+    return runJsonMode(env, configJson, runner::runPipeline, "runPipeline");
+}
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_runAdaptive(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring configJson) {
+    return runJsonMode(env, configJson, runner::runAdaptive, "runAdaptive");
+}
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_runStream(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring configJson) {
+    return runJsonMode(env, configJson, runner::runStream, "runStream");
+}
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_runOpBench(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring configJson) {
+    return runJsonMode(env, configJson, runner::runOpBench, "runOpBench");
+}
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_buildCostTable(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring configJson) {
+    return runJsonMode(env, configJson, runner::buildCostTable, "buildCostTable");
+}
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_predictLatency(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring configJson) {
+    return runJsonMode(env, configJson, runner::predictLatency, "predictLatency");
+}
+
+static JavaVM* gVm = nullptr;
+
+// Executor workers call back into Kotlin, so each stays attached to the VM for its lifetime.
+static void installExecutorHooks(JNIEnv* env) {
+    static std::once_flag once;
+    std::call_once(once, [env] {
+        env->GetJavaVM(&gVm);
+        runner::setExecutorThreadHooks(
+            [] {
+                JavaVMAttachArgs args{JNI_VERSION_1_6, "mnn-executor", nullptr};
+                JNIEnv* workerEnv = nullptr;
+                gVm->AttachCurrentThread(&workerEnv, &args);
+            },
+            [] { gVm->DetachCurrentThread(); });
+    });
+}
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_executorSubmit(
+        JNIEnv* env,
+        jobject /* this */,
+        jint priority,
+        jstring modelKey,
+        jobject task) {
+    installExecutorHooks(env);
+    const char* cKey = modelKey ? env->GetStringUTFChars(modelKey, nullptr) : nullptr;
+    std::string key = cKey ? std::string(cKey) : std::string();
+    if (cKey) env->ReleaseStringUTFChars(modelKey, cKey);
+    jobject ref = env->NewGlobalRef(task);
+    const runner::Priority p = priority == 1 ? runner::Priority::Background : runner::Priority::Interactive;
+    return (jlong)runner::submitJob(p, key, [ref] {
+        JNIEnv* workerEnv = nullptr;
+        if (gVm->GetEnv((void**)&workerEnv, JNI_VERSION_1_6) != JNI_OK) return;
+        jclass cls = workerEnv->GetObjectClass(ref);
+        jmethodID run = workerEnv->GetMethodID(cls, "run", "()V");
+        workerEnv->CallVoidMethod(ref, run);
+        if (workerEnv->ExceptionCheck()) {
+            workerEnv->ExceptionDescribe();
+            workerEnv->ExceptionClear();
+        }
+        workerEnv->DeleteLocalRef(cls);
+        workerEnv->DeleteGlobalRef(ref);
+    });
+}
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_executorAnnotate(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring report) {
+    const char* cReport = report ? env->GetStringUTFChars(report, nullptr) : nullptr;
+    std::string res = runner::annotateWithJob(cReport ? std::string(cReport) : std::string());
+    if (cReport) env->ReleaseStringUTFChars(report, cReport);
+    return env->NewStringUTF(res.c_str());
+}
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_executorStats(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring configJson) {
+    return runJsonMode(env, configJson, runner::executorStats);
+}
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_probeBackendsNative(
+        JNIEnv* env,
+        jobject /* this */) {
+    return env->NewStringUTF(runner::probeBackendsJson().c_str());
+}
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_poolRun(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring configJson) {
+    return runJsonMode(env, configJson, runner::poolRun, "poolRun");
+}
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_prewarmPool(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring configJson) {
+    return runJsonMode(env, configJson, runner::prewarmPool);
+}
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_poolStats(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring configJson) {
+    return runJsonMode(env, configJson, runner::poolStats);
+}
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_trimPool(
+        JNIEnv* env,
+        jobject /* this */,
+        jint level) {
+    return env->NewStringUTF(runner::trimPool((int)level).c_str());
+}
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_listResults(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring configJson) {
+    return runJsonMode(env, configJson, runner::listResults);
+}
+
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_compareResults(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring configJson) {
+    return runJsonMode(env, configJson, runner::compareResults);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_setResultStoreDir(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring dir) {
+    const char* cDir = env->GetStringUTFChars(dir, nullptr);
+    runner::setResultStoreDir(cDir ? std::string(cDir) : std::string());
+    env->ReleaseStringUTFChars(dir, cDir);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_setTuningProfileDir(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring dir) {
+    const char* cDir = env->GetStringUTFChars(dir, nullptr);
+    runner::setTuningProfileDir(cDir ? std::string(cDir) : std::string());
+    env->ReleaseStringUTFChars(dir, cDir);
+}
+
+extern "C" JNIEXPORT jobject JNICALL
+Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_openTelemetry(
+        JNIEnv* env,
+        jobject /* this */,
+        jint capacity,
+        jint opCapacity) {
+    runner::TelemetryRing* ring = runner::openTelemetry(capacity > 0 ? (uint32_t)capacity : 0u,
+                                                         opCapacity > 0 ? (uint32_t)opCapacity : 0u);
+    if (!ring) return nullptr;
+    return env->NewDirectByteBuffer(ring->base, (jlong)ring->bytes);
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_mirrorTelemetry(
+        JNIEnv* env,
+        jobject /* this */,
+        jlong from,
+        jobject dst) {
+    auto* addr = dst ? static_cast<uint8_t*>(env->GetDirectBufferAddress(dst)) : nullptr;
+    const jlong bytes = dst ? env->GetDirectBufferCapacity(dst) : -1;
+    if (!addr || bytes < 0) return JNI_FALSE;
+    return runner::mirrorTelemetry((uint64_t)from, addr, (size_t)bytes) ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_mnn_runner_mnn_1runner_1app_NativeBridge_closeTelemetry(
+        JNIEnv* /* env */,
+        jobject /* this */) {
+    runner::closeTelemetry();
+}
@@ -0,0 +1,450 @@
+// Session-free model inspector: walks the .mnn flatbuffer directly (mmap'd, no
+// Interpreter, no schema headers) and summarizes inputs, outputs, ops and weights.
+// Field slots follow MNN.fbs / CaffeOp.fbs / Tensor.fbs of MNN 2.x-3.x.
+#include "modes.hpp"
+#include "runner_common.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace runner {
+namespace {
+
+// Bounds-checked view of one flatbuffer table. Any out-of-range offset throws, so a
+// file that is not an MNN flatbuffer fails cleanly instead of reading garbage.
+class FbTable {
+public:
+    FbTable(const uint8_t* buf, size_t size, size_t pos) : buf_(buf), size_(size), pos_(pos) {
+        const int64_t vt = (int64_t)pos_ - read<int32_t>(pos_);
+        if (vt < 0) throw std::runtime_error("bad vtable");
+        vtable_ = (size_t)vt;
+        vtableSize_ = read<uint16_t>(vtable_);
+        if (vtableSize_ < 4 || vtable_ + vtableSize_ > size_) throw std::runtime_error("bad vtable");
+    }
+
+    template <typename T>
+    T scalar(int field, T def) const {
+        const size_t off = fieldOffset(field);
+        return off ? read<T>(pos_ + off) : def;
+    }
+    bool hasTable(int field) const { return fieldOffset(field) != 0; }
+    FbTable table(int field) const {
+        const size_t at = pos_ + fieldOffset(field);
+        return FbTable(buf_, size_, at + read<uint32_t>(at));
+    }
+    // Element count and position of the first element, or {0, 0} when the field is absent.
+    std::pair<uint32_t, size_t> vector(int field) const {
+        const size_t off = fieldOffset(field);
+        if (!off) return {0, 0};
+        const size_t at = pos_ + off;
+        const size_t vec = at + read<uint32_t>(at);
+        const uint32_t n = read<uint32_t>(vec);
+        if (vec + 4 + (size_t)n > size_) throw std::runtime_error("vector out of range");
+        return {n, vec + 4};
+    }
+    std::string string(int field) const {
+        auto v = vector(field);
+        if (!v.second) return std::string();
+        return std::string(reinterpret_cast<const char*>(buf_ + v.second), v.first);
+    }
+    // i-th element of a vector of tables or strings.
+    size_t indirect(size_t elem, uint32_t i) const {
+        const size_t at = elem + 4 * (size_t)i;
+        return at + read<uint32_t>(at);
+    }
+    FbTable tableAt(size_t pos) const { return FbTable(buf_, size_, pos); }
+    std::string stringAt(size_t pos) const {
+        const uint32_t n = read<uint32_t>(pos);
+        if (pos + 4 + (size_t)n > size_) throw std::runtime_error("string out of range");
+        return std::string(reinterpret_cast<const char*>(buf_ + pos + 4), n);
+    }
+
+    template <typename T>
+    T read(size_t at) const {
+        if (at + sizeof(T) > size_) throw std::runtime_error("offset out of range");
+        T v;
+        std::memcpy(&v, buf_ + at, sizeof(T));
+        return v;
+    }
+
+private:
+    size_t fieldOffset(int field) const {
+        const size_t slot = 4 + 2 * (size_t)field;
+        return slot + 2 <= vtableSize_ ? read<uint16_t>(vtable_ + slot) : 0;
+    }
+
+    const uint8_t* buf_;
+    size_t size_;
+    size_t pos_;
+    size_t vtable_ = 0;
+    uint16_t vtableSize_ = 0;
+};
+
+// The root uoffset at byte 0 points at the Net table (MNN files carry no file identifier).
+size_t rootTable(const uint8_t* buf, size_t size) {
+    uint32_t root;
+    std::memcpy(&root, buf, sizeof(root));
+    if (root < 4 || (size_t)root + 4 > size) throw std::runtime_error("not an MNN flatbuffer");
+    return root;
+}
+
+// Field slots (union members take two: type, then value).
+namespace NetField { enum { bizCode = 0, extraTensorDescribe = 1, extraInfo = 2, oplists = 3, outputName = 4,
+                            preferForwardType = 5, sourceType = 6, tensorName = 7, tensorNumber = 8, usage = 9,
+                            subgraphs = 10 }; }
+namespace OpField { enum { inputIndexes = 0, mainType = 1, main = 2, name = 3, outputIndexes = 4, type = 5 }; }
+namespace InputField { enum { dims = 0, dtype = 1, dformat = 2 }; }
+namespace BlobField { enum { dims = 0, dataFormat = 1, dataType = 2, uint8s = 3, int8s = 4, int32s = 5, int64s = 6,
+                             float32s = 7, strings = 8, external = 9 }; }
+namespace ConvField { enum { common = 0, weight = 1, bias = 2, quanParameter = 3, symmetricQuan = 4,
+                             sparseParameter = 5, external = 6 }; }
+namespace ConvCommonField { enum { kernelX = 2, kernelY = 3, group = 9, outputCount = 10, inputCount = 11 }; }
+namespace QuanField { enum { buffer = 0, alpha = 1, type = 2 }; }
+namespace ExtraInfoField { enum { buffer = 0, name = 1, version = 2 }; }
+
+// OpType values the histogram names; anything else is reported as "OpType_<n>".
+const char* opTypeName(int t) {
+    switch (t) {
+        case 7: return "BinaryOp";
+        case 9: return "Cast";
+        case 10: return "Concat";
+        case 11: return "Const";
+        case 12: return "Convolution";
+        case 13: return "ConvolutionDepthwise";
+        case 14: return "Crop";
+        case 17: return "Deconvolution";
+        case 18: return "DeconvolutionDepthwise";
+        case 21: return "Dropout";
+        case 22: return "Eltwise";
+        case 26: return "ExpandDims";
+        case 27: return "Fill";
+        case 28: return "Flatten";
+        case 30: return "Gather";
+        case 31: return "GatherV2";
+        case 33: return "InnerProduct";
+        case 34: return "Input";
+        case 35: return "Interp";
+        case 39: return "MatMul";
+        case 44: return "Pack";
+        case 45: return "Padding";
+        case 46: return "Permute";
+        case 47: return "Pooling";
+        case 49: return "PReLU";
+        case 65: return "Range";
+        case 68: return "Reduction";
+        case 69: return "ReLU";
+        case 70: return "ReLU6";
+        case 73: return "Reshape";
+        case 77: return "Scale";
+        case 80: return "Shape";
+        case 81: return "Sigmoid";
+        case 83: return "Slice";
+        case 85: return "Softmax";
+        case 88: return "Split";
+        case 90: return "Squeeze";
+        case 91: return "StridedSlice";
+        case 95: return "TanH";
+        case 98: return "Tile";
+        case 99: return "TopKV2";
+        case 100: return "Transpose";
+        case 101: return "UnaryOp";
+        case 102: return "Unpack";
+        case 103: return "Where";
+        case 106: return "BatchMatMul";
+        case 107: return "Unsqueeze";
+        case 120: return "BroadcastTo";
+        case 128: return "Raster";
+        case 129: return "ConvertTensor";
+        default: return nullptr;
+    }
+}
+
+enum OpTypeValue { OpConst = 11, OpConv = 12, OpConvDw = 13, OpDeconv = 17, OpDeconvDw = 18, OpInput = 34 };
+
+// DataType -> the coarse dtype getModelInfo has always reported.
+const char* dtypeName(int dt) {
+    switch (dt) {
+        case 1: case 2: case 14: case 19: return "float";  // FLOAT, DOUBLE, BFLOAT16, HALF
+        case 3: case 5: case 6: case 9: case 11: case 13: case 15: return "int";
+        case 4: case 10: case 12: case 16: case 17: return "uint";
+        default: return "unknown";
+    }
+}
+
+const char* formatName(int f) {
+    switch (f) {
+        case 0: return "NCHW";
+        case 1: return "NHWC";
+        case 2: return "NC4HW4";
+        case 3: return "NHWC4";
+        default: return "UNKNOWN";
+    }
+}
+
+struct InputInfo {
+    std::string name;
+    std::vector<int> dims;
+    int dtype = 1;
+    int format = 2;
+};
+
+struct WeightStats {
+    long long params = 0;
+    long long floatBytes = 0;
+    long long quantBytes = 0;
+    long long externalBytes = 0;
+    int quantizedConvs = 0;
+    int sparseConvs = 0;
+    int int8Consts = 0;
+    bool paramsEstimated = false;
+    std::map<int, int> quantTypes; // IDSTQuan type -> conv count
+};
+
+void addConvWeights(const FbTable& conv, WeightStats& w) {
+    auto weight = conv.vector(ConvField::weight);
+    auto bias = conv.vector(ConvField::bias);
+    w.params += bias.first;
+    w.floatBytes += 4LL * bias.first;
+    if (conv.hasTable(ConvField::sparseParameter)) ++w.sparseConvs;
+    auto ext = conv.vector(ConvField::external);
+    if (ext.first >= 2) {
+        // [offset, weight bytes, bias bytes, ...] into the external weight file.
+        for (uint32_t i = 1; i < ext.first && i < 3; ++i) w.externalBytes += conv.read<int64_t>(ext.second + 8 * (size_t)i);
+    }
+    if (weight.first) {
+        w.params += weight.first;
+        w.floatBytes += 4LL * weight.first;
+        return;
+    }
+    if (conv.hasTable(ConvField::quanParameter)) {
+        FbTable quan = conv.table(ConvField::quanParameter);
+        ++w.quantizedConvs;
+        ++w.quantTypes[quan.scalar<int32_t>(QuanField::type, 0)];
+        w.quantBytes += quan.vector(QuanField::buffer).first + 4LL * quan.vector(QuanField::alpha).first;
+    }
+    // Quantized buffers are bit-packed, so count parameters from the kernel geometry.
+    if (conv.hasTable(ConvField::common)) {
+        FbTable common = conv.table(ConvField::common);
+        const int kx = common.scalar<int32_t>(ConvCommonField::kernelX, 1);
+        const int ky = common.scalar<int32_t>(ConvCommonField::kernelY, 1);
+        const int group = std::max(1, common.scalar<int32_t>(ConvCommonField::group, 1));
+        const int outC = common.scalar<int32_t>(ConvCommonField::outputCount, 0);
+        const int inC = common.scalar<int32_t>(ConvCommonField::inputCount, 0);
+        if (outC > 0 && inC > 0) w.params += (long long)outC * (inC / group) * kx * ky;
+        else w.paramsEstimated = true;
+    }
+}
+
+void addBlob(const FbTable& blob, WeightStats& w) {
+    static const int widths[] = {0, 0, 0, 1, 1, 4, 8, 4};
+    for (int f = BlobField::uint8s; f <= BlobField::float32s; ++f) {
+        auto v = blob.vector(f);
+        if (!v.first) continue;
+        w.params += v.first;
+        if (f == BlobField::int8s || f == BlobField::uint8s) {
+            w.quantBytes += v.first;
+            ++w.int8Consts;
+        } else {
+            w.floatBytes += (long long)widths[f] * v.first;
+        }
+    }
+    auto ext = blob.vector(BlobField::external);
+    if (ext.first >= 2) {
+        const long long bytes = blob.read<int64_t>(ext.second + 8);
+        w.externalBytes += bytes;
+        auto dims = blob.vector(BlobField::dims);
+        long long n = 1;
+        for (uint32_t i = 0; i < dims.first; ++i) n *= std::max(1, blob.read<int32_t>(dims.second + 4 * (size_t)i));
+        w.params += n;
+    }
+}
+
+std::string inspectBuffer(const uint8_t* buf, size_t size, double* parseMs) {
+    auto t0 = clock::now();
+    if (size < 8) throw std::runtime_error("file too small for an MNN model");
+    FbTable net(buf, size, rootTable(buf, size));
+
+    std::vector<std::string> tensorNames;
+    auto names = net.vector(NetField::tensorName);
+    tensorNames.reserve(names.first);
+    for (uint32_t i = 0; i < names.first; ++i) tensorNames.push_back(net.stringAt(net.indirect(names.second, i)));
+    auto tensorName = [&](int idx) {
+        return idx >= 0 && (size_t)idx < tensorNames.size() ? tensorNames[(size_t)idx] : std::to_string(idx);
+    };
+
+    std::vector<InputInfo> inputs;
+    std::map<std::string, int> histogram;
+    std::set<int> produced, consumed;
+    WeightStats weights;
+    auto ops = net.vector(NetField::oplists);
+    for (uint32_t i = 0; i < ops.first; ++i) {
+        FbTable op = net.tableAt(net.indirect(ops.second, i));
+        const int type = op.scalar<int32_t>(OpField::type, 0);
+        const char* tn = opTypeName(type);
+        ++histogram[tn ? std::string(tn) : "OpType_" + std::to_string(type)];
+
+        auto outs = op.vector(OpField::outputIndexes);
+        for (uint32_t k = 0; k < outs.first; ++k) produced.insert(op.read<int32_t>(outs.second + 4 * (size_t)k));
+        auto ins = op.vector(OpField::inputIndexes);
+        for (uint32_t k = 0; k < ins.first; ++k) consumed.insert(op.read<int32_t>(ins.second + 4 * (size_t)k));
+
+        const bool hasMain = op.hasTable(OpField::main);
+        if (type == OpInput) {
+            InputInfo in;
+            in.name = outs.first ? tensorName(op.read<int32_t>(outs.second)) : op.string(OpField::name);
+            if (hasMain) {
+                FbTable p = op.table(OpField::main);
+                auto dims = p.vector(InputField::dims);
+                for (uint32_t k = 0; k < dims.first; ++k) in.dims.push_back(p.read<int32_t>(dims.second + 4 * (size_t)k));
+                in.dtype = p.scalar<int32_t>(InputField::dtype, 1);
+                in.format = p.scalar<int8_t>(InputField::dformat, 2);
+            }
+            inputs.push_back(in);
+        } else if (hasMain && (type == OpConv || type == OpConvDw || type == OpDeconv || type == OpDeconvDw)) {
+            addConvWeights(op.table(OpField::main), weights);
+        } else if (hasMain && type == OpConst) {
+            addBlob(op.table(OpField::main), weights);
+        }
+    }
+
+    std::vector<std::string> outputs;
+    auto outNames = net.vector(NetField::outputName);
+    for (uint32_t i = 0; i < outNames.first; ++i) outputs.push_back(net.stringAt(net.indirect(outNames.second, i)));
+    if (outputs.empty()) {
+        // Older converters leave outputName empty: outputs are tensors nobody consumes.
+        for (int idx : produced) {
+            if (!consumed.count(idx)) outputs.push_back(tensorName(idx));
+        }
+    }
+    std::string version = "unknown";
+    if (net.hasTable(NetField::extraInfo)) {
+        std::string v = net.table(NetField::extraInfo).string(ExtraInfoField::version);
+        if (!v.empty()) version = v;
+    }
+    const std::string bizCode = net.string(NetField::bizCode);
+    const int subgraphs = (int)net.vector(NetField::subgraphs).first;
+    *parseMs = msBetween(t0, clock::now());
+
+    std::ostringstream json;
+    json.setf(std::ios::fixed); json.precision(3);
+    json << "{\"inputs\":[";
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        const auto& in = inputs[i];
+        if (i) json << ",";
+        // "dims" keeps getModelInfo's contract (unknown dims as 1); "model_dims" is what the file says.
+        json << "{\"name\":\"" << jsonEscape(in.name) << "\",\"dims\":[";
+        for (size_t k = 0; k < in.dims.size(); ++k) json << (k ? "," : "") << (in.dims[k] > 0 ? in.dims[k] : 1);
+        json << "],\"model_dims\":[";
+        for (size_t k = 0; k < in.dims.size(); ++k) json << (k ? "," : "") << in.dims[k];
+        json << "],\"dtype\":\"" << dtypeName(in.dtype) << "\",\"format\":\"" << formatName(in.format) << "\"}";
+    }
+    json << "],\"outputs\":[";
+    for (size_t i = 0; i < outputs.size(); ++i) json << (i ? "," : "") << "\"" << jsonEscape(outputs[i]) << "\"";
+    json << "],\"op_count\":" << ops.first
+         << ",\"op_histogram\":{";
+    bool first = true;
+    for (auto& kv : histogram) {
+        json << (first ? "" : ",") << "\"" << jsonEscape(kv.first) << "\":" << kv.second;
+        first = false;
+    }
+    json << "},\"tensor_count\":" << net.scalar<int32_t>(NetField::tensorNumber, (int32_t)tensorNames.size())
+         << ",\"subgraphs\":" << subgraphs
+         << ",\"params\":" << weights.params
+         << ",\"params_estimated\":" << (weights.paramsEstimated ? "true" : "false")
+         << ",\"weight_bytes\":" << weights.floatBytes + weights.quantBytes
+         << ",\"float_weight_bytes\":" << weights.floatBytes
+         << ",\"external_weight_bytes\":" << weights.externalBytes
+         << ",\"quantization\":{\"quantized_weight_bytes\":" << weights.quantBytes
+         << ",\"quantized_convs\":" << weights.quantizedConvs
+         << ",\"sparse_convs\":" << weights.sparseConvs
+         << ",\"int8_consts\":" << weights.int8Consts
+         << ",\"quant_types\":{";
+    first = true;
+    for (auto& kv : weights.quantTypes) {
+        json << (first ? "" : ",") << "\"" << kv.first << "\":" << kv.second;
+        first = false;
+    }
+    json << "}},\"model_version\":\"" << jsonEscape(version) << "\""
+         << ",\"biz_code\":\"" << jsonEscape(bizCode) << "\""
+         << ",\"file_bytes\":" << size
+         << ",\"inspector\":\"flatbuffer\"";
+    return json.str(); // caller closes the object after adding cache fields
+}
+
+struct CacheEntry {
+    long long mtimeNs;
+    long long size;
+    std::string json;
+    uint64_t lastUse; // cache tick, larger is more recent
+};
+
+std::mutex gCacheMutex;
+std::map<std::string, CacheEntry> gCache;
+uint64_t gCacheTick = 0;
+const size_t kMaxCacheEntries = 32;
+
+} // namespace
+
+std::string inspectModel(const std::string& modelPath) {
+    try {
+        struct stat st;
+        if (stat(modelPath.c_str(), &st) != 0) throw std::runtime_error("Model not found: " + modelPath);
+        const long long mtimeNs = (long long)st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+        {
+            std::lock_guard<std::mutex> lock(gCacheMutex);
+            auto it = gCache.find(modelPath);
+            if (it != gCache.end() && it->second.mtimeNs == mtimeNs && it->second.size == (long long)st.st_size) {
+                it->second.lastUse = ++gCacheTick;
+                return it->second.json + ",\"cached\":true}";
+            }
+        }
+
+        int fd = open(modelPath.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("Cannot open model: " + modelPath);
+        const size_t size = (size_t)st.st_size;
+        void* map = size ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+        close(fd);
+        if (map == MAP_FAILED) throw std::runtime_error("Cannot map model: " + modelPath);
+        std::string body;
+        double parseMs = 0.0;
+        try {
+            body = inspectBuffer(static_cast<const uint8_t*>(map), size, &parseMs);
+        } catch (...) {
+            munmap(map, size);
+            throw;
+        }
+        munmap(map, size);
+
+        std::ostringstream timing;
+        timing.setf(std::ios::fixed); timing.precision(3);
+        timing << ",\"parse_ms\":" << parseMs;
+        body += timing.str();
+        {
+            std::lock_guard<std::mutex> lock(gCacheMutex);
+            if (gCache.size() >= kMaxCacheEntries && !gCache.count(modelPath)) {
+                // Evict the least recently used entry.
+                auto victim = gCache.begin();
+                for (auto it = gCache.begin(); it != gCache.end(); ++it) {
+                    if (it->second.lastUse < victim->second.lastUse) victim = it;
+                }
+                gCache.erase(victim);
+            }
+            gCache[modelPath] = CacheEntry{mtimeNs, (long long)st.st_size, body, ++gCacheTick};
+        }
+        return body + ",\"cached\":false}";
+    } catch (const std::exception& e) {
+        return std::string("{\"error\":\"") + jsonEscape(e.what()) + "\"}";
+    }
+}
+
+} // namespace runner
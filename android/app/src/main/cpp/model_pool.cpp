@@ -0,0 +1,567 @@
+// Resident model pool: prepared Interpreter + Session pairs kept across runs so switching between
+// a handful of models stops paying createFromFile/createSession each time.
+//   - keyed by model file (path, size, mtime), input shapes and everything the session is built from,
+//     including the tuning-profile hints applied to the interpreter;
+//   - each entry's footprint is measured once when it is built (RSS delta, or the session's
+//     MEMORY info when larger), and least-recently-used idle entries are evicted to stay under
+//     the byte budget;
+//   - one background worker prewarms entries: explicitly requested ones, and the model that most
+//     often followed the current one in earlier switches. A prewarm build starts only when no other
+//     build runs and foreground misses never wait for it;
+//   - trimPool maps Android's onTrimMemory levels to how much of the pool to release.
+#include "modes.hpp"
+#include "runner_common.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include <sys/stat.h>
+
+namespace runner {
+
+#if HAVE_MNN
+namespace {
+
+// ComponentCallbacks2 levels.
+constexpr int kTrimRunningModerate = 5;
+constexpr int kTrimRunningLow = 10;
+constexpr int kTrimRunningCritical = 15;
+constexpr int kTrimUiHidden = 20;
+constexpr int kTrimModerate = 60;
+
+struct PoolEntry {
+    std::string key;
+    RunOptions opt;
+    std::map<int, int> profileHints; // tuning-profile hints applied at build, part of the key
+    std::unique_ptr<MNN::Interpreter> net;
+    MNN::Session* session = nullptr;
+    long long footprintBytes = 0;
+    long long rssDeltaBytes = -1;  // -1 also when another build overlapped and the delta is shared
+    long long sessionMemoryBytes = 0;
+    double createInterpreterMs = 0.0;
+    double createSessionMs = 0.0;
+    double resizeSessionMs = 0.0;
+    bool prewarmed = false;   // built by the worker and not used yet
+    uint64_t lastUse = 0;     // pool tick, larger is more recent
+    long long hits = 0;
+    std::mutex runMutex;      // one inference at a time per session
+
+    ~PoolEntry() {
+        if (net && session) net->releaseSession(session);
+    }
+};
+using EntryPtr = std::shared_ptr<PoolEntry>;
+
+struct PoolStats {
+    long long hits = 0;
+    long long misses = 0;
+    long long prewarmHits = 0;    // first use of a prewarmed entry
+    long long inflightWaits = 0;  // miss that joined a build already in progress
+    long long evictions = 0;
+    long long evictedBytes = 0;
+    long long prewarms = 0;
+    long long prewarmFailures = 0;
+    long long trims = 0;
+};
+
+struct Pool {
+    std::mutex mutex;
+    std::map<std::string, EntryPtr> entries;
+    std::map<std::string, std::shared_future<EntryPtr>> building;
+    long long budgetBytes = 512LL << 20;
+    bool predictNext = true;
+    uint64_t tick = 0;
+    PoolStats stats;
+    // Switch history: key -> next key -> count, and the config each key was built from.
+    std::map<std::string, std::map<std::string, int>> transitions;
+    std::map<std::string, RunOptions> configs;
+    std::string lastKey;
+
+    // Build admission. The RSS delta is attributable to an entry only when no other build overlapped
+    // it, so prewarms wait for a quiet moment; foreground builds start at once and, when they
+    // overlap, fall back to the session's MEMORY info.
+    std::mutex buildMutex;
+    std::condition_variable buildCv;
+    int activeBuilds = 0;
+    int foregroundBuilds = 0;
+    uint64_t buildsStarted = 0;
+
+    std::mutex workerMutex;
+    std::condition_variable workerCv;
+    std::deque<RunOptions> prewarmQueue;
+    bool workerStarted = false;
+};
+
+Pool& pool() {
+    static Pool* p = new Pool(); // leaked on purpose: the worker thread outlives static destruction
+    return *p;
+}
+
+std::string poolKey(const RunOptions& opt, const std::map<int, int>& profileHints) {
+    std::ostringstream k;
+    struct stat st {};
+    if (::stat(opt.modelPath.c_str(), &st) == 0) {
+        k << opt.modelPath << "@" << (long long)st.st_size << ":" << (long long)st.st_mtime;
+    } else {
+        k << opt.modelPath;
+    }
+    k << "|" << shapeSignature(opt) << "|" << opt.backend << "+" << opt.backupType << "|" << opt.precisionMode
+      << "|" << opt.memoryMode << "|" << opt.powerMode << "|" << opt.threads << "t";
+    for (auto& kv : opt.sessionHints) k << "|h" << kv.first << "=" << kv.second;
+    for (auto& kv : profileHints) k << "|p" << kv.first << "=" << kv.second;
+    return k.str();
+}
+
+std::string poolKey(const RunOptions& opt) {
+    return poolKey(opt, activeHints(opt.modelPath));
+}
+
+// Holds a build slot for the lifetime of one buildEntry.
+class BuildSlot {
+public:
+    explicit BuildSlot(bool prewarm) : prewarm_(prewarm) {
+        Pool& p = pool();
+        std::unique_lock<std::mutex> lock(p.buildMutex);
+        if (prewarm_) p.buildCv.wait(lock, [&p] { return p.activeBuilds == 0 && p.foregroundBuilds == 0; });
+        else p.foregroundBuilds++;
+        alone_ = p.activeBuilds == 0;
+        p.activeBuilds++;
+        seq_ = ++p.buildsStarted;
+    }
+    ~BuildSlot() {
+        Pool& p = pool();
+        {
+            std::lock_guard<std::mutex> lock(p.buildMutex);
+            p.activeBuilds--;
+            if (!prewarm_) p.foregroundBuilds--;
+        }
+        p.buildCv.notify_all();
+    }
+    // No other build ran at any point since this one started.
+    bool alone() {
+        Pool& p = pool();
+        std::lock_guard<std::mutex> lock(p.buildMutex);
+        return alone_ && p.buildsStarted == seq_;
+    }
+
+private:
+    bool prewarm_;
+    bool alone_ = false;
+    uint64_t seq_ = 0;
+};
+
+EntryPtr buildEntry(const RunOptions& opt, const std::map<int, int>& profileHints, const std::string& key,
+                    bool prewarm) {
+    auto e = std::make_shared<PoolEntry>();
+    e->key = key;
+    e->opt = opt;
+    e->profileHints = profileHints;
+    BuildSlot slot(prewarm);
+    const long long rss0 = readRssBytes();
+    auto t0 = clock::now();
+    e->net.reset(MNN::Interpreter::createFromFile(opt.modelPath.c_str()));
+    if (!e->net) throw std::runtime_error("Failed to create interpreter");
+    e->createInterpreterMs = msBetween(t0, clock::now());
+    for (auto& kv : profileHints) e->net->setSessionHint((MNN::Interpreter::HintMode)kv.first, kv.second);
+    if (!opt.cacheFile.empty()) e->net->setCacheFile(opt.cacheFile.c_str());
+    for (auto& kv : opt.sessionHints) e->net->setSessionHint((MNN::Interpreter::HintMode)kv.first, kv.second);
+
+    MNN::BackendConfig bcfg = makeBackendConfig(opt);
+    MNN::ScheduleConfig cfg = makeScheduleConfig(opt, &bcfg);
+    auto t1 = clock::now();
+    e->session = e->net->createSession(cfg);
+    if (!e->session) throw std::runtime_error("Failed to create session");
+    e->createSessionMs = msBetween(t1, clock::now());
+    auto t2 = clock::now();
+    resizeInputs(e->net.get(), e->session, opt);
+    e->resizeSessionMs = msBetween(t2, clock::now());
+    // One run so lazily allocated buffers and GPU kernels count toward the footprint.
+    fillInputs(e->net.get(), e->session, opt.inputFill);
+    e->net->runSession(e->session);
+
+    const long long rss1 = readRssBytes();
+    if (rss0 >= 0 && rss1 >= 0 && slot.alone()) e->rssDeltaBytes = std::max(0LL, rss1 - rss0);
+    float memMb = 0.0f;
+    if (e->net->getSessionInfo(e->session, MNN::Interpreter::MEMORY, &memMb) && memMb > 0.0f) {
+        e->sessionMemoryBytes = (long long)(memMb * 1024.0f * 1024.0f);
+    }
+    e->footprintBytes = std::max(e->rssDeltaBytes, e->sessionMemoryBytes);
+    if (e->footprintBytes <= 0) {
+        struct stat st {};
+        if (::stat(opt.modelPath.c_str(), &st) == 0) e->footprintBytes = (long long)st.st_size;
+    }
+    return e;
+}
+
+long long residentBytesLocked(const Pool& p) {
+    long long total = 0;
+    for (auto& kv : p.entries) total += kv.second->footprintBytes;
+    return total;
+}
+
+// Evict least-recently-used entries until at most `target` bytes stay resident. `keep` is never
+// evicted; entries whose session is running are skipped (they are freed when the run ends anyway,
+// but evicting them would only drop a session that is hot right now).
+void evictToLocked(Pool& p, long long target, const std::string& keep) {
+    long long resident = residentBytesLocked(p);
+    while (resident > target) {
+        EntryPtr victim;
+        for (auto& kv : p.entries) {
+            auto& e = kv.second;
+            if (e->key == keep) continue;
+            std::unique_lock<std::mutex> busy(e->runMutex, std::try_to_lock);
+            if (!busy.owns_lock()) continue;
+            if (!victim || e->lastUse < victim->lastUse) victim = e;
+        }
+        if (!victim) break;
+        resident -= victim->footprintBytes;
+        p.stats.evictions++;
+        p.stats.evictedBytes += victim->footprintBytes;
+        p.entries.erase(victim->key);
+    }
+}
+
+// Resident entry for `opt`, building it (or joining a build in progress) on a miss.
+EntryPtr acquire(const RunOptions& opt, bool forPrewarm, bool& hit, bool& waited) {
+    Pool& p = pool();
+    const std::map<int, int> profileHints = activeHints(opt.modelPath);
+    const std::string key = poolKey(opt, profileHints);
+    hit = false;
+    waited = false;
+    std::promise<EntryPtr> promise;
+    {
+        std::unique_lock<std::mutex> lock(p.mutex);
+        auto it = p.entries.find(key);
+        if (it != p.entries.end()) {
+            hit = true;
+            if (!forPrewarm) {
+                auto& e = it->second;
+                e->lastUse = ++p.tick;
+                e->hits++;
+                p.stats.hits++;
+                if (e->prewarmed) p.stats.prewarmHits++;
+                e->prewarmed = false;
+            }
+            return it->second;
+        }
+        auto b = p.building.find(key);
+        if (b != p.building.end()) {
+            auto future = b->second;
+            lock.unlock();
+            waited = true;
+            EntryPtr e = future.get(); // rethrows the build error
+            std::lock_guard<std::mutex> relock(p.mutex);
+            if (!forPrewarm) {
+                p.stats.misses++;
+                p.stats.inflightWaits++;
+                e->lastUse = ++p.tick;
+                e->prewarmed = false;
+            }
+            return e;
+        }
+        p.building[key] = promise.get_future().share();
+        if (!forPrewarm) p.stats.misses++;
+    }
+
+    EntryPtr e;
+    try {
+        e = buildEntry(opt, profileHints, key, forPrewarm);
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(p.mutex);
+        p.building.erase(key);
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+    {
+        std::lock_guard<std::mutex> lock(p.mutex);
+        e->prewarmed = forPrewarm;
+        e->lastUse = ++p.tick;
+        p.entries[key] = e;
+        p.building.erase(key);
+        evictToLocked(p, p.budgetBytes, key);
+    }
+    promise.set_value(e);
+    return e;
+}
+
+void prewarmWorker() {
+    Pool& p = pool();
+    for (;;) {
+        RunOptions opt;
+        {
+            std::unique_lock<std::mutex> lock(p.workerMutex);
+            p.workerCv.wait(lock, [&p] { return !p.prewarmQueue.empty(); });
+            opt = p.prewarmQueue.front();
+            p.prewarmQueue.pop_front();
+        }
+        bool hit = false, waited = false;
+        try {
+            (void)acquire(opt, true, hit, waited);
+            if (!hit && !waited) {
+                std::lock_guard<std::mutex> lock(p.mutex);
+                p.stats.prewarms++;
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(p.mutex);
+            p.stats.prewarmFailures++;
+        }
+    }
+}
+
+void schedulePrewarm(const RunOptions& opt) {
+    Pool& p = pool();
+    std::lock_guard<std::mutex> lock(p.workerMutex);
+    if (!p.workerStarted) {
+        std::thread(prewarmWorker).detach();
+        p.workerStarted = true;
+    }
+    p.prewarmQueue.push_back(opt);
+    p.workerCv.notify_one();
+}
+
+// Most frequent successor of `key` in the switch history, if it is not already resident or building.
+bool predictSuccessorLocked(Pool& p, const std::string& key, RunOptions& next, std::string& nextKey) {
+    auto t = p.transitions.find(key);
+    if (t == p.transitions.end()) return false;
+    int best = 0;
+    for (auto& kv : t->second) {
+        if (kv.first != key && kv.second > best) {
+            best = kv.second;
+            nextKey = kv.first;
+        }
+    }
+    if (best == 0 || p.entries.count(nextKey) || p.building.count(nextKey)) return false;
+    auto c = p.configs.find(nextKey);
+    if (c == p.configs.end()) return false;
+    next = c->second;
+    return true;
+}
+
+void writeStatsLocked(std::ostream& json, const Pool& p) {
+    const long long resident = residentBytesLocked(p);
+    const long long lookups = p.stats.hits + p.stats.misses;
+    json << "{\"budget_bytes\":" << p.budgetBytes
+         << ",\"resident_bytes\":" << resident
+         << ",\"over_budget\":" << (resident > p.budgetBytes ? "true" : "false")
+         << ",\"hits\":" << p.stats.hits
+         << ",\"misses\":" << p.stats.misses
+         << ",\"hit_rate\":" << (lookups ? (double)p.stats.hits / lookups : 0.0)
+         << ",\"prewarm_hits\":" << p.stats.prewarmHits
+         << ",\"inflight_waits\":" << p.stats.inflightWaits
+         << ",\"evictions\":" << p.stats.evictions
+         << ",\"evicted_bytes\":" << p.stats.evictedBytes
+         << ",\"prewarms\":" << p.stats.prewarms
+         << ",\"prewarm_failures\":" << p.stats.prewarmFailures
+         << ",\"trims\":" << p.stats.trims
+         << ",\"building\":" << p.building.size()
+         << ",\"entries\":[";
+    std::vector<EntryPtr> byUse;
+    for (auto& kv : p.entries) byUse.push_back(kv.second);
+    std::sort(byUse.begin(), byUse.end(), [](const EntryPtr& a, const EntryPtr& b) { return a->lastUse > b->lastUse; });
+    for (size_t i = 0; i < byUse.size(); ++i) {
+        auto& e = byUse[i];
+        json << (i ? "," : "")
+             << "{\"key\":\"" << jsonEscape(e->key) << "\""
+             << ",\"model\":\"" << jsonEscape(e->opt.modelPath) << "\""
+             << ",\"config\":\"" << describeOptions(e->opt) << "\""
+             << ",\"footprint_bytes\":" << e->footprintBytes
+             << ",\"rss_delta_bytes\":" << e->rssDeltaBytes
+             << ",\"session_memory_bytes\":" << e->sessionMemoryBytes
+             << ",\"hits\":" << e->hits
+             << ",\"prewarmed\":" << (e->prewarmed ? "true" : "false")
+             << ",\"lru_rank\":" << i << "}";
+    }
+    json << "]}";
+}
+
+void applyPoolSettingsLocked(Pool& p, const json::Value& root) {
+    if (root.has("budgetMb")) p.budgetBytes = (long long)(root.getNumber("budgetMb", 512.0) * 1024.0 * 1024.0);
+    if (root.has("budgetBytes")) p.budgetBytes = (long long)root.getNumber("budgetBytes", (double)p.budgetBytes);
+    if (p.budgetBytes < 0) p.budgetBytes = 0;
+    p.predictNext = root.getBool("predictNext", p.predictNext);
+}
+
+} // namespace
+#endif
+
+std::string poolRun(const std::string& configJson) {
+#if HAVE_MNN
+    try {
+        json::Value root = json::parse(configJson);
+        RunOptions opt;
+        applyRunOptions(root, opt);
+        if (opt.modelPath.empty()) throw std::runtime_error("Missing modelPath");
+        const int warmup = std::max(0, root.getInt("warmup", 0));
+        const int iterations = std::max(1, root.getInt("iterations", 1));
+        Pool& p = pool();
+
+        auto a0 = clock::now();
+        bool hit = false, waited = false;
+        EntryPtr e = acquire(opt, false, hit, waited);
+        const double acquireMs = msBetween(a0, clock::now());
+
+        std::vector<double> samples;
+        std::ostringstream outputs;
+        {
+            std::lock_guard<std::mutex> run(e->runMutex);
+            fillInputs(e->net.get(), e->session, opt.inputFill);
+            for (int i = 0; i < warmup; ++i) e->net->runSession(e->session);
+            for (int i = 0; i < iterations; ++i) {
+                auto t = clock::now();
+                e->net->runSession(e->session);
+                samples.push_back(msBetween(t, clock::now()));
+            }
+            bool first = true;
+            for (auto& kv : e->net->getSessionOutputAll(e->session)) {
+                if (!kv.second) continue;
+                outputs << (first ? "" : ",") << "{\"name\":\"" << jsonEscape(kv.first) << "\",\"shape\":";
+                writeShape(outputs, kv.second);
+                outputs << "}";
+                first = false;
+            }
+        }
+
+        // Record the switch, then queue the next model: the one asked for, else the predicted one.
+        RunOptions next;
+        std::string nextKey, prewarmReason;
+        {
+            std::lock_guard<std::mutex> lock(p.mutex);
+            applyPoolSettingsLocked(p, root);
+            p.configs[e->key] = opt;
+            if (!p.lastKey.empty() && p.lastKey != e->key) p.transitions[p.lastKey][e->key]++;
+            p.lastKey = e->key;
+            if (auto* pn = root.get("prewarmNext")) {
+                next = opt;
+                if (pn->isString()) next.modelPath = pn->str;
+                else applyRunOptions(*pn, next);
+                nextKey = poolKey(next);
+                if (!p.entries.count(nextKey) && !p.building.count(nextKey)) prewarmReason = "requested";
+            } else if (p.predictNext && predictSuccessorLocked(p, e->key, next, nextKey)) {
+                prewarmReason = "predicted";
+            }
+        }
+        if (!prewarmReason.empty()) schedulePrewarm(next);
+
+        std::ostringstream json;
+        json.setf(std::ios::fixed); json.precision(3);
+        json << "{\"pool\":true"
+             << ",\"key\":\"" << jsonEscape(e->key) << "\""
+             << ",\"config\":\"" << describeOptions(opt) << "\""
+             << ",\"hit\":" << (hit ? "true" : "false")
+             << ",\"waited_for_build\":" << (waited ? "true" : "false")
+             << ",\"acquire_ms\":" << acquireMs
+             << ",\"footprint_bytes\":" << e->footprintBytes;
+        if (!hit && !waited) {
+            json << ",\"build\":{\"createInterpreter_ms\":" << e->createInterpreterMs
+                 << ",\"createSession_ms\":" << e->createSessionMs
+                 << ",\"resizeSession_ms\":" << e->resizeSessionMs << "}";
+        }
+        json << ",\"latency\":";
+        writeLatency(json, samples);
+        json << ",\"outputs\":[" << outputs.str() << "]";
+        if (!prewarmReason.empty()) {
+            json << ",\"prewarm\":{\"reason\":\"" << prewarmReason << "\",\"key\":\"" << jsonEscape(nextKey) << "\"}";
+        }
+        json << ",\"stats\":";
+        {
+            std::lock_guard<std::mutex> lock(p.mutex);
+            writeStatsLocked(json, p);
+        }
+        json << "}";
+        return json.str();
+    } catch (const std::exception& ex) {
+        return std::string("{\"error\":\"") + jsonEscape(ex.what()) + "\"}";
+    }
+#else
+    (void)configJson;
+    return "{\"error\":\"MNN not bundled. Cannot run the model pool. Place headers and libMNN.so as documented.\"}";
+#endif
+}
+
+std::string prewarmPool(const std::string& configJson) {
+#if HAVE_MNN
+    try {
+        json::Value root = json::parse(configJson);
+        RunOptions opt;
+        applyRunOptions(root, opt);
+        if (opt.modelPath.empty()) throw std::runtime_error("Missing modelPath");
+        const std::string key = poolKey(opt);
+        bool queued = false;
+        {
+            std::lock_guard<std::mutex> lock(pool().mutex);
+            queued = !pool().entries.count(key) && !pool().building.count(key);
+        }
+        if (queued) schedulePrewarm(opt);
+        return std::string("{\"key\":\"") + jsonEscape(key) + "\",\"queued\":" + (queued ? "true" : "false") + "}";
+    } catch (const std::exception& ex) {
+        return std::string("{\"error\":\"") + jsonEscape(ex.what()) + "\"}";
+    }
+#else
+    (void)configJson;
+    return "{\"error\":\"MNN not bundled. Cannot run the model pool. Place headers and libMNN.so as documented.\"}";
+#endif
+}
+
+std::string poolStats(const std::string& configJson) {
+#if HAVE_MNN
+    try {
+        json::Value root = configJson.empty() ? json::Value() : json::parse(configJson);
+        Pool& p = pool();
+        std::lock_guard<std::mutex> lock(p.mutex);
+        applyPoolSettingsLocked(p, root);
+        if (root.getBool("clear", false)) evictToLocked(p, 0, std::string());
+        else evictToLocked(p, p.budgetBytes, std::string());
+        std::ostringstream json;
+        json.setf(std::ios::fixed); json.precision(3);
+        writeStatsLocked(json, p);
+        return json.str();
+    } catch (const std::exception& ex) {
+        return std::string("{\"error\":\"") + jsonEscape(ex.what()) + "\"}";
+    }
+#else
+    (void)configJson;
+    return "{\"error\":\"MNN not bundled. Cannot run the model pool. Place headers and libMNN.so as documented.\"}";
+#endif
+}
+
+std::string trimPool(int level) {
+#if HAVE_MNN
+    Pool& p = pool();
+    std::lock_guard<std::mutex> lock(p.mutex);
+    p.stats.trims++;
+    if (level >= kTrimModerate || level == kTrimRunningCritical) {
+        evictToLocked(p, 0, std::string());
+    } else if (level >= kTrimUiHidden) {
+        // In the background: keep only the most recently used model for a quick return.
+        std::string mru;
+        uint64_t best = 0;
+        for (auto& kv : p.entries) {
+            if (kv.second->lastUse >= best) {
+                best = kv.second->lastUse;
+                mru = kv.first;
+            }
+        }
+        evictToLocked(p, 0, mru);
+    } else if (level >= kTrimRunningLow) {
+        evictToLocked(p, p.budgetBytes / 2, p.lastKey);
+    } else if (level >= kTrimRunningModerate) {
+        evictToLocked(p, p.budgetBytes * 3 / 4, p.lastKey);
+    }
+    std::ostringstream json;
+    json.setf(std::ios::fixed); json.precision(3);
+    json << "{\"level\":" << level << ",\"stats\":";
+    writeStatsLocked(json, p);
+    json << "}";
+    return json.str();
+#else
+    return std::string("{\"level\":") + std::to_string(level) + "}";
+#endif
+}
+
+} // namespace runner
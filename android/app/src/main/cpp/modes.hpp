@@ -0,0 +1,127 @@
+// Entry points of the native run modes beyond the plain run/profile paths.
+// Each takes the JSON config sent over the method channel and returns a JSON
+// report, or {"error":"..."} when the mode cannot run.
+#pragma once
+#include <map>
+#include <string>
+
+namespace MNN { class Interpreter; }
+
+namespace runner {
+
+// Run the same inputs under a reference config and candidate configs; report
+// per-output drift (max-abs, relative L2, cosine) next to latency, optionally
+// locating the first op whose output diverges from the reference.
+std::string runCompare(const std::string& configJson);
+
+// Sweep DYNAMIC_QUANT_OPTIONS x QKV_QUANT_OPTIONS on a weight-quantized model and
+// report latency, memory and output error against the float-activation run and against a
+// hints-off control in the variants' memory mode.
+std::string runDynamicQuant(const std::string& configJson);
+
+// Tuning profiles: "best known config" records keyed by device fingerprint and model hash.
+void setTuningProfileDir(const std::string& dir);
+// Sweep threads x precision (or explicit "candidates"), store the fastest as the model's profile.
+std::string runTuneProfile(const std::string& configJson);
+// Merge the stored profile into a run config unless "overrideProfile" is set; the result
+// carries a "tuningProfile" object saying what was applied. Stale records are revalidated
+// in the background.
+std::string applyTuningProfile(const std::string& configJson);
+// Decode loop: a prefill of "promptTokens" then "newTokens" steps, each feeding the whole context
+// so far (no KV cache state is attached); "kvCacheSizeLimit"/"kvCacheDir" go to the runtime.
+// Reports TTFT, per-step latency, steps/s and footprint growth against context length.
+std::string runDecode(const std::string& configJson);
+
+// Express Module engine: static and dynamic Module::Config loads plus parameter-sharing clones,
+// each instance's latency, footprint and output drift reported next to the Interpreter path.
+std::string runModuleEngine(const std::string& configJson);
+
+// External weight data: the resident setExternalFile path against weights mmap'd from
+// EXTERNAL_WEIGHT_DIR, with an RSS / weight-residency timeline and first-touch page-in cost.
+std::string runExternalWeights(const std::string& configJson);
+
+// Low-memory residency: Session_Memory_Collect + releaseModel() after session creation, and
+// feature maps spilled to EXTERNAL_FEATUREMAP_DIR; RSS saved and latency paid vs the default.
+std::string runLowMemory(const std::string& configJson);
+
+// Inputs, outputs, op histogram, parameter/weight bytes and quantization summary read straight
+// from the model flatbuffer, without an Interpreter or session; cached by path, mtime and size.
+// "inputs" keeps the getModelInfo format.
+std::string inspectModel(const std::string& modelPath);
+
+// Append-only result store (<dir>/results.jsonl): every JSON-mode and runModel* report with its config,
+// device fingerprint and MNN version. recordResult returns the record id, or "" when the
+// report is an error or no directory is set.
+void setResultStoreDir(const std::string& dir);
+std::string recordResult(const std::string& mode, const std::string& configJson, const std::string& reportJson);
+// Newest records first; optional "limit", "mode" and "label" filters.
+std::string listResults(const std::string& configJson);
+// Mann-Whitney U + Cliff's delta per latency series of two records ("baseline"/"candidate":
+// a record id or {"label":..,"mode":..} for the newest match); flags significant regressions.
+std::string compareResults(const std::string& configJson);
+
+// Manifest suite: models x backends x threads x precisions from "manifest" (inline) or
+// "manifestPath", each cell checkpointed under "suiteDir" so a crashed run resumes; cells that
+// took the process down are reported as crashed instead of retried unless "retryCrashed".
+std::string runSuite(const std::string& configJson);
+
+// Open-loop load: requests arrive at each target rate ("rates", or fractions of the pool's
+// measured capacity) with Poisson or fixed spacing across "poolSize" sessions; latency from the
+// intended send time into an HDR histogram (p50..p99.99) and the knee of the curve per config.
+std::string runOpenLoop(const std::string& configJson);
+
+// Energy per inference for each BackendConfig::power setting ("powerModes"): powercap RAPL
+// counters on Linux hosts, battery current_now x voltage_now on Android, integrated over the timed
+// iterations; reports why when no counter is usable instead of a number.
+std::string runEnergy(const std::string& configJson);
+
+// Multi-path execution of user-named subgraphs ("paths": [{name, inputs, outputs, threads, cpus}]):
+// the single session, createMultiPathSession, and one session per path with independent paths running
+// concurrently; per-path latency, wall-clock speedup and output drift against the single session.
+std::string runMultiPath(const std::string& configJson);
+
+// Pipeline-parallel streaming: the graph cut at "splits" into stage sessions, each pinned to a core
+// cluster with frames handed over through bounded queues; per-stage utilization, bubble time and
+// steady-state frames/s against the whole model on all cores.
+std::string runPipeline(const std::string& configJson);
+
+// Adaptive sampling: time runSession until the median's confidence interval is within
+// "targetRelWidth" of the median or the budget ("maxMs", "maxSamples") runs out; drops the warm-up
+// transient, flags bimodal latency and grades the measurement.
+std::string runAdaptive(const std::string& configJson);
+
+// Camera-style stream: frames of a Y4M/raw "videoPath" at "targetFps" through preprocess ->
+// inference -> postprocess threads joined by bounded lock-free rings; end-to-end frames/s,
+// per-stage latency, queue occupancy and frames dropped under back-pressure.
+std::string runStream(const std::string& configJson);
+
+// Single-op microbenchmarks: one-op Express graphs (conv, depthwise, matmul, softmax, layernorm,
+// elementwise, pooling) over a shape grid, run as sessions under the configured backend, precision
+// and threads; per-case latency, GFLOP/s and GB/s plus a per-op summary, tagged with the device.
+std::string runOpBench(const std::string& configJson);
+
+// Latency prediction from per-op costs. buildCostTable times every op of "models" (or modelPath)
+// through op callbacks and merges them into the table for this device and backend/precision/threads
+// ("tablePath", or a file under "tableDir"), keyed by op type and input shapes. predictLatency walks
+// a model's ops without running them and sums table estimates into a median with an error bar,
+// then validates it against a measured run when the table is for this device.
+std::string buildCostTable(const std::string& configJson);
+std::string predictLatency(const std::string& configJson);
+
+// Resident model pool: prepared Interpreter + Session pairs reused across runs, LRU-evicted to stay
+// under a byte budget of measured footprints. poolRun acquires (building on a miss), runs and then
+// prewarms "prewarmNext" or the model that usually follows on a background thread.
+std::string poolRun(const std::string& configJson);
+std::string prewarmPool(const std::string& configJson);
+// Hit/miss/eviction counters and resident entries in LRU order; also applies "budgetMb",
+// "budgetBytes", "predictNext" and "clear".
+std::string poolStats(const std::string& configJson);
+// Release pool memory for an Android onTrimMemory level.
+std::string trimPool(int level);
+
+// Session hints of the profile last applied for this model; call right after createFromFile.
+void applyActiveHints(MNN::Interpreter* net, const std::string& modelPath);
+// The same hints as a map (HintMode -> value), for callers that key on them; empty when none apply.
+std::map<int, int> activeHints(const std::string& modelPath);
+
+} // namespace runner
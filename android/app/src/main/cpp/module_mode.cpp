@@ -0,0 +1,246 @@
+// Express Module engine next to the Interpreter/Session path: static and dynamic
+// Module::Config loads, plus parameter-sharing clones for multi-instance use.
+#include "modes.hpp"
+#include "runner_common.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <thread>
+
+#if HAVE_MNN && HAVE_MNN_EXPRESS
+#include "MNN/expr/ExecutorScope.hpp"
+#endif
+
+namespace runner {
+
+#if HAVE_MNN && HAVE_MNN_EXPRESS
+namespace {
+
+using namespace MNN::Express;
+
+// One Module instance with its own Executor, the way MNN expects modules to be run
+// from several threads. Instance 0 is the loaded module, the rest are clones of it.
+struct Instance {
+    std::shared_ptr<Executor> executor;
+    std::shared_ptr<Module> module;
+    std::vector<VARP> inputs;
+    double createMs = 0.0;
+    double firstRunMs = 0.0;
+    long long rssDeltaBytes = -1;
+    std::vector<double> samplesMs;
+    std::vector<double> concurrentMs;
+    NamedOutputs outputs;
+};
+
+// Forward once and map the first output so asynchronous backends finish inside the timing.
+void forwardSync(Instance& inst) {
+    auto outs = inst.module->onForward(inst.inputs);
+    if (outs.empty()) throw std::runtime_error("Module forward returned no outputs");
+    (void)outs[0]->readMap<void>();
+}
+
+struct EngineRun {
+    std::string name;
+    Module::Config config;
+    double loadMs = 0.0;
+    float memoryMb = 0.0f;
+    std::vector<Instance> instances;
+    double concurrentWallMs = 0.0;
+    std::string error;
+};
+
+EngineRun runEngine(const RunOptions& opt, const std::string& name, bool shapeMutable,
+                    int instances, int warmup, int iterations, bool concurrent) {
+    EngineRun run;
+    run.name = name;
+    run.config.dynamic = name == "dynamic";
+    run.config.shapeMutable = shapeMutable;
+
+    MNN::BackendConfig bcfg = makeBackendConfig(opt);
+    RuntimeManagerPtr rtmgr = makeRuntimeManager(opt);
+    run.instances.resize((size_t)instances);
+    for (int i = 0; i < instances; ++i) {
+        Instance& inst = run.instances[(size_t)i];
+        inst.executor = Executor::newExecutor((MNNForwardType)mapForward(opt.backend), bcfg, opt.threads);
+        ExecutorScope scope(inst.executor);
+        const long long rssBefore = readRssBytes();
+        auto t0 = clock::now();
+        if (i == 0) {
+            inst.module.reset(Module::load({}, {}, opt.modelPath.c_str(), rtmgr, &run.config), Module::destroy);
+            if (!inst.module) throw std::runtime_error("Failed to load module (" + name + ")");
+        } else {
+            inst.module.reset(Module::clone(run.instances[0].module.get(), true), Module::destroy);
+            if (!inst.module) throw std::runtime_error("Failed to clone module (" + name + ")");
+        }
+        inst.createMs = msBetween(t0, clock::now());
+        if (i == 0) run.loadMs = inst.createMs;
+
+        // First forward allocates the instance's activations; count it towards its footprint.
+        inst.inputs = makeModuleInputs(inst.module->getInfo(), opt);
+        auto t1 = clock::now();
+        forwardSync(inst);
+        inst.firstRunMs = msBetween(t1, clock::now());
+        const long long rssAfter = readRssBytes();
+        if (rssBefore >= 0 && rssAfter >= 0) inst.rssDeltaBytes = rssAfter - rssBefore;
+    }
+
+    // Each instance alone, so per-instance latency is comparable with the Interpreter run.
+    for (auto& inst : run.instances) {
+        ExecutorScope scope(inst.executor);
+        for (int i = 0; i < warmup; ++i) forwardSync(inst);
+        inst.samplesMs.reserve((size_t)iterations);
+        for (int i = 0; i < iterations; ++i) {
+            auto a = clock::now();
+            forwardSync(inst);
+            inst.samplesMs.push_back(msBetween(a, clock::now()));
+        }
+        auto outs = inst.module->onForward(inst.inputs);
+        inst.outputs = readModuleOutputs(outs, inst.module->getInfo()->outputNames);
+    }
+
+    // All instances at once, one thread each.
+    if (concurrent && instances > 1) {
+        std::vector<std::thread> workers;
+        auto t0 = clock::now();
+        for (auto& inst : run.instances) {
+            workers.emplace_back([&inst, iterations]() {
+                ExecutorScope scope(inst.executor);
+                inst.concurrentMs.reserve((size_t)iterations);
+                for (int i = 0; i < iterations; ++i) {
+                    auto a = clock::now();
+                    forwardSync(inst);
+                    inst.concurrentMs.push_back(msBetween(a, clock::now()));
+                }
+            });
+        }
+        for (auto& w : workers) w.join();
+        run.concurrentWallMs = msBetween(t0, clock::now());
+    }
+    (void)rtmgr->getInfo(MNN::Interpreter::MEMORY, &run.memoryMb);
+
+    // Clones go before the module whose parameters they share, each under its own executor.
+    for (auto it = run.instances.rbegin(); it != run.instances.rend(); ++it) {
+        ExecutorScope scope(it->executor);
+        it->inputs.clear();
+        it->module.reset();
+    }
+    return run;
+}
+
+void writeEngine(std::ostream& json, const EngineRun& run, const BenchRun& interp, int iterations) {
+    const double interpMedian = medianOf(interp.samplesMs);
+    json << "{\"engine\":\"module_" << run.name << "\""
+         << ",\"dynamic\":" << (run.config.dynamic ? "true" : "false")
+         << ",\"shapeMutable\":" << (run.config.shapeMutable ? "true" : "false");
+    if (!run.error.empty()) {
+        json << ",\"error\":\"" << jsonEscape(run.error) << "\"}";
+        return;
+    }
+    json << ",\"load_ms\":" << run.loadMs
+         << ",\"memory_mb\":" << run.memoryMb
+         << ",\"instances\":[";
+    for (size_t i = 0; i < run.instances.size(); ++i) {
+        const Instance& inst = run.instances[i];
+        if (i) json << ",";
+        const double median = medianOf(inst.samplesMs);
+        json << "{\"index\":" << i
+             << ",\"clone\":" << (i ? "true" : "false")
+             << ",\"create_ms\":" << inst.createMs
+             << ",\"first_run_ms\":" << inst.firstRunMs;
+        if (inst.rssDeltaBytes >= 0) json << ",\"rss_delta_mb\":" << inst.rssDeltaBytes / (1024.0 * 1024.0);
+        json << ",\"latency\":";
+        writeLatency(json, inst.samplesMs);
+        json << ",\"speedup_vs_interpreter\":" << (median > 0.0 ? interpMedian / median : 0.0);
+        if (!inst.concurrentMs.empty()) json << ",\"concurrent_median_ms\":" << medianOf(inst.concurrentMs);
+        json << ",\"outputs\":";
+        writeOutputErrors(json, interp.outputs, inst.outputs);
+        json << "}";
+    }
+    json << "]";
+    if (run.concurrentWallMs > 0.0) {
+        const double total = (double)run.instances.size() * iterations;
+        json << ",\"concurrent\":{\"instances\":" << run.instances.size()
+             << ",\"wall_ms\":" << run.concurrentWallMs
+             << ",\"throughput_per_s\":" << 1000.0 * total / run.concurrentWallMs << "}";
+    }
+    json << "}";
+}
+
+} // namespace
+
+std::string runModuleEngine(const std::string& configJson) {
+    try {
+        json::Value root = json::parse(configJson);
+        RunOptions opt;
+        applyRunOptions(root, opt);
+        if (opt.modelPath.empty()) throw std::runtime_error("Missing modelPath");
+
+        const int warmup = std::max(0, root.getInt("warmup", 1));
+        const int iterations = std::max(1, root.getInt("iterations", 10));
+        const int instances = std::max(1, root.getInt("instances", 2));
+        const bool concurrent = root.getBool("concurrent", true);
+        // Static modules keep a session per shape; shapeMutable=false skips resize checks for fixed inputs.
+        const bool shapeMutable = root.getBool("shapeMutable", true);
+        std::vector<std::string> configs;
+        if (auto* list = root.get("moduleConfigs")) {
+            for (auto& c : list->items) {
+                if (c.isString() && (c.str == "static" || c.str == "dynamic")) configs.push_back(c.str);
+            }
+        }
+        if (configs.empty()) configs = {"static", "dynamic"};
+
+        BenchRun interp = benchmarkConfig(opt, warmup, iterations);
+        std::string best = "interpreter";
+        double bestMedian = medianOf(interp.samplesMs);
+
+        std::ostringstream json;
+        json.setf(std::ios::fixed); json.precision(6);
+        json << "{\"moduleEngine\":true"
+             << ",\"backend\":\"" << opt.backend << "\""
+             << ",\"threads\":" << opt.threads
+             << ",\"interpreter\":{\"createSession_ms\":" << interp.createSessionMs
+             << ",\"memory_mb\":" << interp.memoryMb;
+        if (interp.rssBeforeBytes >= 0 && interp.rssAfterBytes >= 0) {
+            json << ",\"rss_delta_mb\":" << (double)(interp.rssAfterBytes - interp.rssBeforeBytes) / (1024.0 * 1024.0);
+        }
+        json << ",\"latency\":";
+        writeLatency(json, interp.samplesMs);
+        json << "},\"modules\":[";
+        for (size_t i = 0; i < configs.size(); ++i) {
+            EngineRun run;
+            try {
+                run = runEngine(opt, configs[i], shapeMutable, instances, warmup, iterations, concurrent);
+                const double median = medianOf(run.instances[0].samplesMs);
+                if (median > 0.0 && median < bestMedian) {
+                    bestMedian = median;
+                    best = "module_" + configs[i];
+                }
+            } catch (const std::exception& e) {
+                run.name = configs[i];
+                run.config.dynamic = configs[i] == "dynamic";
+                run.config.shapeMutable = shapeMutable;
+                run.error = e.what();
+            }
+            if (i) json << ",";
+            writeEngine(json, run, interp, iterations);
+        }
+        json << "],\"fastest\":\"" << best << "\",\"fastest_median_ms\":" << bestMedian << "}";
+        return json.str();
+    } catch (const std::exception& e) {
+        return std::string("{\"error\":\"") + jsonEscape(e.what()) + "\"}";
+    }
+}
+#elif HAVE_MNN
+std::string runModuleEngine(const std::string& configJson) {
+    (void)configJson;
+    return "{\"error\":\"Module engine needs the Express API. Ship libMNN_Express.so in jniLibs/<ABI>/ or build with MNN_EXPRESS_IN_CORE.\"}";
+}
+#else
+std::string runModuleEngine(const std::string& configJson) {
+    (void)configJson;
+    return "{\"error\":\"MNN not bundled. Cannot run module engine. Place headers and libMNN.so as documented.\"}";
+}
+#endif
+
+} // namespace runner
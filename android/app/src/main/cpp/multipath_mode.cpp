@@ -0,0 +1,406 @@
+// Multi-path execution: the model is split into user-named subgraphs (ScheduleConfig::Path in Tensor
+// mode, "inputs" -> "outputs" tensor names) and run three ways:
+//   - single: one session over the whole graph, the baseline;
+//   - multipath_session: Interpreter::createMultiPathSession with one ScheduleConfig per path
+//     (MNN runs the pipelines of such a session one after another inside runSession);
+//   - parallel: one session per path, grouped into dependency levels; the paths of a level run at
+//     the same time on their own threads (optionally pinned to "cpus"), and outputs are handed to
+//     the next level through host tensors. Pinning covers only the path's own thread (ScheduleConfig
+//     has no CPU affinity), so a pinned path defaults to one thread.
+// Interpreter::runSession holds the net's lock, so parallel paths each get their own Interpreter.
+#include "modes.hpp"
+#include "runner_common.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+
+namespace runner {
+
+#if HAVE_MNN
+namespace {
+
+struct PathSpec {
+    std::string name;
+    std::vector<std::string> inputs;
+    std::vector<std::string> outputs;
+    RunOptions opt;
+    std::vector<int> cpus;
+    std::vector<size_t> deps; // producer paths of this path's inputs
+    int level = 0;
+};
+
+std::vector<std::string> stringArray(const json::Value& obj, const std::string& key) {
+    std::vector<std::string> out;
+    if (auto* v = obj.get(key)) {
+        for (auto& s : v->items) if (s.isString()) out.push_back(s.str);
+    }
+    return out;
+}
+
+MNN::ScheduleConfig pathConfig(const PathSpec& p, MNN::BackendConfig* bcfg) {
+    MNN::ScheduleConfig cfg = makeScheduleConfig(p.opt, bcfg);
+    cfg.path.inputs = p.inputs;
+    cfg.path.outputs = p.outputs;
+    cfg.path.mode = MNN::ScheduleConfig::Path::Tensor;
+    cfg.saveTensors = p.outputs;
+    return cfg;
+}
+
+// Persistent thread running one path's session per post(); the caller waits for completion.
+class BranchWorker {
+public:
+    BranchWorker(MNN::Interpreter* net, MNN::Session* session, const std::vector<int>& cpus)
+        : net_(net), session_(session), thread_([this, cpus] { loop(cpus); }) {}
+
+    ~BranchWorker() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        thread_.join();
+    }
+
+    void post() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_ = true;
+        }
+        cv_.notify_all();
+    }
+
+    double wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return !pending_; });
+        return lastMs_;
+    }
+
+    bool pinned() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return started_; });
+        return pinned_;
+    }
+
+private:
+    void loop(std::vector<int> cpus) {
+        const bool pinned = pinCurrentThread(cpus);
+        std::unique_lock<std::mutex> lock(mutex_);
+        pinned_ = pinned;
+        started_ = true;
+        cv_.notify_all();
+        for (;;) {
+            cv_.wait(lock, [this] { return pending_ || stop_; });
+            if (stop_) return;
+            lock.unlock();
+            auto t = clock::now();
+            net_->runSession(session_);
+            const double ms = msBetween(t, clock::now());
+            lock.lock();
+            lastMs_ = ms;
+            pending_ = false;
+            cv_.notify_all();
+        }
+    }
+
+    MNN::Interpreter* net_;
+    MNN::Session* session_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool pending_ = false;
+    bool stop_ = false;
+    bool started_ = false;
+    bool pinned_ = false;
+    double lastMs_ = 0.0;
+    std::thread thread_; // last: starts after the members it uses
+};
+
+} // namespace
+#endif
+
+std::string runMultiPath(const std::string& configJson) {
+#if HAVE_MNN
+    try {
+        json::Value root = json::parse(configJson);
+        RunOptions base;
+        applyRunOptions(root, base);
+        if (base.modelPath.empty()) throw std::runtime_error("Missing modelPath");
+        const int warmup = std::max(0, root.getInt("warmup", 3));
+        const int iterations = std::max(1, root.getInt("iterations", 20));
+
+        std::vector<PathSpec> paths;
+        if (auto* list = root.get("paths")) {
+            for (size_t i = 0; i < list->items.size(); ++i) {
+                auto& item = list->items[i];
+                if (!item.isObject()) continue;
+                PathSpec p;
+                p.name = item.getString("name", "path" + std::to_string(i));
+                p.inputs = stringArray(item, "inputs");
+                p.outputs = stringArray(item, "outputs");
+                if (p.inputs.empty() || p.outputs.empty()) {
+                    throw std::runtime_error("Path " + p.name + " needs input and output tensor names");
+                }
+                p.opt = base;
+                applyRunOptions(item, p.opt);
+                if (auto* cpus = item.get("cpus")) {
+                    for (auto& c : cpus->items) if (c.isNumber()) p.cpus.push_back((int)c.number);
+                }
+                if (!item.has("threads")) p.opt.threads = p.cpus.empty() ? 0 : 1; // 0: split below
+                paths.push_back(p);
+            }
+        }
+        if (paths.size() < 2) throw std::runtime_error("Give at least two \"paths\" ({name, inputs, outputs})");
+
+        // Dependencies: a path depends on every path producing one of its inputs; level = longest chain.
+        std::set<std::string> produced, consumed;
+        for (size_t j = 0; j < paths.size(); ++j) {
+            for (auto& in : paths[j].inputs) {
+                for (size_t i = 0; i < paths.size(); ++i) {
+                    auto& deps = paths[j].deps;
+                    if (i != j && std::count(paths[i].outputs.begin(), paths[i].outputs.end(), in) &&
+                        !std::count(deps.begin(), deps.end(), i)) {
+                        deps.push_back(i);
+                    }
+                }
+                consumed.insert(in);
+            }
+            for (auto& out : paths[j].outputs) produced.insert(out);
+        }
+        for (size_t round = 0;; ++round) {
+            bool changed = false;
+            for (auto& p : paths) {
+                for (size_t d : p.deps) {
+                    if (paths[d].level + 1 > p.level) {
+                        p.level = paths[d].level + 1;
+                        changed = true;
+                    }
+                }
+            }
+            if (!changed) break;
+            if (round > paths.size()) throw std::runtime_error("Paths form a cycle");
+        }
+        int levelCount = 0;
+        for (auto& p : paths) levelCount = std::max(levelCount, p.level + 1);
+        std::vector<std::vector<size_t>> levels(levelCount);
+        for (size_t i = 0; i < paths.size(); ++i) levels[paths[i].level].push_back(i);
+        for (auto& lv : levels) {
+            for (size_t i : lv) {
+                if (paths[i].opt.threads <= 0) paths[i].opt.threads = std::max(1, base.threads / (int)lv.size());
+            }
+        }
+        // Sink outputs are what the model hands back; everything else is passed between paths.
+        std::vector<std::string> sinks;
+        for (auto& p : paths) {
+            for (auto& out : p.outputs) if (!consumed.count(out)) sinks.push_back(out);
+        }
+
+        auto net = loadInterpreter(base);
+
+        // Baseline: the whole graph in one session, keeping every path boundary tensor readable.
+        MNN::BackendConfig bcfg = makeBackendConfig(base);
+        MNN::ScheduleConfig cfg = makeScheduleConfig(base, &bcfg);
+        for (auto& p : paths) {
+            cfg.saveTensors.insert(cfg.saveTensors.end(), p.inputs.begin(), p.inputs.end());
+            cfg.saveTensors.insert(cfg.saveTensors.end(), p.outputs.begin(), p.outputs.end());
+        }
+        auto* single = net->createSession(cfg);
+        if (!single) throw std::runtime_error("Failed to create session");
+        resizeInputs(net.get(), single, base);
+        fillInputs(net.get(), single, base.inputFill);
+        for (int i = 0; i < warmup; ++i) net->runSession(single);
+        std::vector<double> singleMs;
+        for (int i = 0; i < iterations; ++i) {
+            auto t = clock::now();
+            net->runSession(single);
+            singleMs.push_back(msBetween(t, clock::now()));
+        }
+        // Path inputs as the baseline saw them: model inputs verbatim, intermediates for shapes.
+        const auto graphInputs = net->getSessionInputAll(single);
+        std::map<std::string, std::shared_ptr<MNN::Tensor>> staged;
+        for (auto& name : consumed) {
+            auto it = graphInputs.find(name);
+            const MNN::Tensor* t = it != graphInputs.end() ? it->second : net->getSessionOutput(single, name.c_str());
+            if (!t) throw std::runtime_error("Tensor not found in model: " + name);
+            staged[name] = hostCopy(t);
+        }
+        NamedOutputs reference;
+        for (auto& s : sinks) {
+            auto* t = net->getSessionOutput(single, s.c_str());
+            if (t) reference.emplace_back(s, tensorToFloat(t));
+        }
+        std::vector<std::string> external; // path inputs no path produces
+        for (auto& name : consumed) if (!produced.count(name)) external.push_back(name);
+        net->releaseSession(single);
+
+        std::ostringstream json;
+        json.setf(std::ios::fixed); json.precision(3);
+        json << "{\"multipath\":true,\"config\":\"" << describeOptions(base) << "\"";
+        json << ",\"single\":";
+        writeLatency(json, singleMs);
+
+        // createMultiPathSession: every path in one session on the same interpreter.
+        {
+            std::vector<MNN::BackendConfig> bcfgs(paths.size());
+            std::vector<MNN::ScheduleConfig> cfgs;
+            for (size_t i = 0; i < paths.size(); ++i) {
+                bcfgs[i] = makeBackendConfig(paths[i].opt);
+                cfgs.push_back(pathConfig(paths[i], &bcfgs[i]));
+            }
+            auto* multi = net->createMultiPathSession(cfgs);
+            if (!multi) {
+                json << ",\"multipath_session\":{\"error\":\"createMultiPathSession failed\"}";
+            } else {
+                loadNamedInputs(net.get(), multi, external, staged);
+                for (int i = 0; i < warmup; ++i) net->runSession(multi);
+                std::vector<double> multiMs;
+                for (int i = 0; i < iterations; ++i) {
+                    auto t = clock::now();
+                    net->runSession(multi);
+                    multiMs.push_back(msBetween(t, clock::now()));
+                }
+                NamedOutputs outs;
+                for (auto& s : sinks) {
+                    auto* t = net->getSessionOutput(multi, s.c_str());
+                    if (t) outs.emplace_back(s, tensorToFloat(t));
+                }
+                json << ",\"multipath_session\":{\"latency\":";
+                writeLatency(json, multiMs);
+                json << ",\"outputs\":";
+                writeOutputErrors(json, reference, outs);
+                json << "}";
+                net->releaseSession(multi);
+            }
+        }
+
+        // Parallel: one interpreter + session per path.
+        struct Branch {
+            std::unique_ptr<MNN::Interpreter> net;
+            MNN::Session* session = nullptr;
+            std::unique_ptr<BranchWorker> worker;
+            std::vector<double> samples;
+        };
+        const long long rssBranches0 = readRssBytes();
+        std::vector<Branch> branches(paths.size());
+        for (size_t i = 0; i < paths.size(); ++i) {
+            auto& b = branches[i];
+            b.net = loadInterpreter(paths[i].opt);
+            MNN::BackendConfig pb = makeBackendConfig(paths[i].opt);
+            MNN::ScheduleConfig pc = pathConfig(paths[i], &pb);
+            b.session = b.net->createSession(pc);
+            if (!b.session) throw std::runtime_error("Failed to create session for path " + paths[i].name);
+            // The handoff below looks these up every iteration; a name the path session does not
+            // expose fails here instead.
+            for (auto& n : paths[i].inputs) {
+                if (!b.net->getSessionInput(b.session, n.c_str())) {
+                    throw std::runtime_error("Path " + paths[i].name + " has no input tensor " + n);
+                }
+            }
+            for (auto& n : paths[i].outputs) {
+                if (!b.net->getSessionOutput(b.session, n.c_str())) {
+                    throw std::runtime_error("Path " + paths[i].name + " has no output tensor " + n);
+                }
+            }
+            loadNamedInputs(b.net.get(), b.session, paths[i].inputs, staged);
+            b.worker.reset(new BranchWorker(b.net.get(), b.session, paths[i].cpus));
+        }
+        const long long rssBranches1 = readRssBytes();
+
+        std::vector<double> wallMs, handoffMs;
+        auto iterate = [&](bool record) {
+            double handoff = 0.0;
+            auto w0 = clock::now();
+            for (auto& lv : levels) {
+                auto h0 = clock::now();
+                for (size_t i : lv) {
+                    for (size_t d : paths[i].deps) {
+                        for (auto& in : paths[i].inputs) {
+                            auto& outs = paths[d].outputs;
+                            if (!std::count(outs.begin(), outs.end(), in)) continue;
+                            auto* src = branches[d].net->getSessionOutput(branches[d].session, in.c_str());
+                            auto* dst = branches[i].net->getSessionInput(branches[i].session, in.c_str());
+                            src->copyToHostTensor(staged[in].get());
+                            dst->copyFromHostTensor(staged[in].get());
+                        }
+                    }
+                }
+                handoff += msBetween(h0, clock::now());
+                for (size_t i : lv) branches[i].worker->post();
+                for (size_t i : lv) {
+                    const double ms = branches[i].worker->wait();
+                    if (record) branches[i].samples.push_back(ms);
+                }
+            }
+            if (record) {
+                wallMs.push_back(msBetween(w0, clock::now()));
+                handoffMs.push_back(handoff);
+            }
+        };
+        for (int i = 0; i < warmup; ++i) iterate(false);
+        for (int i = 0; i < iterations; ++i) iterate(true);
+
+        NamedOutputs parallelOuts;
+        for (auto& s : sinks) {
+            for (size_t i = 0; i < paths.size(); ++i) {
+                if (!std::count(paths[i].outputs.begin(), paths[i].outputs.end(), s)) continue;
+                auto* t = branches[i].net->getSessionOutput(branches[i].session, s.c_str());
+                if (t) parallelOuts.emplace_back(s, tensorToFloat(t));
+            }
+        }
+
+        // Critical path: per level, the slowest branch (median), plus the median handoff.
+        double criticalMs = medianOf(handoffMs);
+        for (auto& lv : levels) {
+            double slowest = 0.0;
+            for (size_t i : lv) slowest = std::max(slowest, medianOf(branches[i].samples));
+            criticalMs += slowest;
+        }
+        double branchSumMs = 0.0;
+        for (auto& b : branches) branchSumMs += medianOf(b.samples);
+
+        json << ",\"parallel\":{\"latency\":";
+        writeLatency(json, wallMs);
+        json << ",\"handoff_median_ms\":" << medianOf(handoffMs)
+             << ",\"branch_sum_median_ms\":" << branchSumMs
+             << ",\"critical_path_ms\":" << criticalMs
+             << ",\"extra_rss_bytes\":" << (rssBranches0 >= 0 && rssBranches1 >= 0 ? rssBranches1 - rssBranches0 : -1)
+             << ",\"outputs\":";
+        writeOutputErrors(json, reference, parallelOuts);
+        json << "}";
+        const double parallelMedian = medianOf(wallMs);
+        json << ",\"speedup_vs_single\":" << (parallelMedian > 0.0 ? medianOf(singleMs) / parallelMedian : 0.0);
+
+        json << ",\"paths\":[";
+        for (size_t i = 0; i < paths.size(); ++i) {
+            auto& p = paths[i];
+            json << (i ? "," : "") << "{\"name\":\"" << jsonEscape(p.name) << "\""
+                 << ",\"config\":\"" << describeOptions(p.opt) << "\""
+                 << ",\"level\":" << p.level
+                 << ",\"depends_on\":[";
+            for (size_t k = 0; k < p.deps.size(); ++k) {
+                json << (k ? "," : "") << "\"" << jsonEscape(paths[p.deps[k]].name) << "\"";
+            }
+            const bool pinned = branches[i].worker->pinned();
+            // "path": the pinned thread does all the work; "driver_only": MNN's pool threads are not pinned.
+            const char* scope = !pinned ? "none" : p.opt.threads > 1 ? "driver_only" : "path";
+            json << "],\"pinned\":" << (pinned ? "true" : "false")
+                 << ",\"pin_scope\":\"" << scope << "\""
+                 << ",\"latency\":";
+            writeLatency(json, branches[i].samples);
+            json << "}";
+        }
+        json << "]}";
+        return json.str();
+    } catch (const std::exception& ex) {
+        return std::string("{\"error\":\"") + jsonEscape(ex.what()) + "\"}";
+    }
+#else
+    (void)configJson;
+    return "{\"error\":\"MNN not bundled. Cannot run multi-path sessions. Place headers and libMNN.so as documented.\"}";
+#endif
+}
+
+} // namespace runner
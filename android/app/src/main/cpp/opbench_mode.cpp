@@ -0,0 +1,395 @@
+// Single-operator microbenchmarks: each case is a one-op graph built with the Express API over a
+// shape grid, serialized and run through an Interpreter session under the configured backend,
+// precision and threads, so per-op numbers are directly comparable with whole-model runs. Reports
+// latency plus GFLOP/s and GB/s from analytic counts; cases are keyed by "name" so compareResults
+// lines them up across phones and MNN builds.
+#include "modes.hpp"
+#include "runner_common.hpp"
+#include "device_info.hpp"
+#include "executor.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+
+namespace runner {
+
+#if HAVE_MNN && HAVE_MNN_EXPRESS
+namespace {
+
+using namespace MNN::Express;
+
+const char* const kAllOps[] = {"conv", "depthwise", "matmul", "softmax", "layernorm", "elementwise", "pool"};
+
+struct OpCase {
+    std::string op;
+    std::string name;    // unique per grid point, e.g. "conv 64x64 k3 s1 56"
+    std::string params;  // JSON object describing the shape
+    double flops = 0.0;  // analytic, per run
+    double bytes = 0.0;  // activations read + written + weights, fp32
+    bool composed = false; // built from several MNN ops (no fused op in this API)
+    std::function<VARP()> build;
+};
+
+struct CaseResult {
+    std::vector<double> samplesMs;
+    double mnnMflops = 0.0;
+};
+
+std::vector<float> randomWeights(size_t n, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(-0.1f, 0.1f);
+    std::vector<float> w(n);
+    for (auto& v : w) v = dist(rng);
+    return w;
+}
+
+VARP constWeights(const std::vector<int>& shape, unsigned seed) {
+    size_t n = 1;
+    for (int d : shape) n *= (size_t)d;
+    std::vector<float> w = randomWeights(n, seed);
+    return _Const(w.data(), shape, NCHW);
+}
+
+// Grid override for one op: the config's object for `op`, or null.
+const json::Value* opConfig(const json::Value& root, const std::string& op) {
+    const json::Value* v = root.get(op);
+    return v && v->isObject() ? v : nullptr;
+}
+
+std::vector<int> gridInts(const json::Value* cfg, const std::string& key, std::vector<int> def) {
+    if (!cfg) return def;
+    std::vector<int> v = cfg->getIntArray(key);
+    v.erase(std::remove_if(v.begin(), v.end(), [](int x) { return x <= 0; }), v.end());
+    return v.empty() ? def : v;
+}
+
+// Lists of fixed-rank shapes, e.g. "shapes": [[M, K, N], ...]; malformed entries are skipped.
+std::vector<std::vector<int>> gridShapes(const json::Value* cfg, size_t rank, std::vector<std::vector<int>> def) {
+    const json::Value* list = cfg ? cfg->get("shapes") : nullptr;
+    if (!list || !list->isArray()) return def;
+    std::vector<std::vector<int>> out;
+    for (auto& s : list->items) {
+        if (!s.isArray() || s.size() != rank) continue;
+        std::vector<int> dims;
+        for (auto& d : s.items) {
+            if (d.isNumber() && d.number > 0) dims.push_back((int)d.number);
+        }
+        if (dims.size() == rank) out.push_back(dims);
+    }
+    return out.empty() ? def : out;
+}
+
+std::vector<std::string> gridStrings(const json::Value* cfg, const std::string& key, std::vector<std::string> def) {
+    const json::Value* list = cfg ? cfg->get(key) : nullptr;
+    if (!list || !list->isArray()) return def;
+    std::vector<std::string> out;
+    for (auto& s : list->items) {
+        if (s.isString()) out.push_back(s.str);
+    }
+    return out.empty() ? def : out;
+}
+
+int convOut(int size, int stride) {
+    return (size + stride - 1) / stride; // SAME padding
+}
+
+void addConvCases(std::vector<OpCase>& cases, const json::Value* cfg, int batch, bool depthwise) {
+    const std::vector<int> channels = gridInts(cfg, "channels", depthwise ? std::vector<int>{32, 64, 128, 256}
+                                                                          : std::vector<int>{16, 32, 64, 128});
+    const std::vector<int> kernels = gridInts(cfg, "kernels", depthwise ? std::vector<int>{3, 5} : std::vector<int>{1, 3});
+    const std::vector<int> strides = gridInts(cfg, "strides", {1, 2});
+    const std::vector<int> sizes = gridInts(cfg, "sizes", {56, 28});
+    for (int ch : channels) for (int k : kernels) for (int s : strides) for (int hw : sizes) {
+        // Plain convs keep input and output channels equal, like a residual-stage block.
+        const int ic = ch, oc = ch, group = depthwise ? ch : 1;
+        const int oh = convOut(hw, s);
+        OpCase c;
+        c.op = depthwise ? "depthwise" : "conv";
+        std::ostringstream name, params;
+        name << c.op << " " << ic << "x" << oc << " k" << k << " s" << s << " " << hw;
+        params << "{\"n\":" << batch << ",\"ic\":" << ic << ",\"oc\":" << oc << ",\"kernel\":" << k
+               << ",\"stride\":" << s << ",\"size\":" << hw << ",\"group\":" << group << "}";
+        c.name = name.str();
+        c.params = params.str();
+        const double weights = (double)oc * (ic / group) * k * k;
+        c.flops = 2.0 * batch * oc * oh * oh * (double)(ic / group) * k * k;
+        c.bytes = 4.0 * ((double)batch * ic * hw * hw + (double)batch * oc * oh * oh + weights + oc);
+        c.build = [=]() {
+            VARP x = _Input({batch, ic, hw, hw}, NC4HW4);
+            x->setName("x");
+            std::vector<float> w = randomWeights((size_t)weights, 7);
+            std::vector<float> b = randomWeights((size_t)oc, 11);
+            return _Conv(std::move(w), std::move(b), x, {ic, oc}, {k, k}, SAME, {s, s}, {1, 1}, group);
+        };
+        cases.push_back(std::move(c));
+    }
+}
+
+void addMatMulCases(std::vector<OpCase>& cases, const json::Value* cfg) {
+    // [M, K, N]; B is a constant, as in a linear layer. M=1 is the decode-step GEMV.
+    const auto shapes = gridShapes(cfg, 3, {{64, 64, 64}, {256, 256, 256}, {512, 512, 512},
+                                            {1, 1024, 1024}, {128, 768, 768}, {128, 768, 3072}});
+    for (auto& s : shapes) {
+        const int m = s[0], k = s[1], n = s[2];
+        OpCase c;
+        c.op = "matmul";
+        c.name = "matmul " + std::to_string(m) + "x" + std::to_string(k) + "x" + std::to_string(n);
+        c.params = "{\"m\":" + std::to_string(m) + ",\"k\":" + std::to_string(k) + ",\"n\":" + std::to_string(n) + "}";
+        c.flops = 2.0 * m * k * n;
+        c.bytes = 4.0 * ((double)m * k + (double)k * n + (double)m * n);
+        c.build = [=]() {
+            VARP a = _Input({m, k}, NCHW);
+            a->setName("a");
+            return _MatMul(a, constWeights({k, n}, 13));
+        };
+        cases.push_back(std::move(c));
+    }
+}
+
+// Row-wise ops over [rows, cols]; `flopsPerElement` is a nominal count for the exp/rsqrt-based math.
+void addRowCases(std::vector<OpCase>& cases, const json::Value* cfg, const std::string& op,
+                 std::vector<std::vector<int>> def, double flopsPerElement) {
+    for (auto& s : gridShapes(cfg, 2, std::move(def))) {
+        const int rows = s[0], cols = s[1];
+        OpCase c;
+        c.op = op;
+        c.name = op + " " + std::to_string(rows) + "x" + std::to_string(cols);
+        c.params = "{\"rows\":" + std::to_string(rows) + ",\"cols\":" + std::to_string(cols) + "}";
+        const double elements = (double)rows * cols;
+        c.flops = flopsPerElement * elements;
+        c.bytes = 4.0 * 2.0 * elements;
+        if (op == "softmax") {
+            c.build = [=]() {
+                VARP x = _Input({rows, cols}, NCHW);
+                x->setName("x");
+                return _Softmax(x, -1);
+            };
+        } else {
+            // No LayerNorm builder in this Express API: mean / variance / rsqrt / affine, as a
+            // converter without the fused op would emit it.
+            c.composed = true;
+            c.bytes += 4.0 * 2.0 * cols;
+            c.build = [=]() {
+                VARP x = _Input({rows, cols}, NCHW);
+                x->setName("x");
+                VARP d = _Subtract(x, _ReduceMean(x, {-1}, true));
+                VARP var = _ReduceMean(_Square(d), {-1}, true);
+                VARP y = _Multiply(d, _Rsqrt(_Add(var, _Scalar<float>(1e-5f))));
+                return _Add(_Multiply(y, constWeights({cols}, 17)), constWeights({cols}, 19));
+            };
+        }
+        cases.push_back(std::move(c));
+    }
+}
+
+void addElementwiseCases(std::vector<OpCase>& cases, const json::Value* cfg) {
+    const auto kinds = gridStrings(cfg, "kinds", {"add", "mul", "relu", "sigmoid", "gelu"});
+    const auto shapes = gridShapes(cfg, 4, {{1, 64, 56, 56}, {1, 256, 14, 14}});
+    for (auto& kind : kinds) {
+        // Nominal FLOPs per element: sigmoid as exp + add + div, gelu as its tanh approximation.
+        double perElement = 0.0;
+        int operands = 1;
+        if (kind == "add" || kind == "mul") { perElement = 1.0; operands = 2; }
+        else if (kind == "relu") perElement = 1.0;
+        else if (kind == "sigmoid") perElement = 4.0;
+        else if (kind == "gelu") perElement = 8.0;
+        else continue;
+        for (auto& s : shapes) {
+            OpCase c;
+            c.op = "elementwise";
+            std::ostringstream name, params;
+            name << kind << " " << s[0] << "x" << s[1] << "x" << s[2] << "x" << s[3];
+            params << "{\"kind\":\"" << jsonEscape(kind) << "\",\"shape\":[" << s[0] << "," << s[1] << "," << s[2]
+                   << "," << s[3] << "]}";
+            c.name = name.str();
+            c.params = params.str();
+            const double elements = (double)s[0] * s[1] * s[2] * s[3];
+            c.flops = perElement * elements;
+            c.bytes = 4.0 * (operands + 1) * elements;
+            const std::vector<int> shape = s;
+            c.build = [=]() {
+                VARP x = _Input(shape, NCHW);
+                x->setName("x");
+                if (kind == "add" || kind == "mul") {
+                    VARP y = _Input(shape, NCHW);
+                    y->setName("y");
+                    return kind == "add" ? _Add(x, y) : _Multiply(x, y);
+                }
+                if (kind == "relu") return _Relu(x);
+                if (kind == "sigmoid") return _Sigmoid(x);
+                return _Gelu(x);
+            };
+            cases.push_back(std::move(c));
+        }
+    }
+}
+
+void addPoolCases(std::vector<OpCase>& cases, const json::Value* cfg, int batch) {
+    const auto kinds = gridStrings(cfg, "kinds", {"max", "avg"});
+    const std::vector<int> channels = gridInts(cfg, "channels", {64, 256});
+    const std::vector<int> kernels = gridInts(cfg, "kernels", {2, 3});
+    const std::vector<int> strides = gridInts(cfg, "strides", {2});
+    const std::vector<int> sizes = gridInts(cfg, "sizes", {56, 28});
+    for (auto& kind : kinds) {
+        if (kind != "max" && kind != "avg") continue;
+        for (int ch : channels) for (int k : kernels) for (int s : strides) for (int hw : sizes) {
+            if (k > hw) continue;
+            const int oh = (hw - k) / s + 1; // VALID padding
+            OpCase c;
+            c.op = "pool";
+            std::ostringstream name, params;
+            name << kind << "pool c" << ch << " k" << k << " s" << s << " " << hw;
+            params << "{\"kind\":\"" << kind << "\",\"n\":" << batch << ",\"channels\":" << ch << ",\"kernel\":" << k
+                   << ",\"stride\":" << s << ",\"size\":" << hw << "}";
+            c.name = name.str();
+            c.params = params.str();
+            c.flops = (double)batch * ch * oh * oh * k * k;
+            c.bytes = 4.0 * ((double)batch * ch * hw * hw + (double)batch * ch * oh * oh);
+            c.build = [=]() {
+                VARP x = _Input({batch, ch, hw, hw}, NC4HW4);
+                x->setName("x");
+                return kind == "max" ? _MaxPool(x, {k, k}, {s, s}, VALID) : _AvePool(x, {k, k}, {s, s}, VALID);
+            };
+            cases.push_back(std::move(c));
+        }
+    }
+}
+
+// Serialize the one-op graph and time it through a regular session, mapping the output after each
+// run so asynchronous backends finish inside the timing.
+CaseResult runCase(const OpCase& c, const RunOptions& opt, int warmup, int iterations, double budgetMs) {
+    CaseResult r;
+    VARP y = c.build();
+    y->setName("y");
+    const std::vector<int8_t> buffer = Variable::save({y});
+    std::unique_ptr<MNN::Interpreter> net(MNN::Interpreter::createFromBuffer(buffer.data(), buffer.size()));
+    if (!net) throw std::runtime_error("Failed to load the serialized graph");
+    MNN::BackendConfig bcfg = makeBackendConfig(opt);
+    MNN::ScheduleConfig cfg = makeScheduleConfig(opt, &bcfg);
+    MNN::Session* session = net->createSession(cfg);
+    if (!session) throw std::runtime_error("Failed to create session");
+    net->getSessionInfo(session, MNN::Interpreter::FLOPS, &r.mnnMflops);
+    fillInputs(net.get(), session, opt.inputFill);
+    MNN::Tensor* out = net->getSessionOutput(session, nullptr);
+    auto runOnce = [&]() {
+        const MNN::ErrorCode code = net->runSession(session);
+        if (code != MNN::NO_ERROR) throw std::runtime_error("runSession failed with code " + std::to_string((int)code));
+        if (out) out->wait(MNN::Tensor::MAP_TENSOR_READ, true);
+    };
+    for (int i = 0; i < warmup; ++i) {
+        runOnce();
+        yieldPoint();
+    }
+    // The budget bounds slow cases (large convs on a little core); at least 3 samples are kept.
+    auto start = clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        auto t0 = clock::now();
+        runOnce();
+        r.samplesMs.push_back(msBetween(t0, clock::now()));
+        yieldPoint();
+        if (i >= 2 && budgetMs > 0.0 && msBetween(start, clock::now()) > budgetMs) break;
+    }
+    net->releaseSession(session);
+    return r;
+}
+
+} // namespace
+
+std::string runOpBench(const std::string& configJson) {
+    try {
+        json::Value root = json::parse(configJson.empty() ? "{}" : configJson);
+        RunOptions opt;
+        opt.inputFill = "UNIFORM"; // zero inputs can hit fast paths (e.g. exp(0)) real data does not
+        applyRunOptions(root, opt);
+        const int warmup = std::max(0, root.getInt("warmup", 3));
+        const int iterations = std::max(1, root.getInt("iterations", 20));
+        const double budgetMs = root.getNumber("maxMsPerCase", 2000.0);
+        const int batch = std::max(1, root.getInt("batch", 1));
+        std::vector<std::string> ops = gridStrings(&root, "ops", std::vector<std::string>(std::begin(kAllOps), std::end(kAllOps)));
+
+        std::vector<OpCase> cases;
+        for (auto& op : ops) {
+            const json::Value* cfg = opConfig(root, op);
+            if (op == "conv") addConvCases(cases, cfg, batch, false);
+            else if (op == "depthwise") addConvCases(cases, cfg, batch, true);
+            else if (op == "matmul") addMatMulCases(cases, cfg);
+            else if (op == "softmax") addRowCases(cases, cfg, op, {{128, 128}, {512, 512}, {64, 1000}, {1, 32000}}, 5.0);
+            else if (op == "layernorm") addRowCases(cases, cfg, op, {{128, 768}, {196, 384}, {512, 1024}}, 8.0);
+            else if (op == "elementwise") addElementwiseCases(cases, cfg);
+            else if (op == "pool") addPoolCases(cases, cfg, batch);
+            else throw std::runtime_error("Unknown op '" + op + "'");
+        }
+        if (cases.empty()) throw std::runtime_error("No op cases selected");
+
+        // Per op: GFLOP/s of each successful case, and the case that reached the best.
+        std::vector<std::string> opOrder;
+        std::map<std::string, std::vector<double>> opGflops;
+        std::map<std::string, std::pair<double, std::string>> opBest;
+        std::ostringstream json;
+        json.setf(std::ios::fixed); json.precision(6);
+        auto t0 = clock::now();
+        json << "{\"opBench\":true"
+             << ",\"config\":\"" << jsonEscape(describeOptions(opt)) << "\""
+             << ",\"backend\":\"" << opt.backend << "\""
+             << ",\"precision\":\"" << opt.precisionMode << "\""
+             << ",\"threads\":" << opt.threads
+             << ",\"device\":";
+        writeDeviceJson(json, deviceInfo());
+        json << ",\"cases\":[";
+        for (size_t i = 0; i < cases.size(); ++i) {
+            const OpCase& c = cases[i];
+            if (i) json << ",";
+            json << "{\"name\":\"" << jsonEscape(c.name) << "\",\"op\":\"" << c.op << "\",\"params\":" << c.params
+                 << ",\"flops\":" << c.flops << ",\"bytes\":" << c.bytes;
+            if (c.composed) json << ",\"composed\":true";
+            if (std::find(opOrder.begin(), opOrder.end(), c.op) == opOrder.end()) opOrder.push_back(c.op);
+            try {
+                CaseResult r = runCase(c, opt, warmup, iterations, budgetMs);
+                const double median = medianOf(r.samplesMs);
+                const double gflops = median > 0.0 ? c.flops / (median * 1e6) : 0.0;
+                json << ",\"mnn_mflops\":" << r.mnnMflops
+                     << ",\"median_ms\":" << median
+                     << ",\"gflops\":" << gflops
+                     << ",\"gbps\":" << (median > 0.0 ? c.bytes / (median * 1e6) : 0.0)
+                     << ",\"latency\":";
+                writeLatency(json, r.samplesMs);
+                opGflops[c.op].push_back(gflops);
+                auto& best = opBest[c.op];
+                if (gflops > best.first) best = {gflops, c.name};
+            } catch (const std::exception& e) {
+                json << ",\"error\":\"" << jsonEscape(e.what()) << "\"";
+            }
+            json << "}";
+        }
+        json << "],\"summary\":[";
+        for (size_t i = 0; i < opOrder.size(); ++i) {
+            const std::string& op = opOrder[i];
+            const auto& g = opGflops[op];
+            json << (i ? "," : "") << "{\"op\":\"" << op << "\",\"cases\":" << g.size()
+                 << ",\"median_gflops\":" << medianOf(g)
+                 << ",\"best_gflops\":" << opBest[op].first
+                 << ",\"best_case\":\"" << jsonEscape(opBest[op].second) << "\"}";
+        }
+        json << "],\"elapsed_ms\":" << msBetween(t0, clock::now()) << "}";
+        return json.str();
+    } catch (const std::exception& e) {
+        return std::string("{\"error\":\"") + jsonEscape(e.what()) + "\"}";
+    }
+}
+#elif HAVE_MNN
+std::string runOpBench(const std::string& configJson) {
+    (void)configJson;
+    return "{\"error\":\"Op microbenchmarks need the Express API. Ship libMNN_Express.so in jniLibs/<ABI>/ or build with MNN_EXPRESS_IN_CORE.\"}";
+}
+#else
+std::string runOpBench(const std::string& configJson) {
+    (void)configJson;
+    return "{\"error\":\"MNN not bundled. Cannot run op microbenchmarks. Place headers and libMNN.so as documented.\"}";
+}
+#endif
+
+} // namespace runner
@@ -0,0 +1,378 @@
+// Pipeline-parallel streaming: the model is cut at user-chosen tensors ("splits") into stages, each a
+// ScheduleConfig::Path (Tensor mode) session on its own Interpreter and thread, pinned to a core
+// cluster. Frames flow between stages through bounded slot pools, so a slow stage back-pressures the
+// ones before it. Compared with the whole model on all cores, frame by frame: both sides upload the
+// inputs and read the outputs back to the host for every frame.
+//
+// Only the stage's own thread is pinned; ScheduleConfig has no CPU affinity, so MNN's pool threads
+// go wherever the scheduler puts them. A pinned stage therefore defaults to one thread, which keeps
+// all of its work on its cores; "pin_scope" in the report says which case each stage ran in.
+//
+// Per stage: busy (runSession), copy (handoff in/out), starved (waiting for the previous stage) and
+// blocked (waiting for a free slot downstream). Everything but busy time is pipeline bubble.
+#include "modes.hpp"
+#include "runner_common.hpp"
+#include "device_info.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace runner {
+
+#if HAVE_MNN
+namespace {
+
+// Boundary tensors of one frame between two stages.
+struct Slot {
+    std::map<std::string, std::shared_ptr<MNN::Tensor>> tensors;
+    int frame = 0;
+    clock::time_point start;
+};
+
+class SlotQueue {
+public:
+    void push(Slot* s) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            items_.push_back(s);
+        }
+        cv_.notify_one();
+    }
+    // nullptr once closed and drained.
+    Slot* pop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return !items_.empty() || closed_; });
+        if (items_.empty()) return nullptr;
+        Slot* s = items_.front();
+        items_.pop_front();
+        return s;
+    }
+    // Accept frames again after a drained run.
+    void reopen() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = false;
+    }
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        cv_.notify_all();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Slot*> items_;
+    bool closed_ = false;
+};
+
+// Between stage i and i+1: `free` holds queueDepth slots, so at most that many frames are in flight.
+struct Edge {
+    std::vector<std::unique_ptr<Slot>> slots;
+    SlotQueue ready;
+    SlotQueue free;
+};
+
+struct Stage {
+    std::vector<std::string> inputs;
+    std::vector<std::string> outputs;
+    RunOptions opt;
+    std::vector<int> cpus;
+    std::unique_ptr<MNN::Interpreter> net;
+    MNN::Session* session = nullptr;
+    bool pinned = false;
+    double busyMs = 0.0;
+    double copyMs = 0.0;
+    double starvedMs = 0.0;
+    double blockedMs = 0.0;
+    int frames = 0;
+};
+
+std::vector<std::string> namesOf(const json::Value& v) {
+    std::vector<std::string> out;
+    if (v.isString()) out.push_back(v.str);
+    for (auto& s : v.items) if (s.isString()) out.push_back(s.str);
+    return out;
+}
+
+struct PipelineRun {
+    std::vector<double> latencyMs;         // per frame, first stage start to last stage end
+    std::vector<clock::time_point> doneAt; // completion time per frame
+    double wallMs = 0.0;
+    NamedOutputs lastOutputs;
+};
+
+PipelineRun runFrames(std::vector<Stage>& stages, std::vector<Edge>& edges, int frames,
+                      const std::map<std::string, std::shared_ptr<MNN::Tensor>>& source,
+                      const std::map<std::string, std::shared_ptr<MNN::Tensor>>& sink) {
+    PipelineRun run;
+    run.latencyMs.resize(frames);
+    run.doneAt.resize(frames);
+    for (auto& st : stages) st.busyMs = st.copyMs = st.starvedMs = st.blockedMs = 0.0, st.frames = 0;
+    const size_t last = stages.size() - 1;
+
+    auto stageLoop = [&](size_t s) {
+        Stage& st = stages[s];
+        st.pinned = pinCurrentThread(st.cpus);
+        int next = 0;
+        for (;;) {
+            int frame = 0;
+            clock::time_point start;
+            auto c0 = clock::now();
+            if (s == 0) {
+                if (next >= frames) break;
+                frame = next++;
+                start = c0;
+                for (auto& n : st.inputs) st.net->getSessionInput(st.session, n.c_str())->copyFromHostTensor(source.at(n).get());
+            } else {
+                Slot* in = edges[s - 1].ready.pop();
+                auto c1 = clock::now();
+                st.starvedMs += msBetween(c0, c1);
+                if (!in) break;
+                c0 = c1;
+                frame = in->frame;
+                start = in->start;
+                for (auto& n : st.inputs) st.net->getSessionInput(st.session, n.c_str())->copyFromHostTensor(in->tensors[n].get());
+                edges[s - 1].free.push(in);
+            }
+            auto r0 = clock::now();
+            st.copyMs += msBetween(c0, r0);
+            st.net->runSession(st.session);
+            auto r1 = clock::now();
+            st.busyMs += msBetween(r0, r1);
+            st.frames++;
+            if (s < last) {
+                Slot* out = edges[s].free.pop();
+                auto o0 = clock::now();
+                st.blockedMs += msBetween(r1, o0);
+                for (auto& n : st.outputs) st.net->getSessionOutput(st.session, n.c_str())->copyToHostTensor(out->tensors[n].get());
+                out->frame = frame;
+                out->start = start;
+                st.copyMs += msBetween(o0, clock::now());
+                edges[s].ready.push(out);
+            } else {
+                for (auto& n : st.outputs) st.net->getSessionOutput(st.session, n.c_str())->copyToHostTensor(sink.at(n).get());
+                const auto end = clock::now();
+                st.copyMs += msBetween(r1, end);
+                run.latencyMs[frame] = msBetween(start, end);
+                run.doneAt[frame] = end;
+            }
+        }
+        if (s < last) edges[s].ready.close();
+    };
+
+    auto w0 = clock::now();
+    std::vector<std::thread> threads;
+    for (size_t s = 0; s < stages.size(); ++s) threads.emplace_back(stageLoop, s);
+    for (auto& t : threads) t.join();
+    run.wallMs = msBetween(w0, clock::now());
+
+    // Every slot is back in its free pool; reopen for the next run.
+    for (auto& e : edges) e.ready.reopen();
+    Stage& tail = stages[last];
+    for (auto& n : tail.outputs) {
+        auto* t = tail.net->getSessionOutput(tail.session, n.c_str());
+        if (t) run.lastOutputs.emplace_back(n, tensorToFloat(t));
+    }
+    return run;
+}
+
+// Frames/s over the frames after the warmup ones, from their completion times.
+double steadyFps(const std::vector<clock::time_point>& doneAt, int warmup) {
+    const int n = (int)doneAt.size();
+    if (n - warmup < 2) return 0.0;
+    const double ms = msBetween(doneAt[warmup], doneAt[n - 1]);
+    return ms > 0.0 ? (n - 1 - warmup) * 1000.0 / ms : 0.0;
+}
+
+} // namespace
+#endif
+
+std::string runPipeline(const std::string& configJson) {
+#if HAVE_MNN
+    try {
+        json::Value root = json::parse(configJson);
+        RunOptions base;
+        applyRunOptions(root, base);
+        if (base.modelPath.empty()) throw std::runtime_error("Missing modelPath");
+        const int frames = std::max(4, root.getInt("frames", 200));
+        const int warmupFrames = std::min(frames / 2, std::max(0, root.getInt("warmupFrames", 10)));
+        const int queueDepth = std::max(1, root.getInt("queueDepth", 2));
+
+        std::vector<std::vector<std::string>> cuts;
+        if (auto* splits = root.get("splits")) {
+            for (auto& v : splits->items) {
+                auto names = namesOf(v);
+                if (!names.empty()) cuts.push_back(names);
+            }
+        }
+        if (cuts.empty()) throw std::runtime_error("Give \"splits\": tensor names (or lists of names) to cut the graph at");
+
+        const DeviceInfo& dev = deviceInfo();
+
+        // Baseline: whole model on all cores; per frame upload, run and read back the outputs.
+        RunOptions whole = base;
+        whole.threads = root.getInt("baselineThreads", dev.cores);
+        auto net = loadInterpreter(whole);
+        MNN::BackendConfig bcfg = makeBackendConfig(whole);
+        MNN::ScheduleConfig cfg = makeScheduleConfig(whole, &bcfg);
+        for (auto& c : cuts) cfg.saveTensors.insert(cfg.saveTensors.end(), c.begin(), c.end());
+        auto* session = net->createSession(cfg);
+        if (!session) throw std::runtime_error("Failed to create session");
+        resizeInputs(net.get(), session, whole);
+        fillInputs(net.get(), session, whole.inputFill);
+
+        std::vector<std::string> graphInputs, graphOutputs;
+        std::map<std::string, std::shared_ptr<MNN::Tensor>> source, outHost;
+        for (auto& kv : net->getSessionInputAll(session)) {
+            graphInputs.push_back(kv.first);
+            source[kv.first] = hostCopy(kv.second);
+        }
+        net->runSession(session);
+        std::map<std::string, std::shared_ptr<MNN::Tensor>> boundary; // cut tensors, for slot shapes
+        for (auto& c : cuts) {
+            for (auto& n : c) {
+                auto* t = net->getSessionOutput(session, n.c_str());
+                if (!t) throw std::runtime_error("Split tensor not found: " + n);
+                boundary[n] = hostCopy(t);
+            }
+        }
+        for (auto& kv : net->getSessionOutputAll(session)) {
+            graphOutputs.push_back(kv.first);
+            outHost[kv.first] = hostCopy(kv.second);
+        }
+
+        std::vector<double> baseLatency;
+        std::vector<clock::time_point> baseDone;
+        auto b0 = clock::now();
+        for (int f = 0; f < frames; ++f) {
+            auto t = clock::now();
+            for (auto& kv : source) net->getSessionInput(session, kv.first.c_str())->copyFromHostTensor(kv.second.get());
+            net->runSession(session);
+            for (auto& kv : outHost) net->getSessionOutput(session, kv.first.c_str())->copyToHostTensor(kv.second.get());
+            auto e = clock::now();
+            baseLatency.push_back(msBetween(t, e));
+            baseDone.push_back(e);
+        }
+        const double baseWallMs = msBetween(b0, clock::now());
+        NamedOutputs reference;
+        for (auto& n : graphOutputs) reference.emplace_back(n, tensorToFloat(net->getSessionOutput(session, n.c_str())));
+        net->releaseSession(session);
+        net.reset();
+
+        // Stages: cut i ends stage i; by default stage i runs on cluster i (fastest first) with one
+        // thread. "stages": [{threads, cpus, cluster, backend, precisionMode}] overrides.
+        const size_t stageCount = cuts.size() + 1;
+        std::vector<Stage> stages(stageCount);
+        const json::Value* overrides = root.get("stages");
+        for (size_t s = 0; s < stageCount; ++s) {
+            Stage& st = stages[s];
+            st.inputs = s == 0 ? graphInputs : cuts[s - 1];
+            st.outputs = s + 1 == stageCount ? graphOutputs : cuts[s];
+            st.opt = base;
+            const json::Value* o = overrides && s < overrides->items.size() ? &overrides->items[s] : nullptr;
+            size_t cluster = dev.clusters.empty() ? 0 : s % dev.clusters.size();
+            if (o) {
+                applyRunOptions(*o, st.opt);
+                if (o->has("cluster") && !dev.clusters.empty()) {
+                    cluster = (size_t)std::max(0, o->getInt("cluster", 0)) % dev.clusters.size();
+                }
+                if (auto* cpus = o->get("cpus")) {
+                    for (auto& c : cpus->items) if (c.isNumber()) st.cpus.push_back((int)c.number);
+                }
+            }
+            if (st.cpus.empty() && !dev.clusters.empty()) st.cpus = dev.clusters[cluster];
+            if (!o || !o->has("threads")) st.opt.threads = 1;
+
+            st.net = loadInterpreter(st.opt);
+            MNN::BackendConfig sb = makeBackendConfig(st.opt);
+            MNN::ScheduleConfig sc = makeScheduleConfig(st.opt, &sb);
+            sc.path.inputs = st.inputs;
+            sc.path.outputs = st.outputs;
+            sc.path.mode = MNN::ScheduleConfig::Path::Tensor;
+            sc.saveTensors = st.outputs;
+            st.session = st.net->createSession(sc);
+            if (!st.session) throw std::runtime_error("Failed to create session for stage " + std::to_string(s));
+            loadNamedInputs(st.net.get(), st.session, st.inputs, s == 0 ? source : boundary);
+        }
+        std::vector<Edge> edges(stageCount - 1);
+        for (size_t e = 0; e < edges.size(); ++e) {
+            for (int i = 0; i < queueDepth; ++i) {
+                std::unique_ptr<Slot> slot(new Slot());
+                for (auto& n : cuts[e]) {
+                    auto& shape = boundary.at(n);
+                    slot->tensors[n].reset(new MNN::Tensor(shape.get(), shape->getDimensionType()));
+                }
+                edges[e].free.push(slot.get());
+                edges[e].slots.push_back(std::move(slot));
+            }
+        }
+
+        (void)runFrames(stages, edges, std::max(2, warmupFrames), source, outHost);
+        PipelineRun run = runFrames(stages, edges, frames, source, outHost);
+
+        const double baseFps = steadyFps(baseDone, warmupFrames);
+        const double pipeFps = steadyFps(run.doneAt, warmupFrames);
+        double bubbleMs = 0.0;
+        for (auto& st : stages) bubbleMs += std::max(0.0, run.wallMs - st.busyMs);
+
+        std::ostringstream json;
+        json.setf(std::ios::fixed); json.precision(3);
+        json << "{\"pipeline\":true,\"config\":\"" << describeOptions(base) << "\""
+             << ",\"frames\":" << frames << ",\"warmup_frames\":" << warmupFrames << ",\"queue_depth\":" << queueDepth
+             << ",\"baseline\":{\"threads\":" << whole.threads
+             << ",\"fps\":" << baseFps
+             << ",\"wall_ms\":" << baseWallMs
+             << ",\"latency\":";
+        writeLatency(json, baseLatency);
+        json << "},\"pipelined\":{\"fps\":" << pipeFps
+             << ",\"wall_ms\":" << run.wallMs
+             << ",\"bubble_ms\":" << bubbleMs
+             << ",\"bubble_fraction\":" << (run.wallMs > 0.0 ? bubbleMs / (run.wallMs * stageCount) : 0.0)
+             << ",\"latency\":";
+        writeLatency(json, run.latencyMs);
+        json << ",\"outputs\":";
+        writeOutputErrors(json, reference, run.lastOutputs);
+        json << "},\"speedup_fps\":" << (baseFps > 0.0 ? pipeFps / baseFps : 0.0);
+        json << ",\"stages\":[";
+        for (size_t s = 0; s < stageCount; ++s) {
+            const Stage& st = stages[s];
+            json << (s ? "," : "") << "{\"index\":" << s
+                 << ",\"config\":\"" << describeOptions(st.opt) << "\""
+                 << ",\"cpus\":[";
+            for (size_t i = 0; i < st.cpus.size(); ++i) json << (i ? "," : "") << st.cpus[i];
+            // "stage": the pinned thread does all the work; "driver_only": MNN's pool threads are not pinned.
+            const char* scope = !st.pinned ? "none" : st.opt.threads > 1 ? "driver_only" : "stage";
+            json << "],\"pinned\":" << (st.pinned ? "true" : "false")
+                 << ",\"pin_scope\":\"" << scope << "\""
+                 << ",\"inputs\":[";
+            for (size_t i = 0; i < st.inputs.size(); ++i) json << (i ? "," : "") << "\"" << jsonEscape(st.inputs[i]) << "\"";
+            json << "],\"outputs\":[";
+            for (size_t i = 0; i < st.outputs.size(); ++i) json << (i ? "," : "") << "\"" << jsonEscape(st.outputs[i]) << "\"";
+            json << "],\"busy_ms\":" << st.busyMs
+                 << ",\"busy_per_frame_ms\":" << (st.frames ? st.busyMs / st.frames : 0.0)
+                 << ",\"copy_ms\":" << st.copyMs
+                 << ",\"starved_ms\":" << st.starvedMs
+                 << ",\"blocked_ms\":" << st.blockedMs
+                 << ",\"utilization\":" << (run.wallMs > 0.0 ? st.busyMs / run.wallMs : 0.0) << "}";
+        }
+        json << "],\"device\":";
+        writeDeviceJson(json, dev);
+        json << "}";
+        return json.str();
+    } catch (const std::exception& ex) {
+        return std::string("{\"error\":\"") + jsonEscape(ex.what()) + "\"}";
+    }
+#else
+    (void)configJson;
+    return "{\"error\":\"MNN not bundled. Cannot run the stage pipeline. Place headers and libMNN.so as documented.\"}";
+#endif
+}
+
+} // namespace runner
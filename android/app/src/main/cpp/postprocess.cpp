@@ -0,0 +1,331 @@
+#include "postprocess.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define RUNNER_POST_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define RUNNER_POST_SSE 1
+#endif
+
+namespace runner {
+
+namespace {
+
+// Cephes-style expf: x = n*ln2 + r, a degree-5 polynomial for e^r and 2^n written into the exponent
+// bits. Relative error is about 2e-7 over the clamped range, below what softmax scores need.
+constexpr float kExpHi = 88.3762626647949f;
+constexpr float kExpLo = -88.3762626647949f;
+constexpr float kLog2e = 1.44269504088896341f;
+constexpr float kLn2Hi = 0.693359375f;
+constexpr float kLn2Lo = -2.12194440e-4f;
+constexpr float kP0 = 1.9875691500e-4f;
+constexpr float kP1 = 1.3981999507e-3f;
+constexpr float kP2 = 8.3334519073e-3f;
+constexpr float kP3 = 4.1665795894e-2f;
+constexpr float kP4 = 1.6666665459e-1f;
+constexpr float kP5 = 5.0000001201e-1f;
+
+#if RUNNER_POST_NEON
+float32x4_t expV(float32x4_t x) {
+    x = vminq_f32(vmaxq_f32(x, vdupq_n_f32(kExpLo)), vdupq_n_f32(kExpHi));
+    float32x4_t fx = vmlaq_f32(vdupq_n_f32(0.5f), x, vdupq_n_f32(kLog2e));
+    const float32x4_t t = vcvtq_f32_s32(vcvtq_s32_f32(fx));
+    const uint32x4_t over = vcgtq_f32(t, fx); // truncation rounded up: step back to the floor
+    fx = vsubq_f32(t, vreinterpretq_f32_u32(vandq_u32(over, vreinterpretq_u32_f32(vdupq_n_f32(1.0f)))));
+    x = vmlsq_f32(x, fx, vdupq_n_f32(kLn2Hi));
+    x = vmlsq_f32(x, fx, vdupq_n_f32(kLn2Lo));
+    const float32x4_t z = vmulq_f32(x, x);
+    float32x4_t y = vdupq_n_f32(kP0);
+    y = vmlaq_f32(vdupq_n_f32(kP1), y, x);
+    y = vmlaq_f32(vdupq_n_f32(kP2), y, x);
+    y = vmlaq_f32(vdupq_n_f32(kP3), y, x);
+    y = vmlaq_f32(vdupq_n_f32(kP4), y, x);
+    y = vmlaq_f32(vdupq_n_f32(kP5), y, x);
+    y = vaddq_f32(vmlaq_f32(x, y, z), vdupq_n_f32(1.0f));
+    const int32x4_t pow2n = vshlq_n_s32(vaddq_s32(vcvtq_s32_f32(fx), vdupq_n_s32(127)), 23);
+    return vmulq_f32(y, vreinterpretq_f32_s32(pow2n));
+}
+
+float hmax(float32x4_t v) {
+    float32x2_t m = vpmax_f32(vget_low_f32(v), vget_high_f32(v));
+    m = vpmax_f32(m, m);
+    return vget_lane_f32(m, 0);
+}
+
+float hsum(float32x4_t v) {
+    float32x2_t s = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+    s = vpadd_f32(s, s);
+    return vget_lane_f32(s, 0);
+}
+#elif RUNNER_POST_SSE
+__m128 expV(__m128 x) {
+    x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(kExpLo)), _mm_set1_ps(kExpHi));
+    __m128 fx = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(kLog2e)), _mm_set1_ps(0.5f));
+    const __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(fx));
+    fx = _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, fx), _mm_set1_ps(1.0f)));
+    x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(kLn2Hi)));
+    x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(kLn2Lo)));
+    const __m128 z = _mm_mul_ps(x, x);
+    __m128 y = _mm_set1_ps(kP0);
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(kP1));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(kP2));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(kP3));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(kP4));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(kP5));
+    y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(y, z), x), _mm_set1_ps(1.0f));
+    const __m128i pow2n = _mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(fx), _mm_set1_epi32(127)), 23);
+    return _mm_mul_ps(y, _mm_castsi128_ps(pow2n));
+}
+
+float hmax(__m128 v) {
+    v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtss_f32(v);
+}
+
+float hsum(__m128 v) {
+    v = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtss_f32(v);
+}
+#endif
+
+float maxOf(const float* x, int n) {
+    int i = 0;
+    float m = -INFINITY;
+#if RUNNER_POST_NEON
+    if (n >= 4) {
+        float32x4_t v = vld1q_f32(x);
+        for (i = 4; i + 4 <= n; i += 4) v = vmaxq_f32(v, vld1q_f32(x + i));
+        m = hmax(v);
+    }
+#elif RUNNER_POST_SSE
+    if (n >= 4) {
+        __m128 v = _mm_loadu_ps(x);
+        for (i = 4; i + 4 <= n; i += 4) v = _mm_max_ps(v, _mm_loadu_ps(x + i));
+        m = hmax(v);
+    }
+#endif
+    for (; i < n; ++i) m = std::max(m, x[i]);
+    return m;
+}
+
+} // namespace
+
+void softmaxInPlace(float* x, int n) {
+    if (n <= 0) return;
+    const float mx = maxOf(x, n);
+    float sum = 0.0f;
+    int i = 0;
+#if RUNNER_POST_NEON
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    const float32x4_t vmx = vdupq_n_f32(mx);
+    for (; i + 4 <= n; i += 4) {
+        const float32x4_t e = expV(vsubq_f32(vld1q_f32(x + i), vmx));
+        vst1q_f32(x + i, e);
+        acc = vaddq_f32(acc, e);
+    }
+    sum = hsum(acc);
+#elif RUNNER_POST_SSE
+    __m128 acc = _mm_setzero_ps();
+    const __m128 vmx = _mm_set1_ps(mx);
+    for (; i + 4 <= n; i += 4) {
+        const __m128 e = expV(_mm_sub_ps(_mm_loadu_ps(x + i), vmx));
+        _mm_storeu_ps(x + i, e);
+        acc = _mm_add_ps(acc, e);
+    }
+    sum = hsum(acc);
+#endif
+    for (; i < n; ++i) {
+        x[i] = std::exp(x[i] - mx);
+        sum += x[i];
+    }
+    const float inv = sum > 0.0f ? 1.0f / sum : 0.0f;
+    i = 0;
+#if RUNNER_POST_NEON
+    for (; i + 4 <= n; i += 4) vst1q_f32(x + i, vmulq_n_f32(vld1q_f32(x + i), inv));
+#elif RUNNER_POST_SSE
+    for (; i + 4 <= n; i += 4) _mm_storeu_ps(x + i, _mm_mul_ps(_mm_loadu_ps(x + i), _mm_set1_ps(inv)));
+#endif
+    for (; i < n; ++i) x[i] *= inv;
+}
+
+std::vector<int> topKIndices(const float* x, int n, int k) {
+    k = std::max(0, std::min(k, n));
+    std::vector<int> idx(n);
+    std::iota(idx.begin(), idx.end(), 0);
+    std::partial_sort(idx.begin(), idx.begin() + k, idx.end(), [x](int a, int b) { return x[a] > x[b]; });
+    idx.resize(k);
+    return idx;
+}
+
+void bestClass(const float* scores, int count, int classes, int candStride, int classStride,
+               float* bestScore, int32_t* bestIndex) {
+    int i = 0;
+    if (classes <= 0) {
+        for (; i < count; ++i) bestScore[i] = 0.0f, bestIndex[i] = -1;
+        return;
+    }
+    if (candStride == 1) {
+        // [C, N]: four candidates per vector, one class row at a time.
+#if RUNNER_POST_NEON
+        for (; i + 4 <= count; i += 4) {
+            float32x4_t best = vld1q_f32(scores + i);
+            int32x4_t idx = vdupq_n_s32(0);
+            for (int c = 1; c < classes; ++c) {
+                const float32x4_t v = vld1q_f32(scores + (size_t)c * classStride + i);
+                const uint32x4_t gt = vcgtq_f32(v, best);
+                best = vmaxq_f32(best, v);
+                idx = vbslq_s32(gt, vdupq_n_s32(c), idx);
+            }
+            vst1q_f32(bestScore + i, best);
+            vst1q_s32(bestIndex + i, idx);
+        }
+#elif RUNNER_POST_SSE
+        for (; i + 4 <= count; i += 4) {
+            __m128 best = _mm_loadu_ps(scores + i);
+            __m128i idx = _mm_setzero_si128();
+            for (int c = 1; c < classes; ++c) {
+                const __m128 v = _mm_loadu_ps(scores + (size_t)c * classStride + i);
+                const __m128i gt = _mm_castps_si128(_mm_cmpgt_ps(v, best));
+                best = _mm_max_ps(best, v);
+                idx = _mm_or_si128(_mm_and_si128(gt, _mm_set1_epi32(c)), _mm_andnot_si128(gt, idx));
+            }
+            _mm_storeu_ps(bestScore + i, best);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(bestIndex + i), idx);
+        }
+#endif
+    } else if (classStride == 1) {
+        // [N, C]: vector max along the row, then the first lane holding it.
+        for (; i < count; ++i) {
+            const float* row = scores + (size_t)i * candStride;
+            const float m = maxOf(row, classes);
+            int c = 0;
+            while (c + 1 < classes && row[c] != m) ++c;
+            bestScore[i] = m;
+            bestIndex[i] = c;
+        }
+        return;
+    }
+    for (; i < count; ++i) {
+        const float* s = scores + (size_t)i * candStride;
+        float best = s[0];
+        int idx = 0;
+        for (int c = 1; c < classes; ++c) {
+            const float v = s[(size_t)c * classStride];
+            if (v > best) best = v, idx = c;
+        }
+        bestScore[i] = best;
+        bestIndex[i] = idx;
+    }
+}
+
+std::vector<Detection> nonMaxSuppression(std::vector<Detection> dets, float iouThreshold, int maxDetections,
+                                         bool classAware) {
+    std::stable_sort(dets.begin(), dets.end(), [](const Detection& a, const Detection& b) { return a.score > b.score; });
+    const int n = (int)dets.size();
+    // Class-aware NMS as one pass: boxes of different classes are shifted apart so they never overlap.
+    float shift = 0.0f;
+    if (classAware) {
+        for (auto& d : dets) shift = std::max({shift, std::fabs(d.x0), std::fabs(d.y0), std::fabs(d.x1), std::fabs(d.y1)});
+        shift = 2.0f * shift + 1.0f;
+    }
+    std::vector<float> x0(n), y0(n), x1(n), y1(n), area(n);
+    for (int i = 0; i < n; ++i) {
+        const float off = classAware ? dets[i].cls * shift : 0.0f;
+        x0[i] = dets[i].x0 + off;
+        y0[i] = dets[i].y0 + off;
+        x1[i] = dets[i].x1 + off;
+        y1[i] = dets[i].y1 + off;
+        area[i] = std::max(0.0f, dets[i].x1 - dets[i].x0) * std::max(0.0f, dets[i].y1 - dets[i].y0);
+    }
+    std::vector<uint32_t> suppressed(n, 0);
+    std::vector<Detection> kept;
+    for (int i = 0; i < n && (int)kept.size() < maxDetections; ++i) {
+        if (suppressed[i]) continue;
+        kept.push_back(dets[i]);
+        const float bx0 = x0[i], by0 = y0[i], bx1 = x1[i], by1 = y1[i], ba = area[i];
+        int j = i + 1;
+        // Suppress when inter > iou * union, which needs no division.
+#if RUNNER_POST_NEON
+        const float32x4_t vx0 = vdupq_n_f32(bx0), vy0 = vdupq_n_f32(by0), vx1 = vdupq_n_f32(bx1), vy1 = vdupq_n_f32(by1);
+        const float32x4_t va = vdupq_n_f32(ba), vthr = vdupq_n_f32(iouThreshold), zero = vdupq_n_f32(0.0f);
+        for (; j + 4 <= n; j += 4) {
+            const float32x4_t w = vmaxq_f32(zero, vsubq_f32(vminq_f32(vx1, vld1q_f32(&x1[j])), vmaxq_f32(vx0, vld1q_f32(&x0[j]))));
+            const float32x4_t h = vmaxq_f32(zero, vsubq_f32(vminq_f32(vy1, vld1q_f32(&y1[j])), vmaxq_f32(vy0, vld1q_f32(&y0[j]))));
+            const float32x4_t inter = vmulq_f32(w, h);
+            const float32x4_t uni = vsubq_f32(vaddq_f32(va, vld1q_f32(&area[j])), inter);
+            const uint32x4_t over = vcgtq_f32(inter, vmulq_f32(vthr, uni));
+            vst1q_u32(&suppressed[j], vorrq_u32(vld1q_u32(&suppressed[j]), over));
+        }
+#elif RUNNER_POST_SSE
+        const __m128 vx0 = _mm_set1_ps(bx0), vy0 = _mm_set1_ps(by0), vx1 = _mm_set1_ps(bx1), vy1 = _mm_set1_ps(by1);
+        const __m128 va = _mm_set1_ps(ba), vthr = _mm_set1_ps(iouThreshold), zero = _mm_setzero_ps();
+        for (; j + 4 <= n; j += 4) {
+            const __m128 w = _mm_max_ps(zero, _mm_sub_ps(_mm_min_ps(vx1, _mm_loadu_ps(&x1[j])), _mm_max_ps(vx0, _mm_loadu_ps(&x0[j]))));
+            const __m128 h = _mm_max_ps(zero, _mm_sub_ps(_mm_min_ps(vy1, _mm_loadu_ps(&y1[j])), _mm_max_ps(vy0, _mm_loadu_ps(&y0[j]))));
+            const __m128 inter = _mm_mul_ps(w, h);
+            const __m128 uni = _mm_sub_ps(_mm_add_ps(va, _mm_loadu_ps(&area[j])), inter);
+            const __m128i over = _mm_castps_si128(_mm_cmpgt_ps(inter, _mm_mul_ps(vthr, uni)));
+            __m128i* s = reinterpret_cast<__m128i*>(&suppressed[j]);
+            _mm_storeu_si128(s, _mm_or_si128(_mm_loadu_si128(s), over));
+        }
+#endif
+        for (; j < n; ++j) {
+            const float w = std::max(0.0f, std::min(bx1, x1[j]) - std::max(bx0, x0[j]));
+            const float h = std::max(0.0f, std::min(by1, y1[j]) - std::max(by0, y0[j]));
+            const float inter = w * h;
+            if (inter > iouThreshold * (ba + area[j] - inter)) suppressed[j] = ~0u;
+        }
+    }
+    return kept;
+}
+
+void argmaxPlanes(int32_t* dst, const float* src, int channels, int area) {
+    int i = 0;
+    if (channels <= 0) {
+        for (; i < area; ++i) dst[i] = -1;
+        return;
+    }
+#if RUNNER_POST_NEON
+    for (; i + 4 <= area; i += 4) {
+        float32x4_t best = vld1q_f32(src + i);
+        int32x4_t idx = vdupq_n_s32(0);
+        for (int c = 1; c < channels; ++c) {
+            const float32x4_t v = vld1q_f32(src + (size_t)c * area + i);
+            const uint32x4_t gt = vcgtq_f32(v, best);
+            best = vmaxq_f32(best, v);
+            idx = vbslq_s32(gt, vdupq_n_s32(c), idx);
+        }
+        vst1q_s32(dst + i, idx);
+    }
+#elif RUNNER_POST_SSE
+    for (; i + 4 <= area; i += 4) {
+        __m128 best = _mm_loadu_ps(src + i);
+        __m128i idx = _mm_setzero_si128();
+        for (int c = 1; c < channels; ++c) {
+            const __m128 v = _mm_loadu_ps(src + (size_t)c * area + i);
+            const __m128i gt = _mm_castps_si128(_mm_cmpgt_ps(v, best));
+            best = _mm_max_ps(best, v);
+            idx = _mm_or_si128(_mm_and_si128(gt, _mm_set1_epi32(c)), _mm_andnot_si128(gt, idx));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), idx);
+    }
+#endif
+    for (; i < area; ++i) {
+        float best = src[i];
+        int idx = 0;
+        for (int c = 1; c < channels; ++c) {
+            const float v = src[(size_t)c * area + i];
+            if (v > best) best = v, idx = c;
+        }
+        dst[i] = idx;
+    }
+}
+
+} // namespace runner
@@ -0,0 +1,33 @@
+// Postprocessing kernels for common output heads on float32 host buffers, with NEON / SSE2 paths
+// and a scalar fallback: softmax + top-k (classification), best-class scan + NMS (detection) and
+// per-pixel argmax (segmentation).
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace runner {
+
+// Numerically stable softmax over n values, in place.
+void softmaxInPlace(float* x, int n);
+// Indices of the k largest values, largest first.
+std::vector<int> topKIndices(const float* x, int n, int k);
+
+// Best class of `count` candidates; the score of candidate i, class c is
+// scores[i * candStride + c * classStride], so both [N, C] and [C, N] heads are read in place.
+void bestClass(const float* scores, int count, int classes, int candStride, int classStride,
+               float* bestScore, int32_t* bestIndex);
+
+struct Detection {
+    float x0, y0, x1, y1;
+    float score;
+    int cls;
+};
+
+// Greedy NMS, highest score first; with classAware only boxes of the same class suppress each other.
+std::vector<Detection> nonMaxSuppression(std::vector<Detection> dets, float iouThreshold, int maxDetections,
+                                         bool classAware);
+
+// Per-pixel class of `channels` NCHW planes of `area` values each.
+void argmaxPlanes(int32_t* dst, const float* src, int channels, int area);
+
+} // namespace runner
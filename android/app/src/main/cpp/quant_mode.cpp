@@ -0,0 +1,125 @@
+// Dynamic-quantization sweep over DYNAMIC_QUANT_OPTIONS x QKV_QUANT_OPTIONS. Variants run in
+// quantMemoryMode, which may differ from the user's memoryMode, so a control run with both hints off
+// in that mode separates the quantization effect from the memory-mode change.
+#include "modes.hpp"
+#include "runner_common.hpp"
+
+#include <algorithm>
+#include <sstream>
+
+namespace runner {
+
+#if HAVE_MNN
+namespace {
+
+std::vector<int> optionList(const json::Value& root, const char* key, std::vector<int> def) {
+    std::vector<int> out = root.getIntArray(key);
+    return out.empty() ? def : out;
+}
+
+void writeRun(std::ostream& json, const RunOptions& opt, const BenchRun& run) {
+    json << "\"memoryMode\":\"" << opt.memoryMode << "\""
+         << ",\"createSession_ms\":" << run.createSessionMs
+         << ",\"memory_mb\":" << run.memoryMb;
+    if (run.rssBeforeBytes >= 0 && run.rssAfterBytes >= 0) {
+        json << ",\"rss_delta_mb\":" << (double)(run.rssAfterBytes - run.rssBeforeBytes) / (1024.0 * 1024.0);
+    }
+    json << ",\"latency\":";
+    writeLatency(json, run.samplesMs);
+}
+
+} // namespace
+
+std::string runDynamicQuant(const std::string& configJson) {
+    try {
+        json::Value root = json::parse(configJson);
+        RunOptions base;
+        applyRunOptions(root, base);
+        if (base.modelPath.empty()) throw std::runtime_error("Missing modelPath");
+
+        const int warmup = std::max(0, root.getInt("warmup", 1));
+        const int iterations = std::max(1, root.getInt("iterations", 10));
+        // 0 = off, 1 = one scale/zero-point per tensor for general convolution (the only value the
+        // bundled headers document); later MNN builds add more.
+        const std::vector<int> dqOptions = optionList(root, "dynamicQuantOptions", {1});
+        // 0 = none, 1 = key int8, 2 = value fp8, 3 = both, 4 = q/k/v int8 with gemm int8 for attention.
+        const std::vector<int> qkvOptions = optionList(root, "qkvQuantOptions", {0});
+        // MNN's CPU backend only keeps int8 weights and quantizes activations on the fly with Memory_Low.
+        const std::string quantMemory = root.getString("quantMemoryMode", "LOW");
+
+        // Float-activation baseline: the user's config with both quant hints off.
+        BenchHooks baseHooks;
+        baseHooks.beforeSession = [](MNN::Interpreter* net) {
+            net->setSessionHint(MNN::Interpreter::DYNAMIC_QUANT_OPTIONS, 0);
+            net->setSessionHint(MNN::Interpreter::QKV_QUANT_OPTIONS, 0);
+        };
+        auto baseline = benchmarkConfig(base, warmup, iterations, baseHooks);
+        const double baseMedian = medianOf(baseline.samplesMs);
+        // Control: both hints off in the variants' memory mode; the baseline itself when that matches.
+        RunOptions controlOpt = base;
+        controlOpt.memoryMode = quantMemory;
+        const bool separateControl = controlOpt.memoryMode != base.memoryMode;
+        BenchRun control = separateControl ? benchmarkConfig(controlOpt, warmup, iterations, baseHooks) : baseline;
+        const double controlMedian = medianOf(control.samplesMs);
+
+        std::ostringstream json;
+        json.setf(std::ios::fixed); json.precision(6);
+        json << "{\"dynamicQuant\":true"
+             << ",\"backend\":\"" << base.backend << "\""
+             << ",\"threads\":" << base.threads
+             << ",\"baseline\":{\"dynamic_quant\":0,\"qkv_quant\":0,";
+        writeRun(json, base, baseline);
+        json << "},\"control\":{\"dynamic_quant\":0,\"qkv_quant\":0,\"same_as_baseline\":"
+             << (separateControl ? "false" : "true") << ",";
+        writeRun(json, controlOpt, control);
+        json << ",\"speedup_vs_baseline\":" << (controlMedian > 0.0 ? baseMedian / controlMedian : 0.0)
+             << ",\"memory_saved_mb\":" << (baseline.memoryMb - control.memoryMb)
+             << ",\"outputs\":";
+        writeOutputErrors(json, baseline.outputs, control.outputs);
+        json << "},\"variants\":[";
+        bool first = true;
+        for (int dq : dqOptions) {
+            for (int qkv : qkvOptions) {
+                if (dq == 0 && qkv == 0) continue; // that is the baseline
+                if (!first) json << ",";
+                first = false;
+                RunOptions opt = base;
+                opt.memoryMode = quantMemory;
+                json << "{\"dynamic_quant\":" << dq << ",\"qkv_quant\":" << qkv << ",";
+                BenchRun run;
+                try {
+                    BenchHooks hooks;
+                    hooks.beforeSession = [dq, qkv](MNN::Interpreter* net) {
+                        net->setSessionHint(MNN::Interpreter::DYNAMIC_QUANT_OPTIONS, dq);
+                        net->setSessionHint(MNN::Interpreter::QKV_QUANT_OPTIONS, qkv);
+                    };
+                    run = benchmarkConfig(opt, warmup, iterations, hooks);
+                } catch (const std::exception& e) {
+                    json << "\"error\":\"" << jsonEscape(e.what()) << "\"}";
+                    continue;
+                }
+                writeRun(json, opt, run);
+                const double median = medianOf(run.samplesMs);
+                json << ",\"speedup_vs_baseline\":" << (median > 0.0 ? baseMedian / median : 0.0)
+                     << ",\"memory_saved_mb\":" << (baseline.memoryMb - run.memoryMb)
+                     << ",\"speedup_vs_control\":" << (median > 0.0 ? controlMedian / median : 0.0)
+                     << ",\"memory_saved_vs_control_mb\":" << (control.memoryMb - run.memoryMb)
+                     << ",\"outputs\":";
+                writeOutputErrors(json, baseline.outputs, run.outputs);
+                json << "}";
+            }
+        }
+        json << "]}";
+        return json.str();
+    } catch (const std::exception& e) {
+        return std::string("{\"error\":\"") + jsonEscape(e.what()) + "\"}";
+    }
+}
+#else
+std::string runDynamicQuant(const std::string& configJson) {
+    (void)configJson;
+    return "{\"error\":\"MNN not bundled. Cannot run dynamic-quant sweep. Place headers and libMNN.so as documented.\"}";
+}
+#endif
+
+} // namespace runner
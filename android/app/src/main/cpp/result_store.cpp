@@ -0,0 +1,326 @@
+// Append-only benchmark result store and statistical comparison of stored runs.
+//
+// Every JSON-mode report is appended as one line of <dir>/results.jsonl together with
+// the config that produced it, the device fingerprint and the MNN version. Reports carry
+// raw latency samples ("samples_ms" inside each latency block), which compareResults()
+// pairs up by position in the report and tests with Mann-Whitney U plus Cliff's delta.
+#include "modes.hpp"
+#include "runner_common.hpp"
+#include "device_info.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace runner {
+
+namespace {
+
+std::mutex gStoreMutex;
+std::string gStoreDir;
+std::atomic<unsigned> gSequence{0};
+
+std::string storePath() { return gStoreDir + "/results.jsonl"; }
+
+long long nowMillis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Time-ordered id that stays unique for several records in the same millisecond.
+std::string newRecordId() {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%011llx%04x", (unsigned long long)nowMillis(), gSequence++ & 0xffffu);
+    return buf;
+}
+
+// All parseable records, oldest first. A torn last line from a crash mid-append is skipped.
+std::vector<json::Value> loadRecords() {
+    std::vector<json::Value> out;
+    std::ifstream in(storePath());
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+        try {
+            out.push_back(json::parse(line));
+        } catch (const std::exception&) {
+        }
+    }
+    return out;
+}
+
+// Latency series of a report keyed by their position, e.g. "candidates[VULKAN/LOW/4t].latency".
+// Array elements are keyed by a naming field when they have one, so reordering configs
+// between runs does not mis-pair series.
+void collectSeries(const json::Value& v, const std::string& path, std::vector<std::pair<std::string, std::vector<double>>>& out) {
+    if (v.isObject()) {
+        if (auto* samples = v.get("samples_ms")) {
+            std::vector<double> xs;
+            for (auto& s : samples->items) if (s.isNumber()) xs.push_back(s.number);
+            if (!xs.empty()) out.emplace_back(path, std::move(xs));
+        }
+        for (size_t i = 0; i < v.keys.size(); ++i) {
+            if (v.keys[i] == "samples_ms") continue;
+            collectSeries(v.items[i], path.empty() ? v.keys[i] : path + "." + v.keys[i], out);
+        }
+    } else if (v.isArray()) {
+        for (size_t i = 0; i < v.items.size(); ++i) {
+            std::string key = std::to_string(i);
+            for (const char* name : {"label", "variant", "engine", "config", "name"}) {
+                std::string s = v.items[i].getString(name);
+                if (!s.empty()) { key = s; break; }
+            }
+            collectSeries(v.items[i], path + "[" + key + "]", out);
+        }
+    }
+}
+
+struct Verdict {
+    double u = 0.0;
+    double z = 0.0;
+    double p = 1.0;
+    double cliffsDelta = 0.0;   // > 0: candidate tends to be slower
+    double shiftMs = 0.0;       // Hodges-Lehmann estimate of candidate - baseline
+    std::string outcome = "no_change";
+};
+
+// Two-sided Mann-Whitney U (normal approximation with tie and continuity correction),
+// Cliff's delta as the effect size and the Hodges-Lehmann shift in ms.
+Verdict mannWhitney(const std::vector<double>& base, const std::vector<double>& cand, double alpha, double minEffect) {
+    Verdict v;
+    const size_t n1 = base.size(), n2 = cand.size();
+    if (!n1 || !n2) return v;
+    std::vector<std::pair<double, int>> all;
+    all.reserve(n1 + n2);
+    for (double x : base) all.emplace_back(x, 0);
+    for (double x : cand) all.emplace_back(x, 1);
+    std::sort(all.begin(), all.end());
+    double rankSumCand = 0.0, tieTerm = 0.0;
+    for (size_t i = 0; i < all.size();) {
+        size_t j = i;
+        while (j < all.size() && all[j].first == all[i].first) ++j;
+        const double rank = (double)(i + j + 1) / 2.0; // average of 1-based ranks i+1..j
+        const double t = (double)(j - i);
+        tieTerm += t * t * t - t;
+        for (size_t k = i; k < j; ++k) if (all[k].second == 1) rankSumCand += rank;
+        i = j;
+    }
+    // U counts (candidate > baseline) pairs, ties as one half.
+    v.u = rankSumCand - (double)n2 * (n2 + 1) / 2.0;
+    const double n = (double)(n1 + n2);
+    const double mean = (double)n1 * n2 / 2.0;
+    const double var = (double)n1 * n2 / 12.0 * ((n + 1.0) - tieTerm / (n * (n - 1.0)));
+    if (var > 0.0) {
+        const double diff = v.u - mean;
+        v.z = (diff - (diff > 0 ? 0.5 : diff < 0 ? -0.5 : 0.0)) / std::sqrt(var);
+        v.p = std::erfc(std::fabs(v.z) / std::sqrt(2.0));
+    }
+    v.cliffsDelta = 2.0 * v.u / ((double)n1 * n2) - 1.0;
+
+    // Pairwise differences get large quickly; a strided subset keeps this O(1e6).
+    const size_t strideB = std::max<size_t>(1, n1 / 1000), strideC = std::max<size_t>(1, n2 / 1000);
+    std::vector<double> diffs;
+    for (size_t i = 0; i < n1; i += strideB)
+        for (size_t j = 0; j < n2; j += strideC) diffs.push_back(cand[j] - base[i]);
+    v.shiftMs = medianOf(diffs);
+
+    if (v.p < alpha && std::fabs(v.cliffsDelta) >= minEffect) {
+        v.outcome = v.cliffsDelta > 0 ? "regression" : "improvement";
+    }
+    return v;
+}
+
+// Cliff's delta magnitude labels (Romano et al.): negligible < 0.147 <= small < 0.33 <= medium < 0.474 <= large.
+const char* effectLabel(double d) {
+    d = std::fabs(d);
+    if (d < 0.147) return "negligible";
+    if (d < 0.33) return "small";
+    if (d < 0.474) return "medium";
+    return "large";
+}
+
+// A record by "id", or the newest one matching "label" (and "mode" when given).
+const json::Value* pickRecord(const std::vector<json::Value>& records, const json::Value& sel, const std::string& mode) {
+    if (sel.isString()) {
+        for (auto& r : records) if (r.getString("id") == sel.str) return &r;
+        return nullptr;
+    }
+    const std::string id = sel.getString("id");
+    const std::string label = sel.getString("label");
+    const std::string wantMode = sel.getString("mode", mode);
+    for (auto it = records.rbegin(); it != records.rend(); ++it) {
+        if (!id.empty() && it->getString("id") != id) continue;
+        if (!label.empty() && it->getString("label") != label) continue;
+        if (!wantMode.empty() && it->getString("mode") != wantMode) continue;
+        return &*it;
+    }
+    return nullptr;
+}
+
+void writeRecordSummary(std::ostream& json, const json::Value& r) {
+    std::vector<std::pair<std::string, std::vector<double>>> series;
+    if (auto* report = r.get("report")) collectSeries(*report, "", series);
+    json << "{\"id\":\"" << jsonEscape(r.getString("id")) << "\""
+         << ",\"created_at_ms\":" << (long long)r.getNumber("created_at_ms")
+         << ",\"mode\":\"" << jsonEscape(r.getString("mode")) << "\""
+         << ",\"label\":\"" << jsonEscape(r.getString("label")) << "\""
+         << ",\"model_path\":\"" << jsonEscape(r.getString("model_path")) << "\""
+         << ",\"mnn_version\":\"" << jsonEscape(r.getString("mnn_version")) << "\""
+         << ",\"device_fingerprint\":\"" << jsonEscape(r.getString("device_fingerprint")) << "\""
+         << ",\"series\":" << series.size() << "}";
+}
+
+} // namespace
+
+void setResultStoreDir(const std::string& dir) {
+    std::lock_guard<std::mutex> lock(gStoreMutex);
+    gStoreDir = dir;
+    if (!dir.empty()) ::mkdir(dir.c_str(), 0755);
+}
+
+std::string recordResult(const std::string& mode, const std::string& configJson, const std::string& reportJson) {
+    try {
+        json::Value report = json::parse(reportJson);
+        if (!report.isObject() || report.has("error")) return std::string();
+        json::Value config = json::parse(configJson);
+        const DeviceInfo& dev = deviceInfo();
+
+        json::Value record = json::Value::makeObject();
+        const std::string id = newRecordId();
+        record.set("id", json::Value::makeString(id));
+        record.set("created_at_ms", json::Value::makeNumber((double)nowMillis()));
+        record.set("mode", json::Value::makeString(mode));
+        // Free-form build/experiment tag, e.g. an app version or a git sha.
+        record.set("label", json::Value::makeString(config.getString("resultLabel")));
+        const std::string modelPath = config.getString("modelPath");
+        record.set("model_path", json::Value::makeString(modelPath));
+        record.set("model_hash", json::Value::makeString(modelPath.empty() ? std::string() : hashModelFile(modelPath)));
+        record.set("mnn_version", json::Value::makeString(dev.mnnVersion));
+        record.set("device_fingerprint", json::Value::makeString(dev.fingerprint()));
+        std::ostringstream devJson;
+        writeDeviceJson(devJson, dev);
+        record.set("device", json::parse(devJson.str()));
+        record.set("config", config);
+        record.set("report", report);
+        const std::string line = json::dump(record) + "\n";
+
+        std::lock_guard<std::mutex> lock(gStoreMutex);
+        if (gStoreDir.empty()) return std::string();
+        // One write() of a full line with O_APPEND: records never interleave, at worst the last one is torn.
+        int fd = ::open(storePath().c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (fd < 0) return std::string();
+        const ssize_t n = ::write(fd, line.data(), line.size());
+        ::fsync(fd);
+        ::close(fd);
+        return n == (ssize_t)line.size() ? id : std::string();
+    } catch (const std::exception&) {
+        return std::string();
+    }
+}
+
+std::string listResults(const std::string& configJson) {
+    try {
+        json::Value root = configJson.empty() ? json::Value::makeObject() : json::parse(configJson);
+        const int limit = std::max(1, root.getInt("limit", 50));
+        const std::string mode = root.getString("mode");
+        const std::string label = root.getString("label");
+        std::vector<json::Value> records;
+        {
+            std::lock_guard<std::mutex> lock(gStoreMutex);
+            if (gStoreDir.empty()) throw std::runtime_error("Result store directory not set");
+            records = loadRecords();
+        }
+        std::ostringstream json;
+        json << "{\"total\":" << records.size() << ",\"records\":[";
+        int written = 0;
+        for (auto it = records.rbegin(); it != records.rend() && written < limit; ++it) {
+            if (!mode.empty() && it->getString("mode") != mode) continue;
+            if (!label.empty() && it->getString("label") != label) continue;
+            if (written++) json << ",";
+            writeRecordSummary(json, *it);
+        }
+        json << "]}";
+        return json.str();
+    } catch (const std::exception& e) {
+        return std::string("{\"error\":\"") + jsonEscape(e.what()) + "\"}";
+    }
+}
+
+std::string compareResults(const std::string& configJson) {
+    try {
+        json::Value root = json::parse(configJson);
+        const double alpha = root.getNumber("alpha", 0.05);
+        const double minEffect = root.getNumber("minEffect", 0.147);
+        const std::string mode = root.getString("mode");
+        const json::Value* baseSel = root.get("baseline");
+        const json::Value* candSel = root.get("candidate");
+        if (!baseSel || !candSel) throw std::runtime_error("Need \"baseline\" and \"candidate\" (record id or {\"label\":..})");
+
+        std::vector<json::Value> records;
+        {
+            std::lock_guard<std::mutex> lock(gStoreMutex);
+            if (gStoreDir.empty()) throw std::runtime_error("Result store directory not set");
+            records = loadRecords();
+        }
+        const json::Value* base = pickRecord(records, *baseSel, mode);
+        const json::Value* cand = pickRecord(records, *candSel, mode);
+        if (!base) throw std::runtime_error("Baseline record not found");
+        if (!cand) throw std::runtime_error("Candidate record not found");
+
+        std::vector<std::pair<std::string, std::vector<double>>> baseSeries, candSeries;
+        if (auto* r = base->get("report")) collectSeries(*r, "", baseSeries);
+        if (auto* r = cand->get("report")) collectSeries(*r, "", candSeries);
+
+        std::ostringstream json;
+        json.setf(std::ios::fixed); json.precision(6);
+        json << "{\"baseline\":";
+        writeRecordSummary(json, *base);
+        json << ",\"candidate\":";
+        writeRecordSummary(json, *cand);
+        json << ",\"same_device\":" << (base->getString("device_fingerprint") == cand->getString("device_fingerprint") ? "true" : "false")
+             << ",\"same_model\":" << (base->getString("model_hash") == cand->getString("model_hash") ? "true" : "false")
+             << ",\"alpha\":" << alpha
+             << ",\"min_effect\":" << minEffect
+             << ",\"series\":[";
+        int regressions = 0, improvements = 0, compared = 0;
+        for (auto& b : baseSeries) {
+            auto it = std::find_if(candSeries.begin(), candSeries.end(),
+                                   [&b](const std::pair<std::string, std::vector<double>>& c) { return c.first == b.first; });
+            if (it == candSeries.end()) continue;
+            const Verdict v = mannWhitney(b.second, it->second, alpha, minEffect);
+            if (v.outcome == "regression") ++regressions;
+            if (v.outcome == "improvement") ++improvements;
+            if (compared++) json << ",";
+            const double bm = medianOf(b.second), cm = medianOf(it->second);
+            json << "{\"path\":\"" << jsonEscape(b.first) << "\""
+                 << ",\"n_baseline\":" << b.second.size()
+                 << ",\"n_candidate\":" << it->second.size()
+                 << ",\"median_baseline_ms\":" << bm
+                 << ",\"median_candidate_ms\":" << cm
+                 << ",\"median_ratio\":" << (bm > 0.0 ? cm / bm : 0.0)
+                 << ",\"u\":" << v.u
+                 << ",\"z\":" << v.z
+                 << ",\"p_value\":" << v.p
+                 << ",\"cliffs_delta\":" << v.cliffsDelta
+                 << ",\"effect\":\"" << effectLabel(v.cliffsDelta) << "\""
+                 << ",\"shift_ms\":" << v.shiftMs
+                 << ",\"verdict\":\"" << v.outcome << "\"}";
+        }
+        json << "],\"compared\":" << compared
+             << ",\"regressions\":" << regressions
+             << ",\"improvements\":" << improvements << "}";
+        return json.str();
+    } catch (const std::exception& e) {
+        return std::string("{\"error\":\"") + jsonEscape(e.what()) + "\"}";
+    }
+}
+
+} // namespace runner
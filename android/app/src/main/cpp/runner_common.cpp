@@ -0,0 +1,883 @@
+#include "runner_common.hpp"
+#include "modes.hpp"
+#include "telemetry.hpp"
+#include "layout_pack.hpp"
+#include "backend_probe.hpp"
+#include "postprocess.hpp"
+#include "executor.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <sched.h>
+#include <unistd.h>
+
+namespace runner {
+
+void applyRunOptions(const json::Value& obj, RunOptions& opt) {
+    if (!obj.isObject()) return;
+    opt.modelPath = obj.getString("modelPath", opt.modelPath);
+    if (obj.has("inputShape")) opt.inputShape = obj.getIntArray("inputShape");
+    if (auto* shapes = obj.get("inputShapes")) {
+        if (shapes->isObject()) {
+            opt.inputShapes.clear();
+            for (size_t i = 0; i < shapes->keys.size(); ++i) {
+                std::vector<int> dims;
+                for (auto& d : shapes->items[i].items) {
+                    if (d.isNumber()) dims.push_back((int)d.number);
+                }
+                opt.inputShapes[shapes->keys[i]] = dims;
+            }
+        }
+    }
+    opt.backend = obj.getString("backend", opt.backend);
+    // Support both backupType and backup_type, like MainActivity does
+    opt.backupType = obj.getString("backupType", obj.getString("backup_type", opt.backupType));
+    opt.memoryMode = obj.getString("memoryMode", opt.memoryMode);
+    opt.precisionMode = obj.getString("precisionMode", opt.precisionMode);
+    opt.powerMode = obj.getString("powerMode", opt.powerMode);
+    opt.inputFill = obj.getString("inputFill", opt.inputFill);
+    opt.threads = obj.getInt("threads", opt.threads);
+    opt.cacheFile = obj.getString("cacheFile", opt.cacheFile);
+    opt.telemetryOps = obj.getBool("telemetryOps", opt.telemetryOps);
+    if (auto* hints = obj.get("sessionHints")) {
+        if (hints->isObject()) {
+            opt.sessionHints.clear();
+            for (size_t i = 0; i < hints->keys.size(); ++i) {
+                if (hints->items[i].isNumber()) {
+                    opt.sessionHints[std::atoi(hints->keys[i].c_str())] = (int)hints->items[i].number;
+                }
+            }
+        }
+    }
+}
+
+std::string shapeSignature(const RunOptions& opt) {
+    auto dims = [](const std::vector<int>& d) {
+        std::string s;
+        for (size_t i = 0; i < d.size(); ++i) s += (i ? "x" : "") + std::to_string(d[i]);
+        return s;
+    };
+    if (opt.inputShapes.empty()) return dims(opt.inputShape);
+    std::string s;
+    for (auto& kv : opt.inputShapes) {
+        if (!s.empty()) s += ";";
+        s += kv.first + ":" + dims(kv.second);
+    }
+    return s;
+}
+
+std::string describeOptions(const RunOptions& opt) {
+    std::ostringstream s;
+    s << opt.backend << "/" << opt.precisionMode << "/" << opt.threads << "t";
+    return s.str();
+}
+
+int mapForward(const std::string& s) {
+#if HAVE_MNN
+    if (s == "AUTO") return (int)MNN_FORWARD_AUTO;
+    if (s == "CPU") return (int)MNN_FORWARD_CPU;
+    if (s == "VULKAN") return (int)MNN_FORWARD_VULKAN;
+    if (s == "OPENCL") return (int)MNN_FORWARD_OPENCL;
+    if (s == "OPENGL" || s == "OPENGL_ES" || s == "OPENGL_ES3") return (int)MNN_FORWARD_OPENGL;
+    if (s == "METAL") return (int)MNN_FORWARD_METAL;
+    if (s == "CUDA") return (int)MNN_FORWARD_CUDA;
+    if (s == "NN" || s == "NNAPI") return (int)MNN_FORWARD_NN;
+    return (int)MNN_FORWARD_CPU;
+#else
+    (void)s; // unused
+    return 0;
+#endif
+}
+
+std::string jsonEscape(const std::string& s) {
+    std::string quoted;
+    json::dumpString(quoted, s);
+    return quoted.substr(1, quoted.size() - 2);
+}
+
+ErrStats computeErr(const std::vector<float>& ref, const std::vector<float>& cand) {
+    ErrStats st;
+    if (ref.size() != cand.size()) {
+        st.sizeMismatch = true;
+        return st;
+    }
+    double diff2 = 0.0, ref2 = 0.0, cand2 = 0.0, dot = 0.0;
+    for (size_t i = 0; i < ref.size(); ++i) {
+        double r = ref[i], c = cand[i], d = c - r;
+        st.maxAbs = std::max(st.maxAbs, std::fabs(d));
+        diff2 += d * d;
+        ref2 += r * r;
+        cand2 += c * c;
+        dot += r * c;
+    }
+    st.count = ref.size();
+    st.relL2 = std::sqrt(diff2) / std::max(std::sqrt(ref2), 1e-12);
+    if (ref2 == 0.0 && cand2 == 0.0) st.cosine = 1.0;
+    else if (ref2 == 0.0 || cand2 == 0.0) st.cosine = 0.0;
+    else st.cosine = dot / (std::sqrt(ref2) * std::sqrt(cand2));
+    return st;
+}
+
+void writeErrFields(std::ostream& json, const ErrStats& st) {
+    if (st.sizeMismatch) {
+        json << ",\"error\":\"element count mismatch\"";
+        return;
+    }
+    json << ",\"elements\":" << st.count
+         << ",\"max_abs_err\":" << st.maxAbs
+         << ",\"rel_l2_err\":" << st.relL2
+         << ",\"cosine\":" << st.cosine;
+}
+
+void writeOutputErrors(std::ostream& json, const NamedOutputs& ref, const NamedOutputs& cand) {
+    json << "[";
+    bool first = true;
+    for (auto& out : cand) {
+        auto it = std::find_if(ref.begin(), ref.end(),
+                               [&](const NamedOutputs::value_type& p) { return p.first == out.first; });
+        if (it == ref.end()) continue;
+        if (!first) json << ",";
+        first = false;
+        json << "{\"name\":\"" << jsonEscape(out.first) << "\"";
+        writeErrFields(json, computeErr(it->second, out.second));
+        json << "}";
+    }
+    json << "]";
+}
+
+double medianOf(std::vector<double> samples) {
+    if (samples.empty()) return 0.0;
+    std::sort(samples.begin(), samples.end());
+    size_t n = samples.size();
+    return (n % 2) ? samples[n / 2] : 0.5 * (samples[n / 2 - 1] + samples[n / 2]);
+}
+
+void writeLatency(std::ostream& json, std::vector<double> samples) {
+    const size_t n = samples.size();
+    json << "{\"iterations\":" << n << ",\"samples_ms\":[";
+    for (size_t i = 0; i < n; ++i) json << (i ? "," : "") << samples[i];
+    json << "]";
+    std::sort(samples.begin(), samples.end());
+    double sum = 0.0;
+    for (double v : samples) sum += v;
+    if (n) {
+        json << ",\"min_ms\":" << samples.front()
+             << ",\"median_ms\":" << medianOf(samples)
+             << ",\"mean_ms\":" << sum / n
+             << ",\"max_ms\":" << samples.back();
+    }
+    json << "}";
+}
+
+bool pinCurrentThread(const std::vector<int>& cpus) {
+    if (cpus.empty()) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int c : cpus) if (c >= 0 && c < CPU_SETSIZE) CPU_SET(c, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+long long readRssBytes() {
+    FILE* f = std::fopen("/proc/self/statm", "r");
+    if (!f) return -1;
+    long long sizePages = 0, residentPages = 0;
+    int n = std::fscanf(f, "%lld %lld", &sizePages, &residentPages);
+    std::fclose(f);
+    if (n != 2) return -1;
+    return residentPages * (long long)sysconf(_SC_PAGESIZE);
+}
+
+long long mappedRssBytes(const std::vector<std::string>& prefixes) {
+    FILE* f = std::fopen("/proc/self/smaps", "r");
+    if (!f) return -1;
+    long long total = 0;
+    bool matching = false;
+    char line[1024];
+    while (std::fgets(line, sizeof(line), f)) {
+        unsigned long long kb = 0;
+        if (std::sscanf(line, "Rss: %llu kB", &kb) == 1) {
+            if (matching) total += (long long)kb * 1024;
+            continue;
+        }
+        // Mapping header: "start-end perms offset dev inode [path]"; attribute lines are "Key: value".
+        unsigned long long start = 0, end = 0;
+        if (std::sscanf(line, "%llx-%llx ", &start, &end) == 2) {
+            const char* path = std::strchr(line, '/');
+            matching = false;
+            if (path) {
+                std::string p(path);
+                if (!p.empty() && p.back() == '\n') p.pop_back();
+                for (auto& prefix : prefixes) {
+                    if (!prefix.empty() && p.compare(0, prefix.size(), prefix) == 0) { matching = true; break; }
+                }
+            }
+        }
+    }
+    std::fclose(f);
+    return total;
+}
+
+bool readFile(const std::string& path, std::string& out) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    out = ss.str();
+    return true;
+}
+
+bool writeFileAtomic(const std::string& path, const std::string& data) {
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        out << data;
+        if (!out) return false;
+    }
+    return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+#if HAVE_MNN
+const char* forwardName(MNNForwardType t) {
+    switch (t) {
+        case MNN_FORWARD_CPU: return "CPU";
+        case MNN_FORWARD_AUTO: return "AUTO";
+        case MNN_FORWARD_METAL: return "METAL";
+        case MNN_FORWARD_CUDA: return "CUDA";
+        case MNN_FORWARD_OPENCL: return "OPENCL";
+        case MNN_FORWARD_OPENGL: return "OPENGL";
+        case MNN_FORWARD_VULKAN: return "VULKAN";
+        case MNN_FORWARD_NN: return "NN";
+        case MNN_FORWARD_ALL: return "ALL";
+        default: return "UNKNOWN";
+    }
+}
+
+MNN::BackendConfig makeBackendConfig(const RunOptions& opt) {
+    MNN::BackendConfig bcfg;
+    const std::string prec = resolvePrecision(opt.precisionMode, opt.backend);
+    if (prec == "LOW") bcfg.precision = MNN::BackendConfig::Precision_Low;
+    else if (prec == "HIGH") bcfg.precision = MNN::BackendConfig::Precision_High;
+    else bcfg.precision = MNN::BackendConfig::Precision_Normal;
+
+    const auto& mem = opt.memoryMode;
+    if (mem == "LOW") bcfg.memory = MNN::BackendConfig::Memory_Low;
+    else if (mem == "HIGH") bcfg.memory = MNN::BackendConfig::Memory_High;
+    else bcfg.memory = MNN::BackendConfig::Memory_Normal;
+
+    const auto& pow = opt.powerMode;
+    if (pow == "LOW") bcfg.power = MNN::BackendConfig::Power_Low;
+    else if (pow == "HIGH") bcfg.power = MNN::BackendConfig::Power_High;
+    else bcfg.power = MNN::BackendConfig::Power_Normal;
+    return bcfg;
+}
+
+MNN::ScheduleConfig makeScheduleConfig(const RunOptions& opt, MNN::BackendConfig* bcfg) {
+    MNN::ScheduleConfig cfg;
+    cfg.type = (MNNForwardType)mapForward(opt.backend);
+    cfg.backupType = (MNNForwardType)mapForward(opt.backupType.empty() ? std::string("CPU") : opt.backupType);
+    cfg.numThread = opt.threads > 0 ? opt.threads : 1;
+    cfg.backendConfig = bcfg;
+    return cfg;
+}
+
+void resizeInputs(MNN::Interpreter* net, MNN::Session* session, const RunOptions& opt) {
+    if (!opt.inputShapes.empty()) {
+        for (auto& kv : opt.inputShapes) {
+            auto* in = net->getSessionInput(session, kv.first.c_str());
+            if (in) net->resizeTensor(in, kv.second);
+        }
+    } else if (!opt.inputShape.empty()) {
+        // Assume same shape when multiple inputs, as the single-shape JNI path does.
+        for (auto& kv : net->getSessionInputAll(session)) {
+            if (kv.second) net->resizeTensor(kv.second, opt.inputShape);
+        }
+    }
+    net->resizeSession(session);
+}
+
+namespace {
+
+// C4 staging applies to 4-D float32 tensors in NCHW; anything else keeps the default path.
+bool packable(const MNN::Tensor* t) {
+    return t->dimensions() == 4 && t->getDimensionType() == MNN::Tensor::CAFFE &&
+           t->getType().code == halide_type_float && t->getType().bits == 32;
+}
+
+} // namespace
+
+void fillInputs(MNN::Interpreter* net, MNN::Session* session, const std::string& fill, unsigned seed) {
+    (void)stageInputs(net, session, fill, "NCHW", seed);
+}
+
+std::vector<TensorTransfer> stageInputs(MNN::Interpreter* net, MNN::Session* session, const std::string& fill,
+                                        const std::string& layout, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> uni(0.0f, 1.0f);
+    std::normal_distribution<float> norm(0.0f, 1.0f);
+
+    std::vector<TensorTransfer> transfers;
+    for (auto& kv : net->getSessionInputAll(session)) {
+        auto* in = kv.second;
+        if (!in) continue;
+        MNN::Tensor host(in, in->getDimensionType());
+        auto bytes = host.size();
+        auto code = host.getType().code;
+        if (fill == "ONE" && code == halide_type_float) {
+            float* ptr = host.host<float>();
+            for (int i = 0; i < host.elementSize(); ++i) ptr[i] = 1.0f;
+        } else if (fill == "UNIFORM" && code == halide_type_float) {
+            float* ptr = host.host<float>();
+            for (int i = 0; i < host.elementSize(); ++i) ptr[i] = uni(rng);
+        } else if (fill == "NORMAL" && code == halide_type_float) {
+            float* ptr = host.host<float>();
+            for (int i = 0; i < host.elementSize(); ++i) ptr[i] = norm(rng);
+        } else {
+            std::memset(host.host<void>(), 0, bytes);
+        }
+
+        TensorTransfer tr;
+        tr.name = kv.first;
+        if ((layout == "NC4HW4" || layout == "PACK") && packable(in)) {
+            // Data is generated in NCHW so every layout feeds the model identical values; for NC4HW4
+            // the packing stands in for a caller that already holds packed data and is not timed.
+            MNN::Tensor packed(in, MNN::Tensor::CAFFE_C4);
+            auto p0 = clock::now();
+            packNC4HW4(packed.host<float>(), host.host<float>(), host.length(0), host.length(1),
+                       host.length(2) * host.length(3));
+            if (layout == "PACK") tr.packMs = msBetween(p0, clock::now());
+            tr.layout = layout;
+            tr.bytes = packed.size();
+            auto c0 = clock::now();
+            in->copyFromHostTensor(&packed);
+            tr.copyMs = msBetween(c0, clock::now());
+        } else {
+            tr.layout = in->getDimensionType() == MNN::Tensor::TENSORFLOW ? "NHWC" : "NCHW";
+            tr.bytes = bytes;
+            auto c0 = clock::now();
+            in->copyFromHostTensor(&host);
+            tr.copyMs = msBetween(c0, clock::now());
+        }
+        transfers.push_back(tr);
+    }
+    return transfers;
+}
+
+std::vector<TensorTransfer> downloadOutputs(MNN::Interpreter* net, MNN::Session* session, const std::string& layout) {
+    std::vector<TensorTransfer> transfers;
+    for (auto& kv : net->getSessionOutputAll(session)) {
+        auto* out = kv.second;
+        if (!out) continue;
+        TensorTransfer tr;
+        tr.name = kv.first;
+        if ((layout == "NC4HW4" || layout == "PACK") && packable(out)) {
+            MNN::Tensor packed(out, MNN::Tensor::CAFFE_C4);
+            tr.layout = layout;
+            tr.bytes = packed.size();
+            auto c0 = clock::now();
+            out->copyToHostTensor(&packed);
+            tr.copyMs = msBetween(c0, clock::now());
+            if (layout == "PACK") {
+                MNN::Tensor plain(out, MNN::Tensor::CAFFE);
+                auto p0 = clock::now();
+                unpackNC4HW4(plain.host<float>(), packed.host<float>(), plain.length(0), plain.length(1),
+                             plain.length(2) * plain.length(3));
+                tr.packMs = msBetween(p0, clock::now());
+            }
+        } else {
+            MNN::Tensor host(out, out->getDimensionType());
+            tr.layout = out->getDimensionType() == MNN::Tensor::TENSORFLOW ? "NHWC" : "NCHW";
+            tr.bytes = host.size();
+            auto c0 = clock::now();
+            out->copyToHostTensor(&host);
+            tr.copyMs = msBetween(c0, clock::now());
+        }
+        transfers.push_back(tr);
+    }
+    return transfers;
+}
+
+double totalTransferMs(const std::vector<TensorTransfer>& transfers) {
+    double ms = 0.0;
+    for (auto& t : transfers) ms += t.packMs + t.copyMs;
+    return ms;
+}
+
+void writeTransfers(std::ostream& json, const std::vector<TensorTransfer>& inputs, const std::vector<TensorTransfer>& outputs) {
+    auto list = [&json](const std::vector<TensorTransfer>& ts, const char* copyKey, const char* packKey) {
+        json << "[";
+        for (size_t i = 0; i < ts.size(); ++i) {
+            if (i) json << ",";
+            json << "{\"name\":\"" << jsonEscape(ts[i].name) << "\""
+                 << ",\"host_layout\":\"" << ts[i].layout << "\""
+                 << ",\"bytes\":" << ts[i].bytes
+                 << ",\"" << packKey << "\":" << ts[i].packMs
+                 << ",\"" << copyKey << "\":" << ts[i].copyMs << "}";
+        }
+        json << "]";
+    };
+    json << "{\"inputs\":";
+    list(inputs, "upload_ms", "pack_ms");
+    json << ",\"outputs\":";
+    list(outputs, "download_ms", "unpack_ms");
+    json << "}";
+}
+
+std::vector<float> tensorToFloat(const MNN::Tensor* t) {
+    std::vector<float> out;
+    if (!t) return out;
+    MNN::Tensor host(t, MNN::Tensor::CAFFE);
+    t->copyToHostTensor(&host);
+    const int n = host.elementSize();
+    out.resize(n > 0 ? (size_t)n : 0);
+    auto type = host.getType();
+    if (type.code == halide_type_float && type.bits == 32) {
+        std::memcpy(out.data(), host.host<float>(), out.size() * sizeof(float));
+    } else if (type.code == halide_type_int && type.bits == 32) {
+        auto* p = host.host<int32_t>();
+        for (size_t i = 0; i < out.size(); ++i) out[i] = (float)p[i];
+    } else if (type.code == halide_type_int && type.bits == 8) {
+        auto* p = host.host<int8_t>();
+        for (size_t i = 0; i < out.size(); ++i) out[i] = (float)p[i];
+    } else if (type.code == halide_type_uint && type.bits == 8) {
+        auto* p = host.host<uint8_t>();
+        for (size_t i = 0; i < out.size(); ++i) out[i] = (float)p[i];
+    } else {
+        std::fill(out.begin(), out.end(), 0.0f);
+    }
+    return out;
+}
+
+NamedOutputs readOutputs(MNN::Interpreter* net, MNN::Session* session) {
+    NamedOutputs outputs;
+    for (auto& kv : net->getSessionOutputAll(session)) {
+        if (!kv.second) continue;
+        outputs.emplace_back(kv.first, tensorToFloat(kv.second));
+    }
+    return outputs;
+}
+
+std::unique_ptr<MNN::Interpreter> loadInterpreter(const RunOptions& opt) {
+    std::unique_ptr<MNN::Interpreter> net(MNN::Interpreter::createFromFile(opt.modelPath.c_str()));
+    if (!net) throw std::runtime_error("Failed to create interpreter");
+    applyActiveHints(net.get(), opt.modelPath);
+    if (!opt.cacheFile.empty()) net->setCacheFile(opt.cacheFile.c_str());
+    for (auto& kv : opt.sessionHints) net->setSessionHint((MNN::Interpreter::HintMode)kv.first, kv.second);
+    return net;
+}
+
+std::shared_ptr<MNN::Tensor> hostCopy(const MNN::Tensor* t) {
+    std::shared_ptr<MNN::Tensor> host(new MNN::Tensor(t, t->getDimensionType()));
+    t->copyToHostTensor(host.get());
+    return host;
+}
+
+void loadNamedInputs(MNN::Interpreter* net, MNN::Session* session, const std::vector<std::string>& names,
+                     const std::map<std::string, std::shared_ptr<MNN::Tensor>>& staged) {
+    bool resized = false;
+    for (auto& n : names) {
+        auto* in = net->getSessionInput(session, n.c_str());
+        if (!in) throw std::runtime_error("Input not found: " + n);
+        auto& host = staged.at(n);
+        if (in->shape() != host->shape()) {
+            net->resizeTensor(in, host->shape());
+            resized = true;
+        }
+    }
+    if (resized) net->resizeSession(session);
+    for (auto& n : names) net->getSessionInput(session, n.c_str())->copyFromHostTensor(staged.at(n).get());
+}
+
+namespace {
+
+// Shape without leading 1s, so [1, 84, 8400] and [84, 8400] read the same.
+std::vector<int> squeezedShape(const MNN::Tensor* t) {
+    std::vector<int> s;
+    for (int d : t->shape()) if (d != 1 || !s.empty()) s.push_back(d);
+    return s;
+}
+
+const MNN::Tensor* floatOutput(const HostOutputs& outputs, const std::string& name) {
+    auto it = outputs.find(name);
+    if (it == outputs.end() || !it->second) throw std::runtime_error("Postprocess output not found: " + name);
+    auto type = it->second->getType();
+    if (type.code != halide_type_float || type.bits != 32) throw std::runtime_error("Postprocess needs a float32 output: " + name);
+    return it->second.get();
+}
+
+// Field f of candidate i of a detection head is data[i * candStride + f * fieldStride].
+struct HeadView {
+    const float* data = nullptr;
+    int count = 0;
+    int fields = 0;
+    int candStride = 0;
+    int fieldStride = 0;
+};
+
+// A 2-D head as rows [N, F] or columns [F, N]: from `layout`, else from a known field count or
+// candidate count, else the longer axis is the candidates.
+HeadView headView(const MNN::Tensor* t, const std::string& layout, int knownFields, int knownCount) {
+    const auto s = squeezedShape(t);
+    if (s.size() != 2) throw std::runtime_error("detect expects [N, F] or [F, N] outputs");
+    bool columns = s[0] < s[1];
+    if (layout == "rows") columns = false;
+    else if (layout == "columns") columns = true;
+    else if (knownFields > 0) columns = s[0] == knownFields && s[1] != knownFields;
+    else if (knownCount > 0) columns = s[1] == knownCount && s[0] != knownCount;
+    HeadView v;
+    v.data = t->host<float>();
+    v.count = columns ? s[1] : s[0];
+    v.fields = columns ? s[0] : s[1];
+    v.candStride = columns ? 1 : v.fields;
+    v.fieldStride = columns ? v.count : 1;
+    return v;
+}
+
+void runDetect(PostprocessStage& st, const HostOutputs& outputs) {
+    const json::Value& p = st.params;
+    const float scoreThreshold = (float)p.getNumber("scoreThreshold", 0.25);
+    const float iouThreshold = (float)p.getNumber("iouThreshold", 0.45);
+    const int maxDetections = std::max(1, p.getInt("maxDetections", 100));
+    const bool classAware = p.getBool("classAware", true);
+    const bool combined = st.boxes.empty();
+    const bool objectness = combined && p.getBool("objectness", false);
+    const bool xyxy = p.getString("boxFormat", combined ? "cxcywh" : "xyxy") == "xyxy";
+
+    auto t0 = clock::now();
+    HeadView boxes, scores;
+    if (combined) {
+        boxes = headView(floatOutput(outputs, st.output), p.getString("layout", ""), 0, 0);
+        scores = boxes;
+        const int first = objectness ? 5 : 4;
+        scores.fields = boxes.fields - first;
+        scores.data = boxes.data + (size_t)first * boxes.fieldStride;
+    } else {
+        boxes = headView(floatOutput(outputs, st.boxes), p.getString("boxesLayout", ""), 4, 0);
+        scores = headView(floatOutput(outputs, st.output), p.getString("layout", ""), 0, boxes.count);
+        if (scores.count != boxes.count) throw std::runtime_error("detect: boxes and scores disagree on the candidate count");
+    }
+    if (boxes.fields < 4 || scores.fields < 1) throw std::runtime_error("detect: output has too few fields per candidate");
+    const int n = boxes.count;
+    st.scratch.resize(n);
+    st.labels.resize(n);
+    bestClass(scores.data, n, scores.fields, scores.candStride, scores.fieldStride, st.scratch.data(), st.labels.data());
+    std::vector<Detection> candidates;
+    for (int i = 0; i < n; ++i) {
+        const float* b = boxes.data + (size_t)i * boxes.candStride;
+        const int fs = boxes.fieldStride;
+        float score = st.scratch[i];
+        if (objectness) score *= b[4 * fs];
+        if (score < scoreThreshold) continue;
+        Detection d;
+        if (xyxy) {
+            d.x0 = b[0], d.y0 = b[fs], d.x1 = b[2 * fs], d.y1 = b[3 * fs];
+        } else {
+            const float hw = b[2 * fs] * 0.5f, hh = b[3 * fs] * 0.5f;
+            d.x0 = b[0] - hw, d.y0 = b[fs] - hh, d.x1 = b[0] + hw, d.y1 = b[fs] + hh;
+        }
+        d.score = score;
+        d.cls = st.labels[i];
+        candidates.push_back(d);
+    }
+    const size_t above = candidates.size();
+    auto t1 = clock::now();
+    const auto kept = nonMaxSuppression(std::move(candidates), iouThreshold, maxDetections, classAware);
+    auto t2 = clock::now();
+    st.decodeMs.push_back(msBetween(t0, t1));
+    st.nmsMs.push_back(msBetween(t1, t2));
+    st.kernelMs.push_back(msBetween(t0, t2));
+
+    std::ostringstream r;
+    r.setf(std::ios::fixed); r.precision(4);
+    r << "{\"candidates\":" << n << ",\"above_threshold\":" << above << ",\"detections\":" << kept.size() << ",\"boxes\":[";
+    for (size_t i = 0; i < kept.size() && i < 10; ++i) {
+        const auto& d = kept[i];
+        r << (i ? "," : "") << "{\"class\":" << d.cls << ",\"score\":" << d.score
+          << ",\"box\":[" << d.x0 << "," << d.y0 << "," << d.x1 << "," << d.y1 << "]}";
+    }
+    r << "]}";
+    st.result = r.str();
+}
+
+} // namespace
+
+std::vector<PostprocessStage> parsePostprocess(const json::Value* list) {
+    std::vector<PostprocessStage> stages;
+    if (!list) return stages;
+    for (auto& item : list->items) {
+        if (!item.isObject()) continue;
+        PostprocessStage st;
+        st.type = item.getString("type", "");
+        if (st.type != "softmax_topk" && st.type != "detect" && st.type != "argmax") {
+            throw std::runtime_error("Unknown postprocess type: " + st.type);
+        }
+        st.output = item.getString("output", "");
+        if (st.type == "detect") {
+            st.boxes = item.getString("boxes", "");
+            st.output = item.getString("scores", st.output);
+        }
+        if (st.output.empty()) throw std::runtime_error("Postprocess " + st.type + " needs an output name");
+        st.params = item;
+        stages.push_back(std::move(st));
+    }
+    return stages;
+}
+
+HostOutputs postprocessInputs(MNN::Interpreter* net, MNN::Session* session, std::vector<PostprocessStage>& stages) {
+    HostOutputs hosts;
+    for (auto& st : stages) {
+        auto t0 = clock::now();
+        for (const std::string* name : {&st.output, &st.boxes}) {
+            if (name->empty() || hosts.count(*name)) continue;
+            auto* t = net->getSessionOutput(session, name->c_str());
+            if (!t) throw std::runtime_error("Postprocess output not found: " + *name);
+            std::shared_ptr<MNN::Tensor> host(new MNN::Tensor(t, MNN::Tensor::CAFFE));
+            t->copyToHostTensor(host.get());
+            hosts[*name] = host;
+        }
+        st.copyMs = msBetween(t0, clock::now());
+    }
+    return hosts;
+}
+
+void runPostprocess(std::vector<PostprocessStage>& stages, const HostOutputs& outputs) {
+    for (auto& st : stages) {
+        if (st.type == "detect") {
+            runDetect(st, outputs);
+            continue;
+        }
+        const MNN::Tensor* t = floatOutput(outputs, st.output);
+        std::ostringstream r;
+        r.setf(std::ios::fixed); r.precision(4);
+        if (st.type == "softmax_topk") {
+            const int n = t->elementSize();
+            auto t0 = clock::now();
+            st.scratch.assign(t->host<float>(), t->host<float>() + n);
+            if (st.params.getBool("softmax", true)) softmaxInPlace(st.scratch.data(), n);
+            const auto top = topKIndices(st.scratch.data(), n, st.params.getInt("k", 5));
+            st.kernelMs.push_back(msBetween(t0, clock::now()));
+            r << "{\"top\":[";
+            for (size_t i = 0; i < top.size(); ++i) r << (i ? "," : "") << "{\"index\":" << top[i] << ",\"score\":" << st.scratch[top[i]] << "}";
+            r << "]}";
+        } else {
+            const auto shape = t->shape();
+            if (shape.size() < 3) throw std::runtime_error("argmax expects [N, C, H, W]: " + st.output);
+            const int d = (int)shape.size();
+            const int channels = shape[d - 3];
+            const int area = shape[d - 2] * shape[d - 1];
+            st.labels.resize(area);
+            auto t0 = clock::now();
+            argmaxPlanes(st.labels.data(), t->host<float>(), channels, area); // first batch
+            st.kernelMs.push_back(msBetween(t0, clock::now()));
+            std::vector<std::pair<int, int>> counts(channels);
+            for (int c = 0; c < channels; ++c) counts[c] = {0, c};
+            for (int32_t l : st.labels) counts[l].first++;
+            std::sort(counts.begin(), counts.end(), std::greater<std::pair<int, int>>());
+            r << "{\"classes\":" << channels << ",\"pixels\":" << area << ",\"present\":[";
+            for (int i = 0; i < channels && i < 5 && counts[i].first > 0; ++i) {
+                r << (i ? "," : "") << "{\"class\":" << counts[i].second << ",\"pixels\":" << counts[i].first << "}";
+            }
+            r << "]}";
+        }
+        st.result = r.str();
+    }
+}
+
+void writePostprocess(std::ostream& json, const std::vector<PostprocessStage>& stages) {
+    json << "[";
+    for (size_t i = 0; i < stages.size(); ++i) {
+        const auto& st = stages[i];
+        json << (i ? "," : "") << "{\"type\":\"" << st.type << "\",\"output\":\"" << jsonEscape(st.output) << "\"";
+        if (!st.boxes.empty()) json << ",\"boxes\":\"" << jsonEscape(st.boxes) << "\"";
+        json << ",\"copy_ms\":" << st.copyMs << ",\"latency\":";
+        writeLatency(json, st.kernelMs);
+        if (!st.decodeMs.empty()) {
+            json << ",\"decode\":";
+            writeLatency(json, st.decodeMs);
+            json << ",\"nms\":";
+            writeLatency(json, st.nmsMs);
+        }
+        json << ",\"result\":" << (st.result.empty() ? "null" : st.result) << "}";
+    }
+    json << "]";
+}
+
+double totalPostprocessMs(const std::vector<PostprocessStage>& stages) {
+    double ms = 0.0;
+    for (auto& st : stages) ms += st.copyMs + (st.kernelMs.empty() ? 0.0 : st.kernelMs.back());
+    return ms;
+}
+
+BenchRun benchmarkConfig(const RunOptions& opt, int warmup, int iterations, const BenchHooks& hooks) {
+    BenchRun run;
+    run.rssBeforeBytes = readRssBytes();
+    auto t0 = clock::now();
+    std::unique_ptr<MNN::Interpreter> net(MNN::Interpreter::createFromFile(opt.modelPath.c_str()));
+    if (!net) throw std::runtime_error("Failed to create interpreter");
+    run.createInterpreterMs = msBetween(t0, clock::now());
+    if (!opt.cacheFile.empty()) net->setCacheFile(opt.cacheFile.c_str());
+    for (auto& kv : opt.sessionHints) {
+        net->setSessionHint((MNN::Interpreter::HintMode)kv.first, kv.second);
+    }
+    if (hooks.beforeSession) hooks.beforeSession(net.get());
+
+    MNN::BackendConfig bcfg = makeBackendConfig(opt);
+    MNN::ScheduleConfig cfg = makeScheduleConfig(opt, &bcfg);
+    auto t1 = clock::now();
+    auto session = net->createSession(cfg);
+    if (!session) throw std::runtime_error("Failed to create session");
+    run.createSessionMs = msBetween(t1, clock::now());
+
+    auto t2 = clock::now();
+    resizeInputs(net.get(), session, opt);
+    run.resizeSessionMs = msBetween(t2, clock::now());
+    if (hooks.afterResize) hooks.afterResize(net.get(), session);
+    fillInputs(net.get(), session, opt.inputFill);
+
+    for (int i = 0; i < warmup; ++i) {
+        net->runSession(session);
+        if (hooks.preemptible) yieldPoint();
+    }
+    run.samplesMs.reserve(iterations > 0 ? iterations : 0);
+    // Per-op telemetry: callbacks fire in execution order, so one start stamp is enough.
+    // On GPU backends these are enqueue times unless the backend syncs per op. A loop that does
+    // not get the lease (another one is publishing) runs without callbacks.
+    TelemetryLease telemetry;
+    const bool opTelemetry = opt.telemetryOps && telemetry.held();
+    std::map<const MNN::OperatorInfo*, uint32_t> opIds;
+    clock::time_point opStart;
+    MNN::TensorCallBackWithInfo beforeOp = [&](const std::vector<MNN::Tensor*>&, const MNN::OperatorInfo*) {
+        opStart = clock::now();
+        return true;
+    };
+    MNN::TensorCallBackWithInfo afterOp = [&](const std::vector<MNN::Tensor*>&, const MNN::OperatorInfo* info) {
+        const auto end = clock::now();
+        const double ms = msBetween(opStart, end);
+        auto it = opIds.find(info);
+        if (it == opIds.end()) {
+            it = opIds.emplace(info, telemetry.opId(info ? info->name() : std::string("op"))).first;
+        }
+        if (it->second != UINT32_MAX) telemetry.publish(kTelemetryOp, it->second, ms, end);
+        return true;
+    };
+    telemetry.runBegin((uint32_t)std::max(0, iterations));
+    if (hooks.beforeTimed) hooks.beforeTimed();
+    for (int i = 0; i < iterations || (hooks.keepSampling && hooks.keepSampling(run.samplesMs)); ++i) {
+        auto a = clock::now();
+        if (opTelemetry) {
+            net->runSessionWithCallBackInfo(session, beforeOp, afterOp);
+        } else {
+            net->runSession(session);
+        }
+        const auto b = clock::now();
+        const double ms = msBetween(a, b);
+        run.samplesMs.push_back(ms);
+        telemetry.publish(kTelemetryIteration, (uint32_t)i, ms, b);
+        if (hooks.preemptible) yieldPoint();
+    }
+    if (hooks.afterTimed) hooks.afterTimed();
+    run.rssAfterBytes = readRssBytes();
+    (void)net->getSessionInfo(session, MNN::Interpreter::MEMORY, &run.memoryMb);
+    (void)net->getSessionInfo(session, MNN::Interpreter::FLOPS, &run.flopsM);
+    run.outputs = readOutputs(net.get(), session);
+    if (hooks.afterRun) hooks.afterRun(net.get(), session);
+
+    net->releaseSession(session);
+    return run;
+}
+
+void writeShape(std::ostream& json, const MNN::Tensor* t) {
+    json << "[";
+    for (int i = 0; t && i < t->dimensions(); ++i) {
+        if (i) json << ",";
+        json << t->length(i);
+    }
+    json << "]";
+}
+#endif
+
+#if HAVE_MNN && HAVE_MNN_EXPRESS
+RuntimeManagerPtr makeRuntimeManager(const RunOptions& opt) {
+    using MNN::Express::Executor;
+    MNN::BackendConfig bcfg = makeBackendConfig(opt);
+    MNN::ScheduleConfig cfg = makeScheduleConfig(opt, &bcfg);
+    RuntimeManagerPtr rtmgr(Executor::RuntimeManager::createRuntimeManager(cfg), Executor::RuntimeManager::destroy);
+    if (!rtmgr) throw std::runtime_error("Failed to create RuntimeManager");
+    if (!opt.cacheFile.empty()) rtmgr->setCache(opt.cacheFile);
+    for (auto& kv : opt.sessionHints) rtmgr->setHint((MNN::Interpreter::HintMode)kv.first, kv.second);
+    return rtmgr;
+}
+
+std::vector<MNN::Express::VARP> makeModuleInputs(const MNN::Express::Module::Info* info, const RunOptions& opt,
+                                                 unsigned seed) {
+    using namespace MNN::Express;
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> uni(0.0f, 1.0f);
+    std::normal_distribution<float> norm(0.0f, 1.0f);
+
+    // fillInputs walks the session's inputs in name order with one generator; do the same.
+    std::vector<size_t> order(info->inputNames.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [info](size_t a, size_t b) {
+        return info->inputNames[a] < info->inputNames[b];
+    });
+
+    std::vector<VARP> inputs(info->inputNames.size());
+    for (size_t idx : order) {
+        const auto& name = info->inputNames[idx];
+        const auto& vinfo = info->inputs[idx];
+        std::vector<int> dims = vinfo.dim;
+        auto it = opt.inputShapes.find(name);
+        if (it != opt.inputShapes.end()) dims = it->second;
+        else if (opt.inputShapes.empty() && !opt.inputShape.empty()) dims = opt.inputShape;
+        for (auto& d : dims) if (d <= 0) d = 1;
+
+        // Session hosts of NC4HW4 inputs are NCHW; feed NCHW and let the module convert.
+        const bool packed = vinfo.order == NC4HW4;
+        VARP v = _Input(dims, packed ? NCHW : vinfo.order, vinfo.type);
+        const int n = v->getInfo() ? (int)v->getInfo()->size : 0;
+        const auto code = vinfo.type.code;
+        if (opt.inputFill == "ONE" && code == halide_type_float) {
+            float* ptr = v->writeMap<float>();
+            for (int i = 0; i < n; ++i) ptr[i] = 1.0f;
+        } else if (opt.inputFill == "UNIFORM" && code == halide_type_float) {
+            float* ptr = v->writeMap<float>();
+            for (int i = 0; i < n; ++i) ptr[i] = uni(rng);
+        } else if (opt.inputFill == "NORMAL" && code == halide_type_float) {
+            float* ptr = v->writeMap<float>();
+            for (int i = 0; i < n; ++i) ptr[i] = norm(rng);
+        } else {
+            std::memset(v->writeMap<void>(), 0, (size_t)n * ((vinfo.type.bits + 7) / 8));
+        }
+        inputs[idx] = packed ? _Convert(v, NC4HW4) : v;
+    }
+    return inputs;
+}
+
+NamedOutputs readModuleOutputs(const std::vector<MNN::Express::VARP>& outputs, const std::vector<std::string>& names) {
+    using namespace MNN::Express;
+    NamedOutputs out;
+    for (size_t i = 0; i < outputs.size(); ++i) {
+        VARP v = outputs[i];
+        if (!v.get()) continue;
+        auto* vinfo = v->getInfo();
+        if (vinfo && vinfo->order == NC4HW4) v = _Convert(v, NCHW);
+        if (v->getInfo() && v->getInfo()->type.code != halide_type_float) v = _Cast<float>(v);
+        const float* ptr = v->readMap<float>();
+        const size_t n = v->getInfo() ? v->getInfo()->size : 0;
+        std::vector<float> data;
+        if (ptr) data.assign(ptr, ptr + n);
+        out.emplace_back(i < names.size() ? names[i] : std::to_string(i), std::move(data));
+    }
+    return out;
+}
+#endif
+
+} // namespace runner
@@ -0,0 +1,237 @@
+// Shared helpers for the native run modes: config parsing, session setup,
+// deterministic input fill and small JSON output utilities.
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <ostream>
+#include <functional>
+#include <memory>
+
+#include "mini_json.hpp"
+
+#if HAVE_MNN
+#include "MNN/Interpreter.hpp"
+#include "MNN/Tensor.hpp"
+#endif
+
+#if HAVE_MNN && HAVE_MNN_EXPRESS
+#include "MNN/expr/Module.hpp"
+#include "MNN/expr/Executor.hpp"
+#include "MNN/expr/ExprCreator.hpp"
+#endif
+
+namespace runner {
+
+using clock = std::chrono::steady_clock;
+
+inline double msBetween(clock::time_point a, clock::time_point b) {
+    return std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(b - a).count();
+}
+
+// Mirrors the keys produced by MnnRunConfig.toJson() on the Dart side.
+struct RunOptions {
+    std::string modelPath;
+    std::vector<int> inputShape;
+    // Optional per-input shapes; takes precedence over inputShape when non-empty.
+    std::map<std::string, std::vector<int>> inputShapes;
+    std::string backend = "CPU";
+    std::string backupType = "CPU";
+    std::string memoryMode = "BALANCED";
+    std::string precisionMode = "NORMAL";
+    std::string powerMode = "NORMAL";
+    std::string inputFill = "ZERO";
+    int threads = 4;
+    std::string cacheFile;
+    // Interpreter::HintMode -> value, applied before createSession ("sessionHints": {"5": 1}).
+    std::map<int, int> sessionHints;
+    // Publish per-op times to the telemetry ring during timed iterations ("telemetryOps").
+    // Runs the session with callbacks, so the per-iteration latency includes their cost.
+    bool telemetryOps = false;
+};
+
+// Overlay keys present in `obj` onto `opt`; missing keys keep their current value,
+// so a candidate config can inherit everything but what it overrides.
+void applyRunOptions(const json::Value& obj, RunOptions& opt);
+
+// Canonical input-shape key, e.g. "1x3x224x224" or "a:1x3x8;b:1x4" for per-input shapes.
+std::string shapeSignature(const RunOptions& opt);
+
+// Short human-readable label, e.g. "VULKAN/LOW/4t".
+std::string describeOptions(const RunOptions& opt);
+
+int mapForward(const std::string& s);
+
+std::string jsonEscape(const std::string& s);
+
+// Drift of a candidate tensor against a reference tensor (both flattened to float).
+struct ErrStats {
+    double maxAbs = 0.0;
+    double relL2 = 0.0;
+    double cosine = 1.0;
+    size_t count = 0;
+    bool sizeMismatch = false;
+};
+ErrStats computeErr(const std::vector<float>& ref, const std::vector<float>& cand);
+// Writes ,"max_abs_err":..,"rel_l2_err":..,"cosine":.. (or an element-count error) into an open object.
+void writeErrFields(std::ostream& json, const ErrStats& st);
+
+// Output tensors flattened to float, keyed by name in session order.
+using NamedOutputs = std::vector<std::pair<std::string, std::vector<float>>>;
+// [{"name":..,"elements":..,"max_abs_err":..,...}] for outputs present in both runs.
+void writeOutputErrors(std::ostream& json, const NamedOutputs& ref, const NamedOutputs& cand);
+
+double medianOf(std::vector<double> samples);
+// {"iterations":n,"samples_ms":[raw, in run order],"min_ms":..,"median_ms":..,"mean_ms":..,"max_ms":..}
+void writeLatency(std::ostream& json, std::vector<double> samples);
+
+// Restrict the calling thread to `cpus`; false when empty or the kernel refuses.
+bool pinCurrentThread(const std::vector<int>& cpus);
+
+// Resident set size of this process in bytes, or -1 when /proc is unavailable.
+long long readRssBytes();
+
+// Resident bytes of file mappings whose path starts with one of `prefixes` (from /proc/self/smaps),
+// or -1 when smaps is unavailable.
+long long mappedRssBytes(const std::vector<std::string>& prefixes);
+
+// Whole file into `out`; false when it cannot be opened.
+bool readFile(const std::string& path, std::string& out);
+
+// Write to "<path>.tmp", then rename over `path`, so a crash mid-write never leaves a truncated
+// file behind. False on any I/O error.
+bool writeFileAtomic(const std::string& path, const std::string& data);
+
+#if HAVE_MNN
+const char* forwardName(MNNForwardType t);
+
+MNN::BackendConfig makeBackendConfig(const RunOptions& opt);
+MNN::ScheduleConfig makeScheduleConfig(const RunOptions& opt, MNN::BackendConfig* bcfg);
+
+// Resize inputs per opt.inputShape/inputShapes, then resizeSession.
+void resizeInputs(MNN::Interpreter* net, MNN::Session* session, const RunOptions& opt);
+
+// Same fill semantics as the JNI run paths: ZERO/ONE/UNIFORM/NORMAL for float inputs,
+// zeros for everything else. A fixed seed keeps inputs identical across configs.
+void fillInputs(MNN::Interpreter* net, MNN::Session* session, const std::string& fill, unsigned seed = 42);
+
+// Host staging of inputs and outputs, timed per tensor. `layout` ("stagingLayout"):
+//   NCHW   - host tensor in the input's own dimension type; copyFromHostTensor converts to the
+//            backend layout inside the copy (default, what the run paths always did)
+//   NC4HW4 - the caller supplies data already packed as CAFFE_C4, so the copy needs no conversion
+//   PACK   - NCHW data packed to NC4HW4 on the host with packNC4HW4, timed as pack_ms
+// Only 4-D float32 NCHW tensors take the C4 paths; everything else stages as NCHW.
+struct TensorTransfer {
+    std::string name;
+    std::string layout;  // layout actually used
+    size_t bytes = 0;    // host staging bytes
+    double packMs = 0.0; // PACK: pack (inputs) / unpack (outputs) time
+    double copyMs = 0.0; // copyFromHostTensor / copyToHostTensor
+};
+
+// Fill like fillInputs and upload every input through a staging tensor in `layout`.
+std::vector<TensorTransfer> stageInputs(MNN::Interpreter* net, MNN::Session* session, const std::string& fill,
+                                        const std::string& layout, unsigned seed = 42);
+// Copy every output back to a host tensor in `layout`.
+std::vector<TensorTransfer> downloadOutputs(MNN::Interpreter* net, MNN::Session* session, const std::string& layout);
+// "transfers":{"inputs":[..],"outputs":[..]} with per-tensor pack/copy times.
+void writeTransfers(std::ostream& json, const std::vector<TensorTransfer>& inputs, const std::vector<TensorTransfer>& outputs);
+double totalTransferMs(const std::vector<TensorTransfer>& transfers);
+
+// Copy a (possibly device) tensor to host in NCHW order and widen to float.
+std::vector<float> tensorToFloat(const MNN::Tensor* t);
+
+NamedOutputs readOutputs(MNN::Interpreter* net, MNN::Session* session);
+
+// createFromFile with the active profile hints, cache file and session hints of `opt` applied.
+std::unique_ptr<MNN::Interpreter> loadInterpreter(const RunOptions& opt);
+// Host tensor (same dimension type) holding a copy of `t`.
+std::shared_ptr<MNN::Tensor> hostCopy(const MNN::Tensor* t);
+// Resize the named inputs of `session` to the staged tensors' shapes when they differ, then upload.
+void loadNamedInputs(MNN::Interpreter* net, MNN::Session* session, const std::vector<std::string>& names,
+                     const std::map<std::string, std::shared_ptr<MNN::Tensor>>& staged);
+
+// Postprocess stages attached to named outputs ("postprocess": [{type, ...}]), on the kernels of
+// postprocess.hpp over host NCHW float copies:
+//   softmax_topk - "output", "k" (5), "softmax" (true)
+//   detect       - one "output" (YOLO-style, "layout" rows [N, 4+C] or columns [4+C, N], guessed
+//                  from the shape) or "boxes" + "scores"; "boxFormat" cxcywh|xyxy, "objectness",
+//                  "scoreThreshold" (0.25), "iouThreshold" (0.45), "maxDetections" (100), "classAware"
+//   argmax       - "output" [N, C, H, W]: per-pixel class, pixel count per class
+struct PostprocessStage {
+    std::string type;
+    std::string output; // scores for detect
+    std::string boxes;  // detect with separate boxes
+    json::Value params;
+    double copyMs = 0.0;                 // last host copy of the outputs it reads
+    std::vector<double> kernelMs;        // per run
+    std::vector<double> decodeMs, nmsMs; // detect: kernelMs split
+    std::string result;                  // JSON of the last run
+    std::vector<float> scratch;
+    std::vector<int32_t> labels;
+};
+using HostOutputs = std::map<std::string, std::shared_ptr<MNN::Tensor>>;
+
+// Throws on an unknown type or a stage without its output name.
+std::vector<PostprocessStage> parsePostprocess(const json::Value* list);
+// Host NCHW float copies of every output the stages read; copy time goes to each stage's copyMs.
+HostOutputs postprocessInputs(MNN::Interpreter* net, MNN::Session* session, std::vector<PostprocessStage>& stages);
+// Run each stage on `outputs` (host NCHW float tensors by name), timing each separately.
+void runPostprocess(std::vector<PostprocessStage>& stages, const HostOutputs& outputs);
+// [{"type","output","copy_ms","latency",..,"result"}]
+void writePostprocess(std::ostream& json, const std::vector<PostprocessStage>& stages);
+// Copy + kernel time of the last run, summed over stages.
+double totalPostprocessMs(const std::vector<PostprocessStage>& stages);
+
+struct BenchRun {
+    std::vector<double> samplesMs;
+    double createInterpreterMs = 0.0;
+    double createSessionMs = 0.0;
+    double resizeSessionMs = 0.0;
+    float memoryMb = 0.0f;
+    float flopsM = 0.0f;
+    long long rssBeforeBytes = -1; // before createFromFile
+    long long rssAfterBytes = -1;  // after the timed iterations
+    NamedOutputs outputs;
+};
+
+struct BenchHooks {
+    // Called before createSession, for session modes/hints and external files.
+    std::function<void(MNN::Interpreter*)> beforeSession;
+    // Called after the timed iterations and output capture, before the session is released.
+    std::function<void(MNN::Interpreter*, MNN::Session*)> afterRun;
+    // Called once the session is created and resized, before inputs are filled (e.g. releaseModel).
+    std::function<void(MNN::Interpreter*, MNN::Session*)> afterResize;
+    // Called right before the first and right after the last timed iteration (energy counters).
+    std::function<void()> beforeTimed;
+    std::function<void()> afterTimed;
+    // Adaptive sampling: once `iterations` timed runs are done, keep running while this returns true.
+    std::function<bool(const std::vector<double>& samplesMs)> keepSampling;
+    // Let queued interactive executor jobs run between iterations (see executor.hpp); off where
+    // the timed window must hold nothing else, e.g. an energy counter.
+    bool preemptible = true;
+};
+
+// Load the model, create a session for `opt`, fill inputs and time `iterations` runSession calls
+// after `warmup` untimed ones. Throws std::runtime_error when the interpreter/session cannot be created.
+BenchRun benchmarkConfig(const RunOptions& opt, int warmup, int iterations, const BenchHooks& hooks = BenchHooks());
+
+void writeShape(std::ostream& json, const MNN::Tensor* t);
+#endif
+
+#if HAVE_MNN && HAVE_MNN_EXPRESS
+using RuntimeManagerPtr = std::shared_ptr<MNN::Express::Executor::RuntimeManager>;
+
+// RuntimeManager for `opt` with its cache file and session hints applied.
+RuntimeManagerPtr makeRuntimeManager(const RunOptions& opt);
+
+// Module inputs shaped per opt.inputShape/inputShapes (else the model's dims, unknown dims as 1)
+// and filled exactly like fillInputs, so outputs are comparable with the session path.
+std::vector<MNN::Express::VARP> makeModuleInputs(const MNN::Express::Module::Info* info, const RunOptions& opt,
+                                                 unsigned seed = 42);
+
+NamedOutputs readModuleOutputs(const std::vector<MNN::Express::VARP>& outputs, const std::vector<std::string>& names);
+#endif
+
+} // namespace runner
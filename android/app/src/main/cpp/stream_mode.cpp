@@ -0,0 +1,527 @@
+// Camera-style streaming: frames are read from a Y4M or raw video file at a target frame rate and
+// pass through preprocess (ImageProcess colour conversion + resize + normalize) -> inference ->
+// postprocess (the "postprocess" stages, default top-k of the first output), one thread per stage,
+// connected by bounded lock-free SPSC rings.
+//
+// Like a camera HAL, the source never waits: when the first queue is full or every frame buffer is
+// in flight, the frame is dropped and counted ("dropPolicy": "drop"). "block" makes the source wait
+// instead, which measures the throughput ceiling. Reports end-to-end frames/s, per-stage latency and
+// queue wait, queue occupancy and drops.
+#include "modes.hpp"
+#include "runner_common.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#if HAVE_MNN
+#include "MNN/ImageProcess.hpp"
+#endif
+
+namespace runner {
+
+#if HAVE_MNN
+namespace {
+
+// Bounded single-producer single-consumer ring; one slot is kept empty to tell full from empty.
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity) : buf_(capacity + 1) {}
+
+    bool tryPush(T v) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        const size_t next = (head + 1) % buf_.size();
+        if (next == tail_.load(std::memory_order_acquire)) return false;
+        buf_[head] = v;
+        head_.store(next, std::memory_order_release);
+        return true;
+    }
+    bool tryPop(T& v) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) return false;
+        v = buf_[tail];
+        tail_.store((tail + 1) % buf_.size(), std::memory_order_release);
+        return true;
+    }
+    size_t size() const {
+        const size_t head = head_.load(std::memory_order_acquire);
+        const size_t tail = tail_.load(std::memory_order_acquire);
+        return (head + buf_.size() - tail) % buf_.size();
+    }
+    size_t capacity() const { return buf_.size() - 1; }
+    void close() { closed_.store(true, std::memory_order_release); }
+    bool closed() const { return closed_.load(std::memory_order_acquire); }
+
+private:
+    std::vector<T> buf_;
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+    std::atomic<bool> closed_{false};
+};
+
+// Spin briefly, then yield, then sleep: an idle stage must not take cores away from inference.
+class Backoff {
+public:
+    void pause() {
+        if (n_ < 64) {
+            // busy spin
+        } else if (n_ < 128) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+        ++n_;
+    }
+
+private:
+    int n_ = 0;
+};
+
+// Occupancy seen by the producer right after each push.
+struct QueueStats {
+    double occupancySum = 0.0;
+    size_t pushes = 0;
+    size_t maxOccupancy = 0;
+    size_t fullPushes = 0; // pushes that found the ring full (dropped or waited)
+    void sample(size_t occupancy) {
+        occupancySum += occupancy;
+        maxOccupancy = std::max(maxOccupancy, occupancy);
+        ++pushes;
+    }
+};
+
+template <typename T>
+bool popWait(SpscRing<T>& q, T& v, double& waitMs) {
+    if (q.tryPop(v)) return true;
+    auto t0 = clock::now();
+    Backoff backoff;
+    bool got = true;
+    while (!q.tryPop(v)) {
+        if (q.closed()) {
+            got = q.tryPop(v); // a push may have landed just before close
+            break;
+        }
+        backoff.pause();
+    }
+    waitMs += msBetween(t0, clock::now());
+    return got;
+}
+
+template <typename T>
+void pushWait(SpscRing<T>& q, T v, QueueStats& stats, double& blockedMs) {
+    if (!q.tryPush(v)) {
+        stats.fullPushes++;
+        auto t0 = clock::now();
+        Backoff backoff;
+        while (!q.tryPush(v)) backoff.pause();
+        blockedMs += msBetween(t0, clock::now());
+    }
+    stats.sample(q.size());
+}
+
+struct Frame {
+    std::vector<uint8_t> raw;
+    std::shared_ptr<MNN::Tensor> input;                // preprocessed, host NCHW
+    std::vector<std::shared_ptr<MNN::Tensor>> outputs; // host NCHW copies of the session outputs
+    HostOutputs named;                                 // the same tensors by output name
+    int index = 0;
+    clock::time_point captured, preStart, preEnd, inferStart, inferEnd, postStart, postEnd;
+};
+
+struct VideoSource {
+    std::ifstream in;
+    bool y4m = false;
+    std::string formatName;
+    MNN::CV::ImageFormat format = MNN::CV::YUV_I420;
+    int width = 0;
+    int height = 0;
+    size_t frameBytes = 0;
+    double fileFps = 0.0;
+    std::streampos firstFrame;
+    long long fileFrames = 0;
+
+    // Next frame into buf; false at end of file.
+    bool read(std::vector<uint8_t>& buf) {
+        if (y4m) {
+            std::string marker;
+            if (!std::getline(in, marker)) return false;
+            if (marker.compare(0, 5, "FRAME") != 0) throw std::runtime_error("Y4M: expected FRAME marker");
+        }
+        buf.resize(frameBytes);
+        in.read(reinterpret_cast<char*>(buf.data()), (std::streamsize)frameBytes);
+        return (size_t)in.gcount() == frameBytes;
+    }
+    void rewind() {
+        in.clear();
+        in.seekg(firstFrame);
+    }
+};
+
+size_t yuv420Bytes(int w, int h) {
+    return (size_t)w * h + 2 * (size_t)((w + 1) / 2) * ((h + 1) / 2);
+}
+
+// Y4M: "YUV4MPEG2 W.. H.. F.. C..\n" then "FRAME\n" + planar data per frame. Anything else is raw
+// frames of "format" at "width" x "height".
+void openSource(VideoSource& src, const std::string& path, const json::Value& root) {
+    src.in.open(path, std::ios::binary);
+    if (!src.in) throw std::runtime_error("Cannot open video: " + path);
+    std::string header;
+    std::getline(src.in, header);
+    if (header.compare(0, 10, "YUV4MPEG2 ") == 0) {
+        src.y4m = true;
+        std::string colour = "420jpeg";
+        std::istringstream tokens(header.substr(10));
+        std::string tok;
+        while (tokens >> tok) {
+            const std::string v = tok.substr(1);
+            switch (tok[0]) {
+                case 'W': src.width = std::atoi(v.c_str()); break;
+                case 'H': src.height = std::atoi(v.c_str()); break;
+                case 'C': colour = v; break;
+                case 'F': {
+                    const auto colon = v.find(':');
+                    const double num = std::atof(v.substr(0, colon).c_str());
+                    const double den = colon == std::string::npos ? 1.0 : std::atof(v.substr(colon + 1).c_str());
+                    if (den > 0.0) src.fileFps = num / den;
+                    break;
+                }
+                default: break;
+            }
+        }
+        if (colour.compare(0, 3, "420") == 0) {
+            src.format = MNN::CV::YUV_I420;
+            src.formatName = "I420";
+            src.frameBytes = yuv420Bytes(src.width, src.height);
+        } else if (colour == "mono") {
+            src.format = MNN::CV::GRAY;
+            src.formatName = "GRAY";
+            src.frameBytes = (size_t)src.width * src.height;
+        } else {
+            throw std::runtime_error("Y4M colour space C" + colour + " not supported (420* or mono)");
+        }
+        src.firstFrame = src.in.tellg();
+    } else {
+        src.width = root.getInt("width", 0);
+        src.height = root.getInt("height", 0);
+        src.formatName = root.getString("format", "I420");
+        const size_t px = (size_t)src.width * src.height;
+        const std::string& f = src.formatName;
+        if (f == "I420") src.format = MNN::CV::YUV_I420, src.frameBytes = yuv420Bytes(src.width, src.height);
+        else if (f == "NV12") src.format = MNN::CV::YUV_NV12, src.frameBytes = yuv420Bytes(src.width, src.height);
+        else if (f == "NV21") src.format = MNN::CV::YUV_NV21, src.frameBytes = yuv420Bytes(src.width, src.height);
+        else if (f == "RGB") src.format = MNN::CV::RGB, src.frameBytes = px * 3;
+        else if (f == "BGR") src.format = MNN::CV::BGR, src.frameBytes = px * 3;
+        else if (f == "RGBA") src.format = MNN::CV::RGBA, src.frameBytes = px * 4;
+        else if (f == "GRAY") src.format = MNN::CV::GRAY, src.frameBytes = px;
+        else throw std::runtime_error("Unknown raw format: " + f);
+        src.firstFrame = 0;
+        src.rewind();
+    }
+    if (src.width <= 0 || src.height <= 0) throw std::runtime_error("Video size unknown (give \"width\"/\"height\" for raw files)");
+    src.in.seekg(0, std::ios::end);
+    const long long dataBytes = (long long)src.in.tellg() - (long long)src.firstFrame;
+    src.fileFrames = dataBytes / (long long)(src.frameBytes + (src.y4m ? 6 : 0));
+    src.rewind();
+    if (src.fileFrames <= 0) throw std::runtime_error("Video holds no complete frame: " + path);
+}
+
+void writeQueue(std::ostream& json, const char* name, const SpscRing<Frame*>& q, const QueueStats& s) {
+    json << "{\"name\":\"" << name << "\",\"capacity\":" << q.capacity()
+         << ",\"pushes\":" << s.pushes
+         << ",\"mean_occupancy\":" << (s.pushes ? s.occupancySum / s.pushes : 0.0)
+         << ",\"max_occupancy\":" << s.maxOccupancy
+         << ",\"full_pushes\":" << s.fullPushes << "}";
+}
+
+} // namespace
+#endif
+
+std::string runStream(const std::string& configJson) {
+#if HAVE_MNN
+    try {
+        json::Value root = json::parse(configJson);
+        RunOptions opt;
+        applyRunOptions(root, opt);
+        if (opt.modelPath.empty()) throw std::runtime_error("Missing modelPath");
+        const std::string videoPath = root.getString("videoPath", "");
+        if (videoPath.empty()) throw std::runtime_error("Missing videoPath (a .y4m or raw frame file)");
+
+        VideoSource src;
+        openSource(src, videoPath, root);
+        const double targetFps = std::max(0.0, root.getNumber("targetFps", src.fileFps > 0.0 ? src.fileFps : 30.0));
+        const bool paced = targetFps > 0.0;
+        const std::string dropPolicy = root.getString("dropPolicy", paced ? "drop" : "block");
+        const bool dropping = dropPolicy != "block";
+        const int frames = std::max(1, root.getInt("frames", 300));
+        const bool loop = root.getBool("loop", true);
+        const int warmupFrames = std::max(0, root.getInt("warmupFrames", 10));
+        const int queueDepth = std::max(1, root.getInt("queueDepth", 2));
+
+        auto net = loadInterpreter(opt);
+        MNN::BackendConfig bcfg = makeBackendConfig(opt);
+        MNN::ScheduleConfig cfg = makeScheduleConfig(opt, &bcfg);
+        auto* session = net->createSession(cfg);
+        if (!session) throw std::runtime_error("Failed to create session");
+        resizeInputs(net.get(), session, opt);
+        MNN::Tensor* modelInput = net->getSessionInput(session, nullptr);
+        if (!modelInput || modelInput->dimensions() != 4) throw std::runtime_error("Streaming needs a 4-D image input");
+        const auto& outputMap = net->getSessionOutputAll(session);
+        std::vector<std::pair<std::string, MNN::Tensor*>> modelOutputs(outputMap.begin(), outputMap.end());
+        // Postprocess stages; without any, top-"topK" of the first output.
+        std::vector<PostprocessStage> postStages = parsePostprocess(root.get("postprocess"));
+        if (postStages.empty() && !modelOutputs.empty()) {
+            json::Value topk = json::Value::makeObject();
+            topk.set("type", json::Value::makeString("softmax_topk"));
+            topk.set("output", json::Value::makeString(modelOutputs[0].first));
+            topk.set("k", json::Value::makeNumber(std::max(1, root.getInt("topK", 5))));
+            topk.set("softmax", json::Value::makeBool(false));
+            json::Value list = json::Value::makeArray();
+            list.items.push_back(topk);
+            postStages = parsePostprocess(&list);
+        }
+
+        // Preprocess: source pixels -> model channels, scaled to the input size, (x - mean) * normal.
+        std::unique_ptr<MNN::Tensor> inputShape(new MNN::Tensor(modelInput, MNN::Tensor::CAFFE));
+        const int channels = inputShape->channel();
+        MNN::CV::ImageProcess::Config ic;
+        ic.sourceFormat = src.format;
+        ic.destFormat = channels == 1 ? MNN::CV::GRAY
+                       : channels == 4 ? MNN::CV::RGBA
+                       : root.getString("channelOrder", "RGB") == "BGR" ? MNN::CV::BGR : MNN::CV::RGB;
+        ic.filterType = root.getString("filter", "bilinear") == "nearest" ? MNN::CV::NEAREST : MNN::CV::BILINEAR;
+        for (int c = 0; c < 4; ++c) ic.normal[c] = 1.0f / 255.0f;
+        if (auto* v = root.get("mean")) for (size_t c = 0; c < v->items.size() && c < 4; ++c) ic.mean[c] = (float)v->items[c].number;
+        if (auto* v = root.get("normal")) for (size_t c = 0; c < v->items.size() && c < 4; ++c) ic.normal[c] = (float)v->items[c].number;
+        std::unique_ptr<MNN::CV::ImageProcess, decltype(&MNN::CV::ImageProcess::destroy)> process(
+            MNN::CV::ImageProcess::create(ic), MNN::CV::ImageProcess::destroy);
+        MNN::CV::Matrix scale;
+        scale.setScale((float)src.width / std::max(1, inputShape->width()), (float)src.height / std::max(1, inputShape->height()));
+        process->setMatrix(scale);
+
+        // Frame buffers: every queue full plus one in each stage's hands, so drops come from the
+        // queue bound rather than from running out of buffers.
+        const int poolFrames = 3 * queueDepth + 4;
+        std::vector<std::unique_ptr<Frame>> pool;
+        SpscRing<Frame*> toPre(queueDepth), toInfer(queueDepth), toPost(queueDepth), freeFrames(poolFrames);
+        for (int i = 0; i < poolFrames; ++i) {
+            std::unique_ptr<Frame> f(new Frame());
+            f->raw.resize(src.frameBytes);
+            f->input.reset(new MNN::Tensor(modelInput, MNN::Tensor::CAFFE));
+            for (auto& o : modelOutputs) {
+                std::shared_ptr<MNN::Tensor> host(new MNN::Tensor(o.second, MNN::Tensor::CAFFE));
+                f->outputs.push_back(host);
+                f->named[o.first] = host;
+            }
+            freeFrames.tryPush(f.get());
+            pool.push_back(std::move(f));
+        }
+
+        // One untimed pass so the first streamed frame does not pay for lazy allocation.
+        {
+            Frame* f = pool[0].get();
+            if (!src.read(f->raw)) throw std::runtime_error("Cannot read the first frame");
+            src.rewind();
+            process->convert(f->raw.data(), src.width, src.height, 0, f->input.get());
+            modelInput->copyFromHostTensor(f->input.get());
+            net->runSession(session);
+        }
+
+        QueueStats preStats, inferStats, postStats;
+        size_t emitted = 0, droppedFull = 0, droppedNoBuffer = 0, lateFrames = 0;
+        double sourceBlocked = 0.0, preWait = 0.0, preBlocked = 0.0, inferWait = 0.0, inferBlocked = 0.0, postWait = 0.0, freeBlocked = 0.0;
+        std::vector<double> readMs, preMs, inferMs, postMs, preQueueMs, inferQueueMs, postQueueMs, e2eMs;
+        std::vector<clock::time_point> doneAt;
+        int lastIndex = -1;
+        std::string sourceError;
+        std::string postError;
+        QueueStats freeStats; // post -> source recycling, never full
+
+        const auto t0 = clock::now();
+        std::thread source([&] {
+            const auto period = paced ? std::chrono::duration<double>(1.0 / targetFps) : std::chrono::duration<double>(0.0);
+            Frame* spare = nullptr;
+            std::vector<uint8_t> scratch;
+            try {
+                for (int i = 0; i < frames; ++i) {
+                    if (paced) {
+                        const auto due = t0 + std::chrono::duration_cast<clock::duration>(period * i);
+                        const auto now = clock::now();
+                        if (now < due) std::this_thread::sleep_until(due);
+                        else if (now - due > period) lateFrames++;
+                    }
+                    Frame* f = spare;
+                    spare = nullptr;
+                    if (!f) freeFrames.tryPop(f);
+                    if (!f && !dropping) popWait(freeFrames, f, sourceBlocked);
+                    auto r0 = clock::now();
+                    std::vector<uint8_t>& buf = f ? f->raw : scratch; // a dropped frame is still consumed
+                    bool ok = src.read(buf);
+                    if (!ok && loop) {
+                        src.rewind();
+                        ok = src.read(buf);
+                    }
+                    if (!ok) {
+                        spare = f;
+                        break;
+                    }
+                    readMs.push_back(msBetween(r0, clock::now()));
+                    emitted++;
+                    if (!f) {
+                        droppedNoBuffer++;
+                        continue;
+                    }
+                    f->index = i;
+                    f->captured = r0;
+                    if (dropping) {
+                        if (!toPre.tryPush(f)) {
+                            preStats.fullPushes++;
+                            droppedFull++;
+                            spare = f;
+                            continue;
+                        }
+                        preStats.sample(toPre.size());
+                    } else {
+                        pushWait(toPre, f, preStats, sourceBlocked);
+                    }
+                }
+            } catch (const std::exception& ex) {
+                sourceError = ex.what();
+            }
+            toPre.close();
+        });
+        std::thread pre([&] {
+            Frame* f = nullptr;
+            while (popWait(toPre, f, preWait)) {
+                f->preStart = clock::now();
+                process->convert(f->raw.data(), src.width, src.height, 0, f->input.get());
+                f->preEnd = clock::now();
+                pushWait(toInfer, f, inferStats, preBlocked);
+            }
+            toInfer.close();
+        });
+        std::thread infer([&] {
+            Frame* f = nullptr;
+            while (popWait(toInfer, f, inferWait)) {
+                f->inferStart = clock::now();
+                modelInput->copyFromHostTensor(f->input.get());
+                net->runSession(session);
+                for (size_t i = 0; i < modelOutputs.size(); ++i) modelOutputs[i].second->copyToHostTensor(f->outputs[i].get());
+                f->inferEnd = clock::now();
+                pushWait(toPost, f, postStats, inferBlocked);
+            }
+            toPost.close();
+        });
+        std::thread post([&] {
+            Frame* f = nullptr;
+            while (popWait(toPost, f, postWait)) {
+                f->postStart = clock::now();
+                if (postError.empty()) {
+                    // A bad stage fails the run but the frame still goes back to the pool, so the
+                    // upstream stages drain instead of blocking on freeFrames.
+                    try {
+                        runPostprocess(postStages, f->named);
+                    } catch (const std::exception& ex) {
+                        postError = ex.what();
+                    }
+                }
+                f->postEnd = clock::now();
+                lastIndex = f->index;
+                preQueueMs.push_back(msBetween(f->captured, f->preStart));
+                preMs.push_back(msBetween(f->preStart, f->preEnd));
+                inferQueueMs.push_back(msBetween(f->preEnd, f->inferStart));
+                inferMs.push_back(msBetween(f->inferStart, f->inferEnd));
+                postQueueMs.push_back(msBetween(f->inferEnd, f->postStart));
+                postMs.push_back(msBetween(f->postStart, f->postEnd));
+                e2eMs.push_back(msBetween(f->captured, f->postEnd));
+                doneAt.push_back(f->postEnd);
+                pushWait(freeFrames, f, freeStats, freeBlocked);
+            }
+        });
+        source.join();
+        pre.join();
+        infer.join();
+        post.join();
+        const double wallMs = msBetween(t0, clock::now());
+        net->releaseSession(session);
+        if (!sourceError.empty()) throw std::runtime_error(sourceError);
+        if (!postError.empty()) throw std::runtime_error("postprocess: " + postError);
+
+        const size_t completed = e2eMs.size();
+        const size_t dropped = droppedFull + droppedNoBuffer;
+        const int warm = std::min<int>(warmupFrames, (int)completed / 2);
+        double steadyFps = 0.0;
+        if ((int)completed - warm >= 2) {
+            const double ms = msBetween(doneAt[warm], doneAt[completed - 1]);
+            if (ms > 0.0) steadyFps = (completed - 1 - warm) * 1000.0 / ms;
+        }
+        auto steady = [warm](const std::vector<double>& v) {
+            return std::vector<double>(v.begin() + std::min<size_t>(warm, v.size()), v.end());
+        };
+
+        std::ostringstream json;
+        json.setf(std::ios::fixed); json.precision(3);
+        json << "{\"stream\":true,\"config\":\"" << describeOptions(opt) << "\""
+             << ",\"source\":{\"path\":\"" << jsonEscape(videoPath) << "\""
+             << ",\"container\":\"" << (src.y4m ? "y4m" : "raw") << "\""
+             << ",\"format\":\"" << src.formatName << "\""
+             << ",\"width\":" << src.width << ",\"height\":" << src.height
+             << ",\"file_fps\":" << src.fileFps
+             << ",\"file_frames\":" << src.fileFrames << "}"
+             << ",\"target_fps\":" << targetFps
+             << ",\"drop_policy\":\"" << (dropping ? "drop" : "block") << "\""
+             << ",\"queue_depth\":" << queueDepth
+             << ",\"pool_frames\":" << poolFrames
+             << ",\"emitted\":" << emitted
+             << ",\"completed\":" << completed
+             << ",\"dropped\":" << dropped
+             << ",\"drop_rate\":" << (emitted ? (double)dropped / emitted : 0.0)
+             << ",\"drops\":{\"queue_full\":" << droppedFull << ",\"no_buffer\":" << droppedNoBuffer << "}"
+             << ",\"late_frames\":" << lateFrames
+             << ",\"wall_ms\":" << wallMs
+             << ",\"fps\":{\"end_to_end\":" << (wallMs > 0.0 ? completed * 1000.0 / wallMs : 0.0)
+             << ",\"steady\":" << steadyFps
+             << ",\"source\":" << (wallMs > 0.0 ? emitted * 1000.0 / wallMs : 0.0) << "}"
+             << ",\"warmup_frames\":" << warm
+             << ",\"latency\":";
+        writeLatency(json, steady(e2eMs));
+        json << ",\"stages\":[{\"name\":\"source\",\"latency\":";
+        writeLatency(json, readMs);
+        json << ",\"blocked_ms\":" << sourceBlocked << "},{\"name\":\"preprocess\",\"latency\":";
+        writeLatency(json, steady(preMs));
+        json << ",\"queue_wait\":";
+        writeLatency(json, steady(preQueueMs));
+        json << ",\"starved_ms\":" << preWait << ",\"blocked_ms\":" << preBlocked
+             << "},{\"name\":\"inference\",\"latency\":";
+        writeLatency(json, steady(inferMs));
+        json << ",\"queue_wait\":";
+        writeLatency(json, steady(inferQueueMs));
+        json << ",\"starved_ms\":" << inferWait << ",\"blocked_ms\":" << inferBlocked
+             << "},{\"name\":\"postprocess\",\"latency\":";
+        writeLatency(json, steady(postMs));
+        json << ",\"queue_wait\":";
+        writeLatency(json, steady(postQueueMs));
+        json << ",\"starved_ms\":" << postWait << "}],\"queues\":[";
+        writeQueue(json, "source->preprocess", toPre, preStats);
+        json << ",";
+        writeQueue(json, "preprocess->inference", toInfer, inferStats);
+        json << ",";
+        writeQueue(json, "inference->postprocess", toPost, postStats);
+        json << "],\"last_frame\":" << lastIndex << ",\"postprocess\":";
+        writePostprocess(json, postStages);
+        json << "}";
+        return json.str();
+    } catch (const std::exception& ex) {
+        return std::string("{\"error\":\"") + jsonEscape(ex.what()) + "\"}";
+    }
+#else
+    (void)configJson;
+    return "{\"error\":\"MNN not bundled. Cannot run the video stream. Place headers and libMNN.so as documented.\"}";
+#endif
+}
+
+} // namespace runner
@@ -0,0 +1,115 @@
+// Host entry point for the manifest suite runner (built with -DMNN_RUNNER_HOST_CLI=ON):
+//
+//   mnn_suite manifest.json [--model-dir DIR] [--state-dir DIR] [--results DIR]
+//             [--label TAG] [--out report.json] [--no-resume] [--retry-crashed]
+//
+// Prints the same consolidated report the app gets from runSuite; exits 1 on a suite error
+// and 2 when any cell failed or crashed, so CI can gate on it.
+//
+//   mnn_suite --mode runStream config.json [--results DIR] [--label TAG] [--out report.json]
+//
+// runs a single JSON mode on a config file instead (e.g. runStream with a local .y4m as the
+// source); exits 1 when the report is an error.
+#include "modes.hpp"
+#include "mini_json.hpp"
+#include "runner_common.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+
+namespace {
+
+int usage() {
+    std::fprintf(stderr,
+                 "usage: mnn_suite manifest.json [--model-dir DIR] [--state-dir DIR] [--results DIR]\n"
+                 "                 [--label TAG] [--out report.json] [--no-resume] [--retry-crashed]\n"
+                 "       mnn_suite --mode MODE config.json [--results DIR] [--label TAG] [--out report.json]\n");
+    return 1;
+}
+
+// JSON modes that make sense without the app around them.
+const std::map<std::string, std::string (*)(const std::string&)>& hostModes() {
+    static const std::map<std::string, std::string (*)(const std::string&)> modes = {
+        {"runStream", runner::runStream},     {"runPipeline", runner::runPipeline},
+        {"runAdaptive", runner::runAdaptive}, {"runOpenLoop", runner::runOpenLoop},
+        {"runEnergy", runner::runEnergy},     {"runCompare", runner::runCompare},
+        {"runMultiPath", runner::runMultiPath}, {"runOpBench", runner::runOpBench},
+        {"buildCostTable", runner::buildCostTable}, {"predictLatency", runner::predictLatency},
+    };
+    return modes;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    json::Value config = json::Value::makeObject();
+    std::string outPath, resultsDir, mode;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) throw std::runtime_error("missing value for " + arg);
+            return argv[++i];
+        };
+        try {
+            if (arg == "--model-dir") config.set("modelDir", json::Value::makeString(next()));
+            else if (arg == "--state-dir") config.set("suiteDir", json::Value::makeString(next()));
+            else if (arg == "--label") config.set("resultLabel", json::Value::makeString(next()));
+            else if (arg == "--results") resultsDir = next();
+            else if (arg == "--out") outPath = next();
+            else if (arg == "--mode") mode = next();
+            else if (arg == "--no-resume") config.set("resume", json::Value::makeBool(false));
+            else if (arg == "--retry-crashed") config.set("retryCrashed", json::Value::makeBool(true));
+            else if (arg == "-h" || arg == "--help") return usage();
+            else if (!arg.empty() && arg[0] == '-') return usage();
+            else config.set("manifestPath", json::Value::makeString(arg));
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "mnn_suite: %s\n", e.what());
+            return usage();
+        }
+    }
+    if (!config.has("manifestPath")) return usage();
+
+    std::string configJson, report;
+    if (mode.empty()) {
+        mode = "runSuite";
+        configJson = json::dump(config);
+        report = runner::runSuite(configJson);
+    } else {
+        auto it = hostModes().find(mode);
+        if (it == hostModes().end()) {
+            std::fprintf(stderr, "mnn_suite: unknown mode %s\n", mode.c_str());
+            return usage();
+        }
+        try {
+            const std::string path = config.getString("manifestPath");
+            std::string text;
+            if (!runner::readFile(path, text)) throw std::runtime_error("cannot read " + path);
+            json::Value modeConfig = json::parse(text);
+            if (config.has("resultLabel")) modeConfig.set("resultLabel", *config.get("resultLabel"));
+            configJson = json::dump(modeConfig);
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "mnn_suite: %s\n", e.what());
+            return 1;
+        }
+        report = it->second(configJson);
+    }
+    if (!resultsDir.empty()) {
+        runner::setResultStoreDir(resultsDir);
+        const std::string id = runner::recordResult(mode, configJson, report);
+        if (!id.empty()) std::fprintf(stderr, "mnn_suite: stored result %s\n", id.c_str());
+    }
+    if (!outPath.empty()) {
+        std::ofstream out(outPath, std::ios::binary);
+        out << report << "\n";
+    }
+    std::cout << report << std::endl;
+
+    json::Value parsed = json::parse(report);
+    if (parsed.has("error")) return 1;
+    if (mode != "runSuite") return 0;
+    return parsed.getInt("failed") + parsed.getInt("crashed") > 0 ? 2 : 0;
+}
@@ -0,0 +1,332 @@
+// Manifest-driven benchmark suite: models x backends x threads x precisions run as one matrix,
+// with every finished cell checkpointed to <suiteDir>/<name>-<manifest hash>.state.jsonl so a
+// run that died mid-way (OOM kill, driver crash) resumes where it stopped.
+//
+// The same manifest runs on device through the method channel and on a host through the
+// mnn_suite CLI (suite_cli.cpp), so both produce the same consolidated report.
+#include "modes.hpp"
+#include "runner_common.hpp"
+#include "device_info.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace runner {
+
+#if HAVE_MNN
+namespace {
+
+struct SuiteModel {
+    std::string name;
+    RunOptions opt;
+    int warmup = 0;
+    int iterations = 0;
+};
+
+struct SuiteCell {
+    std::string key; // "<model>/<backend>/<threads>t/<precision>"
+    const SuiteModel* model = nullptr;
+    RunOptions opt;
+};
+
+std::string dirName(const std::string& path) {
+    const size_t slash = path.rfind('/');
+    return slash == std::string::npos ? std::string(".") : path.substr(0, slash);
+}
+
+std::string baseName(const std::string& path) {
+    const size_t slash = path.rfind('/');
+    std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+    const size_t dot = name.rfind('.');
+    return dot == std::string::npos || dot == 0 ? name : name.substr(0, dot);
+}
+
+std::vector<std::string> stringList(const json::Value& manifest, const char* key, const std::string& def) {
+    std::vector<std::string> out;
+    if (auto* v = manifest.get(key)) {
+        if (v->isString()) out.push_back(v->str);
+        for (auto& e : v->items) if (e.isString()) out.push_back(e.str);
+    }
+    if (out.empty()) out.push_back(def);
+    return out;
+}
+
+std::vector<int> intList(const json::Value& manifest, const char* key, int def) {
+    std::vector<int> out;
+    if (auto* v = manifest.get(key)) {
+        if (v->isNumber()) out.push_back((int)v->number);
+        for (auto& e : v->items) if (e.isNumber()) out.push_back((int)e.number);
+    }
+    if (out.empty()) out.push_back(def);
+    return out;
+}
+
+// Models resolve relative paths against `modelDir`, so one manifest serves the device's
+// model folder and a host checkout alike.
+std::vector<SuiteModel> parseModels(const json::Value& manifest, const RunOptions& defaults, const std::string& modelDir,
+                                    int warmup, int iterations) {
+    const json::Value* models = manifest.get("models");
+    if (!models || !models->isArray() || models->items.empty()) throw std::runtime_error("Manifest has no \"models\"");
+    std::vector<SuiteModel> out;
+    std::set<std::string> names;
+    for (auto& m : models->items) {
+        SuiteModel sm;
+        sm.opt = defaults;
+        std::string path = m.isString() ? m.str : m.getString("path", m.getString("modelPath"));
+        if (path.empty()) throw std::runtime_error("Manifest model without \"path\"");
+        if (m.isObject()) applyRunOptions(m, sm.opt);
+        if (path[0] != '/' && !modelDir.empty()) path = modelDir + "/" + path;
+        sm.opt.modelPath = path;
+        sm.name = m.isObject() ? m.getString("name", baseName(path)) : baseName(path);
+        if (!names.insert(sm.name).second) throw std::runtime_error("Duplicate model name in manifest: " + sm.name);
+        sm.warmup = std::max(0, m.isObject() ? m.getInt("warmup", warmup) : warmup);
+        sm.iterations = std::max(1, m.isObject() ? m.getInt("iterations", iterations) : iterations);
+        out.push_back(std::move(sm));
+    }
+    return out;
+}
+
+// Append one checkpoint line and flush it to storage before the next cell starts.
+void appendState(const std::string& path, const json::Value& line) {
+    const std::string text = json::dump(line) + "\n";
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) return;
+    (void)::write(fd, text.data(), text.size());
+    ::fsync(fd);
+    ::close(fd);
+}
+
+struct CellState {
+    bool started = false;
+    bool done = false;
+    bool crashed = false;
+    json::Value result;
+};
+
+// Last state per cell key; a "started" line with nothing after it means the process died in that cell.
+std::map<std::string, CellState> loadState(const std::string& path) {
+    std::map<std::string, CellState> out;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+        json::Value v;
+        try {
+            v = json::parse(line);
+        } catch (const std::exception&) {
+            continue; // torn last line
+        }
+        CellState& st = out[v.getString("key")];
+        const std::string status = v.getString("status");
+        if (status == "started") {
+            st.started = true;
+        } else if (status == "done" || status == "failed") {
+            st.done = true;
+            if (auto* r = v.get("result")) st.result = *r;
+        } else if (status == "crashed") {
+            st.crashed = true;
+        }
+    }
+    return out;
+}
+
+json::Value runCell(const SuiteCell& cell) {
+    std::ostringstream json;
+    json.setf(std::ios::fixed); json.precision(3);
+    try {
+        BenchRun b = benchmarkConfig(cell.opt, cell.model->warmup, cell.model->iterations);
+        json << "{\"status\":\"ok\""
+             << ",\"createInterpreter_ms\":" << b.createInterpreterMs
+             << ",\"createSession_ms\":" << b.createSessionMs
+             << ",\"resizeSession_ms\":" << b.resizeSessionMs
+             << ",\"memory_mb\":" << b.memoryMb
+             << ",\"flops_m\":" << b.flopsM
+             << ",\"rss_delta_mb\":"
+             << (b.rssBeforeBytes >= 0 && b.rssAfterBytes >= 0 ? (double)(b.rssAfterBytes - b.rssBeforeBytes) / (1024.0 * 1024.0) : -1.0)
+             << ",\"latency\":";
+        writeLatency(json, b.samplesMs);
+        json << "}";
+    } catch (const std::exception& e) {
+        json.str(std::string());
+        json << "{\"status\":\"failed\",\"error\":\"" << jsonEscape(e.what()) << "\"}";
+    }
+    return json::parse(json.str());
+}
+
+void writeCell(std::ostream& json, const SuiteCell& cell, const json::Value& result, bool resumed) {
+    json << "{\"config\":\"" << jsonEscape(cell.key) << "\""
+         << ",\"model\":\"" << jsonEscape(cell.model->name) << "\""
+         << ",\"model_path\":\"" << jsonEscape(cell.opt.modelPath) << "\""
+         << ",\"input_shape\":\"" << jsonEscape(shapeSignature(cell.opt)) << "\""
+         << ",\"input_fill\":\"" << jsonEscape(cell.opt.inputFill) << "\""
+         << ",\"backend\":\"" << jsonEscape(cell.opt.backend) << "\""
+         << ",\"threads\":" << cell.opt.threads
+         << ",\"precision\":\"" << jsonEscape(cell.opt.precisionMode) << "\""
+         << ",\"resumed\":" << (resumed ? "true" : "false");
+    for (size_t i = 0; i < result.keys.size(); ++i) {
+        json << ",\"" << jsonEscape(result.keys[i]) << "\":" << json::dump(result.items[i]);
+    }
+    json << "}";
+}
+
+} // namespace
+
+std::string runSuite(const std::string& configJson) {
+    try {
+        json::Value root = json::parse(configJson);
+        const std::string manifestPath = root.getString("manifestPath");
+        std::string manifestText;
+        if (auto* inlineManifest = root.get("manifest")) {
+            manifestText = json::dump(*inlineManifest);
+        } else if (!manifestPath.empty()) {
+            if (!readFile(manifestPath, manifestText)) throw std::runtime_error("Cannot read manifest: " + manifestPath);
+        } else {
+            throw std::runtime_error("Missing manifest or manifestPath");
+        }
+        json::Value manifest = json::parse(manifestText);
+        if (!manifest.isObject()) throw std::runtime_error("Manifest must be a JSON object");
+
+        const std::string modelDir = root.getString("modelDir", manifest.getString("modelDir",
+                manifestPath.empty() ? std::string() : dirName(manifestPath)));
+        RunOptions defaults;
+        if (auto* d = manifest.get("defaults")) applyRunOptions(*d, defaults);
+        const int warmup = manifest.getInt("warmup", 2);
+        const int iterations = manifest.getInt("iterations", 20);
+        std::vector<SuiteModel> models = parseModels(manifest, defaults, modelDir, warmup, iterations);
+        const std::vector<std::string> backends = stringList(manifest, "backends", defaults.backend);
+        const std::vector<int> threads = intList(manifest, "threads", defaults.threads);
+        const std::vector<std::string> precisions = stringList(manifest, "precisions", defaults.precisionMode);
+
+        std::vector<SuiteCell> cells;
+        for (auto& m : models) {
+            for (auto& backend : backends) {
+                for (int t : threads) {
+                    for (auto& precision : precisions) {
+                        SuiteCell cell;
+                        cell.model = &m;
+                        cell.opt = m.opt;
+                        cell.opt.backend = backend;
+                        cell.opt.threads = t;
+                        cell.opt.precisionMode = precision;
+                        cell.key = m.name + "/" + backend + "/" + std::to_string(t) + "t/" + precision;
+                        cells.push_back(std::move(cell));
+                    }
+                }
+            }
+        }
+
+        // A manifest edit gets a fresh state file instead of resuming a different matrix.
+        const std::string suiteName = manifest.getString("name", manifestPath.empty() ? std::string("suite") : baseName(manifestPath));
+        const std::string manifestHash = hex64(fnv1a(manifestText.data(), manifestText.size()));
+        const std::string suiteDir = root.getString("suiteDir");
+        const bool resume = root.getBool("resume", true);
+        const bool retryCrashed = root.getBool("retryCrashed", false);
+        std::string statePath;
+        std::map<std::string, CellState> state;
+        if (!suiteDir.empty()) {
+            ::mkdir(suiteDir.c_str(), 0755);
+            statePath = suiteDir + "/" + suiteName + "-" + manifestHash + ".state.jsonl";
+            if (resume) {
+                state = loadState(statePath);
+            } else {
+                ::unlink(statePath.c_str());
+            }
+        }
+
+        std::ostringstream cellsJson;
+        int ran = 0, resumed = 0, failed = 0, crashed = 0;
+        for (size_t i = 0; i < cells.size(); ++i) {
+            const SuiteCell& cell = cells[i];
+            auto it = state.find(cell.key);
+            json::Value result;
+            bool fromState = false;
+            if (it != state.end() && it->second.done) {
+                result = it->second.result;
+                fromState = true;
+                ++resumed;
+            } else if (it != state.end() && (it->second.started || it->second.crashed) && !retryCrashed) {
+                // The previous attempt took the process down; skip it rather than crash-loop.
+                if (!it->second.crashed) {
+                    json::Value mark = json::Value::makeObject();
+                    mark.set("key", json::Value::makeString(cell.key));
+                    mark.set("status", json::Value::makeString("crashed"));
+                    appendState(statePath, mark);
+                }
+                result = json::parse("{\"status\":\"crashed\",\"error\":\"Process died during this cell on a previous attempt\"}");
+                ++crashed;
+            } else {
+                if (!statePath.empty()) {
+                    json::Value mark = json::Value::makeObject();
+                    mark.set("key", json::Value::makeString(cell.key));
+                    mark.set("status", json::Value::makeString("started"));
+                    appendState(statePath, mark);
+                }
+                result = runCell(cell);
+                ++ran;
+                if (!statePath.empty()) {
+                    json::Value line = json::Value::makeObject();
+                    line.set("key", json::Value::makeString(cell.key));
+                    line.set("status", json::Value::makeString(result.getString("status") == "ok" ? "done" : "failed"));
+                    line.set("result", result);
+                    appendState(statePath, line);
+                }
+            }
+            if (result.getString("status") == "failed") ++failed;
+            if (i) cellsJson << ",";
+            writeCell(cellsJson, cell, result, fromState);
+        }
+
+        // Fastest successful cell per model, by median latency.
+        std::ostringstream bestJson;
+        json::Value allCells = json::parse("[" + cellsJson.str() + "]");
+        bool firstBest = true;
+        for (auto& m : models) {
+            const json::Value* best = nullptr;
+            double bestMedian = 0.0;
+            for (auto& c : allCells.items) {
+                if (c.getString("model") != m.name || c.getString("status") != "ok") continue;
+                const json::Value* lat = c.get("latency");
+                const double median = lat ? lat->getNumber("median_ms") : 0.0;
+                if (!best || median < bestMedian) { best = &c; bestMedian = median; }
+            }
+            if (!best) continue;
+            bestJson << (firstBest ? "" : ",") << "{\"model\":\"" << jsonEscape(m.name) << "\""
+                     << ",\"config\":\"" << jsonEscape(best->getString("config")) << "\""
+                     << ",\"median_ms\":" << bestMedian << "}";
+            firstBest = false;
+        }
+
+        std::ostringstream json;
+        json.setf(std::ios::fixed); json.precision(3);
+        json << "{\"suite\":\"" << jsonEscape(suiteName) << "\""
+             << ",\"manifest_hash\":\"" << manifestHash << "\""
+             << ",\"state_file\":\"" << jsonEscape(statePath) << "\""
+             << ",\"device\":";
+        writeDeviceJson(json, deviceInfo());
+        json << ",\"cells_total\":" << cells.size()
+             << ",\"ran\":" << ran
+             << ",\"resumed\":" << resumed
+             << ",\"failed\":" << failed
+             << ",\"crashed\":" << crashed
+             << ",\"cells\":[" << cellsJson.str() << "]"
+             << ",\"fastest\":[" << bestJson.str() << "]}";
+        return json.str();
+    } catch (const std::exception& e) {
+        return std::string("{\"error\":\"") + jsonEscape(e.what()) + "\"}";
+    }
+}
+#else
+std::string runSuite(const std::string& configJson) {
+    (void)configJson;
+    return "{\"error\":\"MNN not bundled. Cannot run benchmark suite. Place headers and libMNN.so as documented.\"}";
+}
+#endif
+
+} // namespace runner
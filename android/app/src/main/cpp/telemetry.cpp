@@ -0,0 +1,116 @@
+#include "telemetry.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+namespace runner {
+
+std::atomic<TelemetryRing*> gTelemetry{nullptr};
+
+namespace {
+
+std::mutex gTelemetryMutex;
+TelemetryRing gRing;
+std::atomic<bool> gLeased{false};
+
+uint32_t roundUpPow2(uint32_t v) {
+    uint32_t p = 64;
+    while (p < v && p < (1u << 24)) p <<= 1;
+    return p;
+}
+
+} // namespace
+
+TelemetryRing* openTelemetry(uint32_t capacity, uint32_t opCapacity) {
+    std::lock_guard<std::mutex> lock(gTelemetryMutex);
+    if (!gRing.base) {
+        const uint32_t slots = roundUpPow2(capacity ? capacity : 4096);
+        const uint32_t ops = opCapacity ? opCapacity : 512;
+        const size_t bytes = TelemetryRing::kHeaderBytes + (size_t)slots * TelemetryRing::kSlotBytes +
+                             (size_t)ops * TelemetryRing::kOpNameBytes;
+        void* mem = nullptr;
+        if (posix_memalign(&mem, 64, bytes) != 0) return nullptr;
+        std::memset(mem, 0, bytes);
+        gRing.base = static_cast<uint8_t*>(mem);
+        gRing.bytes = bytes;
+        gRing.mask = slots - 1;
+        gRing.opCapacity = ops;
+        auto* words = reinterpret_cast<uint32_t*>(gRing.base);
+        words[0] = TelemetryRing::kMagic;
+        words[1] = TelemetryRing::kVersion;
+        words[2] = slots;
+        words[3] = (uint32_t)TelemetryRing::kSlotBytes;
+        words[4] = ops;
+        words[5] = (uint32_t)TelemetryRing::kOpNameBytes;
+    }
+    // The sequence keeps counting across close/open, so readers never see it go backwards.
+    gTelemetry.store(&gRing, std::memory_order_release);
+    return &gRing;
+}
+
+void closeTelemetry() {
+    gTelemetry.store(nullptr, std::memory_order_release);
+}
+
+bool mirrorTelemetry(uint64_t from, uint8_t* dst, size_t dstBytes) {
+    // The ring's geometry is written once, before the first buffer was handed out.
+    TelemetryRing* ring = &gRing;
+    if (!ring->base || !dst || dstBytes < ring->bytes) return false;
+    const uint64_t head = ring->headWord()->load(std::memory_order_acquire);
+    const uint32_t opCount = ring->opCountWord()->load(std::memory_order_acquire);
+    std::memcpy(dst, ring->base, 24);
+    std::memcpy(dst + 24, &opCount, sizeof(opCount));
+    std::memcpy(dst + 64, &head, sizeof(head));
+
+    const uint64_t slots = (uint64_t)ring->mask + 1;
+    uint64_t seq = from > head ? head : (head - from > slots ? head - slots : from);
+    for (; seq < head; ++seq) {
+        const uint8_t* s = ring->slot(seq);
+        uint8_t* d = dst + (ring->slot(seq) - ring->base);
+        const auto* seqWord = reinterpret_cast<const std::atomic<uint64_t>*>(s);
+        const uint64_t before = seqWord->load(std::memory_order_acquire);
+        std::memcpy(d + 8, s + 8, TelemetryRing::kSlotBytes - 8);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t after = seqWord->load(std::memory_order_relaxed);
+        const uint64_t checked = before == after ? before : 0;
+        std::memcpy(d, &checked, sizeof(checked));
+    }
+    const size_t names = (size_t)(ring->opName(0) - reinterpret_cast<char*>(ring->base));
+    std::memcpy(dst + names, ring->base + names, (size_t)opCount * TelemetryRing::kOpNameBytes);
+    return true;
+}
+
+TelemetryLease::TelemetryLease() {
+    TelemetryRing* ring = gTelemetry.load(std::memory_order_acquire);
+    if (!ring) return;
+    bool expected = false;
+    if (gLeased.compare_exchange_strong(expected, true, std::memory_order_acquire)) ring_ = ring;
+}
+
+TelemetryLease::~TelemetryLease() {
+    if (ring_) gLeased.store(false, std::memory_order_release);
+}
+
+void TelemetryLease::runBegin(uint32_t plannedIterations) {
+    if (!ring_) return;
+    ++ring_->run;
+    publish(kTelemetryRunBegin, plannedIterations, 0.0, std::chrono::steady_clock::now());
+}
+
+uint32_t TelemetryLease::opId(const std::string& name) {
+    TelemetryRing* ring = ring_;
+    if (!ring) return UINT32_MAX;
+    const uint32_t count = ring->opCountWord()->load(std::memory_order_relaxed);
+    for (uint32_t i = 0; i < count; ++i) {
+        if (std::strncmp(ring->opName(i), name.c_str(), TelemetryRing::kOpNameBytes - 1) == 0) return i;
+    }
+    if (count >= ring->opCapacity) return UINT32_MAX;
+    char* dst = ring->opName(count);
+    std::strncpy(dst, name.c_str(), TelemetryRing::kOpNameBytes - 1);
+    dst[TelemetryRing::kOpNameBytes - 1] = '\0';
+    ring->opCountWord()->store(count + 1, std::memory_order_release);
+    return count;
+}
+
+} // namespace runner
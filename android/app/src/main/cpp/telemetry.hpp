@@ -0,0 +1,122 @@
+// Live latency telemetry: a single-producer ring of fixed-size records in one block of memory
+// that Kotlin maps as a direct ByteBuffer and polls, so samples cross JNI without a call or a
+// JSON encode each. Publishing is a handful of plain stores plus two release stores.
+//
+// Layout (native byte order, little-endian on every Android ABI):
+//   0   u32 magic 'MNNT'        4   u32 version
+//   8   u32 capacity (slots, power of two)
+//   12  u32 slot size (32)      16  u32 op name capacity    20 u32 op name size (48)
+//   24  u32 op count (release)  28  u32 reserved
+//   64  u64 head: sequence number of the next record (release), alone on its cache line
+//   128 slots[capacity]:  u64 seq (record number + 1, stored last with release)
+//                         u16 kind, u16 run, u32 index, f64 value_ms, u64 t_ns (steady clock)
+//   then op names[op name capacity] of 48 bytes, NUL-terminated; id = position.
+//
+// A reader re-checks a slot's seq after copying it: a changed seq means the producer lapped
+// the reader and the record is dropped, never torn. Callers pass the timestamp they already
+// took for the latency, so publishing never reads the clock itself.
+//
+// Single producer: only the holder of the TelemetryLease writes the ring. Several loops can be
+// timing at once (executor workers, an interactive job inlined at a yield point inside a
+// background run); the first to take the lease publishes, the others publish nothing until it is
+// released. Taking and releasing the lease is an acquire/release pair, so the producer-local
+// head and run counter hand over cleanly between threads.
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace runner {
+
+enum TelemetryKind : uint16_t {
+    kTelemetryRunBegin = 1, // index: planned iterations, value: 0
+    kTelemetryIteration = 2, // index: iteration, value: latency in ms
+    kTelemetryOp = 3,        // index: op name id, value: op time in ms within the current iteration
+    kTelemetryToken = 4,     // index: decode step, value: step latency in ms
+};
+
+struct TelemetryRing {
+    static constexpr uint32_t kMagic = 0x544e4e4d; // "MNNT"
+    static constexpr uint32_t kVersion = 1;
+    static constexpr size_t kHeaderBytes = 128;
+    static constexpr size_t kSlotBytes = 32;
+    static constexpr size_t kOpNameBytes = 48;
+
+    uint8_t* base = nullptr;
+    size_t bytes = 0;
+    uint32_t mask = 0;
+    uint32_t opCapacity = 0;
+    uint64_t head = 0;  // producer-local copy of the published head
+    uint16_t run = 0;
+
+    std::atomic<uint64_t>* headWord() { return reinterpret_cast<std::atomic<uint64_t>*>(base + 64); }
+    std::atomic<uint32_t>* opCountWord() { return reinterpret_cast<std::atomic<uint32_t>*>(base + 24); }
+    uint8_t* slot(uint64_t seq) { return base + kHeaderBytes + (size_t)(seq & mask) * kSlotBytes; }
+    char* opName(uint32_t id) {
+        return reinterpret_cast<char*>(base + kHeaderBytes + (size_t)(mask + 1) * kSlotBytes + (size_t)id * kOpNameBytes);
+    }
+};
+
+// The open ring, or null. Loaded relaxed on every publish, so an idle ring costs one load.
+extern std::atomic<TelemetryRing*> gTelemetry;
+
+// Allocate the ring on first call and start publishing; returns it for the JNI side to wrap.
+// Capacity is rounded up to a power of two and fixed by the first call, since a ByteBuffer
+// may still view it.
+TelemetryRing* openTelemetry(uint32_t capacity, uint32_t opCapacity);
+// Stop publishing; the memory stays valid for readers that still hold the buffer.
+void closeTelemetry();
+// Copy of the ring for readers that cannot order their own loads (a Kotlin reader without
+// VarHandle fences, API < 33): the header with head loaded acquire, the records in
+// [from, head) at their usual slot positions and the op name table. A record the producer
+// overwrote during the copy gets seq 0, so the reader drops it. dst must be ring-sized;
+// returns false when it is not or no ring was ever opened.
+bool mirrorTelemetry(uint64_t from, uint8_t* dst, size_t dstBytes);
+
+// Exclusive right to publish, held for the length of one timed loop. Not held when the ring is
+// closed or another loop holds it; every call is then a no-op.
+class TelemetryLease {
+public:
+    TelemetryLease();
+    ~TelemetryLease();
+    TelemetryLease(const TelemetryLease&) = delete;
+    TelemetryLease& operator=(const TelemetryLease&) = delete;
+
+    bool held() const { return ring_ != nullptr; }
+
+    // Marks the start of a benchmark loop so readers can reset their histograms.
+    void runBegin(uint32_t plannedIterations);
+    inline void publish(uint16_t kind, uint32_t index, double valueMs, std::chrono::steady_clock::time_point at);
+    // Id of an op name in the name table, registering it on first use; UINT32_MAX when the table
+    // is full or the lease is not held.
+    uint32_t opId(const std::string& name);
+
+private:
+    TelemetryRing* ring_ = nullptr;
+};
+
+inline void TelemetryLease::publish(uint16_t kind, uint32_t index, double valueMs,
+                                    std::chrono::steady_clock::time_point at) {
+    // The lease keeps the ring; closeTelemetry still stops publishing mid-loop.
+    if (!ring_ || !gTelemetry.load(std::memory_order_relaxed)) return;
+    TelemetryRing* ring = ring_;
+    const uint64_t seq = ring->head;
+    uint8_t* s = ring->slot(seq);
+    auto* seqWord = reinterpret_cast<std::atomic<uint64_t>*>(s);
+    // Invalidate first so a reader that raced onto this slot sees the overwrite.
+    seqWord->store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    *reinterpret_cast<uint16_t*>(s + 8) = kind;
+    *reinterpret_cast<uint16_t*>(s + 10) = ring->run;
+    *reinterpret_cast<uint32_t*>(s + 12) = index;
+    *reinterpret_cast<double*>(s + 16) = valueMs;
+    *reinterpret_cast<uint64_t*>(s + 24) =
+            (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(at.time_since_epoch()).count();
+    seqWord->store(seq + 1, std::memory_order_release);
+    ring->head = seq + 1;
+    ring->headWord()->store(seq + 1, std::memory_order_release);
+}
+
+} // namespace runner
@@ -0,0 +1,349 @@
+// Persisted per-device, per-model "best known config" records.
+//
+// One JSON file per (device fingerprint, model hash) under the directory set by
+// setTuningProfileDir(). runTuneProfile() sweeps a few configs and stores the fastest;
+// applyTuningProfile() merges the stored config into a run config at load time and
+// queues a short background benchmark when the record is stale.
+#include "modes.hpp"
+#include "runner_common.hpp"
+#include "device_info.hpp"
+#include "executor.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <sys/stat.h>
+
+namespace runner {
+
+namespace {
+
+// Guards the in-memory state below only; run paths take it for applyActiveHints, so nothing
+// slow (hashing, file I/O) happens under it.
+std::mutex gMutex;
+std::string gProfileDir;
+// Session hints of the profile last applied per model path; the JNI run paths apply them after load.
+std::map<std::string, std::map<int, int>> gActiveHints;
+std::set<std::string> gRevalidating;
+// Serialises the record writers (tuning, revalidation) so one's read-modify-write never drops the
+// other's update. Readers need no lock: records are replaced by rename.
+std::mutex gRecordMutex;
+
+// A record whose revalidated latency is this much slower than when it was tuned is flagged for re-tuning.
+constexpr double kRegressionRatio = 1.15;
+
+long long nowSeconds() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+std::string deviceKey() {
+    const auto fp = deviceInfo().fingerprint();
+    return hex64(fnv1a(fp.data(), fp.size()));
+}
+
+std::string profilePath(const std::string& dir, const std::string& modelHash) {
+    return dir + "/" + deviceKey() + "_" + modelHash + ".json";
+}
+
+bool loadRecord(const std::string& path, json::Value& record) {
+    std::string text;
+    if (!readFile(path, text)) return false;
+    try {
+        record = json::parse(text);
+    } catch (const std::exception&) {
+        return false;
+    }
+    return record.isObject();
+}
+
+bool hasBucket(const json::Value& record, const std::string& sig) {
+    auto* buckets = record.get("shape_buckets");
+    if (!buckets || buckets->size() == 0) return true; // no buckets recorded: valid for any shape
+    for (auto& b : buckets->items) {
+        if (b.isString() && b.str == sig) return true;
+    }
+    return false;
+}
+
+#if HAVE_MNN
+std::string profileDir() {
+    std::lock_guard<std::mutex> lock(gMutex);
+    return gProfileDir;
+}
+
+json::Value configToJson(const RunOptions& opt) {
+    json::Value cfg = json::Value::makeObject();
+    cfg.set("backend", json::Value::makeString(opt.backend));
+    cfg.set("backupType", json::Value::makeString(opt.backupType));
+    cfg.set("threads", json::Value::makeNumber(opt.threads));
+    cfg.set("precisionMode", json::Value::makeString(opt.precisionMode));
+    cfg.set("memoryMode", json::Value::makeString(opt.memoryMode));
+    cfg.set("powerMode", json::Value::makeString(opt.powerMode));
+    json::Value hints = json::Value::makeObject();
+    for (auto& kv : opt.sessionHints) hints.set(std::to_string(kv.first), json::Value::makeNumber(kv.second));
+    cfg.set("sessionHints", hints);
+    return cfg;
+}
+
+void revalidate(std::string path, RunOptions opt) {
+    double median = 0.0;
+    bool ok = true;
+    try {
+        BenchRun run = benchmarkConfig(opt, 1, 5);
+        median = medianOf(run.samplesMs);
+    } catch (const std::exception&) {
+        ok = false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(gMutex);
+        gRevalidating.erase(path);
+    }
+    std::lock_guard<std::mutex> lock(gRecordMutex);
+    json::Value record;
+    if (!loadRecord(path, record)) return;
+    record.set("validated_at", json::Value::makeNumber((double)nowSeconds()));
+    if (ok) {
+        const double tuned = record.getNumber("median_ms", 0.0);
+        record.set("validated_median_ms", json::Value::makeNumber(median));
+        record.set("regressed", json::Value::makeBool(tuned > 0.0 && median > tuned * kRegressionRatio));
+    } else {
+        // The stored config no longer loads (driver/plugin change): stop applying it.
+        record.set("invalid", json::Value::makeBool(true));
+    }
+    writeFileAtomic(path, json::dump(record));
+}
+#endif
+
+} // namespace
+
+void setTuningProfileDir(const std::string& dir) {
+    if (!dir.empty()) ::mkdir(dir.c_str(), 0755);
+    std::lock_guard<std::mutex> lock(gMutex);
+    gProfileDir = dir;
+}
+
+std::string applyTuningProfile(const std::string& configJson) {
+    json::Value root;
+    try {
+        root = json::parse(configJson);
+    } catch (const std::exception&) {
+        return configJson; // leave malformed configs for the caller to report
+    }
+    RunOptions opt;
+    applyRunOptions(root, opt);
+    json::Value info = json::Value::makeObject();
+    auto finish = [&](const char* reason) {
+        info.set("applied", json::Value::makeBool(false));
+        info.set("reason", json::Value::makeString(reason));
+        root.set("tuningProfile", info);
+        return json::dump(root);
+    };
+
+    std::string dir;
+    {
+        std::lock_guard<std::mutex> lock(gMutex);
+        gActiveHints.erase(opt.modelPath);
+        dir = gProfileDir;
+    }
+    if (root.getBool("overrideProfile", false)) return finish("override");
+    if (dir.empty() || opt.modelPath.empty()) return finish("no_profile_dir");
+    const std::string modelHash = hashModelFile(opt.modelPath);
+    if (modelHash.empty()) return finish("model_unreadable");
+    const std::string path = profilePath(dir, modelHash);
+    json::Value record;
+    if (!loadRecord(path, record)) return finish("no_record");
+    if (record.getBool("invalid", false)) return finish("invalid_record");
+    if (!hasBucket(record, shapeSignature(opt))) return finish("shape_not_tuned");
+    const json::Value* cfg = record.get("config");
+    if (!cfg || !cfg->isObject()) return finish("no_record");
+
+    for (size_t i = 0; i < cfg->keys.size(); ++i) root.set(cfg->keys[i], cfg->items[i]);
+    RunOptions merged;
+    applyRunOptions(root, merged);
+
+    const double maxAgeDays = root.getNumber("profileMaxAgeDays", 7.0);
+    const long long age = nowSeconds() - (long long)record.getNumber("validated_at", 0.0);
+    const bool stale = age > (long long)(maxAgeDays * 86400.0);
+    bool revalidating = false;
+    bool launch = false;
+    {
+        std::lock_guard<std::mutex> lock(gMutex);
+        gActiveHints[merged.modelPath] = merged.sessionHints;
+        revalidating = gRevalidating.count(path) > 0;
+#if HAVE_MNN
+        if (stale && !revalidating && !root.getBool("skipRevalidation", false)) {
+            gRevalidating.insert(path);
+            revalidating = launch = true;
+        }
+#endif
+    }
+#if HAVE_MNN
+    if (launch) {
+        // Short background job keyed by the model, so it never overlaps a run of the same model
+        // and yields to interactive work between iterations.
+        submitJob(Priority::Background, merged.modelPath, [path, merged] { revalidate(path, merged); });
+    }
+#else
+    (void)launch;
+#endif
+
+    info.set("applied", json::Value::makeBool(true));
+    info.set("key", json::Value::makeString(deviceKey() + "_" + modelHash));
+    info.set("config", *cfg);
+    info.set("median_ms", json::Value::makeNumber(record.getNumber("median_ms", 0.0)));
+    info.set("age_s", json::Value::makeNumber((double)age));
+    info.set("stale", json::Value::makeBool(stale));
+    info.set("revalidating", json::Value::makeBool(revalidating));
+    info.set("regressed", json::Value::makeBool(record.getBool("regressed", false)));
+    root.set("tuningProfile", info);
+    return json::dump(root);
+}
+
+void applyActiveHints(MNN::Interpreter* net, const std::string& modelPath) {
+#if HAVE_MNN
+    std::lock_guard<std::mutex> lock(gMutex);
+    auto it = gActiveHints.find(modelPath);
+    if (it == gActiveHints.end()) return;
+    for (auto& kv : it->second) net->setSessionHint((MNN::Interpreter::HintMode)kv.first, kv.second);
+#else
+    (void)net;
+    (void)modelPath;
+#endif
+}
+
+std::map<int, int> activeHints(const std::string& modelPath) {
+    std::lock_guard<std::mutex> lock(gMutex);
+    auto it = gActiveHints.find(modelPath);
+    return it == gActiveHints.end() ? std::map<int, int>() : it->second;
+}
+
+#if HAVE_MNN
+std::string runTuneProfile(const std::string& configJson) {
+    try {
+        json::Value root = json::parse(configJson);
+        RunOptions base;
+        applyRunOptions(root, base);
+        if (base.modelPath.empty()) throw std::runtime_error("Missing modelPath");
+        const int warmup = std::max(0, root.getInt("warmup", 1));
+        const int iterations = std::max(1, root.getInt("iterations", 5));
+
+        std::vector<RunOptions> cands;
+        if (auto* c = root.get("candidates")) {
+            for (auto& item : c->items) {
+                RunOptions o = base;
+                applyRunOptions(item, o);
+                cands.push_back(o);
+            }
+        }
+        if (cands.empty()) {
+            // Default sweep: thread counts up to the core count x NORMAL/LOW precision on the selected backend.
+            const int cores = deviceInfo().cores;
+            std::vector<int> threads = root.getIntArray("threadCandidates");
+            if (threads.empty()) threads = {1, 2, 4, cores};
+            std::sort(threads.begin(), threads.end());
+            threads.erase(std::unique(threads.begin(), threads.end()), threads.end());
+            std::vector<std::string> precisions;
+            if (auto* p = root.get("precisionCandidates")) {
+                for (auto& e : p->items) if (e.isString()) precisions.push_back(e.str);
+            }
+            if (precisions.empty()) precisions = {"NORMAL", "LOW"};
+            for (int t : threads) {
+                if (t < 1 || t > cores) continue;
+                for (auto& prec : precisions) {
+                    RunOptions o = base;
+                    o.threads = t;
+                    o.precisionMode = prec;
+                    cands.push_back(o);
+                }
+            }
+        }
+
+        std::ostringstream json;
+        json.setf(std::ios::fixed); json.precision(3);
+        json << "{\"tune\":true,\"device\":";
+        writeDeviceJson(json, deviceInfo());
+        json << ",\"candidates\":[";
+        int best = -1;
+        double bestMedian = 0.0;
+        for (size_t i = 0; i < cands.size(); ++i) {
+            if (i) json << ",";
+            json << "{\"label\":\"" << jsonEscape(describeOptions(cands[i])) << "\"";
+            try {
+                BenchRun run = benchmarkConfig(cands[i], warmup, iterations);
+                const double median = medianOf(run.samplesMs);
+                json << ",\"memory_mb\":" << run.memoryMb << ",\"latency\":";
+                writeLatency(json, run.samplesMs);
+                if (best < 0 || median < bestMedian) {
+                    best = (int)i;
+                    bestMedian = median;
+                }
+            } catch (const std::exception& e) {
+                json << ",\"error\":\"" << jsonEscape(e.what()) << "\"";
+            }
+            json << "}";
+        }
+        json << "]";
+        if (best < 0) {
+            json << ",\"saved\":false}";
+            return json.str();
+        }
+        json << ",\"best\":\"" << jsonEscape(describeOptions(cands[best])) << "\",\"best_median_ms\":" << bestMedian;
+
+        const std::string dir = profileDir();
+        const std::string modelHash = dir.empty() ? std::string() : hashModelFile(base.modelPath);
+        if (modelHash.empty()) {
+            json << ",\"saved\":false}";
+            return json.str();
+        }
+        const std::string path = profilePath(dir, modelHash);
+        const json::Value cfg = configToJson(cands[best]);
+        const std::string sig = shapeSignature(base);
+
+        // Keep the shape buckets of an existing record when the winner is unchanged; a new winner starts over.
+        std::lock_guard<std::mutex> lock(gRecordMutex);
+        json::Value buckets = json::Value::makeArray();
+        json::Value old;
+        if (loadRecord(path, old)) {
+            auto* oldCfg = old.get("config");
+            auto* oldBuckets = old.get("shape_buckets");
+            if (oldCfg && oldBuckets && json::dump(*oldCfg) == json::dump(cfg)) buckets = *oldBuckets;
+        }
+        bool present = false;
+        for (auto& b : buckets.items) present = present || (b.isString() && b.str == sig);
+        if (!present) buckets.items.push_back(json::Value::makeString(sig));
+
+        const auto& dev = deviceInfo();
+        json::Value record = json::Value::makeObject();
+        json::Value device = json::Value::makeObject();
+        device.set("cpu", json::Value::makeString(dev.cpuModel));
+        device.set("core_layout", json::Value::makeString(dev.coreLayout));
+        device.set("abi", json::Value::makeString(dev.abi));
+        device.set("mnn_version", json::Value::makeString(dev.mnnVersion));
+        record.set("version", json::Value::makeNumber(1));
+        record.set("device", device);
+        record.set("model_hash", json::Value::makeString(modelHash));
+        record.set("model_path", json::Value::makeString(base.modelPath));
+        record.set("config", cfg);
+        record.set("shape_buckets", buckets);
+        record.set("median_ms", json::Value::makeNumber(bestMedian));
+        record.set("created_at", json::Value::makeNumber((double)nowSeconds()));
+        record.set("validated_at", json::Value::makeNumber((double)nowSeconds()));
+        const bool saved = writeFileAtomic(path, json::dump(record));
+        json << ",\"saved\":" << (saved ? "true" : "false")
+             << ",\"path\":\"" << jsonEscape(path) << "\"}";
+        return json.str();
+    } catch (const std::exception& e) {
+        return std::string("{\"error\":\"") + jsonEscape(e.what()) + "\"}";
+    }
+}
+#else
+std::string runTuneProfile(const std::string& configJson) {
+    (void)configJson;
+    return "{\"error\":\"MNN not bundled. Cannot tune. Place headers and libMNN.so as documented.\"}";
+}
+#endif
+
+} // namespace runner
@@ -0,0 +1,395 @@
+// External weight files: weights loaded through setExternalFile versus kept in
+// memory-mapped files under EXTERNAL_WEIGHT_DIR and paged in on first touch.
+//
+// The mmap variant needs the Module engine, so it is compared with a resident run on the same
+// engine; every variant evicts the weight pages the same way before its first run.
+#include "modes.hpp"
+#include "runner_common.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace runner {
+
+#if HAVE_MNN
+namespace {
+
+bool fileExists(const std::string& path) {
+    struct stat st;
+    return !path.empty() && stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode);
+}
+
+// Drop clean page-cache pages of a file so the next touch of its mapping is a real page-in.
+void evictFile(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+// Ask the kernel to page out our own mappings of weight files (MADV_PAGEOUT, Linux 5.4+);
+// fadvise alone leaves pages that are currently mapped resident.
+void pageOutMappings(const std::vector<std::string>& prefixes) {
+#ifdef MADV_PAGEOUT
+    FILE* f = std::fopen("/proc/self/maps", "r");
+    if (!f) return;
+    char line[1024];
+    while (std::fgets(line, sizeof(line), f)) {
+        unsigned long long start = 0, end = 0;
+        if (std::sscanf(line, "%llx-%llx ", &start, &end) != 2) continue;
+        const char* path = std::strchr(line, '/');
+        if (!path) continue;
+        for (auto& prefix : prefixes) {
+            if (!prefix.empty() && std::strncmp(path, prefix.c_str(), prefix.size()) == 0) {
+                madvise((void*)(uintptr_t)start, (size_t)(end - start), MADV_PAGEOUT);
+                break;
+            }
+        }
+    }
+    std::fclose(f);
+#else
+    (void)prefixes;
+#endif
+}
+
+void evictDir(const std::string& dir) {
+    DIR* d = opendir(dir.c_str());
+    if (!d) return;
+    while (auto* e = readdir(d)) {
+        std::string name = e->d_name;
+        if (name == "." || name == "..") continue;
+        evictFile(dir + "/" + name);
+    }
+    closedir(d);
+}
+
+// Samples process RSS and the RSS of weight mappings on a fixed interval, tagged with
+// the phase the run is in.
+class RssSampler {
+public:
+    struct Sample {
+        double tMs;
+        std::string phase;
+        long long rss;
+        long long weightRss;
+    };
+
+    RssSampler(int intervalMs, std::vector<std::string> weightPrefixes)
+        : intervalMs_(std::max(1, intervalMs)), prefixes_(std::move(weightPrefixes)) {}
+    ~RssSampler() { stop(); }
+
+    void start(const std::string& phase) {
+        t0_ = clock::now();
+        mark(phase);
+        running_ = true;
+        thread_ = std::thread([this]() {
+            while (running_) {
+                sample();
+                std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs_));
+            }
+        });
+    }
+    // Switch phase and take a sample right away, so short phases are not missed.
+    void mark(const std::string& phase) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            phase_ = phase;
+        }
+        sample();
+    }
+    void stop() {
+        if (!running_.exchange(false)) return;
+        if (thread_.joinable()) thread_.join();
+        sample();
+    }
+    std::vector<Sample> samples() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return samples_;
+    }
+
+private:
+    void sample() {
+        const long long rss = readRssBytes();
+        const long long weightRss = mappedRssBytes(prefixes_);
+        std::lock_guard<std::mutex> lock(mutex_);
+        samples_.push_back(Sample{msBetween(t0_, clock::now()), phase_, rss, weightRss});
+    }
+
+    int intervalMs_;
+    std::vector<std::string> prefixes_;
+    clock::time_point t0_;
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+    mutable std::mutex mutex_;
+    std::string phase_;
+    std::vector<Sample> samples_;
+};
+
+struct WeightsRun {
+    std::string variant;
+    std::string engine;
+    double loadMs = 0.0;
+    double createMs = 0.0;
+    double firstRunMs = 0.0;
+    double coldRunMs = -1.0; // first run after evicting the weight pages, when requested
+    std::vector<double> samplesMs;
+    std::vector<RssSampler::Sample> timeline;
+    NamedOutputs outputs;
+};
+
+struct WeightsParams {
+    std::string externalFile;
+    std::string weightDir;
+    int warmup = 1;
+    int iterations = 10;
+    int sampleIntervalMs = 20;
+    bool evictPageCache = true;
+    int mmapFileSizeKb = 0;
+};
+
+// Page out and drop the cached pages of the weight files a variant reads.
+void evictWeights(const WeightsParams& p, bool mapped) {
+    pageOutMappings({mapped ? p.weightDir : std::string(), p.externalFile});
+    if (mapped) evictDir(p.weightDir);
+    if (!p.externalFile.empty()) evictFile(p.externalFile);
+}
+
+// Today's path: Interpreter with the external data file read in at createSession.
+WeightsRun runResident(const RunOptions& opt, const WeightsParams& p) {
+    WeightsRun run;
+    run.variant = "resident";
+    run.engine = "interpreter";
+    RssSampler sampler(p.sampleIntervalMs, {p.externalFile});
+    sampler.start("load");
+    auto t0 = clock::now();
+    std::unique_ptr<MNN::Interpreter> net(MNN::Interpreter::createFromFile(opt.modelPath.c_str()));
+    if (!net) throw std::runtime_error("Failed to create interpreter");
+    if (!p.externalFile.empty()) net->setExternalFile(p.externalFile.c_str());
+    if (!opt.cacheFile.empty()) net->setCacheFile(opt.cacheFile.c_str());
+    for (auto& kv : opt.sessionHints) net->setSessionHint((MNN::Interpreter::HintMode)kv.first, kv.second);
+    run.loadMs = msBetween(t0, clock::now());
+
+    sampler.mark("create");
+    MNN::BackendConfig bcfg = makeBackendConfig(opt);
+    MNN::ScheduleConfig cfg = makeScheduleConfig(opt, &bcfg);
+    auto t1 = clock::now();
+    auto session = net->createSession(cfg);
+    if (!session) throw std::runtime_error("Failed to create session");
+    resizeInputs(net.get(), session, opt);
+    run.createMs = msBetween(t1, clock::now());
+    fillInputs(net.get(), session, opt.inputFill);
+
+    if (p.evictPageCache) evictWeights(p, false);
+    sampler.mark("first_run");
+    auto t2 = clock::now();
+    net->runSession(session);
+    run.firstRunMs = msBetween(t2, clock::now());
+
+    sampler.mark("steady");
+    for (int i = 0; i < p.warmup; ++i) net->runSession(session);
+    for (int i = 0; i < p.iterations; ++i) {
+        auto a = clock::now();
+        net->runSession(session);
+        run.samplesMs.push_back(msBetween(a, clock::now()));
+    }
+    run.outputs = readOutputs(net.get(), session);
+    sampler.stop();
+    run.timeline = sampler.samples();
+    net->releaseSession(session);
+    return run;
+}
+
+#if HAVE_MNN_EXPRESS
+// Module engine. `mapped`: weights live in mmap'd files under EXTERNAL_WEIGHT_DIR and are paged in on
+// demand (the lazy path); otherwise they are read in at load, the same-engine control for it.
+WeightsRun runModule(const RunOptions& opt, const WeightsParams& p, bool mapped) {
+    using namespace MNN::Express;
+    WeightsRun run;
+    run.variant = mapped ? "mmap" : "resident_module";
+    run.engine = "module";
+    RssSampler sampler(p.sampleIntervalMs, {mapped ? p.weightDir : std::string(), p.externalFile});
+    sampler.start("load");
+    auto t0 = clock::now();
+    RuntimeManagerPtr rtmgr = makeRuntimeManager(opt);
+    if (!p.externalFile.empty()) rtmgr->setExternalFile(p.externalFile);
+    if (mapped) {
+        rtmgr->setExternalPath(p.weightDir, MNN::Interpreter::EXTERNAL_WEIGHT_DIR);
+        // Reuse weight files from a previous run instead of rewriting them on every load.
+        rtmgr->setHint(MNN::Interpreter::USE_CACHED_MMAP, 1);
+        if (p.mmapFileSizeKb > 0) rtmgr->setHint(MNN::Interpreter::MMAP_FILE_SIZE, p.mmapFileSizeKb);
+    }
+    run.loadMs = msBetween(t0, clock::now());
+
+    sampler.mark("create");
+    auto t1 = clock::now();
+    Module::Config mcfg;
+    std::shared_ptr<Module> module(Module::load({}, {}, opt.modelPath.c_str(), rtmgr, &mcfg), Module::destroy);
+    if (!module) throw std::runtime_error(mapped ? "Failed to load module with external weight dir" : "Failed to load module");
+    auto inputs = makeModuleInputs(module->getInfo(), opt);
+    run.createMs = msBetween(t1, clock::now());
+
+    auto forward = [&]() {
+        auto outs = module->onForward(inputs);
+        if (outs.empty()) throw std::runtime_error("Module forward returned no outputs");
+        (void)outs[0]->readMap<void>();
+    };
+    if (p.evictPageCache) evictWeights(p, mapped);
+    sampler.mark("first_run");
+    auto t2 = clock::now();
+    forward();
+    run.firstRunMs = msBetween(t2, clock::now());
+
+    sampler.mark("steady");
+    for (int i = 0; i < p.warmup; ++i) forward();
+    for (int i = 0; i < p.iterations; ++i) {
+        auto a = clock::now();
+        forward();
+        run.samplesMs.push_back(msBetween(a, clock::now()));
+    }
+    run.outputs = readModuleOutputs(module->onForward(inputs), module->getInfo()->outputNames);
+
+    if (p.evictPageCache) {
+        // Clean file pages can be dropped under memory pressure at any time; time a run after that.
+        evictWeights(p, mapped);
+        sampler.mark("after_evict");
+        auto t3 = clock::now();
+        forward();
+        run.coldRunMs = msBetween(t3, clock::now());
+    }
+    sampler.stop();
+    run.timeline = sampler.samples();
+    return run;
+}
+#endif
+
+// `resident` is the run to compare against, or null for the resident run itself.
+void writeRun(std::ostream& json, const WeightsRun& run, const WeightsRun* resident) {
+    const double median = medianOf(run.samplesMs);
+    long long peakRss = -1, peakWeight = -1, lastWeight = -1;
+    for (auto& s : run.timeline) {
+        peakRss = std::max(peakRss, s.rss);
+        peakWeight = std::max(peakWeight, s.weightRss);
+        lastWeight = s.weightRss;
+    }
+    json << "{\"variant\":\"" << run.variant << "\""
+         << ",\"engine\":\"" << run.engine << "\""
+         << ",\"load_ms\":" << run.loadMs
+         << ",\"create_ms\":" << run.createMs
+         << ",\"first_run_ms\":" << run.firstRunMs;
+    if (run.coldRunMs >= 0.0) json << ",\"cold_run_ms\":" << run.coldRunMs;
+    if (resident) {
+        json << ",\"compared_to\":\"" << resident->variant << "\""
+             << ",\"first_touch_penalty_ms\":" << run.firstRunMs - resident->firstRunMs
+             << ",\"steady_delta_ms\":" << median - medianOf(resident->samplesMs)
+             << ",\"outputs\":";
+        writeOutputErrors(json, resident->outputs, run.outputs);
+    }
+    json << ",\"peak_rss_mb\":" << peakRss / (1024.0 * 1024.0)
+         << ",\"peak_weight_resident_mb\":" << peakWeight / (1024.0 * 1024.0)
+         << ",\"final_weight_resident_mb\":" << lastWeight / (1024.0 * 1024.0)
+         << ",\"latency\":";
+    writeLatency(json, run.samplesMs);
+    json << ",\"timeline\":[";
+    for (size_t i = 0; i < run.timeline.size(); ++i) {
+        const auto& s = run.timeline[i];
+        if (i) json << ",";
+        json << "{\"t_ms\":" << s.tMs
+             << ",\"phase\":\"" << s.phase << "\""
+             << ",\"rss_mb\":" << (s.rss >= 0 ? s.rss / (1024.0 * 1024.0) : -1.0)
+             << ",\"weight_resident_mb\":" << (s.weightRss >= 0 ? s.weightRss / (1024.0 * 1024.0) : -1.0) << "}";
+    }
+    json << "]}";
+}
+
+} // namespace
+
+std::string runExternalWeights(const std::string& configJson) {
+    try {
+        json::Value root = json::parse(configJson);
+        RunOptions opt;
+        applyRunOptions(root, opt);
+        if (opt.modelPath.empty()) throw std::runtime_error("Missing modelPath");
+
+        WeightsParams p;
+        // MNNConvert --saveExternalData writes the weights next to the model as "<model>.weight".
+        p.externalFile = root.getString("externalFile");
+        if (p.externalFile.empty() && fileExists(opt.modelPath + ".weight")) p.externalFile = opt.modelPath + ".weight";
+        p.weightDir = root.getString("weightDir");
+        p.warmup = std::max(0, root.getInt("warmup", p.warmup));
+        p.iterations = std::max(1, root.getInt("iterations", p.iterations));
+        p.sampleIntervalMs = root.getInt("sampleIntervalMs", p.sampleIntervalMs);
+        p.evictPageCache = root.getBool("evictPageCache", p.evictPageCache);
+        p.mmapFileSizeKb = root.getInt("mmapFileSizeKb", 0);
+        if (!p.externalFile.empty() && !fileExists(p.externalFile)) {
+            throw std::runtime_error("External weight file not found: " + p.externalFile);
+        }
+
+        WeightsRun resident = runResident(opt, p);
+
+        std::ostringstream json;
+        json.setf(std::ios::fixed); json.precision(3);
+        json << "{\"externalWeights\":true"
+             << ",\"backend\":\"" << opt.backend << "\""
+             << ",\"external_file\":\"" << jsonEscape(p.externalFile) << "\"";
+        if (!p.externalFile.empty()) {
+            struct stat st;
+            if (stat(p.externalFile.c_str(), &st) == 0) json << ",\"external_file_mb\":" << st.st_size / (1024.0 * 1024.0);
+        }
+        json << ",\"weight_dir\":\"" << jsonEscape(p.weightDir) << "\""
+             << ",\"runs\":[";
+        writeRun(json, resident, nullptr);
+#if HAVE_MNN_EXPRESS
+        if (!p.weightDir.empty()) {
+            // The mmap run is judged against resident weights on its own engine, so the penalty is
+            // paging alone; the Interpreter run stays as today's reference.
+            WeightsRun control;
+            bool haveControl = false;
+            json << ",";
+            try {
+                control = runModule(opt, p, false);
+                haveControl = true;
+                writeRun(json, control, &resident);
+            } catch (const std::exception& e) {
+                json << "{\"variant\":\"resident_module\",\"error\":\"" << jsonEscape(e.what()) << "\"}";
+            }
+            json << ",";
+            try {
+                writeRun(json, runModule(opt, p, true), haveControl ? &control : &resident);
+            } catch (const std::exception& e) {
+                json << "{\"variant\":\"mmap\",\"error\":\"" << jsonEscape(e.what()) << "\"}";
+            }
+        }
+        json << "]";
+        if (p.weightDir.empty()) json << ",\"note\":\"set weightDir to app storage to measure mmap'd weights\"";
+#else
+        json << "],\"note\":\"EXTERNAL_WEIGHT_DIR is set through the Express RuntimeManager; ship libMNN_Express.so to measure mmap'd weights\"";
+#endif
+        json << "}";
+        return json.str();
+    } catch (const std::exception& e) {
+        return std::string("{\"error\":\"") + jsonEscape(e.what()) + "\"}";
+    }
+}
+#else
+std::string runExternalWeights(const std::string& configJson) {
+    (void)configJson;
+    return "{\"error\":\"MNN not bundled. Cannot run external-weights mode. Place headers and libMNN.so as documented.\"}";
+}
+#endif
+
+} // namespace runner
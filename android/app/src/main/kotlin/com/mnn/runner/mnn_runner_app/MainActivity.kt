@@ -6,6 +6,7 @@ import android.os.Bundle
 import androidx.core.app.ActivityCompat
 import io.flutter.embedding.android.FlutterActivity
 import io.flutter.embedding.engine.FlutterEngine
+import io.flutter.plugin.common.MethodCall
 import io.flutter.plugin.common.MethodChannel
 import org.json.JSONObject
 import java.nio.IntBuffer
@@ -13,6 +14,7 @@ import java.nio.IntBuffer
 
 class MainActivity : FlutterActivity() {
 	private val channelName = "mnn_runner"
+	@Volatile private var telemetry: TelemetryReader? = null
 
 	override fun onCreate(savedInstanceState: Bundle?) {
 		super.onCreate(savedInstanceState)
@@ -28,6 +30,11 @@ class MainActivity : FlutterActivity() {
 
     override fun configureFlutterEngine(flutterEngine: FlutterEngine) {
         super.configureFlutterEngine(flutterEngine)
+        try {
+            val base = applicationContext.getExternalFilesDir(null) ?: applicationContext.filesDir
+            NativeBridge.setTuningProfileDir(java.io.File(base, "mnn_profiles").absolutePath)
+            NativeBridge.setResultStoreDir(java.io.File(base, "mnn_results").absolutePath)
+        } catch (_: Throwable) { }
         MethodChannel(flutterEngine.dartExecutor.binaryMessenger, channelName)
             .setMethodCallHandler { call, result ->
                 when (call.method) {
@@ -62,22 +69,29 @@ class MainActivity : FlutterActivity() {
                         }
                     }
                     "probeBackends" -> {
-                        try {
-                            val json = NativeBridge.probeBackends()
-                            result.success(json)
-                        } catch (e: Exception) {
-                            result.error("PROBE", e.message, null)
-                        }
+                        // The first probe creates a runtime per GPU backend; keep it off the platform thread.
+                        Thread {
+                            try {
+                                val json = NativeBridge.probeBackends()
+                                runOnUiThread { result.success(json) }
+                            } catch (e: Exception) {
+                                runOnUiThread { result.error("PROBE", e.message, null) }
+                            }
+                        }.start()
                     }
                     "runModel" -> {
                         // Offload heavy JNI work off the platform thread to avoid UI stalls/ANR
-                        Thread {
+                        onExecutor(call.arguments as? String, NativeBridge.PRIORITY_INTERACTIVE) {
                             try {
                                 val json = call.arguments as? String ?: run {
                                     runOnUiThread { result.error("ARG", "Missing JSON config", null) }
-                                    return@Thread
+                                    return@onExecutor
                                 }
-                                val cfg = JSONObject(json)
+                                // Merge this device's stored tuning profile for the model unless overrideProfile is set
+                                val cfg = try {
+                                    JSONObject(NativeBridge.applyTuningProfile(json))
+                                } catch (_: Throwable) { JSONObject(json) }
+                                val tuning = cfg.optJSONObject("tuningProfile")
                                 val modelPath = cfg.getString("modelPath")
                                 val shapeArr = cfg.getJSONArray("inputShape")
                                 val inputShape = IntArray(shapeArr.length()) { i -> shapeArr.getInt(i) }
@@ -88,6 +102,10 @@ class MainActivity : FlutterActivity() {
                                 val threads = cfg.optInt("threads", 4)
                                 val inputFill = cfg.optString("inputFill", "ZERO")
                                 val profile = cfg.optBoolean("profile", false)
+                                val stagingLayout = cfg.optString("stagingLayout", "NCHW")
+                                // Postprocess stages on named outputs, timed in the profile (profile runs only)
+                                val postprocess = cfg.optJSONArray("postprocess")?.toString() ?: ""
+                                val usePool = cfg.optBoolean("pool", false)
                                 val cacheEnabled = cfg.optBoolean("cache", false)
                                 val cachePathArg = cfg.optString("cacheFile", "")
                                 val cacheFile: String? = try {
@@ -134,11 +152,11 @@ class MainActivity : FlutterActivity() {
                                     val f = java.io.File(modelPath)
                                     if (!f.exists()) {
                                         runOnUiThread { result.error("MODEL", "Model not found: ${modelPath}", null) }
-                                        return@Thread
+                                        return@onExecutor
                                     }
                                 } catch (_: Throwable) {
                                     runOnUiThread { result.error("MODEL", "Model not accessible: ${modelPath}", null) }
-                                    return@Thread
+                                    return@onExecutor
                                 }
 
                                 // Load optional backend plugin libs just-in-time
@@ -152,7 +170,12 @@ class MainActivity : FlutterActivity() {
                                 }
 
                                 val jniMsg = try {
-                                    if (inputShapesObj != null && inputShapesObj.length() > 0) {
+                                    if (usePool && !profile) {
+                                        // Backend/backup after the availability fallbacks above.
+                                        cfg.put("backend", backend).put("backupType", backupType)
+                                        if (cacheFile != null) cfg.put("cacheFile", cacheFile)
+                                        NativeBridge.poolRun(cfg.toString())
+                                    } else if (inputShapesObj != null && inputShapesObj.length() > 0) {
                                         val names = mutableListOf<String>()
                                         val shapes = mutableListOf<IntArray>()
                                         val it = inputShapesObj.keys()
@@ -175,7 +198,9 @@ class MainActivity : FlutterActivity() {
                                                 powerMode,
                                                 inputFill,
                                                 threads,
-                                                cacheFile
+                                                cacheFile,
+                                                stagingLayout,
+                                                postprocess
                                             )
                                         } else {
                                             NativeBridge.runModelMulti(
@@ -204,7 +229,9 @@ class MainActivity : FlutterActivity() {
                                                 powerMode,
                                                 inputFill,
                                                 threads,
-                                                cacheFile
+                                                cacheFile,
+                                                stagingLayout,
+                                                postprocess
                                             )
                                         } else {
                                             NativeBridge.runModel(
@@ -224,14 +251,142 @@ class MainActivity : FlutterActivity() {
                                 } catch (t: Throwable) {
                                     "JNI error: ${'$'}{t.message}"
                                 }
-                                runOnUiThread { result.success(jniMsg) }
+                                val reply = if (tuning?.optBoolean("applied", false) == true) {
+                                    if (jniMsg.trimStart().startsWith("{")) {
+                                        try { JSONObject(jniMsg).put("tuningProfile", tuning).toString() } catch (_: Throwable) { jniMsg }
+                                    } else "$jniMsg (tuning profile applied)"
+                                } else jniMsg
+                                runOnUiThread { result.success(withJobTimes(reply)) }
                             } catch (e: Exception) {
                                 runOnUiThread { result.error("RUN", e.message, null) }
                             }
-                        }.start()
+                        }
+                    }
+                    "runCompare" -> runJsonMode(call, result, "COMPARE") { NativeBridge.runCompare(it) }
+                    "runDynamicQuant" -> runJsonMode(call, result, "QUANT") { NativeBridge.runDynamicQuant(it) }
+                    "tuneProfile" -> runJsonMode(call, result, "TUNE") { NativeBridge.runTuneProfile(it) }
+                    "runDecode" -> runJsonMode(call, result, "DECODE") { NativeBridge.runDecode(it) }
+                    "runModuleEngine" -> runJsonMode(call, result, "MODULE") { NativeBridge.runModuleEngine(it) }
+                    "listResults" -> runJsonMode(call, result, NativeBridge.PRIORITY_INTERACTIVE, "RESULTS") { NativeBridge.listResults(it) }
+                    "compareResults" -> runJsonMode(call, result, NativeBridge.PRIORITY_INTERACTIVE, "RESULTS") { NativeBridge.compareResults(it) }
+                    "runLowMemory" -> runJsonMode(call, result, "LOWMEM") {
+                        NativeBridge.runLowMemory(withStorageDir(it, "featureMapDir", java.io.File(cacheDir, "mnn_featuremap")))
+                    }
+                    "runExternalWeights" -> runJsonMode(call, result, "WEIGHTS") {
+                        NativeBridge.runExternalWeights(withStorageDir(it, "weightDir", java.io.File(filesDir, "mnn_weights")))
+                    }
+                    "runOpenLoop" -> runJsonMode(call, result, "LOADGEN") { NativeBridge.runOpenLoop(it) }
+                    "runEnergy" -> runJsonMode(call, result, "ENERGY") { NativeBridge.runEnergy(it) }
+                    "runMultiPath" -> runJsonMode(call, result, "MULTIPATH") { NativeBridge.runMultiPath(it) }
+                    "runPipeline" -> runJsonMode(call, result, "PIPELINE") { NativeBridge.runPipeline(it) }
+                    "runAdaptive" -> runJsonMode(call, result, "ADAPTIVE") { NativeBridge.runAdaptive(it) }
+                    "runStream" -> runJsonMode(call, result, "STREAM") { NativeBridge.runStream(it) }
+                    "runOpBench" -> runJsonMode(call, result, "OPBENCH") { NativeBridge.runOpBench(it) }
+                    "buildCostTable" -> runJsonMode(call, result, "COSTTABLE") {
+                        NativeBridge.buildCostTable(withStorageDir(it, "tableDir", java.io.File(filesDir, "mnn_costs")))
+                    }
+                    "predictLatency" -> runJsonMode(call, result, "PREDICT") {
+                        NativeBridge.predictLatency(withStorageDir(it, "tableDir", java.io.File(filesDir, "mnn_costs")))
+                    }
+                    "poolRun" -> runJsonMode(call, result, NativeBridge.PRIORITY_INTERACTIVE, "POOL") { NativeBridge.poolRun(it) }
+                    "prewarmPool" -> runJsonMode(call, result, "POOL") { NativeBridge.prewarmPool(it) }
+                    "poolStats" -> result.success(NativeBridge.poolStats(call.arguments as? String ?: "{}"))
+                    "executorStats" -> result.success(NativeBridge.executorStats(call.arguments as? String ?: "{}"))
+                    "openTelemetry" -> {
+                        try {
+                            val capacity = call.argument<Int>("capacity") ?: 4096
+                            val opCapacity = call.argument<Int>("opCapacity") ?: 512
+                            val buffer = NativeBridge.openTelemetry(capacity, opCapacity)
+                            telemetry = buffer?.let { TelemetryReader(it) }
+                            result.success(telemetry != null)
+                        } catch (e: Throwable) {
+                            result.error("TELEMETRY", e.message, null)
+                        }
+                    }
+                    "pollTelemetry" -> result.success(telemetry?.poll())
+                    "closeTelemetry" -> {
+                        NativeBridge.closeTelemetry()
+                        telemetry = null
+                        result.success(true)
+                    }
+                    "runSuite" -> runJsonMode(call, result, "SUITE") {
+                        NativeBridge.runSuite(withStorageDir(it, "suiteDir", java.io.File(filesDir, "mnn_suites")))
                     }
                     else -> result.notImplemented()
                 }
             }
     }
+
+    override fun onTrimMemory(level: Int) {
+        super.onTrimMemory(level)
+        try { NativeBridge.trimPool(level) } catch (_: Throwable) { }
+    }
+
+    // JSON-config native modes: load the backend plugins the config mentions, then run on the native
+    // executor, as background work unless the mode is interactive or the config says otherwise.
+    private fun runJsonMode(call: MethodCall, result: MethodChannel.Result, errorCode: String, mode: (String) -> String) =
+        runJsonMode(call, result, NativeBridge.PRIORITY_BACKGROUND, errorCode, mode)
+
+    private fun runJsonMode(call: MethodCall, result: MethodChannel.Result, priority: Int, errorCode: String,
+                            mode: (String) -> String) {
+        val json = call.arguments as? String ?: run {
+            result.error("ARG", "Missing JSON config", null)
+            return
+        }
+        onExecutor(json, priority) {
+            try {
+                ensureConfigBackendLibs(JSONObject(json))
+                val report = try {
+                    mode(json)
+                } catch (t: Throwable) {
+                    JSONObject().put("error", "JNI error: ${t.message}").toString()
+                }
+                runOnUiThread { result.success(withJobTimes(report)) }
+            } catch (e: Exception) {
+                runOnUiThread { result.error(errorCode, e.message, null) }
+            }
+        }
+    }
+
+    // Runs [task] on the native executor: a fixed worker set, runs on one model serialized, interactive
+    // work ahead of background benchmarks. A "priority" key in the config overrides [priority]. Falls
+    // back to a plain thread when the native library is missing.
+    private fun onExecutor(json: String?, priority: Int, task: () -> Unit) {
+        val cfg = try { json?.let { JSONObject(it) } } catch (_: Throwable) { null }
+        val p = when (cfg?.optString("priority", "")?.lowercase()) {
+            "interactive" -> NativeBridge.PRIORITY_INTERACTIVE
+            "background" -> NativeBridge.PRIORITY_BACKGROUND
+            else -> priority
+        }
+        try {
+            NativeBridge.executorSubmit(p, cfg?.optString("modelPath", "") ?: "", Runnable { task() })
+        } catch (_: UnsatisfiedLinkError) {
+            Thread { task() }.start()
+        }
+    }
+
+    // Queue wait and run time of the executor job this thread is running, attached to its reply.
+    private fun withJobTimes(reply: String): String =
+        try { NativeBridge.executorAnnotate(reply) } catch (_: Throwable) { reply }
+
+    // Point a directory key of the config at app storage unless the caller already set one.
+    private fun withStorageDir(json: String, key: String, dir: java.io.File): String {
+        val cfg = JSONObject(json)
+        if (cfg.optString(key, "").isNotEmpty()) return json
+        dir.mkdirs()
+        return cfg.put(key, dir.absolutePath).toString()
+    }
+
+    private fun ensureConfigBackendLibs(cfg: JSONObject) {
+        fun load(obj: JSONObject?) {
+            if (obj == null) return
+            NativeBridge.ensureBackendLibs(obj.optString("backend", ""), obj.optString("backupType", ""))
+        }
+        load(cfg)
+        load(cfg.optJSONObject("reference"))
+        for (key in listOf("candidates", "paths")) {
+            val list = cfg.optJSONArray(key) ?: continue
+            for (i in 0 until list.length()) load(list.optJSONObject(i))
+        }
+    }
 }
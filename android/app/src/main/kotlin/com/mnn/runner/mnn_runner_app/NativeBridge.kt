@@ -13,9 +13,17 @@ object NativeBridge {
         }
     }
 
-    private fun tryLoadLibrary(name: String): Boolean = try {
-        System.loadLibrary(name); true
-    } catch (_: Throwable) { false }
+    // loadLibrary outcome per library; each is attempted once per process.
+    private val loadResults = java.util.concurrent.ConcurrentHashMap<String, Boolean>()
+
+    private fun tryLoadLibrary(name: String): Boolean = loadResults.getOrPut(name) {
+        try {
+            System.loadLibrary(name); true
+        } catch (_: Throwable) { false }
+    }
+
+    @Volatile
+    private var probeCache: String? = null
 
     /**
      * Lazily load optional MNN backend plugin libraries based on the requested backends.
@@ -48,26 +56,36 @@ object NativeBridge {
     }
 
     /**
-     * Check if Vulkan runtime and MNN Vulkan plugin can be loaded in this process.
-     * This intentionally only checks dlopen/loadLibrary feasibility and avoids creating instances.
+     * Whether the Vulkan backend is usable in this process, from the cached probe: with the
+     * native probe this means a Vulkan runtime was actually created, not just that the libraries load.
      */
     @JvmStatic
-    fun hasVulkanRuntime(): Boolean {
-        val vk = tryLoadLibrary("vulkan")
-        val plugin = tryLoadLibrary("MNN_Vulkan")
-        return vk && plugin
-    }
+    fun hasVulkanRuntime(): Boolean = try {
+        org.json.JSONObject(probeBackends()).optJSONObject("vulkan")?.optBoolean("available", false) ?: false
+    } catch (_: Throwable) { false }
 
     /**
-     * Probe availability of CPU/VULKAN/OPENCL backends and return a JSON string.
-     * Example: {"cpu":{"available":true},"vulkan":{"available":true,"lib":true,"plugin":true},"opencl":{"available":false,"lib":false,"plugin":false,"source":null}}
+     * Probe availability of CPU/VULKAN/OPENCL/OPENGL backends and return a JSON string, computed once
+     * per process. Uses the native probe (timed dlopen, runtime creation, FP16/dot-product/low-power
+     * status) and falls back to loadLibrary checks when the native library is missing.
+     * Example: {"cpu":{"available":true},"vulkan":{"available":true,"lib":true,"plugin":true,"fp16":true,..},..}
      */
     @JvmStatic
     fun probeBackends(): String {
-        val cpuAvail = true
+        probeCache?.let { return it }
+        val json = try {
+            probeBackendsNative()
+        } catch (t: Throwable) {
+            Log.w("NativeBridge", "Native backend probe unavailable, using loadLibrary checks", t)
+            probeBackendsByLoad()
+        }
+        probeCache = json
+        return json
+    }
 
+    private fun probeBackendsByLoad(): String {
         // Vulkan probe: require both system loader and packaged plugin to be present
-        val vkAvail = hasVulkanRuntime()
+        val vkAvail = tryLoadLibrary("vulkan") && tryLoadLibrary("MNN_Vulkan")
 
         // OpenCL probe: Try loading libMNN_CL.so only. We do NOT load vendor libOpenCL.so here.
         // Modern MNN CL builds don't link against libOpenCL at load time and will dlopen
@@ -95,6 +113,12 @@ object NativeBridge {
         return sb.toString()
     }
 
+    /**
+     * Native backend probe, run once per process: timed dlopen of each libMNN_* plugin, a minimal
+     * runtime per backend and its RuntimeStatus (FP16, dot product, low power), plus CPU hwcaps.
+     */
+    private external fun probeBackendsNative(): String
+
     external fun runModel(
         modelPath: String,
         inputShape: IntArray,
@@ -108,6 +132,11 @@ object NativeBridge {
         cacheFile: String?
     ): String
 
+    /**
+     * Model summary read from the flatbuffer without creating a session: inputs (name/dims/dtype),
+     * outputs, op histogram, parameter and weight bytes, quantization. Cached per mtime/size;
+     * falls back to a CPU session for files the inspector cannot parse.
+     */
     external fun getModelInfo(
         modelPath: String
     ): String
@@ -123,7 +152,11 @@ object NativeBridge {
         powerMode: String,
         inputFill: String,
         threads: Int,
-        cacheFile: String?
+        cacheFile: String?,
+        // NCHW | NC4HW4 | PACK: host staging layout, see stageInputs in runner_common.hpp
+        stagingLayout: String,
+        // JSON array of postprocess stages (softmax_topk / detect / argmax), "" for none
+        postprocess: String
     ): String
 
     // Profiled multi-input run
@@ -138,7 +171,9 @@ object NativeBridge {
         powerMode: String,
         inputFill: String,
         threads: Int,
-        cacheFile: String?
+        cacheFile: String?,
+        stagingLayout: String,
+        postprocess: String
     ): String
 
     external fun runModelMulti(
@@ -154,4 +189,182 @@ object NativeBridge {
         threads: Int,
         cacheFile: String?
     ): String
+
+    /**
+     * Run the same inputs under a reference config (CPU/HIGH by default) and candidate configs.
+     * Takes the run config JSON plus optional "reference", "candidates", "iterations", "warmup"
+     * and "traceOps"; returns a JSON report with per-output drift and latency per config.
+     */
+    external fun runCompare(configJson: String): String
+
+    /**
+     * Sweep DYNAMIC_QUANT_OPTIONS ("dynamicQuantOptions") x QKV_QUANT_OPTIONS ("qkvQuantOptions")
+     * on a weight-quantized model; reports latency, memory and output error per option
+     * against the float-activation baseline.
+     */
+    external fun runDynamicQuant(configJson: String): String
+
+    /** Directory for per-device, per-model tuning profiles; call once before any run. */
+    external fun setTuningProfileDir(dir: String)
+
+    /**
+     * Benchmark thread/precision candidates for the config's model and store the fastest as
+     * its tuning profile for this device. Returns a JSON report of every candidate.
+     */
+    external fun runTuneProfile(configJson: String): String
+
+    /**
+     * Merge the stored tuning profile into a run config (unless "overrideProfile" is true).
+     * Returns the config JSON with a "tuningProfile" object describing what was applied.
+     */
+    external fun applyTuningProfile(configJson: String): String
+
+    /**
+     * Autoregressive decode loop: a prefill of "promptTokens" then "newTokens" steps, each feeding
+     * the whole context so far (no KV cache state is attached). Optional "decodeEngine" ("module" or
+     * "session"), "kvCacheSizeLimit" and "kvCacheDir"; returns TTFT, per-step latency/memory and
+     * steps/s as JSON.
+     */
+    external fun runDecode(configJson: String): String
+
+    /**
+     * Run the model through the Express Module engine ("moduleConfigs": static/dynamic) with
+     * "instances" parameter-sharing clones; reports each instance next to the Interpreter path.
+     */
+    external fun runModuleEngine(configJson: String): String
+
+    /**
+     * Compare weights loaded from an external data file ("externalFile", default "<model>.weight")
+     * with weights mmap'd from EXTERNAL_WEIGHT_DIR ("weightDir"); reports RSS and resident
+     * weight bytes over time plus the first-touch page-in cost.
+     */
+    external fun runExternalWeights(configJson: String): String
+
+    /**
+     * Compare the default footprint with Session_Memory_Collect + releaseModel() and, when
+     * "featureMapDir" is set, feature maps spilled to disk; reports RSS saved and latency paid.
+     */
+    external fun runLowMemory(configJson: String): String
+
+    /** Directory of the append-only benchmark result store (results.jsonl); call once before any run. */
+    external fun setResultStoreDir(dir: String)
+
+    /** Stored benchmark records, newest first; optional "limit", "mode" and "label" filters. */
+    external fun listResults(configJson: String): String
+
+    /**
+     * Mann-Whitney U test with Cliff's delta per latency series of two stored records.
+     * "baseline"/"candidate" are record ids or {"label": .., "mode": ..} selecting the newest match.
+     */
+    external fun compareResults(configJson: String): String
+
+    /**
+     * Run a benchmark manifest (models x backends x threads x precisions) as one matrix. Each cell is
+     * checkpointed under "suiteDir", so calling again with the same manifest resumes after a crash.
+     */
+    external fun runSuite(configJson: String): String
+
+    /**
+     * Start publishing per-iteration, per-token and (with "telemetryOps") per-op latency into a
+     * native ring and return it as a direct ByteBuffer for [TelemetryReader]. The buffer stays
+     * valid for the life of the process; capacity is fixed by the first call.
+     */
+    external fun openTelemetry(capacity: Int, opCapacity: Int): java.nio.ByteBuffer?
+
+    /**
+     * Copy the telemetry ring into [dst] (a direct buffer of the same size) with the records from
+     * sequence [from] validated natively; torn records come back with seq 0. Used by
+     * [TelemetryReader] below API 33, where Kotlin cannot fence its own buffer reads.
+     */
+    external fun mirrorTelemetry(from: Long, dst: java.nio.ByteBuffer): Boolean
+
+    /** Stop publishing telemetry; existing readers keep their buffer. */
+    external fun closeTelemetry()
+
+    /**
+     * Open-loop load sweep: requests at increasing target rates (Poisson or fixed spacing) over a
+     * pool of sessions, latency measured from the intended send time; reports p50..p99.99 and the knee.
+     */
+    external fun runOpenLoop(configJson: String): String
+
+    /**
+     * Joules per inference next to latency for each power mode. Uses powercap RAPL or battery
+     * current x voltage; when no counter is usable the report carries the reason, not a number.
+     */
+    external fun runEnergy(configJson: String): String
+
+    /**
+     * Run through the resident model pool: reuses a prepared interpreter and session when one is
+     * resident, evicts least-recently-used models over the byte budget, then prewarms "prewarmNext"
+     * (or the model that usually follows) in the background.
+     */
+    external fun poolRun(configJson: String): String
+
+    /** Queue a pool entry to be built on the background worker. */
+    external fun prewarmPool(configJson: String): String
+
+    /** Pool hit/miss/eviction counters and resident entries; also sets "budgetMb" and "clear". */
+    external fun poolStats(configJson: String): String
+
+    /** Release pool memory for a ComponentCallbacks2 trim level. */
+    external fun trimPool(level: Int): String
+
+    /**
+     * Multi-branch timing: the whole graph as one session, as one createMultiPathSession, and as one
+     * session per "paths" entry with independent paths running concurrently on their own threads.
+     */
+    external fun runMultiPath(configJson: String): String
+
+    /**
+     * Stream frames through the model cut at "splits" into stages, each on its own core cluster with
+     * bounded queues between them; per-stage utilization, bubble time and frames/s vs all cores.
+     */
+    external fun runPipeline(configJson: String): String
+
+    /**
+     * Benchmark until the 95% confidence interval of the median is narrow enough (or the budget runs
+     * out); reports samples needed, the warm-up transient, bimodality and a quality grade.
+     */
+    external fun runAdaptive(configJson: String): String
+
+    /**
+     * Stream frames of a Y4M or raw video file ("videoPath") at "targetFps" through preprocess,
+     * inference and postprocess threads with bounded queues; reports frames/s, per-stage latency,
+     * queue occupancy and frames dropped under back-pressure.
+     */
+    external fun runStream(configJson: String): String
+
+    /**
+     * Single-op microbenchmarks (conv, depthwise, matmul, softmax, layernorm, elementwise, pool)
+     * built with the Express API over a shape grid; per-case latency, GFLOP/s and GB/s under the
+     * configured backend, precision and threads.
+     */
+    external fun runOpBench(configJson: String): String
+
+    /**
+     * Time every op of "models" (or modelPath) through op callbacks and merge the costs into this
+     * device's table for the configured backend/precision/threads, keyed by op type and input shapes.
+     */
+    external fun buildCostTable(configJson: String): String
+
+    /**
+     * Estimate a model's latency from a cost table without running it: per-op lookups summed into a
+     * median with an error bar, validated against a measured run when the table is for this device.
+     */
+    external fun predictLatency(configJson: String): String
+
+    const val PRIORITY_INTERACTIVE = 0
+    const val PRIORITY_BACKGROUND = 1
+
+    /**
+     * Queue [task] on the native executor's fixed worker set; tasks with the same non-empty
+     * [modelKey] never overlap, and background tasks let interactive ones run between iterations.
+     */
+    external fun executorSubmit(priority: Int, modelKey: String, task: Runnable): Long
+
+    /** [report] with the running job's queue wait, run and preempted time attached. */
+    external fun executorAnnotate(report: String): String
+
+    /** Workers, queue depths and per-priority wait/run totals; "workers" resizes the worker set. */
+    external fun executorStats(configJson: String): String
 }
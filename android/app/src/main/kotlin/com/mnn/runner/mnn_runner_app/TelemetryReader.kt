@@ -0,0 +1,141 @@
+package com.mnn.runner.mnn_runner_app
+
+import android.os.Build
+import java.lang.invoke.VarHandle
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/**
+ * Consumer of the native telemetry ring (see telemetry.hpp for the layout). [poll] copies every
+ * record published since the previous poll straight out of the direct buffer: one method-channel
+ * reply per frame instead of a JNI call or JSON encode per sample.
+ *
+ * Records the producer overwrote before they were read are counted in "dropped", never returned torn.
+ * That needs the slot reads ordered between the two sequence reads: API 33+ uses VarHandle fences;
+ * below it each poll has the native side copy the ring into [mirror] with acquire loads (one JNI
+ * call per poll), and the records are read from that copy instead.
+ */
+class TelemetryReader(buffer: ByteBuffer) {
+    private val buf: ByteBuffer = buffer.order(ByteOrder.nativeOrder())
+    private val capacity = buf.getInt(8)
+    private val slotSize = buf.getInt(12)
+    private val opNameSize = buf.getInt(20)
+    private val opNamesOffset = HEADER_BYTES + capacity * slotSize
+    private var cursor = buf.getLong(HEAD_OFFSET)
+    private var dropped = 0L
+    private var run = -1
+    private var planned = 0
+
+    private class OpAgg(val name: String) {
+        var count = 0L
+        var totalMs = 0.0
+        var maxMs = 0.0
+    }
+    private val ops = HashMap<Int, OpAgg>()
+
+    private val mirror: ByteBuffer? =
+        if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.TIRAMISU) null
+        else ByteBuffer.allocateDirect(buf.capacity()).order(ByteOrder.nativeOrder())
+
+    init {
+        require(buf.getInt(0) == MAGIC) { "Not a telemetry buffer" }
+    }
+
+    private fun acquireFence() {
+        // Orders the slot reads after the sequence reads; plain ByteBuffer gets are unordered.
+        // Only reached on the live buffer, i.e. API 33+; the mirror is already validated.
+        if (mirror == null) VarHandle.acquireFence()
+    }
+
+    private fun opName(src: ByteBuffer, id: Int): String {
+        val count = src.getInt(24)
+        if (id >= count) return "op#$id"
+        acquireFence()
+        val start = opNamesOffset + id * opNameSize
+        val bytes = ByteArray(opNameSize)
+        var n = 0
+        while (n < opNameSize - 1) {
+            val b = src.get(start + n)
+            if (b.toInt() == 0) break
+            bytes[n++] = b
+        }
+        return String(bytes, 0, n, Charsets.UTF_8)
+    }
+
+    /**
+     * New samples since the last call: {"run", "planned", "iterations": DoubleArray (ms),
+     * "tokens": DoubleArray (ms), "ops": [{"name","count","total_ms","max_ms"}] since the run began,
+     * "dropped"}.
+     */
+    @Synchronized
+    fun poll(): HashMap<String, Any> {
+        val src = mirror ?: buf
+        // A failed copy (no ring behind the buffer) reads as no new records.
+        if (mirror != null && !NativeBridge.mirrorTelemetry(cursor, mirror)) mirror.putLong(HEAD_OFFSET, cursor)
+        val head = src.getLong(HEAD_OFFSET)
+        acquireFence()
+        if (head < cursor) cursor = head
+        if (head - cursor > capacity) {
+            dropped += head - cursor - capacity
+            cursor = head - capacity
+        }
+        val iterations = ArrayList<Double>()
+        val tokens = ArrayList<Double>()
+        while (cursor < head) {
+            val off = HEADER_BYTES + (cursor and (capacity - 1).toLong()).toInt() * slotSize
+            val seq = src.getLong(off)
+            acquireFence()
+            val kind = src.getShort(off + 8).toInt()
+            val runTag = src.getShort(off + 10).toInt() and 0xffff
+            val index = src.getInt(off + 12)
+            val value = src.getDouble(off + 16)
+            acquireFence()
+            val seqAfter = src.getLong(off)
+            if (seq != cursor + 1 || seqAfter != seq) {
+                dropped++
+                cursor++
+                continue
+            }
+            when (kind) {
+                KIND_RUN_BEGIN -> {
+                    run = runTag
+                    planned = index
+                    ops.clear()
+                    iterations.clear()
+                    tokens.clear()
+                }
+                KIND_ITERATION -> iterations.add(value)
+                KIND_TOKEN -> tokens.add(value)
+                KIND_OP -> {
+                    val agg = ops.getOrPut(index) { OpAgg(opName(src, index)) }
+                    agg.count++
+                    agg.totalMs += value
+                    if (value > agg.maxMs) agg.maxMs = value
+                }
+            }
+            cursor++
+        }
+        val opList = ArrayList<HashMap<String, Any>>()
+        for (agg in ops.values.sortedByDescending { it.totalMs }) {
+            opList.add(hashMapOf("name" to agg.name, "count" to agg.count, "total_ms" to agg.totalMs, "max_ms" to agg.maxMs))
+        }
+        return hashMapOf(
+            "run" to run,
+            "planned" to planned,
+            "iterations" to iterations.toDoubleArray(),
+            "tokens" to tokens.toDoubleArray(),
+            "ops" to opList,
+            "dropped" to dropped,
+        )
+    }
+
+    companion object {
+        private const val MAGIC = 0x544e4e4d
+        private const val HEADER_BYTES = 128
+        private const val HEAD_OFFSET = 64
+        private const val KIND_RUN_BEGIN = 1
+        private const val KIND_ITERATION = 2
+        private const val KIND_OP = 3
+        private const val KIND_TOKEN = 4
+    }
+}
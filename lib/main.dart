@@ -5,13 +5,15 @@ import 'dart:convert';
 import 'dart:io';
 import 'package:path_provider/path_provider.dart';
 import 'json_viewer.dart';
+import 'mnn_ffi.dart';
 import 'util/color_compat.dart';
 
 enum MnnBackend { auto, cpu, opencl, vulkan, metal, openGL }
 
 enum MemoryMode { low, balanced, high }
 
-enum PrecisionMode { low, normal, high }
+// auto: LOW where the probed backend reports FP16 support, NORMAL elsewhere (resolved natively).
+enum PrecisionMode { low, normal, high, auto }
 
 enum PowerMode { low, normal, high }
 
@@ -732,6 +734,39 @@ class _RunnerHomeState extends State<_RunnerHome> {
     }
   }
 
+  // Per-call overhead of the dart:ffi path against the MethodChannel path on the current config.
+  Future<void> _compareFfi() async {
+    final shape = _parseShape(_shapeCtrl.text);
+    final modelPath = _modelCtrl.text.trim();
+    if (modelPath.isEmpty || shape == null) {
+      setState(() => _status = 'Set model and valid shape');
+      return;
+    }
+    final cfg = MnnRunConfig(
+      modelPath: modelPath,
+      inputShape: shape,
+      backend: _backend,
+      backupType: _backup,
+      memoryMode: _memory,
+      precisionMode: _precision,
+      powerMode: _power,
+      inputFill: _fill,
+      threads: _threads,
+    );
+    setState(() {
+      _running = true;
+      _status = 'Comparing ffi and channel…';
+    });
+    try {
+      final report = await compareFfiWithChannel(_channel, cfg.toJson());
+      if (mounted) setState(() => _status = jsonEncode(report));
+    } catch (e) {
+      if (mounted) setState(() => _status = 'FFI compare error: $e');
+    } finally {
+      if (mounted) setState(() => _running = false);
+    }
+  }
+
   Future<void> _probeBackends() async {
     if (!Platform.isAndroid) {
       setState(() => _status = 'Probe is available on Android only for now');
@@ -751,15 +786,21 @@ class _RunnerHomeState extends State<_RunnerHome> {
         _clProbe = _Probe.fromJson(cl);
       });
       String fmtBool(dynamic v) => (v == true) ? 'YES' : 'NO';
-      final cpuOk = (obj['cpu'] as Map?)?['available'] ?? true;
+      // Capability flags are null when the runtime could not be asked (no Express, backend missing).
+      String fmtCaps(Map m) => m.containsKey('fp16')
+          ? ', fp16=${m['fp16'] == null ? '?' : fmtBool(m['fp16'])}, dot=${m['dot_product'] == null ? '?' : fmtBool(m['dot_product'])}'
+          : '';
+      final cpu = (obj['cpu'] as Map?) ?? const {};
+      final cpuOk = cpu['available'] ?? true;
+      final features = ((obj['cpu_features'] as Map?)?['features'] as List?)?.join(' ') ?? '';
       final summary = StringBuffer()
         ..writeln('Backend probe:')
-        ..writeln('- CPU: ${fmtBool(cpuOk)}')
+        ..writeln('- CPU: ${fmtBool(cpuOk)}${fmtCaps(cpu)}${features.isEmpty ? '' : ' [$features]'}')
         ..writeln(
-          '- VULKAN: avail=${fmtBool(vk['available'])}, lib=${fmtBool(vk['lib'])}, plugin=${fmtBool(vk['plugin'])}',
+          '- VULKAN: avail=${fmtBool(vk['available'])}, lib=${fmtBool(vk['lib'])}, plugin=${fmtBool(vk['plugin'])}${fmtCaps(vk)}',
         )
         ..writeln(
-          '- OPENCL: avail=${fmtBool(cl['available'])}, lib=${fmtBool(cl['lib'])}, plugin=${fmtBool(cl['plugin'])}, source=${cl['source'] ?? 'null'}',
+          '- OPENCL: avail=${fmtBool(cl['available'])}, lib=${fmtBool(cl['lib'])}, plugin=${fmtBool(cl['plugin'])}, source=${cl['source'] ?? 'null'}${fmtCaps(cl)}',
         );
       setState(() => _status = summary.toString());
     } on PlatformException catch (e) {
@@ -1090,13 +1131,21 @@ class _RunnerHomeState extends State<_RunnerHome> {
                       ],
                     ),
                     const SizedBox(height: 12),
-                    Align(
-                      alignment: Alignment.centerLeft,
-                      child: ElevatedButton.icon(
-                        onPressed: _running ? null : _probeBackends,
-                        icon: const Icon(Icons.manage_search),
-                        label: const Text('Probe backends'),
-                      ),
+                    Wrap(
+                      spacing: 8,
+                      runSpacing: 8,
+                      children: [
+                        ElevatedButton.icon(
+                          onPressed: _running ? null : _probeBackends,
+                          icon: const Icon(Icons.manage_search),
+                          label: const Text('Probe backends'),
+                        ),
+                        ElevatedButton.icon(
+                          onPressed: _running ? null : _compareFfi,
+                          icon: const Icon(Icons.compare_arrows),
+                          label: const Text('FFI vs channel'),
+                        ),
+                      ],
                     ),
                     const SizedBox(height: 12),
                     Row(
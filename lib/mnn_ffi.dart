@@ -0,0 +1,385 @@
+import 'dart:convert';
+import 'dart:ffi';
+import 'dart:io';
+import 'dart:isolate';
+import 'dart:typed_data';
+
+import 'package:ffi/ffi.dart';
+import 'package:flutter/services.dart';
+
+// dart:ffi binding of the native C ABI (android/app/src/main/cpp/mnn_capi.h). A session keeps the
+// prepared interpreter and host tensor buffers in native memory; inputs and outputs are typed-list
+// views of those buffers, so a run crosses no JSON, MethodChannel or thread.
+
+const int _mnnrAbiVersion = 1;
+const int _maxDims = 8;
+const int _maxName = 64;
+
+// Element types of mnnr_tensor_desc.type.
+const int mnnrFloat32 = 0;
+const int mnnrInt32 = 1;
+const int mnnrUint8 = 2;
+const int mnnrInt8 = 3;
+
+final class _Config extends Struct {
+  external Pointer<Utf8> modelPath;
+  external Pointer<Utf8> backend;
+  external Pointer<Utf8> backupType;
+  external Pointer<Utf8> precision;
+  external Pointer<Utf8> memory;
+  external Pointer<Utf8> power;
+  external Pointer<Utf8> cacheFile;
+  @Int32()
+  external int threads;
+  external Pointer<Int32> inputShape;
+  @Int32()
+  external int inputRank;
+}
+
+final class _OpenInfo extends Struct {
+  @Double()
+  external double createInterpreterMs;
+  @Double()
+  external double createSessionMs;
+  @Double()
+  external double resizeSessionMs;
+  @Int32()
+  external int inputs;
+  @Int32()
+  external int outputs;
+}
+
+final class _TensorDesc extends Struct {
+  @Array(_maxName)
+  external Array<Uint8> name;
+  @Int32()
+  external int type;
+  @Int32()
+  external int rank;
+  @Array(_maxDims)
+  external Array<Int32> dims;
+  @Int64()
+  external int elements;
+  @Int64()
+  external int bytes;
+}
+
+final class _Timing extends Struct {
+  @Double()
+  external double uploadMs;
+  @Double()
+  external double runMs;
+  @Double()
+  external double downloadMs;
+  @Double()
+  external double totalMs;
+}
+
+class _Api {
+  _Api(DynamicLibrary lib)
+      : abiVersion = lib.lookupFunction<Int32 Function(), int Function()>('mnnr_abi_version'),
+        lastError = lib.lookupFunction<Pointer<Utf8> Function(), Pointer<Utf8> Function()>('mnnr_last_error'),
+        open = lib.lookupFunction<Pointer<Void> Function(Pointer<_Config>, Pointer<_OpenInfo>),
+            Pointer<Void> Function(Pointer<_Config>, Pointer<_OpenInfo>)>('mnnr_open'),
+        close = lib.lookupFunction<Void Function(Pointer<Void>), void Function(Pointer<Void>)>('mnnr_close'),
+        describe = lib.lookupFunction<Int32 Function(Pointer<Void>, Int32, Int32, Pointer<_TensorDesc>),
+            int Function(Pointer<Void>, int, int, Pointer<_TensorDesc>)>('mnnr_describe'),
+        buffer = lib.lookupFunction<Pointer<Void> Function(Pointer<Void>, Int32, Int32),
+            Pointer<Void> Function(Pointer<Void>, int, int)>('mnnr_buffer'),
+        resizeInput = lib.lookupFunction<Int32 Function(Pointer<Void>, Int32, Pointer<Int32>, Int32),
+            int Function(Pointer<Void>, int, Pointer<Int32>, int)>('mnnr_resize_input'),
+        run = lib.lookupFunction<Int32 Function(Pointer<Void>, Pointer<_Timing>),
+            int Function(Pointer<Void>, Pointer<_Timing>)>('mnnr_run'),
+        bench = lib.lookupFunction<Int32 Function(Pointer<Void>, Int32, Int32, Pointer<Double>),
+            int Function(Pointer<Void>, int, int, Pointer<Double>)>('mnnr_bench');
+
+  final int Function() abiVersion;
+  final Pointer<Utf8> Function() lastError;
+  final Pointer<Void> Function(Pointer<_Config>, Pointer<_OpenInfo>) open;
+  final void Function(Pointer<Void>) close;
+  final int Function(Pointer<Void>, int, int, Pointer<_TensorDesc>) describe;
+  final Pointer<Void> Function(Pointer<Void>, int, int) buffer;
+  final int Function(Pointer<Void>, int, Pointer<Int32>, int) resizeInput;
+  final int Function(Pointer<Void>, Pointer<_Timing>) run;
+  final int Function(Pointer<Void>, int, int, Pointer<Double>) bench;
+
+  static _Api? _instance;
+
+  // The JNI library on Android (already loaded by NativeBridge), the host build's
+  // libmnn_runner_capi.so bundled under lib/ on Linux.
+  static _Api get instance {
+    final cached = _instance;
+    if (cached != null) return cached;
+    final DynamicLibrary lib;
+    if (Platform.isAndroid) {
+      lib = DynamicLibrary.open('libmnn_runner.so');
+    } else if (Platform.isLinux) {
+      final bundled = '${File(Platform.resolvedExecutable).parent.path}/lib/libmnn_runner_capi.so';
+      lib = DynamicLibrary.open(File(bundled).existsSync() ? bundled : 'libmnn_runner_capi.so');
+    } else {
+      throw UnsupportedError('The native runner C ABI is built for Android and Linux only');
+    }
+    final api = _Api(lib);
+    final version = api.abiVersion();
+    if (version != _mnnrAbiVersion) {
+      throw StateError('mnnr ABI $version, expected $_mnnrAbiVersion');
+    }
+    return _instance = api;
+  }
+
+  String error() => lastError().toDartString();
+}
+
+class MnnTensorDesc {
+  final String name;
+  final int type;
+  final List<int> shape;
+  final int elements;
+  final int bytes;
+
+  const MnnTensorDesc(this.name, this.type, this.shape, this.elements, this.bytes);
+
+  Map<String, dynamic> toJson() => {'name': name, 'type': type, 'shape': shape, 'elements': elements};
+}
+
+class MnnRunTiming {
+  final double uploadMs;
+  final double runMs;
+  final double downloadMs;
+  final double totalMs;
+
+  const MnnRunTiming(this.uploadMs, this.runMs, this.downloadMs, this.totalMs);
+}
+
+class MnnFfiException implements Exception {
+  final String message;
+  const MnnFfiException(this.message);
+
+  @override
+  String toString() => 'MnnFfiException: $message';
+}
+
+/// A prepared model in native memory. Fill [input] views, call [run], read [output] views; the
+/// views alias native buffers and are invalidated by [resizeInput] and [close].
+class MnnFfiSession {
+  MnnFfiSession._(this._api, this._handle, this.openInfo) : _timing = calloc<_Timing>() {
+    _describeAll();
+  }
+
+  final _Api _api;
+  Pointer<Void> _handle;
+  final Pointer<_Timing> _timing;
+  final Map<String, double> openInfo;
+  late List<MnnTensorDesc> inputs;
+  late List<MnnTensorDesc> outputs;
+  late List<TypedData> _inputViews;
+  late List<TypedData> _outputViews;
+
+  /// Same keys as `MnnRunConfig.toJson()`: modelPath, backend, backupType, precisionMode,
+  /// memoryMode, powerMode, threads, inputShape, cacheFile.
+  static MnnFfiSession open(Map<String, dynamic> config) {
+    final api = _Api.instance;
+    final shape = (config['inputShape'] as List?)?.cast<num>() ?? const <num>[];
+    return using((arena) {
+      String? str(String key) => config[key] is String ? config[key] as String : null;
+      Pointer<Utf8> cstr(String? s) => s == null ? nullptr : s.toNativeUtf8(allocator: arena);
+      final cfg = arena<_Config>();
+      cfg.ref
+        ..modelPath = cstr(str('modelPath'))
+        ..backend = cstr(str('backend'))
+        ..backupType = cstr(str('backupType'))
+        ..precision = cstr(str('precisionMode'))
+        ..memory = cstr(str('memoryMode'))
+        ..power = cstr(str('powerMode'))
+        ..cacheFile = cstr(str('cacheFile'))
+        ..threads = (config['threads'] as num?)?.toInt() ?? 4
+        ..inputRank = shape.length;
+      final dims = arena<Int32>(shape.isEmpty ? 1 : shape.length);
+      for (var i = 0; i < shape.length; i++) {
+        dims[i] = shape[i].toInt();
+      }
+      cfg.ref.inputShape = shape.isEmpty ? nullptr : dims;
+      final info = arena<_OpenInfo>();
+      final handle = api.open(cfg, info);
+      if (handle == nullptr) throw MnnFfiException(api.error());
+      return MnnFfiSession._(api, handle, {
+        'createInterpreter_ms': info.ref.createInterpreterMs,
+        'createSession_ms': info.ref.createSessionMs,
+        'resizeSession_ms': info.ref.resizeSessionMs,
+      });
+    });
+  }
+
+  void _describeAll() {
+    inputs = _describe(false);
+    outputs = _describe(true);
+    _inputViews = [for (var i = 0; i < inputs.length; i++) _view(false, i, inputs[i])];
+    _outputViews = [for (var i = 0; i < outputs.length; i++) _view(true, i, outputs[i])];
+  }
+
+  List<MnnTensorDesc> _describe(bool isOutput) {
+    final list = <MnnTensorDesc>[];
+    using((arena) {
+      final d = arena<_TensorDesc>();
+      for (var i = 0; _api.describe(_handle, isOutput ? 1 : 0, i, d) == 0; i++) {
+        final nameBytes = <int>[];
+        for (var c = 0; c < _maxName && d.ref.name[c] != 0; c++) {
+          nameBytes.add(d.ref.name[c]);
+        }
+        list.add(MnnTensorDesc(
+          utf8.decode(nameBytes, allowMalformed: true),
+          d.ref.type,
+          [for (var r = 0; r < d.ref.rank; r++) d.ref.dims[r]],
+          d.ref.elements,
+          d.ref.bytes,
+        ));
+      }
+    });
+    return list;
+  }
+
+  TypedData _view(bool isOutput, int index, MnnTensorDesc desc) {
+    final p = _api.buffer(_handle, isOutput ? 1 : 0, index);
+    switch (desc.type) {
+      case mnnrFloat32:
+        return p.cast<Float>().asTypedList(desc.elements);
+      case mnnrInt32:
+        return p.cast<Int32>().asTypedList(desc.elements);
+      case mnnrInt8:
+        return p.cast<Int8>().asTypedList(desc.elements);
+      default:
+        return p.cast<Uint8>().asTypedList(desc.bytes);
+    }
+  }
+
+  /// Native input buffer: Float32List, Int32List, Int8List, or raw bytes for other types.
+  TypedData input(int index) => _inputViews[index];
+  TypedData output(int index) => _outputViews[index];
+
+  void resizeInput(int index, List<int> shape) {
+    using((arena) {
+      final dims = arena<Int32>(shape.length);
+      for (var i = 0; i < shape.length; i++) {
+        dims[i] = shape[i];
+      }
+      if (_api.resizeInput(_handle, index, dims, shape.length) != 0) throw MnnFfiException(_api.error());
+    });
+    _describeAll();
+  }
+
+  MnnRunTiming run() {
+    if (_api.run(_handle, _timing) != 0) throw MnnFfiException(_api.error());
+    final t = _timing.ref;
+    return MnnRunTiming(t.uploadMs, t.runMs, t.downloadMs, t.totalMs);
+  }
+
+  /// Per-run total_ms of `iterations` runs timed inside native code.
+  List<double> bench({int warmup = 0, required int iterations}) {
+    final samples = calloc<Double>(iterations);
+    try {
+      if (_api.bench(_handle, warmup, iterations, samples) != 0) throw MnnFfiException(_api.error());
+      return List<double>.generate(iterations, (i) => samples[i]);
+    } finally {
+      calloc.free(samples);
+    }
+  }
+
+  void close() {
+    if (_handle == nullptr) return;
+    _api.close(_handle);
+    _handle = nullptr;
+    calloc.free(_timing);
+  }
+}
+
+Map<String, dynamic> _stats(List<double> v) {
+  if (v.isEmpty) return const {};
+  final s = [...v]..sort();
+  final mid = s.length ~/ 2;
+  final median = s.length.isOdd ? s[mid] : (s[mid - 1] + s[mid]) / 2;
+  double r(double x) => (x * 1000).roundToDouble() / 1000;
+  return {
+    'min_ms': r(s.first),
+    'median_ms': r(median),
+    'mean_ms': r(v.reduce((a, b) => a + b) / v.length),
+    'max_ms': r(s.last),
+  };
+}
+
+// Per-call cost of one inference through the C ABI: wall time of the Dart call around mnnr_run
+// against the native runSession time it reports. Runs in a background isolate, off the UI thread.
+Future<Map<String, dynamic>> _measureFfi(Map<String, dynamic> config, int calls) {
+  return Isolate.run(() {
+    final session = MnnFfiSession.open(config);
+    try {
+      session.run();
+      final wall = <double>[], run = <double>[], staging = <double>[], overhead = <double>[];
+      final sw = Stopwatch();
+      for (var i = 0; i < calls; i++) {
+        sw
+          ..reset()
+          ..start();
+        final t = session.run();
+        sw.stop();
+        final w = sw.elapsedMicroseconds / 1000.0;
+        wall.add(w);
+        run.add(t.runMs);
+        staging.add(t.uploadMs + t.downloadMs);
+        overhead.add(w - t.runMs);
+      }
+      return {
+        'open': session.openInfo,
+        'wall': _stats(wall),
+        'runSession': _stats(run),
+        'tensor_copy': _stats(staging),
+        'overhead': _stats(overhead),
+      };
+    } finally {
+      session.close();
+    }
+  });
+}
+
+// The same per-call measurement through the MethodChannel `poolRun` path (JSON encode, platform
+// thread, Kotlin JSONObject, worker thread, JNI, JSON report, decode) on a resident pool entry.
+Future<Map<String, dynamic>> _measureChannel(MethodChannel channel, Map<String, dynamic> config, int calls) async {
+  final cfg = {...config, 'iterations': 1, 'warmup': 0, 'predictNext': false, 'profile': false};
+  // First call builds the pool entry; only calls on the resident entry are timed.
+  await channel.invokeMethod<String>('poolRun', jsonEncode(cfg));
+  final wall = <double>[], run = <double>[], overhead = <double>[];
+  final sw = Stopwatch();
+  for (var i = 0; i < calls; i++) {
+    sw
+      ..reset()
+      ..start();
+    final res = await channel.invokeMethod<String>('poolRun', jsonEncode(cfg));
+    final obj = jsonDecode(res ?? '{}') as Map<String, dynamic>;
+    sw.stop();
+    if (obj['error'] != null) throw MnnFfiException(obj['error'].toString());
+    final samples = ((obj['latency'] as Map?)?['samples_ms'] as List?) ?? const [];
+    final r = samples.isEmpty ? 0.0 : (samples.first as num).toDouble();
+    final w = sw.elapsedMicroseconds / 1000.0;
+    wall.add(w);
+    run.add(r);
+    overhead.add(w - r);
+  }
+  return {'wall': _stats(wall), 'runSession': _stats(run), 'overhead': _stats(overhead)};
+}
+
+/// Per-call overhead of the dart:ffi path against the MethodChannel path for the same model and
+/// config, `calls` inferences each on an already prepared session. Overhead is wall time minus the
+/// runSession time each path reports; the channel half runs on Android only.
+Future<Map<String, dynamic>> compareFfiWithChannel(
+  MethodChannel channel,
+  Map<String, dynamic> config, {
+  int calls = 50,
+}) async {
+  final report = <String, dynamic>{'calls': calls, 'ffi': await _measureFfi(config, calls)};
+  if (Platform.isAndroid) {
+    report['channel'] = await _measureChannel(channel, config, calls);
+    final ffiOver = (report['ffi']['overhead'] as Map)['median_ms'] as double;
+    final chOver = (report['channel']['overhead'] as Map)['median_ms'] as double;
+    report['overhead_saved_ms'] = ((chOver - ffiOver) * 1000).roundToDouble() / 1000;
+  }
+  return report;
+}